@@ -49,11 +49,11 @@ private:
 
   const crud_context context_;
 
-  std::shared_ptr<matador::http::detail::template_part> list_template_;
-  std::shared_ptr<matador::http::detail::template_part> details_template_;
-  std::shared_ptr<matador::http::detail::template_part> create_template_;
-  std::shared_ptr<matador::http::detail::template_part> edit_template_;
-  std::shared_ptr<matador::http::detail::template_part> delete_template_;
+  std::shared_ptr<matador::http::detail::template_program> list_template_;
+  std::shared_ptr<matador::http::detail::template_program> details_template_;
+  std::shared_ptr<matador::http::detail::template_program> create_template_;
+  std::shared_ptr<matador::http::detail::template_program> edit_template_;
+  std::shared_ptr<matador::http::detail::template_program> delete_template_;
 };
 
 template < class EntityType >
@@ -69,31 +69,31 @@ crud_page<EntityType>::crud_page(const crud_context &ctx,
   f.close();
 
   using namespace matador::http;
-  list_template_ = template_engine::build(tmpl);
+  list_template_ = template_engine::compile(tmpl);
 
   f.open("../templates/" + ctx.entity_type_name + "_details.matador", "r");
   tmpl = read_as_text(f);
   f.close();
 
-  details_template_ = template_engine::build(tmpl);
+  details_template_ = template_engine::compile(tmpl);
 
   f.open("../templates/" + ctx.entity_type_name + "_create.matador", "r");
   tmpl = read_as_text(f);
   f.close();
 
-  create_template_ = template_engine::build(tmpl);
+  create_template_ = template_engine::compile(tmpl);
 
   f.open("../templates/" + ctx.entity_type_name + "_edit.matador", "r");
   tmpl = read_as_text(f);
   f.close();
 
-  edit_template_ = template_engine::build(tmpl);
+  edit_template_ = template_engine::compile(tmpl);
 
   f.open("../templates/" + ctx.entity_type_name + "_delete.matador", "r");
   tmpl = read_as_text(f);
   f.close();
 
-  delete_template_ = template_engine::build(tmpl);
+  delete_template_ = template_engine::compile(tmpl);
 
   server.on_get("/" + ctx.entity_type_name, [this](const request &req) {
     return list(req);
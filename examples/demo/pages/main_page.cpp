@@ -16,7 +16,7 @@ main_page::main_page(matador::http::server &s, matador::persistence &p)
   auto tmpl = read_as_text(f);
   f.close();
 
-  index_template_ = template_engine::build(tmpl);
+  index_template_ = template_engine::compile(tmpl);
 
   s.on_get("/", [this](const request &req) {
     return view(req);
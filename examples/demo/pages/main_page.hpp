@@ -9,7 +9,7 @@ namespace matador {
 class persistence;
 namespace http {
 namespace detail {
-class template_part;
+class template_program;
 }
 class server;
 class request;
@@ -28,7 +28,7 @@ private:
 
   matador::persistence& persistence_;
 
-  std::shared_ptr<matador::http::detail::template_part> index_template_;
+  std::shared_ptr<matador::http::detail::template_program> index_template_;
 };
 
 
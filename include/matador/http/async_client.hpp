@@ -0,0 +1,300 @@
+#ifndef MATADOR_ASYNC_CLIENT_HPP
+#define MATADOR_ASYNC_CLIENT_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/http/response.hpp"
+#include "matador/http/request.hpp"
+
+#include "matador/net/handler_creator.hpp"
+#include "matador/net/io_service.hpp"
+#include "matador/net/ip.hpp"
+
+#include "matador/logger/logger.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace matador {
+namespace http {
+
+/// @cond MATADOR_DEV
+namespace detail {
+class client_connection;
+struct client_exchange;
+}
+/// @endcond
+
+/**
+ * @brief An asynchronous http client
+ *
+ * The asynchronous client sends its requests on the
+ * connections of an io_service. A request returns
+ * immediately; the response is delivered to the given
+ * callback or the returned future once it was received.
+ * Any number of requests may be in flight at the same
+ * time, all of them dispatched by the threads of the
+ * io_service.
+ *
+ * Requests may be issued from any thread, the request
+ * is handed over to the reactor thread owning its
+ * connection. The host is resolved once by a thread of
+ * its own, the calling thread never blocks.
+ *
+ * Connections are established non blocking. After a
+ * response was read the connection is kept and reused
+ * by the next request. If the server closed a kept
+ * connection before the response was received, a safe
+ * request (GET, HEAD, OPTIONS) is sent once again on a
+ * new connection; any other request fails.
+ *
+ * Each request has a timeout. If the response isn't
+ * complete within the timeout the connection is closed
+ * and the request fails with ETIMEDOUT. This includes
+ * the time a request waits for the host to be resolved.
+ *
+ * Callbacks are called from a thread of the io_service
+ * and must not block. The client must outlive all of its
+ * requests and the io_service must be running to complete
+ * them.
+ */
+class OOS_HTTP_API async_client : public handler_creator
+{
+public:
+  /**
+   * Callback receiving the result of a request. The error
+   * code is zero on success, otherwise an errno value
+   * (i.e. ETIMEDOUT or ECONNREFUSED) and the response
+   * is empty.
+   */
+  typedef std::function<void(int ec, const response &resp)> t_response_handler;
+
+  /**
+   * Function resolving the endpoints of a host and port
+   */
+  typedef std::function<std::vector<tcp::peer>(const std::string &host, const std::string &port)> t_resolver;
+
+  /**
+   * Creates an asynchronous client for the given host
+   * dispatched by the given io_service.
+   *
+   * @param service The io_service to dispatch the requests
+   * @param host Host and optional port string
+   */
+  async_client(io_service &service, const std::string &host);
+
+  /**
+   * Closes all kept connections. While the io_service
+   * is running the connections are closed by their
+   * reactors and the destructor waits for it. Thus
+   * the client must not be destroyed within one of
+   * its callbacks.
+   */
+  ~async_client() override;
+
+  async_client(const async_client&) = delete;
+  async_client& operator=(const async_client&) = delete;
+
+  /**
+   * Sends a GET request to the given route and
+   * calls the handler with the response.
+   *
+   * @param route Route to be requested
+   * @param handler Handler called with the response
+   */
+  void get(const std::string &route, t_response_handler handler);
+
+  /**
+   * Sends a GET request to the given route.
+   *
+   * @param route Route to be requested
+   * @return Future of the response
+   */
+  std::future<response> get(const std::string &route);
+
+  /**
+   * Sends a POST request to the given route with
+   * the given body and calls the handler with the
+   * response.
+   *
+   * @param route Route to be requested
+   * @param body String representing the body of the request
+   * @param handler Handler called with the response
+   */
+  void post(const std::string &route, const std::string &body, t_response_handler handler);
+
+  /**
+   * Sends a POST request to the given route
+   * with the given body.
+   *
+   * @param route Route to be requested
+   * @param body String representing the body of the request
+   * @return Future of the response
+   */
+  std::future<response> post(const std::string &route, const std::string &body);
+
+  /**
+   * Sends a PUT request to the given route with
+   * the given body and calls the handler with the
+   * response.
+   *
+   * @param route Route to be requested
+   * @param body String representing the body of the request
+   * @param handler Handler called with the response
+   */
+  void put(const std::string &route, const std::string &body, t_response_handler handler);
+
+  /**
+   * Sends a PUT request to the given route
+   * with the given body.
+   *
+   * @param route Route to be requested
+   * @param body String representing the body of the request
+   * @return Future of the response
+   */
+  std::future<response> put(const std::string &route, const std::string &body);
+
+  /**
+   * Sends a DELETE request to the given route and
+   * calls the handler with the response.
+   *
+   * @param route Route to be requested
+   * @param handler Handler called with the response
+   */
+  void remove(const std::string &route, t_response_handler handler);
+
+  /**
+   * Sends a DELETE request to the given route.
+   *
+   * @param route Route to be requested
+   * @return Future of the response
+   */
+  std::future<response> remove(const std::string &route);
+
+  /**
+   * Sends the given request with the given timeout
+   * and calls the handler with the response. A zero
+   * timeout waits without limit.
+   *
+   * @param req Request to send
+   * @param handler Handler called with the response
+   * @param timeout Timeout of the request
+   */
+  void execute(request req, t_response_handler handler, std::chrono::milliseconds timeout);
+
+  /**
+   * Sends the given request with the default timeout
+   * and calls the handler with the response.
+   *
+   * @param req Request to send
+   * @param handler Handler called with the response
+   */
+  void execute(request req, t_response_handler handler);
+
+  /**
+   * Sends the given request with the default timeout.
+   * If the request fails the future throws a
+   * std::system_error with the error code.
+   *
+   * @param req Request to send
+   * @return Future of the response
+   */
+  std::future<response> execute(request req);
+
+  /**
+   * Sets the default timeout of a request.
+   * Defaults to 30 seconds.
+   *
+   * @param timeout Default timeout of a request
+   */
+  void timeout(std::chrono::milliseconds timeout);
+
+  /**
+   * Returns the default timeout of a request.
+   *
+   * @return Default timeout of a request
+   */
+  std::chrono::milliseconds timeout() const;
+
+  /**
+   * Sets the function resolving the host. It is
+   * called by the resolving thread and may block.
+   * Defaults to the tcp::resolver.
+   *
+   * @param resolver Function resolving the host
+   */
+  void resolver(t_resolver resolver);
+
+  /**
+   * Sets the maximum number of kept idle
+   * connections. Defaults to 32.
+   *
+   * @param max_idle Maximum number of idle connections
+   */
+  void max_idle_connections(std::size_t max_idle);
+
+  /**
+   * Returns the number of open connections
+   *
+   * @return Number of open connections
+   */
+  std::size_t connections() const;
+
+  /**
+   * Returns the number of idle connections
+   *
+   * @return Number of idle connections
+   */
+  std::size_t idle_connections() const;
+
+  /// @cond MATADOR_DEV
+  void notify_close(handler *hndlr) override;
+
+  void release(const std::shared_ptr<detail::client_connection> &conn, bool reuse);
+  void retry(const std::shared_ptr<detail::client_exchange> &exchange);
+  /// @endcond
+
+private:
+  void send(const std::shared_ptr<detail::client_exchange> &exchange, bool allow_idle);
+  void connect(const std::shared_ptr<detail::client_exchange> &exchange);
+  bool connect(const std::vector<tcp::peer> &endpoints, const std::shared_ptr<detail::client_exchange> &exchange);
+  void resolve();
+  void expire();
+
+private:
+  io_service &service_;
+  std::string host_;
+  std::string port_ { "80" };
+
+  std::chrono::milliseconds timeout_ { std::chrono::seconds(30) };
+  std::size_t max_idle_ = 32;
+
+  logger log_;
+
+  std::atomic_size_t next_shard_ { 0 };
+
+  mutable std::mutex mutex_;
+  std::vector<tcp::peer> endpoints_;
+  t_resolver resolver_;
+  std::list<std::shared_ptr<detail::client_exchange>> waiting_;
+  bool resolving_ = false;
+  bool expiring_ = false;
+  std::condition_variable resolved_;
+  std::list<std::shared_ptr<detail::client_connection>> idle_;
+  std::list<std::shared_ptr<detail::client_connection>> closing_;
+  std::condition_variable closed_;
+  std::size_t connections_ = 0;
+};
+
+}
+}
+
+#endif //MATADOR_ASYNC_CLIENT_HPP
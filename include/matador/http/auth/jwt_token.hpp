@@ -1,8 +1,11 @@
 #ifndef MATADOR_JWT_TOKEN_HPP
 #define MATADOR_JWT_TOKEN_HPP
 
+#include "matador/utils/access.hpp"
 #include "matador/utils/time.hpp"
 
+#include <string>
+
 namespace matador {
 namespace http {
 namespace auth {
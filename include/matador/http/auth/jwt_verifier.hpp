@@ -0,0 +1,126 @@
+#ifndef MATADOR_JWT_VERIFIER_HPP
+#define MATADOR_JWT_VERIFIER_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/http/auth/jwt_token.hpp"
+
+#include "matador/utils/hmac.hpp"
+
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace matador {
+namespace http {
+namespace auth {
+
+/**
+ * @brief Signs and verifies HS256 json web tokens
+ *
+ * The verifier signs tokens with HMAC-SHA256 and checks
+ * the signature and the time claims (exp and nbf) of a
+ * given token. The hmac key pads of the secret are
+ * precomputed once.
+ *
+ * Verified tokens are kept in a bounded cache (least
+ * recently used tokens are removed first). A cached
+ * token is verified without any decoding or hashing,
+ * only its expiration time is checked again. Tokens
+ * are cached with their complete text, so a modified
+ * token is never taken from the cache.
+ *
+ * The verifier may be used by more than one thread.
+ */
+class OOS_HTTP_API jwt_verifier
+{
+public:
+  /**
+   * Creates a verifier for tokens signed
+   * with the given secret.
+   *
+   * @param secret Secret of the tokens
+   * @param cache_size Maximum number of cached tokens
+   */
+  explicit jwt_verifier(const std::string &secret, std::size_t cache_size = 1024);
+
+  jwt_verifier(const jwt_verifier&) = delete;
+  jwt_verifier& operator=(const jwt_verifier&) = delete;
+
+  /**
+   * Encodes and signs the given token. The header
+   * algorithm and type are set to HS256 and JWT.
+   *
+   * @param token Token to encode
+   * @return The encoded token
+   */
+  std::string encode(const jwt_token &token) const;
+
+  /**
+   * Returns true if the given token is signed with
+   * the secret of the verifier and is neither
+   * expired nor used before its not before time.
+   *
+   * @param token Encoded token to verify
+   * @return True if the token is valid
+   */
+  bool verify(const std::string &token);
+
+  /**
+   * Verifies the given encoded token and on success
+   * writes the decoded token to the given result.
+   *
+   * @param token Encoded token to verify
+   * @param result The decoded token
+   * @return True if the token is valid
+   */
+  bool verify(const std::string &token, jwt_token &result);
+
+  /**
+   * Returns the number of cached tokens
+   *
+   * @return Number of cached tokens
+   */
+  std::size_t size() const;
+
+  /**
+   * Returns the maximum number of cached tokens
+   *
+   * @return Maximum number of cached tokens
+   */
+  std::size_t cache_size() const;
+
+  /**
+   * Removes all tokens from the cache
+   */
+  void clear();
+
+private:
+  struct entry
+  {
+    std::string text;
+    jwt_token token;
+    std::time_t expires = 0;
+  };
+
+  std::string signature(const char *data, std::size_t size) const;
+  bool decode(const std::string &text, jwt_token &token) const;
+
+  static bool is_valid(const jwt_token &token, std::time_t now);
+
+private:
+  hmac_key key_;
+  std::size_t cache_size_;
+
+  mutable std::mutex mutex_;
+  std::list<entry> entries_;
+  std::unordered_map<std::string, std::list<entry>::iterator> index_;
+};
+
+}
+}
+}
+
+#endif //MATADOR_JWT_VERIFIER_HPP
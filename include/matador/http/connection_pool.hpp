@@ -0,0 +1,201 @@
+#ifndef MATADOR_CONNECTION_POOL_HPP
+#define MATADOR_CONNECTION_POOL_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/net/ip.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace matador {
+namespace http {
+
+/**
+ * @brief Pool of persistent client connections
+ *
+ * The connection pool keeps the idle persistent connections
+ * of http clients per host and port. A client acquires a
+ * connection before it sends a request and releases it
+ * after the response was read. An idle connection is
+ * reused by the next request to the same host.
+ *
+ * The number of connections per host (idle and in use)
+ * is limited. If the limit is reached a client waits until
+ * another client releases its connection.
+ *
+ * Idle connections closed by the server and connections
+ * idle longer than the idle timeout are dropped on the
+ * next acquire.
+ *
+ * The pool caches the resolved endpoints of each host as
+ * well.
+ *
+ * The pool may be shared by clients of different
+ * threads.
+ */
+class OOS_HTTP_API connection_pool
+{
+public:
+  /**
+   * Creates a connection pool with at most
+   * max_connections connections per host.
+   *
+   * @param max_connections Maximum number of connections per host
+   */
+  explicit connection_pool(std::size_t max_connections = 8);
+
+  connection_pool(const connection_pool&) = delete;
+  connection_pool& operator=(const connection_pool&) = delete;
+
+  /**
+   * Closes all idle connections
+   */
+  ~connection_pool();
+
+  /**
+   * Acquires a connection to the given host and port. If
+   * there is an idle connection it is assigned to the given
+   * socket. Otherwise a new connection is accounted and the
+   * given socket stays closed; the caller must connect it.
+   *
+   * If the connection limit of the host is reached the call
+   * waits until a connection is released or the timeout
+   * elapsed. A zero timeout waits without limit.
+   *
+   * @param host Host to connect to
+   * @param port Port to connect to
+   * @param sock Socket to assign the idle connection to
+   * @param timeout Maximum time to wait for a connection
+   * @return False if there was no connection in time
+   */
+  bool acquire(const std::string &host, const std::string &port, tcp::socket &sock, std::chrono::milliseconds timeout);
+
+  /**
+   * Releases an acquired connection. If reuse is true and
+   * the socket is open the connection is kept for the next
+   * request. Otherwise the socket is closed.
+   *
+   * @param host Host of the connection
+   * @param port Port of the connection
+   * @param sock Socket of the connection
+   * @param reuse True if the connection may be reused
+   */
+  void release(const std::string &host, const std::string &port, tcp::socket &sock, bool reuse);
+
+  /**
+   * Returns the cached endpoints of the given
+   * host and port. They are resolved on the first
+   * call.
+   *
+   * @param host Host to resolve
+   * @param port Port to resolve
+   * @return The endpoints of the host
+   */
+  std::vector<tcp::peer> endpoints(const std::string &host, const std::string &port);
+
+  /**
+   * Removes the cached endpoints of the given host
+   * and port. They are resolved again with the next
+   * call to endpoints().
+   *
+   * @param host Host of the endpoints
+   * @param port Port of the endpoints
+   */
+  void invalidate_endpoints(const std::string &host, const std::string &port);
+
+  /**
+   * Sets the maximum number of connections
+   * per host.
+   *
+   * @param max_connections Maximum number of connections per host
+   */
+  void max_connections(std::size_t max_connections);
+
+  /**
+   * Returns the maximum number of connections
+   * per host.
+   *
+   * @return Maximum number of connections per host
+   */
+  std::size_t max_connections() const;
+
+  /**
+   * Sets the time after which an idle connection
+   * is closed. Defaults to 30 seconds.
+   *
+   * @param timeout Idle timeout
+   */
+  void idle_timeout(std::chrono::milliseconds timeout);
+
+  /**
+   * Returns the time after which an idle
+   * connection is closed.
+   *
+   * @return Idle timeout
+   */
+  std::chrono::milliseconds idle_timeout() const;
+
+  /**
+   * Returns the number of idle and used
+   * connections to the given host and port.
+   *
+   * @param host Host of the connections
+   * @param port Port of the connections
+   * @return Number of connections
+   */
+  std::size_t connections(const std::string &host, const std::string &port) const;
+
+  /**
+   * Returns the number of idle connections
+   * to the given host and port.
+   *
+   * @param host Host of the connections
+   * @param port Port of the connections
+   * @return Number of idle connections
+   */
+  std::size_t idle_connections(const std::string &host, const std::string &port) const;
+
+  /**
+   * Closes all idle connections
+   */
+  void clear();
+
+private:
+  struct idle_connection
+  {
+    tcp::socket sock;
+    std::chrono::steady_clock::time_point since;
+  };
+
+  struct host_entry
+  {
+    // most recently released first
+    std::list<idle_connection> idle;
+    // idle and used connections
+    std::size_t connections = 0;
+    std::vector<tcp::peer> endpoints;
+  };
+
+  static std::string key(const std::string &host, const std::string &port);
+  static bool is_closed(const tcp::socket &sock);
+
+private:
+  mutable std::mutex mutex_;
+  std::condition_variable released_;
+
+  std::size_t max_connections_;
+  std::chrono::milliseconds idle_timeout_ { std::chrono::seconds(30) };
+
+  std::unordered_map<std::string, host_entry> hosts_;
+};
+
+}
+}
+
+#endif //MATADOR_CONNECTION_POOL_HPP
@@ -0,0 +1,47 @@
+#ifndef MATADOR_HEADER_VALUE_HPP
+#define MATADOR_HEADER_VALUE_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/utils/string_span.hpp"
+
+namespace matador {
+namespace http {
+namespace detail {
+
+/// @cond MATADOR_DEV
+
+/**
+ * Returns true if the entity tag list of an If-None-Match
+ * header matches the given entity tag. The list matches
+ * if it is "*" or contains the tag. Tags are compared
+ * weakly, a weak tag (W/"...") matches as well.
+ *
+ * @param if_none_match Value of the If-None-Match header
+ * @param etag Entity tag of the current representation
+ * @return True if the list matches the tag
+ */
+OOS_HTTP_API bool match_entity_tag(const string_span &if_none_match, const string_span &etag);
+
+/**
+ * Returns true if a connection stays open after the
+ * current message. The Connection header is a comma
+ * separated list of case insensitive tokens; "close"
+ * ends the connection, "keep-alive" keeps it open.
+ * Without either token persistent connections are
+ * the default since HTTP/1.1.
+ *
+ * @param connection Value of the Connection header
+ * @param major Major HTTP version of the message
+ * @param minor Minor HTTP version of the message
+ * @return True if the connection is persistent
+ */
+OOS_HTTP_API bool is_persistent_connection(const string_span &connection, int major, int minor);
+
+/// @endcond
+
+}
+}
+}
+
+#endif //MATADOR_HEADER_VALUE_HPP
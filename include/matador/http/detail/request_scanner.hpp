@@ -0,0 +1,97 @@
+#ifndef MATADOR_REQUEST_SCANNER_HPP
+#define MATADOR_REQUEST_SCANNER_HPP
+
+#include "matador/http/export.hpp"
+
+namespace matador {
+namespace http {
+namespace detail {
+
+/// @cond MATADOR_DEV
+
+/**
+ * Instruction set used to scan requests
+ */
+enum class scan_level
+{
+  SCALAR, /**< One byte at a time with lookup tables */
+  SSE42,  /**< 16 bytes at a time with SSE4.2 string instructions */
+  AVX2    /**< 32 bytes at a time with AVX2 */
+};
+
+/**
+ * Returns the best scan level supported by the CPU.
+ * The level is detected once at runtime.
+ *
+ * @return Best supported scan level
+ */
+OOS_HTTP_API scan_level supported_scan_level();
+
+/**
+ * Returns the scan level currently used
+ *
+ * @return Current scan level
+ */
+OOS_HTTP_API scan_level current_scan_level();
+
+/**
+ * Sets the scan level used by all parsers. Fails if
+ * the level isn't supported by the CPU. Meant for
+ * tests and benchmarks.
+ *
+ * @param level Scan level to use
+ * @return True if the level was set
+ */
+OOS_HTTP_API bool use_scan_level(scan_level level);
+
+/**
+ * Returns the first character in the range which isn't
+ * valid in an url or end. Valid are all alphanumeric
+ * characters, '%' and "-._~:/?#[]@!$&'()*+,;=".
+ *
+ * @param begin Begin of the range
+ * @param end End of the range
+ * @return First invalid url character or end
+ */
+OOS_HTTP_API const char* find_non_url_char(const char *begin, const char *end);
+
+/**
+ * Returns the first character in the range which
+ * isn't valid in a header name (alphanumeric
+ * or '-') or end.
+ *
+ * @param begin Begin of the range
+ * @param end End of the range
+ * @return First invalid header name character or end
+ */
+OOS_HTTP_API const char* find_non_token_char(const char *begin, const char *end);
+
+/**
+ * Returns the first character in the range which
+ * isn't valid in a header value (printable or blank)
+ * or end. This is at the latest the CR ending the line.
+ *
+ * @param begin Begin of the range
+ * @param end End of the range
+ * @return First invalid header value character or end
+ */
+OOS_HTTP_API const char* find_non_value_char(const char *begin, const char *end);
+
+/**
+ * Returns the position of the empty line (CRLF CRLF)
+ * ending the header or nullptr if the range doesn't
+ * contain it.
+ *
+ * @param begin Begin of the range
+ * @param end End of the range
+ * @return Start of CRLF CRLF or nullptr
+ */
+OOS_HTTP_API const char* find_header_end(const char *begin, const char *end);
+
+/// @endcond
+
+}
+}
+}
+
+#endif //MATADOR_REQUEST_SCANNER_HPP
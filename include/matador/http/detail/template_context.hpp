@@ -0,0 +1,65 @@
+#ifndef MATADOR_TEMPLATE_CONTEXT_HPP
+#define MATADOR_TEMPLATE_CONTEXT_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/http/detail/template_value.hpp"
+
+#include <string>
+#include <vector>
+
+namespace matador {
+namespace http {
+namespace detail {
+
+/// @cond MATADOR_DEV
+
+/*
+ * A dotted path (i.e. "person.name") split
+ * into its segments once when the template
+ * is parsed.
+ */
+using template_path = std::vector<std::string>;
+
+OOS_HTTP_API template_path split_path(const std::string &path);
+
+/*
+ * Resolves template paths against the rendered
+ * data (json or serializable object) and the
+ * elements of the enclosing for loops. The innermost loop element is
+ * looked up first; 'forloop.parent' steps out
+ * to the enclosing scope.
+ */
+class OOS_HTTP_API template_context
+{
+public:
+  explicit template_context(const json &data);
+  explicit template_context(const template_value &data);
+
+  template_value at(const template_path &path) const;
+
+  void push(const std::string &name, const template_value &value);
+  void replace(const template_value &value);
+  void pop();
+
+private:
+  static template_value resolve(template_value value, const template_path &path, std::size_t index);
+
+private:
+  struct scope
+  {
+    const std::string *name;
+    template_value value;
+  };
+
+  template_value data_;
+  std::vector<scope> scopes_;
+};
+
+/// @endcond
+
+}
+}
+}
+
+#endif //MATADOR_TEMPLATE_CONTEXT_HPP
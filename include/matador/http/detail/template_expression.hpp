@@ -3,6 +3,8 @@
 
 #include "matador/http/export.hpp"
 
+#include "matador/http/detail/template_context.hpp"
+
 #include <string>
 #include <functional>
 
@@ -20,7 +22,9 @@ class OOS_HTTP_API template_expression
 public:
   virtual ~template_expression() = default;
 
-  virtual bool evaluate(const json &data) const = 0;
+  bool evaluate(const json &data) const;
+
+  virtual bool evaluate(const template_context &context) const = 0;
 };
 
 OOS_HTTP_API bool operator==(const json &a, const std::string &b);
@@ -29,27 +33,29 @@ OOS_HTTP_API bool operator!=(const json &a, const std::string &b);
 class OOS_HTTP_API json_value_expression : public template_expression
 {
 public:
-  explicit json_value_expression(std::string value_name);
+  explicit json_value_expression(const std::string &value_name);
 
-  bool evaluate(const json &data) const override;
+  using template_expression::evaluate;
+  bool evaluate(const template_context &context) const override;
 
 private:
-  std::string value_name_;
+  template_path value_path_;
 };
 
 class OOS_HTTP_API json_compare_expression : public template_expression
 {
 public:
   template < typename Function >
-  json_compare_expression(std::string value_name, Function &&func)
-    : value_name_(std::move(value_name))
+  json_compare_expression(const std::string &value_name, Function &&func)
+    : value_path_(split_path(value_name))
     , compare_func_(func)
   {}
 
-  bool evaluate(const json &data) const override;
+  using template_expression::evaluate;
+  bool evaluate(const template_context &context) const override;
 
 private:
-  std::string value_name_;
+  template_path value_path_;
   std::function<bool(const json &value)> compare_func_;
 };
 
@@ -57,17 +63,18 @@ class OOS_HTTP_API json_json_compare_expression : public template_expression
 {
 public:
   template < typename Function >
-  json_json_compare_expression(std::string left_name, std::string right_name, Function &&func)
-    : left_name_(std::move(left_name))
-    , right_name_(std::move(right_name))
+  json_json_compare_expression(const std::string &left_name, const std::string &right_name, Function &&func)
+    : left_path_(split_path(left_name))
+    , right_path_(split_path(right_name))
     , compare_func_(func)
   {}
 
-  bool evaluate(const json &data) const override;
+  using template_expression::evaluate;
+  bool evaluate(const template_context &context) const override;
 
 private:
-  std::string left_name_;
-  std::string right_name_;
+  template_path left_path_;
+  template_path right_path_;
   std::function<bool(const json &left, const json &right)> compare_func_;
 };
 
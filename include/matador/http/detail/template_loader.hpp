@@ -0,0 +1,56 @@
+#ifndef MATADOR_TEMPLATE_LOADER_HPP
+#define MATADOR_TEMPLATE_LOADER_HPP
+
+#include "matador/http/export.hpp"
+
+#include <memory>
+#include <string>
+
+namespace matador {
+namespace http {
+namespace detail {
+
+/// @cond MATADOR_DEV
+
+class template_part;
+
+/*
+ * Loads the templates included while a template
+ * is parsed. If no loader is installed for the
+ * parsing thread, included files are read from
+ * disk and parsed on every include.
+ */
+class OOS_HTTP_API template_loader
+{
+public:
+  virtual ~template_loader() = default;
+
+  virtual std::shared_ptr<template_part> load(const std::string &path) = 0;
+
+  static template_loader* current();
+};
+
+/*
+ * Installs the given loader for the current
+ * thread until the scope is left.
+ */
+class OOS_HTTP_API template_loader_scope
+{
+public:
+  explicit template_loader_scope(template_loader *loader);
+  ~template_loader_scope();
+
+  template_loader_scope(const template_loader_scope&) = delete;
+  template_loader_scope& operator=(const template_loader_scope&) = delete;
+
+private:
+  template_loader *previous_;
+};
+
+/// @endcond
+
+}
+}
+}
+
+#endif //MATADOR_TEMPLATE_LOADER_HPP
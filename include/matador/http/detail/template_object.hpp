@@ -0,0 +1,394 @@
+#ifndef MATADOR_TEMPLATE_OBJECT_HPP
+#define MATADOR_TEMPLATE_OBJECT_HPP
+
+#include "matador/http/detail/template_value.hpp"
+
+#include "matador/object/container.hpp"
+#include "matador/object/object_ptr.hpp"
+#include "matador/object/object_view.hpp"
+
+#include "matador/utils/access.hpp"
+#include "matador/utils/cascade_type.hpp"
+#include "matador/utils/date.hpp"
+#include "matador/utils/field_attributes.hpp"
+#include "matador/utils/time.hpp"
+
+#include <list>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace matador {
+namespace http {
+namespace detail {
+
+/// @cond MATADOR_DEV
+
+template < class Type, class Enable = void >
+struct template_type_traits;
+
+template < class Type >
+template_value make_template_value(const Type &value)
+{
+  return template_value(&value, template_type_traits<Type>::type());
+}
+
+template < class Type >
+class object_template_type;
+
+template < class Type >
+template_value make_template_value(const object_ptr<Type> &value)
+{
+  if (value.empty()) {
+    return template_value();
+  }
+  return template_value(value.get(), object_template_type<Type>::instance());
+}
+
+/*
+ * A field of a serializable type addressed
+ * by its offset within the object
+ */
+struct template_field
+{
+  std::size_t offset;
+  const template_type *type;
+};
+
+using template_field_map = std::unordered_map<std::string, template_field>;
+
+/*
+ * Collects the fields of a serializable object
+ * with their offsets and value types.
+ */
+class template_field_collector
+{
+public:
+  template_field_collector(const void *object, template_field_map &fields)
+    : object_(static_cast<const char*>(object))
+    , fields_(fields)
+  {}
+
+  template < class V >
+  void on_primary_key(const char *id, V &pk)
+  {
+    add(id, pk);
+  }
+
+  void on_primary_key(const char *id, std::string &pk, size_t /*size*/)
+  {
+    add(id, pk);
+  }
+
+  void on_revision(const char *id, unsigned long long &rev)
+  {
+    add(id, rev);
+  }
+
+  template < class V >
+  void on_attribute(const char *id, V &val, const field_attributes &/*attr*/ = null_attributes)
+  {
+    add(id, val);
+  }
+
+  template < class V >
+  void on_belongs_to(const char *id, object_ptr<V> &x, cascade_type)
+  {
+    add(id, x);
+  }
+
+  template < class V >
+  void on_has_one(const char *id, object_ptr<V> &x, cascade_type)
+  {
+    add(id, x);
+  }
+
+  template < class V, template < class ... > class C >
+  void on_has_many(const char *id, container<V, C> &c, const char *, const char *, cascade_type)
+  {
+    add(id, c);
+  }
+
+  template < class V, template < class ... > class C >
+  void on_has_many(const char *id, container<V, C> &c, cascade_type)
+  {
+    add(id, c);
+  }
+
+private:
+  template < class V >
+  void add(const char *id, const V &val)
+  {
+    const auto offset = static_cast<std::size_t>(reinterpret_cast<const char*>(&val) - object_);
+    fields_[id] = { offset, &template_type_traits<V>::type() };
+  }
+
+private:
+  const char *object_;
+  template_field_map &fields_;
+};
+
+/*
+ * Reads the fields of a serializable type. The
+ * fields are collected once per type with the
+ * first rendered object.
+ */
+template < class Type >
+class object_template_type : public template_type
+{
+public:
+  static const object_template_type& instance()
+  {
+    static const object_template_type type;
+    return type;
+  }
+
+  kind_t kind(const void *) const override
+  {
+    return OBJECT;
+  }
+
+  template_value at(const void *ptr, const std::string &key) const override
+  {
+    const auto &fields = fields_of(*static_cast<const Type*>(ptr));
+    auto it = fields.find(key);
+    if (it == fields.end()) {
+      throw std::logic_error("object doesn't contain key " + key);
+    }
+    return template_value(static_cast<const char*>(ptr) + it->second.offset, *it->second.type);
+  }
+
+  bool empty(const void *ptr) const override
+  {
+    return fields_of(*static_cast<const Type*>(ptr)).empty();
+  }
+
+private:
+  static const template_field_map& fields_of(const Type &obj)
+  {
+    // the offsets are the same for all objects of the type
+    static const template_field_map fields = collect(obj);
+    return fields;
+  }
+
+  static template_field_map collect(const Type &obj)
+  {
+    template_field_map fields;
+    template_field_collector collector(&obj, fields);
+    matador::access::process(collector, obj);
+    return fields;
+  }
+};
+
+template < class Type >
+class object_ptr_template_type : public template_type
+{
+public:
+  static const object_ptr_template_type& instance()
+  {
+    static const object_ptr_template_type type;
+    return type;
+  }
+
+  kind_t kind(const void *ptr) const override
+  {
+    return static_cast<const object_ptr<Type>*>(ptr)->empty() ? NULL_VALUE : OBJECT;
+  }
+
+  template_value at(const void *ptr, const std::string &key) const override
+  {
+    return make_template_value(*static_cast<const object_ptr<Type>*>(ptr)).at(key);
+  }
+
+  bool empty(const void *ptr) const override
+  {
+    return static_cast<const object_ptr<Type>*>(ptr)->empty();
+  }
+
+  void append_to(const void *ptr, std::string &out) const override
+  {
+    make_template_value(*static_cast<const object_ptr<Type>*>(ptr)).append_to(out);
+  }
+
+  const json& as_json(const void *ptr, json &buffer) const override
+  {
+    return make_template_value(*static_cast<const object_ptr<Type>*>(ptr)).as_json(buffer);
+  }
+};
+
+template < class Type >
+class number_template_type : public template_type
+{
+public:
+  static const number_template_type& instance()
+  {
+    static const number_template_type type;
+    return type;
+  }
+
+  kind_t kind(const void *) const override
+  {
+    return SCALAR;
+  }
+
+  void append_to(const void *ptr, std::string &out) const override
+  {
+    out.append(std::to_string(value(*static_cast<const Type*>(ptr))));
+  }
+
+  const json& as_json(const void *ptr, json &buffer) const override
+  {
+    buffer = value(*static_cast<const Type*>(ptr));
+    return buffer;
+  }
+
+private:
+  // reals are written like json reals
+  template < class V >
+  static double value(V val, typename std::enable_if<std::is_floating_point<V>::value>::type* = nullptr)
+  {
+    return static_cast<double>(val);
+  }
+
+  template < class V >
+  static V value(V val, typename std::enable_if<std::is_integral<V>::value>::type* = nullptr)
+  {
+    return val;
+  }
+
+  template < class V >
+  static long long value(V val, typename std::enable_if<std::is_enum<V>::value>::type* = nullptr)
+  {
+    return static_cast<long long>(val);
+  }
+};
+
+template < class Container >
+class sequence_template_type : public template_type
+{
+public:
+  static const sequence_template_type& instance()
+  {
+    static const sequence_template_type type;
+    return type;
+  }
+
+  kind_t kind(const void *) const override
+  {
+    return ARRAY;
+  }
+
+  bool empty(const void *ptr) const override
+  {
+    return static_cast<const Container*>(ptr)->empty();
+  }
+
+  void elements(const void *ptr, std::vector<template_value> &elems) const override
+  {
+    const auto &cont = *static_cast<const Container*>(ptr);
+    for (auto it = cont.begin(); it != cont.end(); ++it) {
+      elems.push_back(make_template_value(*it));
+    }
+  }
+};
+
+/*
+ * Maps a value type to its template type. Any
+ * type not listed below is read as serializable
+ * object.
+ */
+template < class Type, class Enable >
+struct template_type_traits
+{
+  static const template_type& type() { return object_template_type<Type>::instance(); }
+};
+
+template < class Type >
+struct template_type_traits<Type, typename std::enable_if<(std::is_arithmetic<Type>::value && !std::is_same<Type, bool>::value) || std::is_enum<Type>::value>::type>
+{
+  static const template_type& type() { return number_template_type<Type>::instance(); }
+};
+
+template <>
+struct template_type_traits<bool>
+{
+  static const template_type& type() { return bool_template_type::instance(); }
+};
+
+template <>
+struct template_type_traits<std::string>
+{
+  static const template_type& type() { return string_template_type::instance(); }
+};
+
+template < std::size_t Size >
+struct template_type_traits<char[Size]>
+{
+  static const template_type& type() { return char_array_template_type::instance(); }
+};
+
+template <>
+struct template_type_traits<date>
+{
+  static const template_type& type() { return date_template_type::instance(); }
+};
+
+template <>
+struct template_type_traits<time>
+{
+  static const template_type& type() { return time_template_type::instance(); }
+};
+
+template < class Type >
+struct template_type_traits<object_ptr<Type>>
+{
+  static const template_type& type() { return object_ptr_template_type<Type>::instance(); }
+};
+
+template < class Type, template < class ... > class ContainerType >
+struct template_type_traits<container<Type, ContainerType>>
+{
+  static const template_type& type() { return sequence_template_type<container<Type, ContainerType>>::instance(); }
+};
+
+template < class Type >
+struct template_type_traits<object_view<Type>>
+{
+  static const template_type& type() { return sequence_template_type<object_view<Type>>::instance(); }
+};
+
+template < class Type, class Allocator >
+struct template_type_traits<std::vector<Type, Allocator>>
+{
+  static const template_type& type() { return sequence_template_type<std::vector<Type, Allocator>>::instance(); }
+};
+
+template < class Type, class Allocator >
+struct template_type_traits<std::list<Type, Allocator>>
+{
+  static const template_type& type() { return sequence_template_type<std::list<Type, Allocator>>::instance(); }
+};
+
+template < class Type, class Compare, class Allocator >
+struct template_type_traits<std::set<Type, Compare, Allocator>>
+{
+  static const template_type& type() { return sequence_template_type<std::set<Type, Compare, Allocator>>::instance(); }
+};
+
+template < class Type, class Hash, class Equal, class Allocator >
+struct template_type_traits<std::unordered_set<Type, Hash, Equal, Allocator>>
+{
+  static const template_type& type() { return sequence_template_type<std::unordered_set<Type, Hash, Equal, Allocator>>::instance(); }
+};
+
+/// @endcond
+
+}
+}
+}
+
+#endif //MATADOR_TEMPLATE_OBJECT_HPP
@@ -4,6 +4,7 @@
 #include "matador/http/export.hpp"
 
 #include "matador/http/detail/template_filter.hpp"
+#include "matador/http/detail/template_context.hpp"
 
 #include <string>
 #include <memory>
@@ -19,6 +20,7 @@ namespace detail {
 /// @cond MATADOR_DEV
 
 class template_expression;
+class template_program;
 
 using template_filter_ptr = std::shared_ptr<template_filter>;
 
@@ -29,10 +31,13 @@ public:
 
   virtual std::string render(const json &data) = 0;
 
+  virtual void compile(template_program &program) const = 0;
+
   void append_filter(const template_filter_ptr &filter);
 
 protected:
   json apply_filter(const json &data);
+  const template_filter_ptr& filter() const;
 
 private:
   template_filter_ptr filter_;
@@ -47,6 +52,8 @@ public:
 
   std::string render(const json &) override;
 
+  void compile(template_program &program) const override;
+
 private:
   std::string str_;
 };
@@ -54,12 +61,14 @@ private:
 class OOS_HTTP_API variable_part : public template_part
 {
 public:
-  explicit variable_part(std::string str);
+  explicit variable_part(const std::string &str);
 
   std::string render(const json &data) override;
 
+  void compile(template_program &program) const override;
+
 private:
-  std::string str_;
+  template_path path_;
 };
 
 class OOS_HTTP_API multi_template_part : public template_part
@@ -69,6 +78,8 @@ public:
 
   std::string render(const json &data) override;
 
+  void compile(template_program &program) const override;
+
   std::list<template_part_ptr>& parts();
 
 private:
@@ -78,14 +89,16 @@ private:
 class OOS_HTTP_API loop_template_part : public template_part
 {
 public:
-  loop_template_part(template_part_ptr part, template_part_ptr on_empty_part, std::string list_name, std::string elem_name);
+  loop_template_part(template_part_ptr part, template_part_ptr on_empty_part, const std::string &list_name, std::string elem_name);
 
   std::string render(const json &data) override;
 
+  void compile(template_program &program) const override;
+
 private:
   template_part_ptr part_;
   template_part_ptr loop_part_;
-  std::string list_name_;
+  template_path list_path_;
   std::string elem_name_;
 };
 
@@ -97,6 +110,8 @@ public:
 
   std::string render(const json &data) override;
 
+  void compile(template_program &program) const override;
+
 private:
   t_expression_list expression_list_;
 
@@ -0,0 +1,112 @@
+#ifndef MATADOR_TEMPLATE_PROGRAM_HPP
+#define MATADOR_TEMPLATE_PROGRAM_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/http/detail/template_context.hpp"
+
+#include <atomic>
+#include <string>
+#include <memory>
+#include <vector>
+
+namespace matador {
+
+class json;
+
+namespace http {
+namespace detail {
+
+/// @cond MATADOR_DEV
+
+class template_part;
+class template_filter;
+class template_expression;
+
+/*
+ * A template compiled to a flat list of instructions.
+ *
+ * All static text is kept in one string and referred by
+ * offset and length, variable paths are split once and
+ * loops and branches jump to the instruction index stored
+ * in the instruction itself. Rendering walks the list once
+ * and appends to a single output string.
+ */
+class OOS_HTTP_API template_program
+{
+public:
+  enum opcode_t {
+    TEXT,    /**< Append text [offset, offset + length) */
+    VALUE,   /**< Append value at path with optional filter */
+    LOOP,    /**< Enter loop over path as name; jump to target if empty */
+    NEXT,    /**< Next loop element; jump to target or leave to end */
+    BRANCH,  /**< Jump to target if expression evaluates to false */
+    JUMP     /**< Jump to target */
+  };
+
+  /*
+   * Meaning of the fields by opcode:
+   * TEXT:   offset/length of the text
+   * VALUE:  offset is the path index, length the filter index
+   * LOOP:   offset is the path index, length the name index
+   * BRANCH: offset is the expression index
+   */
+  struct instruction
+  {
+    opcode_t opcode;
+    std::size_t offset;
+    std::size_t length;
+    std::size_t target;
+    std::size_t end;
+  };
+
+  static std::shared_ptr<template_program> compile(const template_part &part);
+
+  void render(const template_value &data, std::string &out) const;
+  void render(const json &data, std::string &out) const;
+  std::string render(const json &data) const;
+
+  const std::vector<instruction>& instructions() const;
+
+  /*
+   * Compiler interface used by the template parts
+   */
+  void append_text(const std::string &text);
+  void append_value(const template_path &path, const std::shared_ptr<template_filter> &filter);
+  std::size_t append_loop(const template_path &path, const std::string &name);
+  std::size_t append_next(std::size_t body);
+  std::size_t append_branch(const std::shared_ptr<template_expression> &expression);
+  std::size_t append_jump();
+
+  std::size_t label();
+  void jump_to(std::size_t index, std::size_t target);
+  void leave_to(std::size_t index, std::size_t end);
+
+private:
+  std::size_t append(opcode_t opcode, std::size_t offset = 0, std::size_t length = 0);
+
+private:
+  std::vector<instruction> instructions_;
+  std::string text_;
+
+  std::vector<template_path> paths_;
+  std::vector<std::string> names_;
+  std::vector<std::shared_ptr<template_filter>> filters_;
+  std::vector<std::shared_ptr<template_expression>> expressions_;
+
+  // no text is merged into an instruction
+  // before a jump target
+  std::size_t label_ = 0;
+  // size of the largest rendering so far
+  mutable std::atomic_size_t size_hint_ { 0 };
+};
+
+using template_program_ptr = std::shared_ptr<template_program>;
+
+/// @endcond
+
+}
+}
+}
+
+#endif //MATADOR_TEMPLATE_PROGRAM_HPP
@@ -0,0 +1,153 @@
+#ifndef MATADOR_TEMPLATE_VALUE_HPP
+#define MATADOR_TEMPLATE_VALUE_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/json/json.hpp"
+
+#include <string>
+#include <vector>
+
+namespace matador {
+
+class date;
+class time;
+
+namespace http {
+namespace detail {
+
+/// @cond MATADOR_DEV
+
+class template_type;
+
+OOS_HTTP_API void append_value(std::string &out, const json &value);
+
+/*
+ * A value read by a template. It refers either to
+ * a json value or to a value of a serializable object
+ * (or one of its fields); the template_type knows how
+ * to read it. A default constructed value is null.
+ */
+class OOS_HTTP_API template_value
+{
+public:
+  template_value() = default;
+  explicit template_value(const json &data);
+  template_value(const void *ptr, const template_type &type);
+
+  bool is_null() const;
+  bool is_object() const;
+  bool is_array() const;
+
+  template_value at(const std::string &key) const;
+  bool empty() const;
+  void elements(std::vector<template_value> &elems) const;
+
+  void append_to(std::string &out) const;
+
+  /*
+   * Returns the value as json. A json value is returned
+   * as is, any other value is converted into the given
+   * buffer. Objects and arrays can't be converted.
+   */
+  const json& as_json(json &buffer) const;
+
+private:
+  const void *ptr_ = nullptr;
+  const template_type *type_ = nullptr;
+};
+
+class OOS_HTTP_API template_type
+{
+public:
+  enum kind_t {
+    NULL_VALUE,
+    SCALAR,
+    OBJECT,
+    ARRAY
+  };
+
+  virtual ~template_type() = default;
+
+  virtual kind_t kind(const void *ptr) const = 0;
+
+  virtual template_value at(const void *ptr, const std::string &key) const;
+  virtual bool empty(const void *ptr) const;
+  virtual void elements(const void *ptr, std::vector<template_value> &elems) const;
+
+  virtual void append_to(const void *ptr, std::string &out) const;
+  virtual const json& as_json(const void *ptr, json &buffer) const;
+};
+
+class OOS_HTTP_API json_template_type : public template_type
+{
+public:
+  static const json_template_type& instance();
+
+  kind_t kind(const void *ptr) const override;
+  template_value at(const void *ptr, const std::string &key) const override;
+  bool empty(const void *ptr) const override;
+  void elements(const void *ptr, std::vector<template_value> &elems) const override;
+  void append_to(const void *ptr, std::string &out) const override;
+  const json& as_json(const void *ptr, json &buffer) const override;
+};
+
+class OOS_HTTP_API bool_template_type : public template_type
+{
+public:
+  static const bool_template_type& instance();
+
+  kind_t kind(const void *ptr) const override;
+  void append_to(const void *ptr, std::string &out) const override;
+  const json& as_json(const void *ptr, json &buffer) const override;
+};
+
+class OOS_HTTP_API string_template_type : public template_type
+{
+public:
+  static const string_template_type& instance();
+
+  kind_t kind(const void *ptr) const override;
+  bool empty(const void *ptr) const override;
+  void append_to(const void *ptr, std::string &out) const override;
+  const json& as_json(const void *ptr, json &buffer) const override;
+};
+
+class OOS_HTTP_API char_array_template_type : public template_type
+{
+public:
+  static const char_array_template_type& instance();
+
+  kind_t kind(const void *ptr) const override;
+  bool empty(const void *ptr) const override;
+  void append_to(const void *ptr, std::string &out) const override;
+  const json& as_json(const void *ptr, json &buffer) const override;
+};
+
+class OOS_HTTP_API date_template_type : public template_type
+{
+public:
+  static const date_template_type& instance();
+
+  kind_t kind(const void *ptr) const override;
+  void append_to(const void *ptr, std::string &out) const override;
+  const json& as_json(const void *ptr, json &buffer) const override;
+};
+
+class OOS_HTTP_API time_template_type : public template_type
+{
+public:
+  static const time_template_type& instance();
+
+  kind_t kind(const void *ptr) const override;
+  void append_to(const void *ptr, std::string &out) const override;
+  const json& as_json(const void *ptr, json &buffer) const override;
+};
+
+/// @endcond
+
+}
+}
+}
+
+#endif //MATADOR_TEMPLATE_VALUE_HPP
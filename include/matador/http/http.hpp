@@ -71,6 +71,18 @@ public:
    */
   static OOS_HTTP_API method_t to_method(const std::string &str);
 
+  /**
+   * Returns true if the given method is safe, i.e. one
+   * of GET, HEAD and OPTIONS. Safe requests never change
+   * the state on the server, a client may send them
+   * again after a kept connection was closed before
+   * the response arrived.
+   *
+   * @param m Http method to check
+   * @return True if the method is safe
+   */
+  static OOS_HTTP_API bool is_safe(method_t m);
+
   /**
    * Http status codes enumeration
    */
@@ -87,6 +99,8 @@ public:
     UNAUTHORIZED = 401,           /**< UNAUTHORIZED status code */
     FORBIDDEN = 403,              /**< FORBIDDEN status code */
     NOT_FOUND = 404,              /**< NOT_FOUND status code */
+    PAYLOAD_TOO_LARGE = 413,      /**< PAYLOAD_TOO_LARGE status code */
+    REQUEST_HEADER_FIELDS_TOO_LARGE = 431, /**< REQUEST_HEADER_FIELDS_TOO_LARGE status code */
     INTERNAL_SERVER_ERROR = 500,  /**< INTERNAL_SERVER_ERROR status code */
     NOT_IMPLEMENTED = 501,        /**< NOT_IMPLEMENTED status code */
     BAD_GATEWAY = 502,            /**< BAD_GATEWAY status code */
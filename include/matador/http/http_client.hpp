@@ -3,6 +3,7 @@
 
 #include "matador/http/export.hpp"
 
+#include "matador/http/connection_pool.hpp"
 #include "matador/http/response.hpp"
 #include "matador/http/request.hpp"
 
@@ -11,6 +12,8 @@
 
 #include "matador/logger/logger.hpp"
 
+#include <chrono>
+#include <memory>
 #include <string>
 
 namespace matador {
@@ -36,6 +39,13 @@ namespace http {
  *
  * Once the answer is received and processed a response
  * object is returned.
+ *
+ * Connections are persistent. After a response was read
+ * the connection is kept in the connection pool of the
+ * client and reused by the next request. The pool may be
+ * shared by several clients. If the server closed a pooled
+ * connection before the response was received, the request
+ * is sent once again on a new connection.
  */
 class OOS_HTTP_API client
 {
@@ -47,6 +57,15 @@ public:
    */
   explicit client(const std::string &host);
 
+  /**
+   * Creates a client for the given host using
+   * the given connection pool.
+   *
+   * @param host Host and optional port string
+   * @param pool Connection pool to use
+   */
+  client(const std::string &host, std::shared_ptr<connection_pool> pool);
+
   /**
    * Sends a GET request to the given route at the
    * configured host.
@@ -85,17 +104,81 @@ public:
    */
   response remove(const std::string &route);
 
+  /**
+   * Sets the timeout for establishing a connection and
+   * for waiting for a free connection of the pool.
+   * Zero waits without limit. Defaults to five seconds.
+   *
+   * @param timeout Connect timeout
+   */
+  void connect_timeout(std::chrono::milliseconds timeout);
+
+  /**
+   * Returns the connect timeout
+   *
+   * @return Connect timeout
+   */
+  std::chrono::milliseconds connect_timeout() const;
+
+  /**
+   * Sets the timeout for each read of the response and
+   * each write of the request. Zero waits without limit.
+   * Defaults to 30 seconds.
+   *
+   * @param timeout Read timeout
+   */
+  void read_timeout(std::chrono::milliseconds timeout);
+
+  /**
+   * Returns the read timeout
+   *
+   * @return Read timeout
+   */
+  std::chrono::milliseconds read_timeout() const;
+
+  /**
+   * Returns the connection pool of the client
+   *
+   * @return The connection pool
+   */
+  const std::shared_ptr<connection_pool>& pool() const;
+
+  /**
+   * Returns true if the connection a response was
+   * read from may be used for another request. This
+   * is the case if the body was delimited by its length
+   * and the server keeps the connection alive.
+   *
+   * @param resp Response read from a connection
+   * @return True if the connection may be reused
+   */
+  static bool is_reusable(const response &resp);
+
 private:
+  enum read_result_t {
+    READ_FINISHED,
+    READ_NOTHING,
+    READ_CLOSED,
+    READ_FAILED
+  };
+
   response execute(const request& req);
 
-  void connect(tcp::socket &stream);
-  void send_request(tcp::socket &stream, const request &req);
-  void read_response(tcp::socket &stream, response &resp);
+  bool connect(tcp::socket &stream);
+  bool connect(tcp::socket &stream, const tcp::peer &endpoint);
+  void apply_timeouts(tcp::socket &stream);
+  bool send_request(tcp::socket &stream, const request &req);
+  read_result_t read_response(tcp::socket &stream, response &resp);
 
 private:
   std::string host_;
   std::string port_ { "80" };
 
+  std::shared_ptr<connection_pool> pool_;
+
+  std::chrono::milliseconds connect_timeout_ { std::chrono::seconds(5) };
+  std::chrono::milliseconds read_timeout_ { std::chrono::seconds(30) };
+
   logger log_;
 };
 
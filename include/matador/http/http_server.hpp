@@ -11,6 +11,8 @@
 #include "matador/http/routing_engine.hpp"
 #include "matador/http/middleware.hpp"
 
+#include <chrono>
+
 namespace matador {
 namespace http {
 
@@ -97,6 +99,37 @@ public:
     add_route(route, http::POST, request_handler);
   }
 
+  /**
+   * Registers a HTTP POST method callback for the given
+   * route whose request body is streamed. Once the header
+   * of a request was received the factory creates a body
+   * consumer which gets the body part by part as it
+   * arrives. The body isn't kept in the request passed
+   * to the callback.
+   *
+   * @code
+   * server.on_post("/upload/{name}", [](const http::request &req) {
+   *   auto out = std::make_shared<std::ofstream>(req.path_params().at("name"), std::ios::binary);
+   *   return [out](const char *data, std::size_t size) {
+   *     return size == 0 ? out->flush().good() : out->write(data, size).good();
+   *   };
+   * }, [](const http::request &req) {
+   *   return http::response::no_content();
+   * });
+   * @endcode
+   *
+   * @tparam BodyConsumerFactory Type of the body consumer factory
+   * @tparam RequestHandler Type of the callback
+   * @param route The route for the callback
+   * @param body_consumer_factory Creates the consumer of a request body
+   * @param request_handler The POST callback to be executed
+   */
+  template < class BodyConsumerFactory, class RequestHandler >
+  void on_post(const std::string &route, BodyConsumerFactory body_consumer_factory, RequestHandler request_handler)
+  {
+    add_route(route, http::POST, request_handler, body_consumer_factory);
+  }
+
   /**
    * Registers a HTTP PUT method callback for the
    * given route.
@@ -111,6 +144,25 @@ public:
     add_route(route, http::PUT, request_handler);
   }
 
+  /**
+   * Registers a HTTP PUT method callback for the given
+   * route whose request body is streamed into the consumer
+   * created by the given factory.
+   *
+   * @see on_post(const std::string&, BodyConsumerFactory, RequestHandler)
+   *
+   * @tparam BodyConsumerFactory Type of the body consumer factory
+   * @tparam RequestHandler Type of the callback
+   * @param route The route for the callback
+   * @param body_consumer_factory Creates the consumer of a request body
+   * @param request_handler The PUT callback to be executed
+   */
+  template < class BodyConsumerFactory, class RequestHandler >
+  void on_put(const std::string &route, BodyConsumerFactory body_consumer_factory, RequestHandler request_handler)
+  {
+    add_route(route, http::PUT, request_handler, body_consumer_factory);
+  }
+
   /**
    * Registers a HTTP DELETE method callback for the
    * given route.
@@ -144,6 +196,76 @@ public:
    */
   void add_routing_middleware();
 
+  /**
+   * Sets the time an idle persistent connection
+   * is kept open waiting for the next request.
+   * Zero means the connection is kept open until
+   * the client closes it. Defaults to five seconds.
+   *
+   * @param timeout Keep alive timeout
+   */
+  void keep_alive_timeout(std::chrono::milliseconds timeout);
+
+  /**
+   * Returns the keep alive timeout
+   *
+   * @return The keep alive timeout
+   */
+  std::chrono::milliseconds keep_alive_timeout() const;
+
+  /**
+   * Sets the maximum number of requests handled on
+   * one persistent connection. The connection is
+   * closed after the response to the last request.
+   * A value of one disables persistent connections.
+   * Defaults to 100.
+   *
+   * @param max_requests Maximum number of requests per connection
+   */
+  void max_keep_alive_requests(std::size_t max_requests);
+
+  /**
+   * Returns the maximum number of requests
+   * handled on one persistent connection.
+   *
+   * @return Maximum number of requests per connection
+   */
+  std::size_t max_keep_alive_requests() const;
+
+  /**
+   * Sets the maximum size of a request body. A request
+   * with a larger body is rejected with PAYLOAD_TOO_LARGE
+   * as soon as its size is known; for a chunked body
+   * when the limit is exceeded. Defaults to 16MB.
+   *
+   * @param max_size Maximum size of a request body
+   */
+  void max_body_size(std::size_t max_size);
+
+  /**
+   * Returns the maximum size of a request body
+   *
+   * @return Maximum size of a request body
+   */
+  std::size_t max_body_size() const;
+
+  /**
+   * Sets the maximum size of a request header, the
+   * request line included. A request with a larger
+   * header is rejected with REQUEST_HEADER_FIELDS_TOO_LARGE
+   * and the connection is closed. Defaults to 64KB.
+   *
+   * @param max_size Maximum size of a request header
+   */
+  void max_header_size(std::size_t max_size);
+
+  /**
+   * Returns the maximum size of a request header
+   *
+   * @return Maximum size of a request header
+   */
+  std::size_t max_header_size() const;
+
 private:
   template < class RequestHandler >
   void add_route(const std::string &path_spec, http::method_t method, RequestHandler request_handler)
@@ -157,6 +279,19 @@ private:
     router_.add(path_spec, method, request_handler);
   }
 
+  template < class RequestHandler, class BodyConsumerFactory >
+  void add_route(const std::string &path_spec, http::method_t method, RequestHandler request_handler,
+                 BodyConsumerFactory body_consumer_factory)
+  {
+    auto r = router_.find(path_spec, method);
+    if (router_.valid(r)) {
+      log_.warn("path_spec <%s> already registered for method <%s>", path_spec.c_str(), http::to_string(method).c_str());
+      return;
+    }
+    log_.info("adding streaming route <%s> (<%s>)", path_spec.c_str(), http::to_string(method).c_str());
+    router_.add(path_spec, method, request_handler, body_consumer_factory);
+  }
+
 private:
   matador::logger log_;
   matador::io_service service_;
@@ -165,6 +300,11 @@ private:
   routing_engine router_;
 
   middleware_pipeline pipeline_;
+
+  std::chrono::milliseconds keep_alive_timeout_ { std::chrono::seconds(5) };
+  std::size_t max_keep_alive_requests_ = 100;
+  std::size_t max_body_size_ = 16 * 1024 * 1024;
+  std::size_t max_header_size_ = 64 * 1024;
 };
 }
 
@@ -7,14 +7,18 @@
 
 #include "matador/logger/logger.hpp"
 
-#include "matador/utils/buffer.hpp"
+#include "matador/utils/buffer_chain.hpp"
 #include "matador/utils/optional.hpp"
 
 #include "matador/http/request_parser.hpp"
 #include "matador/http/response.hpp"
 #include "matador/http/request.hpp"
+#include "matador/http/request_view.hpp"
 #include "matador/http/middleware.hpp"
+#include "matador/http/routing_engine.hpp"
 
+#include <chrono>
+#include <limits>
 #include <memory>
 
 namespace matador {
@@ -29,17 +33,33 @@ class OOS_HTTP_API http_server_connection : public std::enable_shared_from_this<
 {
 public:
   http_server_connection(middleware_pipeline &pipeline, matador::io_stream &stream, matador::tcp::peer endpoint);
+  http_server_connection(middleware_pipeline &pipeline, matador::io_stream &stream, matador::tcp::peer endpoint,
+                         std::chrono::milliseconds keep_alive_timeout, std::size_t max_requests);
+
+  void body_settings(const routing_engine &router, std::size_t max_body_size);
+  void max_header_size(std::size_t max_size);
 
   void start();
   void read();
   void write();
 
 private:
+  void handle_input();
+  void append_linear_input();
+  void handle_body();
+  bool consume_body(const char *data, std::size_t size);
+  void dispatch();
+  void reject(response resp);
+  void write_chunk();
+  void finish_response();
   response process(request &req) const;
 
+  static bool is_keep_alive(const request_view &req);
+  static bool is_chunked(const request_view &req);
+
 private:
   matador::logger log_;
-  std::array<char, 16384> buf_{};
+  matador::buffer_chain input_;
   matador::io_stream &stream_;
   matador::tcp::peer endpoint_;
 
@@ -47,8 +67,34 @@ private:
 
   middleware_pipeline &pipeline_;
 
+  request_view view_;
+  std::string linear_input_;
+  std::size_t max_header_size_ = std::numeric_limits<std::size_t>::max();
   request request_;
   response response_;
+
+  std::chrono::milliseconds keep_alive_timeout_;
+  std::size_t max_requests_;
+  std::size_t requests_ = 0;
+  bool keep_alive_ = false;
+
+  enum body_state_t {
+    NO_BODY,
+    LENGTH_BODY,
+    CHUNKED_BODY
+  };
+
+  const routing_engine *router_ = nullptr;
+  std::size_t max_body_size_ = std::numeric_limits<std::size_t>::max();
+  body_state_t body_state_ = NO_BODY;
+  std::size_t body_remaining_ = 0;
+  std::size_t body_size_ = 0;
+  t_body_consumer body_consumer_;
+  bool body_too_large_ = false;
+
+  bool chunked_ = false;
+  std::string chunk_;
+  std::string chunk_header_;
 };
 
 /// @endcond
@@ -0,0 +1,195 @@
+#ifndef MATADOR_COMPRESSION_MIDDLEWARE_HPP
+#define MATADOR_COMPRESSION_MIDDLEWARE_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/http/middleware.hpp"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace matador {
+namespace http {
+namespace middlewares {
+
+/**
+ * @brief Compresses response bodies with gzip or deflate
+ *
+ * The compression middleware negotiates the content coding
+ * with the Accept-Encoding header of the request and
+ * compresses the body of eligible responses with zlib.
+ * A response is eligible if its content type is one of the
+ * compressible mime types and it isn't encoded already.
+ * Every eligible response gets a "Vary: Accept-Encoding"
+ * header, whether it was compressed or not.
+ *
+ * - A plain body is compressed if it isn't smaller than
+ *   the minimum size.
+ * - A shared body (i.e. from the static_file_cache) is
+ *   compressed once; the result is cached as long as the
+ *   shared body lives, up to the maximum cache size.
+ * - A file body is replaced by its precompressed ".gz"
+ *   sibling if there is one and gzip was negotiated.
+ *   Otherwise the file is sent uncompressed.
+ * - A streamed body is compressed chunk by chunk.
+ *
+ * A strong ETag of a compressed response is turned into
+ * a weak one.
+ *
+ * Add the middleware after the routing middleware so that
+ * it processes the responses of all routes.
+ */
+class OOS_HTTP_API compression_middleware : public middleware
+{
+public:
+  /**
+   * Content codings
+   */
+  enum encoding_t {
+    IDENTITY, /**< No compression */
+    GZIP,     /**< gzip format */
+    DEFLATE   /**< zlib format */
+  };
+
+  /**
+   * Creates a compression middleware compressing with
+   * the given zlib compression level (0-9, -1 is the zlib
+   * default). Bodies smaller than min_size aren't
+   * compressed.
+   *
+   * @param level Compression level
+   * @param min_size Minimum size of a compressed body
+   */
+  explicit compression_middleware(int level = -1, std::size_t min_size = 1024);
+
+  response process(request &req, const next_func_t &next) override;
+
+  /**
+   * Sets the zlib compression level (0-9, -1
+   * is the zlib default)
+   *
+   * @param level Compression level
+   */
+  void level(int level);
+
+  /**
+   * Returns the compression level
+   *
+   * @return The compression level
+   */
+  int level() const;
+
+  /**
+   * Sets the minimum size of a body to be compressed
+   *
+   * @param min_size Minimum size of a compressed body
+   */
+  void min_size(std::size_t min_size);
+
+  /**
+   * Returns the minimum size of a body to be compressed
+   *
+   * @return Minimum size of a compressed body
+   */
+  std::size_t min_size() const;
+
+  /**
+   * Adds a compressible mime type. A type ending
+   * with '/' matches all types of the group, i.e.
+   * "text/". Text, json, javascript, xml and svg
+   * are compressible by default.
+   *
+   * @param type Mime type to add
+   */
+  void add_mime_type(const std::string &type);
+
+  /**
+   * Returns true if a body of the given
+   * content type is compressed.
+   *
+   * @param content_type Content type to check
+   * @return True if the content type is compressible
+   */
+  bool is_compressible(const std::string &content_type) const;
+
+  /**
+   * Enables or disables serving precompressed
+   * ".gz" siblings of files. Enabled by default.
+   *
+   * @param enable True to serve precompressed files
+   */
+  void precompressed(bool enable);
+
+  /**
+   * Sets the maximum size of the cached compressed
+   * shared bodies. Defaults to 16MB.
+   *
+   * @param max_size Maximum size of the cache
+   */
+  void max_cache_size(std::size_t max_size);
+
+  /**
+   * Returns the size of the cached compressed bodies
+   *
+   * @return Size of the cache
+   */
+  std::size_t cache_size() const;
+
+  /**
+   * Returns the preferred supported content coding
+   * of the given Accept-Encoding header value.
+   *
+   * @param accept_encoding Accept-Encoding header value
+   * @return The preferred content coding
+   */
+  static encoding_t negotiate(const std::string &accept_encoding);
+
+  /**
+   * Compresses the given data in the given content
+   * coding with the given level into out.
+   *
+   * @param data Data to compress
+   * @param size Size of the data
+   * @param encoding Content coding
+   * @param level Compression level
+   * @param out Compressed data
+   * @return True on success
+   */
+  static bool compress(const char *data, std::size_t size, encoding_t encoding, int level, std::string &out);
+
+private:
+  std::shared_ptr<const std::string> compress_shared(const std::shared_ptr<const std::string> &body, encoding_t encoding);
+
+private:
+  int level_;
+  std::size_t min_size_;
+  bool precompressed_ = true;
+
+  std::vector<std::string> mime_types_;
+
+  struct cache_entry
+  {
+    std::weak_ptr<const std::string> source;
+    std::shared_ptr<const std::string> compressed;
+  };
+
+  typedef std::pair<const std::string*, encoding_t> t_cache_key;
+  typedef std::list<std::pair<t_cache_key, cache_entry>> t_cache_list;
+
+  mutable std::mutex mutex_;
+  std::size_t max_cache_size_ = 16 * 1024 * 1024;
+  std::size_t cache_size_ = 0;
+  // most recently used first
+  t_cache_list cache_;
+  std::map<t_cache_key, t_cache_list::iterator> cache_map_;
+};
+
+}
+}
+}
+
+#endif //MATADOR_COMPRESSION_MIDDLEWARE_HPP
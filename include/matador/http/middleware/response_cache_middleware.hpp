@@ -0,0 +1,193 @@
+#ifndef MATADOR_RESPONSE_CACHE_MIDDLEWARE_HPP
+#define MATADOR_RESPONSE_CACHE_MIDDLEWARE_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/http/middleware.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace matador {
+namespace http {
+namespace middlewares {
+
+/**
+ * @brief Caches complete responses of GET requests
+ *
+ * The response cache middleware keeps the responses of
+ * GET requests for a time to live. Responses are keyed by
+ * path, query parameters and the values of the request
+ * headers added with vary(). A cached response shares its
+ * body with all responses served from the cache.
+ *
+ * - Routes are cached with the default time to live or
+ *   the one of the first matching route added with ttl().
+ *   A time to live of zero disables the cache for a route.
+ * - Concurrent requests missing the same key are
+ *   coalesced: the first request runs the handler, the
+ *   others wait for and share its response.
+ * - Every cacheable response gets an ETag over its body,
+ *   a request with a matching If-None-Match header is
+ *   answered with 304 Not Modified.
+ * - The cache is bounded by its maximum size, the least
+ *   recently used responses are removed first.
+ *
+ * Only OK responses with a plain body are cached, responses
+ * setting a cookie or marked with "Cache-Control: no-store"
+ * or "private" aren't. Requests with an Authorization header
+ * bypass the cache unless the header was added with vary().
+ * A request with "Cache-Control: no-cache" runs the handler
+ * and replaces the cached response.
+ *
+ * Add the middleware after the routing middleware and
+ * before the compression middleware.
+ */
+class OOS_HTTP_API response_cache_middleware : public middleware
+{
+public:
+  /**
+   * Creates a response cache middleware with the
+   * given default time to live and maximum size.
+   *
+   * @param ttl Default time to live of a response
+   * @param max_size Maximum size of all cached responses
+   */
+  explicit response_cache_middleware(std::chrono::milliseconds ttl = std::chrono::seconds(60), std::size_t max_size = 16 * 1024 * 1024);
+
+  response process(request &req, const next_func_t &next) override;
+
+  /**
+   * Sets the time to live of the responses of the given
+   * route. A route ending with '*' matches all paths
+   * starting with the route. Routes are matched in the
+   * order they were added.
+   *
+   * @param route Path or path prefix of the route
+   * @param ttl Time to live of the responses, zero disables the cache
+   */
+  void ttl(const std::string &route, std::chrono::milliseconds ttl);
+
+  /**
+   * Returns the time to live of the
+   * responses of the given path.
+   *
+   * @param path Path of the request
+   * @return Time to live of the responses
+   */
+  std::chrono::milliseconds ttl(const std::string &path) const;
+
+  /**
+   * Adds a request header whose value is
+   * part of the key of a cached response.
+   *
+   * @param header Name of the request header
+   */
+  void vary(const std::string &header);
+
+  /**
+   * Sets the maximum size of all cached responses
+   *
+   * @param max_size Maximum size of the cache
+   */
+  void max_size(std::size_t max_size);
+
+  /**
+   * Returns the maximum size of all cached responses
+   *
+   * @return Maximum size of the cache
+   */
+  std::size_t max_size() const;
+
+  /**
+   * Returns the size of all cached responses
+   *
+   * @return Size of the cache
+   */
+  std::size_t size() const;
+
+  /**
+   * Returns the number of cached responses
+   *
+   * @return Number of cached responses
+   */
+  std::size_t count() const;
+
+  /**
+   * Removes all cached responses of the given path
+   *
+   * @param path Path of the responses
+   */
+  void invalidate(const std::string &path);
+
+  /**
+   * Removes all cached responses
+   */
+  void clear();
+
+  /**
+   * Returns the strong entity tag of the given body
+   *
+   * @param body Body to create the entity tag for
+   * @return The entity tag
+   */
+  static std::string etag(const std::string &body);
+
+private:
+  struct entry
+  {
+    std::string key;
+    std::string path;
+    response resp;
+    std::string etag;
+    std::chrono::steady_clock::time_point expires;
+    std::size_t size = 0;
+  };
+
+  // a running request other requests with the same key wait for
+  struct pending
+  {
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool done = false;
+    bool cached = false;
+    response resp;
+    std::string etag;
+  };
+
+  typedef std::list<entry> t_entry_list;
+
+  std::string key(const request &req) const;
+  bool is_cacheable(const request &req) const;
+  static bool is_cacheable(const response &resp);
+  static bool is_not_modified(const request &req, const std::string &etag);
+  static response serve(const request &req, const response &resp, const std::string &etag);
+
+  void store(const std::string &key, const std::string &path, response &resp, std::string &etag, std::chrono::milliseconds ttl);
+  void remove(t_entry_list::iterator it);
+
+private:
+  std::chrono::milliseconds default_ttl_;
+  std::vector<std::pair<std::string, std::chrono::milliseconds>> routes_;
+  std::vector<std::string> vary_;
+
+  mutable std::mutex mutex_;
+  std::size_t max_size_;
+  std::size_t size_ = 0;
+  // most recently used first
+  t_entry_list entries_;
+  std::unordered_map<std::string, t_entry_list::iterator> entry_map_;
+  std::unordered_map<std::string, std::shared_ptr<pending>> pending_;
+};
+
+}
+}
+}
+
+#endif //MATADOR_RESPONSE_CACHE_MIDDLEWARE_HPP
@@ -169,6 +169,8 @@ public:
 private:
   friend class request_parser;
   friend class route_endpoint;
+  friend class routing_engine;
+  friend class http_server_connection;
 
 private:
   http::method_t method_ = http::UNKNOWN;
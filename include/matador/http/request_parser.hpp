@@ -5,15 +5,19 @@
 
 #include "matador/http/http.hpp"
 
+#include "matador/utils/string_span.hpp"
+
 #include <string>
 #include <cstring>
 #include <cstdlib>
+#include <functional>
 #include <memory>
 
 namespace matador {
 namespace http {
 
 class request;
+class request_view;
 
 /// @cond MATADOR_DEV
 
@@ -44,6 +48,19 @@ private:
     BODY
   };
 
+  enum chunk_state_t {
+    CHUNK_SIZE,
+    CHUNK_EXTENSION,
+    CHUNK_SIZE_NEWLINE,
+    CHUNK_DATA,
+    CHUNK_DATA_CR,
+    CHUNK_DATA_NEWLINE,
+    CHUNK_TRAILER,
+    CHUNK_TRAILER_LINE,
+    CHUNK_TRAILER_NEWLINE,
+    CHUNK_FINISH
+  };
+
   enum hex_parse_t {
     HEX_FIRST,
     HEX_SECOND,
@@ -56,6 +73,80 @@ private:
 public:
   return_t parse(const std::string &msg, request &r);
 
+  /**
+   * Parses the request at the beginning of the given
+   * buffer into the given request view. The view
+   * references the buffer, nothing is copied.
+   *
+   * The buffer must always contain the request from its
+   * first byte on. If the request is incomplete PARTIAL
+   * is returned and the call must be repeated once more
+   * data was appended; the search for the end of the
+   * header continues where the last call stopped.
+   *
+   * @param data Start of the buffer
+   * @param size Size of the buffer
+   * @param req Request view to fill
+   * @return Result of the parsing
+   */
+  return_t parse_view(const char *data, std::size_t size, request_view &req);
+
+  /**
+   * Parses only the header of the request at the beginning
+   * of the given buffer into the given view. Once the header
+   * is complete FINISH is returned and consumed() is the
+   * size of the header; the body isn't touched.
+   *
+   * @param data Start of the buffer
+   * @param size Size of the buffer
+   * @param req Request view to fill
+   * @return Result of the parsing
+   */
+  return_t parse_view_header(const char *data, std::size_t size, request_view &req);
+
+  /**
+   * Decodes the chunked encoded body at the beginning of the
+   * given buffer and passes each decoded part to the given
+   * consumer. The body may be split over any number of calls;
+   * consumed() is the number of bytes used by the last call.
+   * FINISH is returned after the last chunk and the trailer.
+   * If the consumer returns false INVALID is returned.
+   *
+   * @param data Start of the buffer
+   * @param size Size of the buffer
+   * @param consumer Consumer of the decoded body parts
+   * @return Result of the parsing
+   */
+  return_t parse_chunked_body(const char *data, std::size_t size,
+                              const std::function<bool(const char*, std::size_t)> &consumer);
+
+  /**
+   * Fills the given request with owned
+   * copies of the parts of the given view.
+   *
+   * @param view View to copy
+   * @param req Request to fill
+   */
+  void apply(const request_view &view, request &req);
+
+  /**
+   * Returns the number of bytes of the last parsed
+   * message belonging to the request. If the request
+   * is finished the remaining bytes are the beginning
+   * of the next (pipelined) request.
+   *
+   * @return Number of consumed bytes
+   */
+  std::size_t consumed() const;
+
+  /**
+   * Processes the complete body of the given request,
+   * i.e. parses form data.
+   *
+   * @param req Request with complete body
+   */
+  void process_body(request &req);
+
   void reset();
 
 private:
@@ -78,11 +169,18 @@ private:
   bool is_hex_char(char c) const;
 
   void insert_header(const std::string &key, const std::string &value, request &req);
+  void insert_header(std::string &&key, std::string &&value, request &req);
   void apply_method(const std::string &method, request &req);
 
-  void process_body(request &req);
-
   bool parse_form_data(request &req);
+  bool parse_params(const string_span &data, t_string_param_map &params);
+
+  bool parse_request_line(const string_span &line, request_view &req) const;
+  const char* parse_header_line(const char *line, const char *header_end, request_view &req) const;
+
+  std::size_t take_run(const char *begin, const char *end, request &req);
+
+  static bool parse_content_length(const string_span &value, std::size_t &length);
 
 private:
   state_t state_ = METHOD;
@@ -98,6 +196,13 @@ private:
   bool skip_blanks_ = false;
 
   hex_parse_t hex_parse_state_ = HEX_FINISHED;
+  std::size_t consumed_ = 0;
+  std::size_t scanned_ = 0;
+  std::size_t content_length_ = 0;
+
+  chunk_state_t chunk_state_ = CHUNK_SIZE;
+  std::size_t chunk_size_ = 0;
+  std::size_t chunk_digits_ = 0;
   std::string hex_str_;
 
   static constexpr const char* URL_SPECIAL_CHAR    = "-._~:/?#[]@!$&'()*+,;=";
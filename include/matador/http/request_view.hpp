@@ -0,0 +1,180 @@
+#ifndef MATADOR_REQUEST_VIEW_HPP
+#define MATADOR_REQUEST_VIEW_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/http/http.hpp"
+
+#include "matador/utils/string_span.hpp"
+
+#include <array>
+#include <vector>
+
+namespace matador {
+namespace http {
+
+class request;
+
+/**
+ * @brief Non owning view of a parsed HTTP request
+ *
+ * The request view is filled by request_parser::parse_view().
+ * All its parts reference the buffer the request was parsed
+ * from; nothing is copied. The view is only valid as long
+ * as this buffer isn't changed.
+ *
+ * The headers are kept in a flat vector in the order they
+ * were received. The headers needed to handle the request
+ * (content length and type, host and connection) are
+ * additionally indexed by known_header_t.
+ *
+ * A view is meant to be reused for all requests of a
+ * connection. clear() keeps the memory of the header
+ * vector, so once it has grown parsing a request doesn't
+ * allocate at all.
+ *
+ * Use to_request() to get an owned request object.
+ */
+class OOS_HTTP_API request_view
+{
+public:
+  /**
+   * Headers indexed while parsing
+   */
+  enum known_header_t
+  {
+    CONTENT_LENGTH = 0, /**< Content-Length header */
+    CONTENT_TYPE,       /**< Content-Type header */
+    HOST,               /**< Host header */
+    CONNECTION,         /**< Connection header */
+    TRANSFER_ENCODING,  /**< Transfer-Encoding header */
+    NUM_KNOWN_HEADERS   /**< Number of known headers */
+  };
+
+  /**
+   * A header consisting of name and value.
+   * A folded value contains the raw line breaks.
+   */
+  struct header_field
+  {
+    string_span name;  /**< Name of the header */
+    string_span value; /**< Value of the header */
+  };
+
+  typedef std::vector<header_field> t_header_vector; /**< Shortcut to the header vector */
+
+  /**
+   * Returns the HTTP method of the request
+   *
+   * @return The HTTP method
+   */
+  http::method_t method() const;
+
+  /**
+   * Returns the path of the url without
+   * query and fragment.
+   *
+   * @return The path of the url
+   */
+  string_span url() const;
+
+  /**
+   * Returns the raw, not decoded query
+   * part of the url without the leading '?'.
+   *
+   * @return The raw query
+   */
+  string_span query() const;
+
+  /**
+   * Returns the fragment of the url
+   *
+   * @return The fragment of the url
+   */
+  string_span fragment() const;
+
+  /**
+   * Returns the HTTP version of the request
+   *
+   * @return The HTTP version
+   */
+  http::version version() const;
+
+  /**
+   * Returns all headers in the order
+   * they were received.
+   *
+   * @return All headers of the request
+   */
+  const t_header_vector& headers() const;
+
+  /**
+   * Returns the value of the given known header.
+   * If the request doesn't contain the header an
+   * empty span is returned.
+   *
+   * @param header Known header to return
+   * @return The value of the header
+   */
+  string_span header(known_header_t header) const;
+
+  /**
+   * Returns the value of the first header with
+   * the given name. The name is compared case
+   * insensitive. If the request doesn't contain
+   * the header an empty span is returned.
+   *
+   * @param name Name of the header
+   * @return The value of the header
+   */
+  string_span header(const string_span &name) const;
+
+  /**
+   * Returns the content length of the
+   * request or 0 if there is none.
+   *
+   * @return The content length
+   */
+  std::size_t content_length() const;
+
+  /**
+   * Returns the body of the request
+   *
+   * @return The body of the request
+   */
+  string_span body() const;
+
+  /**
+   * Creates an owned request from the view. The
+   * query and a form data body are decoded and
+   * folded header values are unfolded.
+   *
+   * @return The owned request
+   */
+  request to_request() const;
+
+  /**
+   * Clears the view but keeps its memory
+   */
+  void clear();
+
+private:
+  friend class request_parser;
+
+  http::method_t method_ = http::UNKNOWN;
+  string_span url_;
+  string_span query_;
+  string_span fragment_;
+  http::version version_;
+  std::size_t content_length_ = 0;
+
+  t_header_vector headers_;
+  std::array<string_span, NUM_KNOWN_HEADERS> known_headers_;
+
+  string_span body_;
+};
+
+}
+}
+
+#endif //MATADOR_REQUEST_VIEW_HPP
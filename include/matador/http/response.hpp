@@ -19,12 +19,25 @@
 #include "matador/utils/file.hpp"
 #include "matador/utils/buffer_view.hpp"
 
+#include "matador/net/file_body.hpp"
+
+#include <functional>
+#include <memory>
+
 namespace matador {
 
 class json;
 
 namespace http {
 
+/**
+ * Producer of a streamed response body. It is called
+ * each time the previous part of the body was sent.
+ * It appends the next part to the given string and
+ * returns false once the body is complete.
+ */
+typedef std::function<bool(std::string &chunk)> t_body_producer;
+
 /**
  * The response class bundles all information of the
  * result of an HTTP request.
@@ -78,6 +91,25 @@ public:
    */
   const t_string_param_map& headers() const;
 
+  /**
+   * Adds a HTTP header to the response consisting of the
+   * header key and the header value.
+   *
+   * @param header The header key name
+   * @param value The value of the key
+   * @return True if the header was successfully added.
+   */
+  bool add_header(const std::string &header, const std::string &value);
+
+  /**
+   * Removes a header identified by the given
+   * header key from the response.
+   *
+   * @param header Key of the header to remove
+   * @return True if the header was successfully removed
+   */
+  bool remove_header(const std::string &header);
+
   /**
    * Returns the raw body as string.
    *
@@ -85,6 +117,68 @@ public:
    */
   const std::string& body() const;
 
+  /**
+   * Replaces the body of the response with the
+   * given content. A file or streamed body is
+   * dropped; the content type is kept.
+   *
+   * @param content The new body
+   */
+  void body(std::string content);
+
+  /**
+   * Replaces the body of the response with the given
+   * shared content, which isn't copied. A file or
+   * streamed body is dropped; the content type is kept.
+   *
+   * @param content The new shared body
+   */
+  void body(std::shared_ptr<const std::string> content);
+
+  /**
+   * Returns the shared body of the response. If
+   * the body isn't shared an empty pointer is
+   * returned.
+   *
+   * @return The shared body or an empty pointer
+   */
+  const std::shared_ptr<const std::string>& shared_body() const;
+
+  /**
+   * Returns the file sent as body of the
+   * response. If the body isn't a file
+   * an empty pointer is returned.
+   *
+   * @return The file body or an empty pointer
+   */
+  const std::shared_ptr<matador::file_body>& body_file() const;
+
+  /**
+   * Replaces the body of the response with
+   * the given file. The content type is kept.
+   *
+   * @param file The file to send as body
+   */
+  void body_file(std::shared_ptr<matador::file_body> file);
+
+  /**
+   * Returns the producer of a streamed body. If
+   * the body isn't streamed an empty function
+   * is returned.
+   *
+   * @return The body producer or an empty function
+   */
+  const t_body_producer& body_producer() const;
+
+  /**
+   * Replaces the body of the response with a body
+   * streamed from the given producer. The content
+   * type is kept.
+   *
+   * @param producer Producer of the new body
+   */
+  void body_producer(t_body_producer producer);
+
   /**
    * Creates an OK response with the given object
    * converted to a json string as body
@@ -171,6 +265,27 @@ public:
    */
   static response bad_request();
 
+  /**
+   * Creates a NOT_MODIFIED response
+   *
+   * @return The created NOT_MODIFIED response
+   */
+  static response not_modified();
+
+  /**
+   * Creates a PAYLOAD_TOO_LARGE response
+   *
+   * @return The created PAYLOAD_TOO_LARGE response
+   */
+  static response payload_too_large();
+
+  /**
+   * Creates a REQUEST_HEADER_FIELDS_TOO_LARGE response
+   *
+   * @return The created REQUEST_HEADER_FIELDS_TOO_LARGE response
+   */
+  static response request_header_fields_too_large();
+
   /**
    * Creates a REDIRECT response to the given
    * location.
@@ -191,6 +306,57 @@ public:
    */
   static response from_file(const std::string &file_path);
 
+  /**
+   * Creates an OK response sending the file at
+   * the given path as body. In contrast to from_file()
+   * the file isn't read into memory; the server sends it
+   * straight from the file (see file_body). The media
+   * type is determined by the file extension.
+   *
+   * If the file doesn't exist a not found
+   * response is returned.
+   *
+   * @param file_path Path of the file
+   * @return The created OK response
+   */
+  static response send_file(const std::string &file_path);
+
+  /**
+   * Creates a response with the given status whose body
+   * is shared with other responses, i.e. held by a cache.
+   * The body isn't copied and must not be changed.
+   *
+   * @param status Status of the response
+   * @param body Shared body of the response
+   * @param content_type Content type of the body
+   * @return The created response
+   */
+  static response shared(http::status_t status, std::shared_ptr<const std::string> body, const std::string &content_type);
+
+  /**
+   * Creates an OK response with a streamed body of the
+   * given media type. The body is sent with chunked
+   * transfer encoding part by part as produced by the
+   * given producer; the producer is only called once
+   * the previous part was written to the socket.
+   *
+   * @code
+   * std::size_t row = 0;
+   * return response::stream([&, row](std::string &chunk) mutable {
+   *   chunk = report.line(row++);
+   *   return row < report.lines();
+   * }, mime_types::TYPE_TEXT_PLAIN);
+   * @endcode
+   *
+   * HTTP/1.0 clients receive the body without chunked
+   * encoding and the connection is closed afterwards.
+   *
+   * @param producer Producer of the body
+   * @param type Media type of the body
+   * @return The created OK response
+   */
+  static response stream(t_body_producer producer, mime_types::types type);
+
   /**
    * Returns the response as a string
    *
@@ -221,6 +387,9 @@ private:
   t_string_param_map headers_;
 
   std::string body_;
+  std::shared_ptr<const std::string> shared_body_;
+  std::shared_ptr<matador::file_body> body_file_;
+  t_body_producer body_producer_;
 };
 
 template<class T>
@@ -15,6 +15,21 @@ class request;
 class response;
 
 typedef std::function<response(const request&)> t_request_handler;
+
+/**
+ * Consumer of a streamed request body. It is called for
+ * each part of the body as it arrives and once with a
+ * size of 0 when the body is complete. Returning false
+ * rejects the request with BAD_REQUEST.
+ */
+typedef std::function<bool(const char *data, std::size_t size)> t_body_consumer;
+
+/**
+ * Creates the body consumer for a request. The given
+ * request contains all headers and path params but
+ * no body.
+ */
+typedef std::function<t_body_consumer(const request&)> t_body_consumer_factory;
 typedef std::unordered_map<size_t, std::string> t_size_string_map;
 
 /// @cond MATADOR_DEV
@@ -38,12 +53,17 @@ public:
 
   response execute(const request &req);
 
+  void body_consumer_factory(t_body_consumer_factory factory);
+  bool streams_body() const;
+  t_body_consumer create_body_consumer(const request &req) const;
+
 private:
   std::string path_spec_;
   std::regex path_regex_;
   std::string path_regex_str_;
   http::method_t method_;
   t_request_handler request_handler_;
+  t_body_consumer_factory body_consumer_factory_;
 
   t_size_string_map param_index_map_;
 };
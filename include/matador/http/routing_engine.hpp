@@ -4,10 +4,16 @@
 #include "matador/http/export.hpp"
 
 #include "matador/http/route_endpoint.hpp"
+#include "matador/http/enum_class_hash.hpp"
+
+#include "matador/utils/string_span.hpp"
 
 #include <memory>
 #include <string>
 #include <list>
+#include <regex>
+#include <unordered_map>
+#include <vector>
 
 namespace matador {
 namespace http {
@@ -16,6 +22,31 @@ class request;
 
 /// @cond MATADOR_DEV
 
+/**
+ * Part of a route spec
+ */
+struct route_part
+{
+  enum type_t {
+    STATIC,  /**< Plain path element */
+    PARAM,   /**< Path param {name} or {name: regex} */
+    WILDCARD /**< Static files *.* */
+  };
+
+  type_t type = STATIC;
+  std::string value;      /**< Path element or name of the path param */
+  std::string constraint; /**< Regex constraint of a path param */
+};
+
+/**
+ * The routing engine compiles all routes of a method into a
+ * tree of path segments. A request url is matched segment by
+ * segment; static segments are tried before path params, path
+ * params before a static files wildcard.
+ *
+ * A regex is only evaluated for path params with a custom
+ * regex constraint, and only on their segment.
+ */
 class OOS_HTTP_API routing_engine
 {
 public:
@@ -29,6 +60,8 @@ public:
   routing_engine() = default;
 
   void add(const std::string& path, http::http::method_t method, const t_request_handler& request_handler);
+  void add(const std::string& path, http::http::method_t method, const t_request_handler& request_handler,
+           const t_body_consumer_factory &body_consumer_factory);
 
   iterator find(const std::string &path, http::http::method_t method);
 
@@ -39,14 +72,44 @@ public:
   bool valid(const const_iterator& it) const;
 
 private:
+  static const std::size_t NO_ROUTE;
+
+  struct route_node;
+
+  struct param_edge
+  {
+    std::string name;
+    std::string constraint;
+    std::unique_ptr<std::regex> regex;
+    std::unique_ptr<route_node> node;
+  };
+
+  struct route_node
+  {
+    // static children sorted by segment
+    std::vector<std::pair<std::string, std::unique_ptr<route_node>>> statics;
+    std::vector<param_edge> params;
+    std::size_t route = NO_ROUTE;
+    std::size_t wildcard_route = NO_ROUTE;
+  };
 
   iterator find_internal(const std::string &path, http::http::method_t method);
 
+  void insert(const std::vector<route_part> &parts, http::method_t method, std::size_t route);
+
+  bool match_node(const route_node &node, const char *begin, const char *end, bool has_segment,
+                  std::vector<string_span> &captures, std::size_t &route) const;
+
 private:
 
   std::vector<route_endpoint_ptr> routes_;
+  std::vector<std::vector<std::string>> route_param_names_;
+
+  std::unordered_map<http::method_t, route_node, detail::enum_class_hash> trees_;
 };
 
+OOS_HTTP_API std::vector<route_part> parse_route_spec(const std::string &path_spec);
+
 OOS_HTTP_API routing_engine::route_endpoint_ptr create_route_endpoint(
   const std::string &path_spec,
   http::method_t method,
@@ -0,0 +1,201 @@
+#ifndef MATADOR_STATIC_FILE_CACHE_HPP
+#define MATADOR_STATIC_FILE_CACHE_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/http/response.hpp"
+
+#include "matador/utils/os.hpp"
+
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace matador {
+namespace http {
+
+class request;
+
+/**
+ * @brief In process cache of static files
+ *
+ * The static file cache keeps the content of small files
+ * in memory together with their content type, length and
+ * cache validators (ETag and Last-Modified). The memory
+ * used by the cache is limited; once the limit is reached
+ * the least recently served files are evicted.
+ *
+ * Files larger than the maximum file size aren't kept in
+ * memory. They are sent with sendfile, but their validators
+ * are cached as well.
+ *
+ * An entry is revalidated against the modification time,
+ * size and inode of its file at most once per revalidate
+ * interval or when a request contains
+ * "Cache-Control: no-cache".
+ *
+ * Conditional requests are answered with NOT_MODIFIED and
+ * without body if the file didn't change. If-None-Match
+ * takes precedence over If-Modified-Since.
+ *
+ * The cache may be used by more than one thread. Files
+ * are read from disk without holding the cache lock.
+ */
+class OOS_HTTP_API static_file_cache
+{
+public:
+  /**
+   * Creates a static file cache using
+   * at most max_size bytes of memory.
+   *
+   * @param max_size Maximum memory used by the cache
+   */
+  explicit static_file_cache(std::size_t max_size = 64 * 1024 * 1024);
+
+  /**
+   * Serves the file at the given path for the given
+   * request. Returns NOT_FOUND if there is no regular
+   * file at the path.
+   *
+   * @param req Request to serve
+   * @param path Path of the file
+   * @return The response for the request
+   */
+  response serve(const request &req, const std::string &path);
+
+  /**
+   * Sets the maximum memory used by the cache.
+   * Files are evicted until the limit is reached.
+   *
+   * @param max_size Maximum memory used by the cache
+   */
+  void max_size(std::size_t max_size);
+
+  /**
+   * Returns the maximum memory used by the cache
+   *
+   * @return Maximum memory used by the cache
+   */
+  std::size_t max_size() const;
+
+  /**
+   * Sets the size up to which the content of a file
+   * is kept in memory. Defaults to 1MB.
+   *
+   * @param max_file_size Maximum size of a cached file content
+   */
+  void max_file_size(std::size_t max_file_size);
+
+  /**
+   * Returns the size up to which the content
+   * of a file is kept in memory.
+   *
+   * @return Maximum size of a cached file content
+   */
+  std::size_t max_file_size() const;
+
+  /**
+   * Sets the interval in which a cached file is checked
+   * for changes. Zero checks the file on every request.
+   * Defaults to one second.
+   *
+   * @param interval Revalidate interval
+   */
+  void revalidate_interval(std::chrono::milliseconds interval);
+
+  /**
+   * Returns the interval in which a cached
+   * file is checked for changes.
+   *
+   * @return Revalidate interval
+   */
+  std::chrono::milliseconds revalidate_interval() const;
+
+  /**
+   * Sets the value of the Cache-Control header sent with
+   * each served file, i.e. "public, max-age=3600". If the
+   * value is empty (the default) no header is sent.
+   *
+   * @param value Value of the Cache-Control header
+   */
+  void cache_control(const std::string &value);
+
+  /**
+   * Returns the value of the Cache-Control
+   * header sent with each served file.
+   *
+   * @return Value of the Cache-Control header
+   */
+  const std::string& cache_control() const;
+
+  /**
+   * Returns the number of cached files
+   *
+   * @return Number of cached files
+   */
+  std::size_t size() const;
+
+  /**
+   * Returns the memory used by the cache, the
+   * cached file contents and their entries.
+   *
+   * @return Memory used by the cache
+   */
+  std::size_t memory_usage() const;
+
+  /**
+   * Removes all files from the cache
+   */
+  void clear();
+
+private:
+  struct entry
+  {
+    std::string path;
+    os::file_stat stat;
+    std::shared_ptr<const std::string> content;
+    std::string content_type;
+    std::string etag;
+    std::string last_modified;
+    std::chrono::steady_clock::time_point checked;
+  };
+
+  typedef std::list<entry> t_entry_list;
+
+  static bool is_not_modified(const request &req, const entry &e);
+  static bool must_revalidate(const request &req);
+  static bool is_same_file(const os::file_stat &a, const os::file_stat &b);
+  static std::size_t entry_size(const entry &e);
+  static response respond(const request &req, const entry &e, const std::string &cache_control);
+
+  // reads the file without holding the lock
+  static bool load(const std::string &path, const os::file_stat &st, std::size_t max_content_size, entry &e);
+
+  t_entry_list::iterator insert(entry &&e);
+  void remove(const std::string &path);
+  void evict();
+
+private:
+  mutable std::mutex mutex_;
+
+  std::size_t max_size_;
+  std::size_t max_file_size_ = 1024 * 1024;
+  std::chrono::milliseconds revalidate_interval_ { std::chrono::seconds(1) };
+  std::string cache_control_;
+
+  std::size_t memory_usage_ = 0;
+
+  // most recently served first
+  t_entry_list entries_;
+  std::unordered_map<std::string, t_entry_list::iterator> entry_map_;
+};
+
+}
+}
+
+#endif //MATADOR_STATIC_FILE_CACHE_HPP
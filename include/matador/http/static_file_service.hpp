@@ -4,6 +4,7 @@
 #include "matador/http/export.hpp"
 
 #include "matador/http/http_server.hpp"
+#include "matador/http/static_file_cache.hpp"
 
 #include "matador/logger/log_manager.hpp"
 
@@ -13,7 +14,8 @@ namespace http {
 /**
  * Shortcut function for adding a static file route
  * to the given server. All files at the given path will
- * be served by the given server.
+ * be served by the given server. The files are served
+ * through a static_file_cache with default settings.
  *
  * @param path Where the static files resides
  * @param s The http server
@@ -22,7 +24,9 @@ OOS_HTTP_API void serve_static_files_at(const std::string &path, server &s);
 
 /**
  * This class stands as a static file service
- * for a given server and path.
+ * for a given server and path. The files are
+ * served through a static_file_cache which can
+ * be configured with cache().
  */
 class OOS_HTTP_API static_file_service
 {
@@ -37,11 +41,19 @@ public:
    */
   static_file_service(const std::string &path, server &s);
 
+  /**
+   * Returns the cache the files are served from
+   *
+   * @return The static file cache
+   */
+  static_file_cache& cache();
+
 private:
   response serve(const request &req);
 
 private:
   matador::logger log_;
+  static_file_cache cache_;
 };
 
 }
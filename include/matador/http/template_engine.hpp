@@ -3,9 +3,8 @@
 
 #include "matador/http/export.hpp"
 
-#include "matador/json/json_mapper.hpp"
-
-#include "matador/object/json_object_mapper.hpp"
+#include "matador/http/detail/template_object.hpp"
+#include "matador/http/detail/template_program.hpp"
 
 #include <string>
 #include <stack>
@@ -37,7 +36,8 @@ public:
 
   /**
    * Render the given format string with the given
-   * data object.
+   * data object. The fields of the object are read
+   * directly, the object isn't converted to json.
    *
    * @tparam T Type of data object.
    * @param format Format string to render.
@@ -82,8 +82,77 @@ public:
 
   static std::string render(const std::shared_ptr<detail::template_part>& part, const matador::json &data);
 
+  /**
+   * Render the given compiled template with the
+   * given json data object.
+   *
+   * @param program Compiled template to render.
+   * @param data Json data object to be rendered in.
+   * @return The rendered string
+   */
+  static std::string render(const std::shared_ptr<detail::template_program> &program, const matador::json &data);
+
+  /**
+   * Render the given compiled template with the given
+   * json data object and append the result to the given
+   * output string. No temporary strings are created for
+   * the static text and the values of the template.
+   *
+   * @param program Compiled template to render.
+   * @param data Json data object to be rendered in.
+   * @param out String the rendered template is appended to.
+   */
+  static void render(const std::shared_ptr<detail::template_program> &program, const matador::json &data, std::string &out);
+
+  /**
+   * Render the given compiled template with the given
+   * data object. The data object may be a serializable
+   * object, an object pointer or a container of them.
+   * Its fields are read directly, the object isn't
+   * converted to json.
+   *
+   * @tparam T Type of data object.
+   * @param program Compiled template to render.
+   * @param data Data object to be rendered in.
+   * @return The rendered string
+   */
+  template < class T >
+  static std::string render(const std::shared_ptr<detail::template_program> &program, const T &data);
+
+  /**
+   * Render the given compiled template with the given
+   * data object and append the result to the given
+   * output string.
+   *
+   * @tparam T Type of data object.
+   * @param program Compiled template to render.
+   * @param data Data object to be rendered in.
+   * @param out String the rendered template is appended to.
+   */
+  template < class T >
+  static void render(const std::shared_ptr<detail::template_program> &program, const T &data, std::string &out);
+
   static std::shared_ptr<detail::template_part> build(const std::string &format);
 
+  /**
+   * Compile the given format string into a flat list
+   * of instructions. The compiled template should be
+   * kept and rendered multiple times.
+   *
+   * @param format Format string to compile.
+   * @return The compiled template
+   */
+  static std::shared_ptr<detail::template_program> compile(const std::string &format);
+
+  /**
+   * Compile the given parsed template into a flat
+   * list of instructions.
+   *
+   * @param part Parsed template to compile.
+   * @return The compiled template
+   */
+  static std::shared_ptr<detail::template_program> compile(const std::shared_ptr<detail::template_part> &part);
+
 private:
 
   static std::shared_ptr<detail::template_part> build(const char *format, size_t len);
@@ -92,15 +161,27 @@ private:
 template<class T>
 std::string template_engine::render(const std::string &format, const T &data)
 {
-  json_mapper mapper;
-  return render(format, mapper.to_json(data));
+  return render(compile(format), data);
 }
 
 template<typename T>
 std::string template_engine::render(const std::string &format, const object_ptr<T> &data)
 {
-  json_object_mapper mapper;
-  return render(format, mapper.to_json(data));
+  return render(compile(format), data);
+}
+
+template<class T>
+std::string template_engine::render(const std::shared_ptr<detail::template_program> &program, const T &data)
+{
+  std::string out;
+  render(program, data, out);
+  return out;
+}
+
+template<class T>
+void template_engine::render(const std::shared_ptr<detail::template_program> &program, const T &data, std::string &out)
+{
+  program->render(detail::make_template_value(data), out);
 }
 
 }
@@ -0,0 +1,234 @@
+#ifndef MATADOR_TEMPLATE_REPOSITORY_HPP
+#define MATADOR_TEMPLATE_REPOSITORY_HPP
+
+#include "matador/http/export.hpp"
+
+#include "matador/http/detail/template_object.hpp"
+#include "matador/http/detail/template_program.hpp"
+
+#include "matador/utils/os.hpp"
+
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace matador {
+
+class json;
+
+namespace http {
+
+namespace detail {
+
+class template_part;
+
+}
+
+/**
+ * @brief Cache of compiled template files
+ *
+ * The template repository reads, parses and compiles the
+ * template files below its root directory once and keeps
+ * the compiled templates keyed by their path relative to
+ * the root. Included templates are resolved relative to
+ * the root as well and are parsed only once, however often
+ * they are included.
+ *
+ * The repository records the templates each template
+ * includes. If a template file changes, the template
+ * and all templates including it (directly or through
+ * other templates) are compiled again with their next
+ * request.
+ *
+ * Files are checked for changes at most once per
+ * revalidate interval. With auto reload disabled cached
+ * templates are never checked; together with prewarm()
+ * at startup there is no template file access and no
+ * parsing when a template is rendered.
+ *
+ * The repository may be used by more than one thread.
+ */
+class OOS_HTTP_API template_repository
+{
+public:
+  /**
+   * Creates a template repository for the
+   * templates below the given root directory.
+   *
+   * @param root Root directory of the templates
+   */
+  explicit template_repository(std::string root = "");
+
+  template_repository(const template_repository&) = delete;
+  template_repository& operator=(const template_repository&) = delete;
+
+  ~template_repository();
+
+  /**
+   * Returns the compiled template of the given
+   * path. It is read and compiled on first request.
+   *
+   * @param path Path of the template relative to the root
+   * @return The compiled template
+   * @throws std::logic_error If the template doesn't exist or is invalid
+   */
+  std::shared_ptr<detail::template_program> get(const std::string &path);
+
+  /**
+   * Renders the template of the given path
+   * with the given json data object.
+   *
+   * @param path Path of the template relative to the root
+   * @param data Json data object to be rendered in.
+   * @return The rendered string
+   */
+  std::string render(const std::string &path, const matador::json &data);
+
+  /**
+   * Renders the template of the given path with
+   * the given json data object and appends the
+   * result to the given output string.
+   *
+   * @param path Path of the template relative to the root
+   * @param data Json data object to be rendered in.
+   * @param out String the rendered template is appended to.
+   */
+  void render(const std::string &path, const matador::json &data, std::string &out);
+
+  /**
+   * Renders the template of the given path with the
+   * given data object and appends the result to the
+   * given output string. The fields of the object are
+   * read directly, the object isn't converted to json.
+   *
+   * @tparam T Type of data object.
+   * @param path Path of the template relative to the root
+   * @param data Data object to be rendered in.
+   * @param out String the rendered template is appended to.
+   */
+  template < class T >
+  void render(const std::string &path, const T &data, std::string &out)
+  {
+    get(path)->render(detail::make_template_value(data), out);
+  }
+
+  /**
+   * Compiles all templates below the root directory
+   * with one of the given file extensions.
+   *
+   * @param extensions File extensions of the templates
+   * @return The number of compiled templates
+   */
+  std::size_t prewarm(const std::vector<std::string> &extensions = { ".html", ".matador" });
+
+  /**
+   * Removes the template of the given path and all
+   * templates including it from the repository.
+   *
+   * @param path Path of the template relative to the root
+   */
+  void invalidate(const std::string &path);
+
+  /**
+   * Returns the paths of the templates directly
+   * included by the template of the given path.
+   *
+   * @param path Path of the template relative to the root
+   * @return Paths of the included templates
+   */
+  std::set<std::string> dependencies(const std::string &path) const;
+
+  /**
+   * Enables or disables the check of cached
+   * templates for changes. Enabled by default.
+   *
+   * @param enable True to check templates for changes
+   */
+  void auto_reload(bool enable);
+
+  /**
+   * Returns true if cached templates are
+   * checked for changes.
+   *
+   * @return True if cached templates are checked for changes
+   */
+  bool auto_reload() const;
+
+  /**
+   * Sets the interval in which a cached template is
+   * checked for changes. Zero checks the template on
+   * every request. Defaults to one second.
+   *
+   * @param interval Revalidate interval
+   */
+  void revalidate_interval(std::chrono::milliseconds interval);
+
+  /**
+   * Returns the interval in which a cached
+   * template is checked for changes.
+   *
+   * @return Revalidate interval
+   */
+  std::chrono::milliseconds revalidate_interval() const;
+
+  /**
+   * Returns the root directory of the templates
+   *
+   * @return Root directory of the templates
+   */
+  const std::string& root() const;
+
+  /**
+   * Returns the number of cached templates
+   *
+   * @return Number of cached templates
+   */
+  std::size_t size() const;
+
+  /**
+   * Removes all templates from the repository
+   */
+  void clear();
+
+private:
+  class loader;
+
+  struct entry
+  {
+    os::file_stat stat;
+    std::shared_ptr<detail::template_part> part;
+    std::shared_ptr<detail::template_program> program;
+    std::set<std::string> dependencies;
+    std::chrono::steady_clock::time_point checked;
+  };
+
+  std::string full_path(const std::string &path) const;
+
+  entry& load(const std::string &path);
+  void revalidate(const std::string &path, std::chrono::steady_clock::time_point now);
+  void remove(const std::string &path);
+
+private:
+  mutable std::mutex mutex_;
+
+  std::string root_;
+  bool auto_reload_ = true;
+  std::chrono::milliseconds revalidate_interval_ { std::chrono::seconds(1) };
+
+  std::unordered_map<std::string, entry> entries_;
+  // paths of the templates including a template
+  std::unordered_map<std::string, std::set<std::string>> dependents_;
+
+  // templates currently parsed and their includes
+  std::vector<std::pair<std::string, std::set<std::string>>> loading_;
+};
+
+}
+}
+
+#endif //MATADOR_TEMPLATE_REPOSITORY_HPP
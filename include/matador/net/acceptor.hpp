@@ -12,6 +12,8 @@
 
 namespace matador {
 
+class reactor;
+
 /**
  * The acceptor class is used to accept new connection
  * within the reactor dispatcher.
@@ -24,6 +26,7 @@ class OOS_NET_API acceptor : public handler, public handler_creator
 {
 public:
   typedef std::function<std::shared_ptr<handler>(tcp::socket sock, tcp::peer endpoint, acceptor *accptr)> t_accept_handler; /**< Shortcut to a function creating a handler on successfully accepted a new connection */
+  typedef std::function<reactor*()> t_reactor_assignment; /**< Shortcut to a function choosing the reactor of a new connection */
 
   /**
    * Default constructor
@@ -74,6 +77,70 @@ public:
    */
   void accecpt(const tcp::peer& endpoint, t_accept_handler on_new_connection);
 
+  /**
+   * Sets the function choosing the reactor which
+   * dispatches a newly accepted connection. Without
+   * such a function the connection is registered
+   * within the reactor of the acceptor.
+   *
+   * @param assignment Function returning the reactor for a new connection
+   */
+  void assign_reactor(t_reactor_assignment assignment);
+
+  /**
+   * Sets or clears the reuse port flag of the
+   * listening socket. Must be called before the
+   * acceptor is opened. Several acceptors with
+   * this flag can listen on the same endpoint.
+   *
+   * @param reuse True if the port can be shared
+   */
+  void reuse_port(bool reuse);
+
+  /**
+   * Returns true if the reuse port
+   * flag is set.
+   *
+   * @return True if the port can be shared
+   */
+  bool reuse_port() const;
+
+  /**
+   * Sets the maximum length of the queue of pending
+   * connections of the listening socket. Must be
+   * called before the acceptor is opened.
+   *
+   * @param backlog Maximum length of the pending connection queue
+   */
+  void backlog(int backlog);
+
+  /**
+   * Returns the maximum length of the
+   * queue of pending connections.
+   *
+   * @return Maximum length of the pending connection queue
+   */
+  int backlog() const;
+
+  /**
+   * Sets the maximum number of connections accepted
+   * on one read event. The acceptor accepts until the
+   * queue of pending connections is drained or the
+   * maximum is reached; the remaining connections are
+   * accepted with the next event.
+   *
+   * @param max_accepts Maximum number of accepted connections per event
+   */
+  void accepts_per_event(std::size_t max_accepts);
+
+  /**
+   * Returns the maximum number of
+   * connections accepted on one read event.
+   *
+   * @return Maximum number of accepted connections per event
+   */
+  std::size_t accepts_per_event() const;
+
   /**
    * Opens the acceptor means the socket address of the
    * endpoint is bound to the created listing socket
@@ -95,6 +162,9 @@ public:
    * a new connection handler is created and the socket is
    * passed to the handler. The handler is then registered
    * to the reactor to disptach its read and write events.
+   *
+   * All pending connections up to the maximum
+   * per event are accepted at once.
    */
   void on_input() override;
 
@@ -164,9 +234,16 @@ private:
   std::string name_ { "acceptor" };
 
   t_accept_handler accept_handler_;
+  t_reactor_assignment reactor_assignment_;
+
+  int backlog_ = SOMAXCONN;
+  std::size_t accepts_per_event_ = 64;
+
+  bool completes_io_ = false;
 
   logger log_;
 
+  int accept(tcp::socket &sock, tcp::peer &endpoint);
   tcp::peer create_client_endpoint() const;
 };
 
@@ -0,0 +1,240 @@
+#ifndef MATADOR_DEMULTIPLEXER_HPP
+#define MATADOR_DEMULTIPLEXER_HPP
+
+#include "matador/net/export.hpp"
+#include "matador/net/event_type.hpp"
+#include "matador/net/os.hpp"
+
+#include <list>
+#include <memory>
+#include <vector>
+
+namespace matador {
+
+class buffer_view;
+
+/**
+ * Enum representing the available event
+ * demultiplexer backends of the reactor.
+ */
+enum class demultiplexer_type {
+  SELECT,  /**< Enum value for the select based demultiplexer (all platforms) */
+  EPOLL,   /**< Enum value for the epoll based demultiplexer (linux only) */
+  IO_URING /**< Enum value for the io_uring based demultiplexer (linux 5.5 and later) */
+};
+
+/**
+ * Enum representing the io operations a demultiplexer
+ * completes for a socket (see demultiplexer::complete_io()).
+ */
+enum class io_operation {
+  STREAM, /**< Enum value for receiving and sending on a connected socket */
+  ACCEPT  /**< Enum value for accepting connections on a listening socket */
+};
+
+/**
+ * Interface of an event demultiplexer used by the
+ * reactor to wait for io events on a set of
+ * file descriptors.
+ *
+ * The interest of a file descriptor is registered
+ * persistently with add(), changed with modify() and
+ * dropped with remove(). A call to wait() only
+ * returns the descriptors which became ready.
+ *
+ * A demultiplexer may also complete the io operations
+ * of a socket itself (see completes_io()). Then a read
+ * or write event means that an operation completed and
+ * its result is taken with receive(), send() or accept().
+ */
+class OOS_NET_API demultiplexer
+{
+public:
+  /**
+   * A ready event consisting of the file
+   * descriptor and the event which occurred.
+   */
+  struct ready_event
+  {
+    socket_type fd;  /**< Ready file descriptor */
+    event_type type; /**< Occurred event (read or write) */
+  };
+
+  typedef std::vector<ready_event> t_ready_events; /**< Shortcut to a list of ready events */
+
+  /**
+   * Virtual destructor
+   */
+  virtual ~demultiplexer() = default;
+
+  /**
+   * Registers the given file descriptor with
+   * the given interest (read, write or both).
+   *
+   * @param fd File descriptor to register
+   * @param interest Event mask of interest
+   */
+  virtual void add(socket_type fd, event_type interest) = 0;
+
+  /**
+   * Changes the interest of an already
+   * registered file descriptor.
+   *
+   * @param fd File descriptor to modify
+   * @param interest New event mask of interest
+   */
+  virtual void modify(socket_type fd, event_type interest) = 0;
+
+  /**
+   * Removes the given file descriptor
+   * from the demultiplexer.
+   *
+   * @param fd File descriptor to remove
+   */
+  virtual void remove(socket_type fd) = 0;
+
+  /**
+   * Waits until at least one of the registered file
+   * descriptors becomes ready or the timeout expires.
+   * The ready descriptors are appended to the
+   * given list of events. All events of one
+   * descriptor are appended consecutively, a
+   * write event before a read event.
+   *
+   * A negative timeout blocks until an event
+   * occurs. On error -1 is returned and errno is set.
+   *
+   * @param timeout Timeout in milliseconds
+   * @param events List receiving the ready events
+   * @return Number of ready events or -1 on error
+   */
+  virtual int wait(long timeout, t_ready_events &events) = 0;
+
+  /**
+   * Returns true if a change of interest only
+   * takes effect with the next call to wait().
+   * In this case a blocked wait must be interrupted
+   * to recognize the change.
+   *
+   * @return True if a change requires an interrupt
+   */
+  virtual bool requires_interrupt() const = 0;
+
+  /**
+   * Returns the number of registered
+   * file descriptors.
+   *
+   * @return Number of registered file descriptors
+   */
+  virtual std::size_t size() const = 0;
+
+  /**
+   * Returns the type of the demultiplexer.
+   *
+   * @return Type of the demultiplexer
+   */
+  virtual demultiplexer_type type() const = 0;
+
+  /**
+   * Returns true if the demultiplexer receives, sends
+   * and accepts on the sockets handed over with
+   * complete_io() instead of only reporting their
+   * readiness. Defaults to false.
+   *
+   * @return True if io operations are completed by the demultiplexer
+   */
+  virtual bool completes_io() const;
+
+  /**
+   * Hands the io operations of the given socket over to
+   * the demultiplexer. Afterwards the socket is read,
+   * written, accepted on and closed only through the
+   * demultiplexer. Does nothing if completes_io()
+   * returns false.
+   *
+   * @param fd Socket to hand over
+   * @param op Kind of io operations of the socket
+   */
+  virtual void complete_io(socket_type fd, io_operation op);
+
+  /**
+   * Copies data received for the given socket into the
+   * given buffer. Returns 0 if the peer closed the
+   * connection. If no data was received yet -1 is
+   * returned and errno is set to EAGAIN.
+   *
+   * @param fd Socket to take the data from
+   * @param buf Buffer receiving the data
+   * @param len Size of the buffer
+   * @return Number of copied bytes, 0 on close or -1 on error
+   */
+  virtual long receive(socket_type fd, char *buf, std::size_t len);
+
+  /**
+   * Takes the result of the last send on the given socket
+   * and sends the rest of the given buffers. The sent bytes
+   * are consumed from the buffers. The data of the buffers
+   * must not change until all of them were sent, the owner
+   * is kept until then. If nothing was sent yet -1 is
+   * returned and errno is set to EAGAIN.
+   *
+   * @param fd Socket to send on
+   * @param buffers Buffers to send
+   * @param owner Owner of the buffer data
+   * @return Number of sent bytes or -1 on error
+   */
+  virtual long send(socket_type fd, std::list<buffer_view> &buffers, const std::shared_ptr<void> &owner);
+
+  /**
+   * Takes a connection accepted on the given listening
+   * socket. The accepted socket is non blocking. If no
+   * connection is pending -1 is returned and errno is
+   * set to EAGAIN.
+   *
+   * @param fd Listening socket
+   * @return The accepted socket or -1 on error
+   */
+  virtual socket_type accept(socket_type fd);
+
+  /**
+   * Cancels all pending operations of the given socket
+   * and closes it.
+   *
+   * @param fd Socket to close
+   */
+  virtual void close(socket_type fd);
+};
+
+/**
+ * Returns the best demultiplexer type available
+ * on the current platform.
+ *
+ * @return The default demultiplexer type
+ */
+OOS_NET_API demultiplexer_type default_demultiplexer_type();
+
+/**
+ * Returns true if the given demultiplexer type is
+ * available. For io_uring the running kernel
+ * is checked as well.
+ *
+ * @param type Demultiplexer type to check
+ * @return True if the type is available
+ */
+OOS_NET_API bool is_demultiplexer_available(demultiplexer_type type);
+
+/**
+ * Creates a demultiplexer of the requested type. If
+ * io_uring isn't supported by the running kernel the
+ * default demultiplexer is created. If any other type
+ * isn't available on the current platform a select
+ * based demultiplexer is created.
+ *
+ * @param type Requested demultiplexer type
+ * @return The created demultiplexer
+ */
+OOS_NET_API std::unique_ptr<demultiplexer> make_demultiplexer(demultiplexer_type type);
+
+}
+
+#endif //MATADOR_DEMULTIPLEXER_HPP
@@ -0,0 +1,64 @@
+#ifndef MATADOR_EPOLL_DEMULTIPLEXER_HPP
+#define MATADOR_EPOLL_DEMULTIPLEXER_HPP
+
+#include "matador/net/export.hpp"
+#include "matador/net/demultiplexer.hpp"
+
+#if defined(__linux__)
+#define MATADOR_HAS_EPOLL 1
+#endif
+
+#ifdef MATADOR_HAS_EPOLL
+
+#include <sys/epoll.h>
+
+#include <atomic>
+
+namespace matador {
+
+/// @cond MATADOR_DEV
+
+/**
+ * Demultiplexer based on linux epoll. The interest
+ * of each file descriptor is kept registered within
+ * the kernel and a call to wait only returns the
+ * ready descriptors. Therefore the costs of a wait
+ * don't depend on the number of registered
+ * but on the number of active descriptors.
+ */
+class OOS_NET_API epoll_demultiplexer : public demultiplexer
+{
+public:
+  epoll_demultiplexer();
+  ~epoll_demultiplexer() override;
+
+  void add(socket_type fd, event_type interest) override;
+  void modify(socket_type fd, event_type interest) override;
+  void remove(socket_type fd) override;
+
+  int wait(long timeout, t_ready_events &events) override;
+
+  bool requires_interrupt() const override;
+
+  std::size_t size() const override;
+
+  demultiplexer_type type() const override;
+
+private:
+  static unsigned int to_epoll_events(event_type interest);
+
+private:
+  int epoll_fd_ = -1;
+
+  std::atomic_size_t size_ { 0 };
+
+  std::vector<struct epoll_event> epoll_events_;
+};
+
+/// @endcond
+
+}
+
+#endif
+
+#endif //MATADOR_EPOLL_DEMULTIPLEXER_HPP
@@ -0,0 +1,130 @@
+#ifndef MATADOR_FILE_BODY_HPP
+#define MATADOR_FILE_BODY_HPP
+
+#include "matador/net/export.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace matador {
+
+/**
+ * @brief Read only file sent as body of a stream
+ *
+ * The file body holds an open file descriptor and a
+ * cursor marking how much of the file was already
+ * sent. A socket stream sends the file directly from
+ * the page cache with sendfile(2) where available,
+ * otherwise the file is read in chunks with pread.
+ * In both cases the file is never held in memory
+ * as a whole.
+ *
+ * The interface follows buffer_view: capacity()
+ * is the number of bytes left to send and bump()
+ * moves the cursor forward.
+ */
+class OOS_NET_API file_body
+{
+public:
+  /**
+   * Opens the file at the given path for reading.
+   * Check with is_open() if the file could be opened.
+   *
+   * @param path Path of the file
+   */
+  explicit file_body(const std::string &path);
+
+  file_body(const file_body&) = delete;
+  file_body& operator=(const file_body&) = delete;
+
+  /**
+   * Closes the file
+   */
+  ~file_body();
+
+  /**
+   * Returns the path of the file
+   *
+   * @return Path of the file
+   */
+  const std::string& path() const;
+
+  /**
+   * Returns true if the file is open
+   *
+   * @return True if the file is open
+   */
+  bool is_open() const;
+
+  /**
+   * Returns the file descriptor of the file
+   *
+   * @return The file descriptor
+   */
+  int fd() const;
+
+  /**
+   * Returns the size of the file
+   *
+   * @return Size of the file
+   */
+  std::size_t size() const;
+
+  /**
+   * Returns the offset of the next
+   * byte to send.
+   *
+   * @return Offset of the next byte to send
+   */
+  std::size_t offset() const;
+
+  /**
+   * Returns the number of bytes left to send
+   *
+   * @return Number of bytes left to send
+   */
+  std::size_t capacity() const;
+
+  /**
+   * Moves the cursor forward by the given
+   * number of bytes.
+   *
+   * @param len Number of sent bytes
+   */
+  void bump(std::size_t len);
+
+  /**
+   * Returns true if the whole file was sent
+   *
+   * @return True if the whole file was sent
+   */
+  bool full() const;
+
+  /**
+   * Reads up to size bytes at the current offset into
+   * the given buffer without moving the cursor.
+   *
+   * @param buf Buffer to read into
+   * @param size Size of the buffer
+   * @return Number of bytes read or -1 on error
+   */
+  long read(char *buf, std::size_t size) const;
+
+  /**
+   * Returns the complete content of
+   * the file as string.
+   *
+   * @return Content of the file
+   */
+  std::string to_string() const;
+
+private:
+  std::string path_;
+  int fd_ = -1;
+  std::size_t size_ = 0;
+  std::size_t offset_ = 0;
+};
+
+}
+
+#endif //MATADOR_FILE_BODY_HPP
@@ -3,6 +3,8 @@
 
 #include "matador/net/export.hpp"
 #include "matador/net/os.hpp"
+#include "matador/net/event_type.hpp"
+#include "matador/net/timer_wheel.hpp"
 
 #include <memory>
 #include <string>
@@ -60,6 +62,16 @@ public:
    */
   virtual void on_timeout() = 0;
 
+  /**
+   * Called when the timer with the given id
+   * expired. The default implementation calls
+   * on_timeout(). Handlers scheduling more than
+   * one timer override this to distinguish them.
+   *
+   * @param id Id of the expired timer
+   */
+  virtual void on_timer(timer_id id);
+
   /**
    * Interface called when the handler is closed
    */
@@ -133,6 +145,10 @@ private:
 
   time_t next_timeout_ = 0;
   time_t interval_ = 0;
+  timer_id timer_ = 0;
+
+  socket_type registered_handle_ = 0;
+  event_type registered_interest_ = event_type::NONE_MASK;
 };
 
 }
@@ -9,11 +9,46 @@
 #include "matador/net/connector.hpp"
 #include "matador/net/stream_handler.hpp"
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 namespace matador {
 
+/**
+ * Policy assigning new connections to
+ * the shards of an io_service.
+ */
+enum class shard_policy
+{
+  ROUND_ROBIN, /**< One acceptor hands new connections to the shards in turn */
+  REUSE_PORT   /**< Each shard listens with its own socket bound with SO_REUSEPORT */
+};
+
+/**
+ * Configuration of a sharded io_service. Each shard
+ * is a reactor with its own event loop, handler table,
+ * timers and threads. A connection is dispatched by
+ * one shard for its whole lifetime.
+ */
+struct io_service_config
+{
+  std::size_t shards = 0;                                        /**< Number of shards; zero means one per cpu */
+  std::size_t threads_per_shard = 1;                             /**< Number of dispatching threads of each shard */
+  shard_policy policy = shard_policy::ROUND_ROBIN;               /**< Assignment of new connections to the shards */
+  bool pin_threads = false;                                      /**< Bind the threads of shard n to cpu n */
+  demultiplexer_type demultiplexer = default_demultiplexer_type(); /**< Demultiplexer of the shards */
+};
+
 /**
  * IO Service is used to encapsulate the an instance
  * of the reactor class.
+ *
+ * Configured with more than one shard the service
+ * runs one reactor per shard. New connections are
+ * spread over the shards either by one acceptor
+ * handing them over in turn or by one listening
+ * socket per shard sharing the port (SO_REUSEPORT).
  */
 class OOS_NET_API io_service
 {
@@ -23,6 +58,22 @@ public:
    */
   io_service();
 
+  /**
+   * Creates a io_service with a reactor using
+   * the given demultiplexer type
+   *
+   * @param type Type of the demultiplexer
+   */
+  explicit io_service(demultiplexer_type type);
+
+  /**
+   * Creates a sharded io_service with
+   * the given configuration
+   *
+   * @param config Configuration of the shards
+   */
+  explicit io_service(const io_service_config &config);
+
   ~io_service();
   /**
    * Starts the io_service with the underlying reactor
@@ -31,12 +82,28 @@ public:
 
   /**
    * Returns true if the io service is
-   * running
+   * running, i.e. all shards are running.
    *
    * @return True if service is running
    */
   bool is_running() const;
 
+  /**
+   * Returns the number of shards
+   *
+   * @return Number of shards
+   */
+  std::size_t shards() const;
+
+  /**
+   * Returns the reactor of the shard
+   * with the given index.
+   *
+   * @param index Index of the shard
+   * @return The reactor of the shard
+   */
+  reactor& shard(std::size_t index);
+
   /**
    * Shuts down a running service
    */
@@ -86,31 +153,41 @@ public:
   template < typename ConnectCallback >
   void connect(const std::shared_ptr<connector>& co, const std::string &port, ConnectCallback connect_callback);
 
+private:
+  template < typename Callback >
+  acceptor::t_accept_handler make_accept_handler(Callback callback);
+
+  void register_acceptor(const std::shared_ptr<acceptor>& ac, const acceptor::t_accept_handler &make_handler);
+
+  reactor& next_reactor();
+
 private:
   logger log_;
-  reactor reactor_;
+  std::vector<std::unique_ptr<reactor>> reactors_;
+  shard_policy policy_ = shard_policy::ROUND_ROBIN;
+  std::atomic_size_t next_shard_ { 0 };
+  // listening acceptors of the shards sharing the port
+  std::vector<std::shared_ptr<acceptor>> shard_acceptors_;
 };
 
 template<typename AcceptCallback>
 void io_service::accept(const std::shared_ptr<acceptor>& ac, const tcp::peer &ep, AcceptCallback accept_callback)
 {
   log_.info("registering acceptor for %s", ep.to_string().c_str());
-  ac->accecpt(ep, [accept_callback, this](tcp::socket sock, tcp::peer p, acceptor *accptr) {
-    return std::make_shared<stream_handler>(sock, p, accptr, accept_callback);
-  });
+  auto make_handler = make_accept_handler(accept_callback);
+  ac->accecpt(ep, make_handler);
 
-  reactor_.register_handler(ac, event_type::ACCEPT_MASK);
+  register_acceptor(ac, make_handler);
 }
 
 template<typename AcceptCallback>
 void io_service::accept(const std::shared_ptr<acceptor>& ac, AcceptCallback accept_callback)
 {
   log_.info("registering acceptor for %s", ac->endpoint().to_string().c_str());
-  ac->accecpt([accept_callback](tcp::socket sock, tcp::peer p, acceptor *accptr) {
-    return std::make_shared<stream_handler>(sock, p, accptr, accept_callback);
-  });
+  auto make_handler = make_accept_handler(accept_callback);
+  ac->accecpt(make_handler);
 
-  reactor_.register_handler(ac, event_type::ACCEPT_MASK);
+  register_acceptor(ac, make_handler);
 }
 
 template<typename ConnectCallback>
@@ -119,10 +196,18 @@ void io_service::connect(const std::shared_ptr<connector> &co, const std::string
   log_.info("registering connector for localhost:%s", port.c_str());
   tcp::resolver resolver;
   auto endpoints = resolver.resolve("localhost", port);
-  co->connect(reactor_, endpoints, [connect_callback](const tcp::socket& sock, const tcp::peer &p, connector *cnnctr) {
+  co->connect(next_reactor(), endpoints, [connect_callback](const tcp::socket& sock, const tcp::peer &p, connector *cnnctr) {
     return std::make_shared<stream_handler>(sock, p, cnnctr, connect_callback);
   });
 }
 
+template<typename Callback>
+acceptor::t_accept_handler io_service::make_accept_handler(Callback callback)
+{
+  return [callback](tcp::socket sock, tcp::peer p, acceptor *accptr) {
+    return std::make_shared<stream_handler>(sock, p, accptr, callback);
+  };
+}
+
 }
 #endif //MATADOR_IO_SERVICE_HPP
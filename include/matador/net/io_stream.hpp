@@ -1,8 +1,10 @@
 #ifndef MATADOR_IO_STREAM_HPP
 #define MATADOR_IO_STREAM_HPP
 
+#include <chrono>
 #include <functional>
 #include <list>
+#include <memory>
 
 #include "matador/net/export.hpp"
 #include "matador/net/ip.hpp"
@@ -11,6 +13,8 @@ namespace matador {
 
 class buffer;
 class buffer_view;
+class buffer_chain;
+class file_body;
 
 /**
  * The io stream class is proposed
@@ -34,6 +38,23 @@ public:
    */
   virtual void read(buffer_view buf, t_read_handler read_handler) = 0;
 
+  /**
+   * This interface is called when data should
+   * be read from a socket into the given buffer chain.
+   * The chain takes a segment from its pool not until
+   * the socket is readable, so a stream waiting for
+   * data doesn't hold any buffer memory. Once the data
+   * was read it is appended to the chain and the given
+   * read handler is called.
+   *
+   * The chain must stay valid until the
+   * read handler was called.
+   *
+   * @param chain Buffer chain to append the data to
+   * @param read_handler Handler to be called when data was read
+   */
+  virtual void read(buffer_chain &chain, t_read_handler read_handler) = 0;
+
   /**
    * This interface is called when data should be written
    * to a socket. Once the data was written the given
@@ -44,6 +65,29 @@ public:
    */
   virtual void write(std::list<buffer_view> buffers, t_write_handler write_handler) = 0;
 
+  /**
+   * This interface is called when data followed by the
+   * content of a file should be written to a socket. The
+   * buffers are written first, then the file is sent without
+   * reading it into memory (see file_body). Once all data
+   * was written the given write handler is called.
+   *
+   * @param buffers List of buffers containing the data to write before the file
+   * @param file File to send after the buffers
+   * @param write_handler Handler to be called when the data was written
+   */
+  virtual void write(std::list<buffer_view> buffers, std::shared_ptr<file_body> file, t_write_handler write_handler) = 0;
+
+  /**
+   * Sets the time a read waits for data. If no data
+   * arrives within this time the stream is closed. The
+   * timeout applies to all following reads. A timeout
+   * of zero (the default) waits forever.
+   *
+   * @param timeout Time to wait for data
+   */
+  virtual void read_timeout(std::chrono::milliseconds timeout) = 0;
+
   /**
    * Closes the stream
    */
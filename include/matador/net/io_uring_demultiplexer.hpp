@@ -0,0 +1,235 @@
+#ifndef MATADOR_IO_URING_DEMULTIPLEXER_HPP
+#define MATADOR_IO_URING_DEMULTIPLEXER_HPP
+
+#include "matador/net/export.hpp"
+#include "matador/net/demultiplexer.hpp"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#ifdef IORING_ENTER_EXT_ARG
+#define MATADOR_HAS_IO_URING 1
+#endif
+#endif
+#endif
+
+#ifdef MATADOR_HAS_IO_URING
+
+#ifdef IORING_RECV_MULTISHOT
+#define MATADOR_HAS_IO_URING_COMPLETION 1
+#endif
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace matador {
+
+/// @cond MATADOR_DEV
+
+/**
+ * Demultiplexer based on linux io_uring. The interest
+ * of a file descriptor is submitted as a poll request
+ * to the submission ring; readiness is taken from the
+ * completion ring.
+ *
+ * Poll requests are one shot. A descriptor which
+ * became ready is armed again with the next call
+ * to wait() unless its interest was changed in the
+ * meantime. This gives the same level triggered
+ * behaviour as the select and epoll demultiplexer.
+ *
+ * Sockets handed over with complete_io() are read,
+ * written, accepted on and closed by the ring itself:
+ *
+ * - A stream socket receives with a multishot recv into
+ *   buffers provided to the kernel by a registered buffer
+ *   ring. At most four buffers are queued per socket, then
+ *   the recv is cancelled until the data was taken.
+ * - The buffers of a send are submitted as one sendmsg
+ *   without copying them. A socket which isn't writable
+ *   is polled before the next send.
+ * - A listening socket accepts with a multishot accept.
+ * - Closing a socket cancels its pending requests.
+ *
+ * Their readiness is reported once a request completed.
+ * A kernel rejecting multishot recv receives with single
+ * shot requests.
+ *
+ * The demultiplexer needs the nodrop feature of the
+ * kernel (5.5 and later). Without the ext arg feature
+ * (5.11) the timeout of wait() is submitted as a
+ * timeout request. Completing io needs buffer rings
+ * (5.19); on older kernels the demultiplexer only polls.
+ * Use is_supported() to check the running kernel.
+ */
+class OOS_NET_API io_uring_demultiplexer : public demultiplexer
+{
+public:
+  /**
+   * Creates the ring. If complete_io is false or the
+   * kernel can't complete io, sockets are only polled
+   * for readiness.
+   *
+   * @param complete_io True if io shall be completed by the ring
+   */
+  explicit io_uring_demultiplexer(bool complete_io = true);
+  ~io_uring_demultiplexer() override;
+
+  io_uring_demultiplexer(const io_uring_demultiplexer&) = delete;
+  io_uring_demultiplexer& operator=(const io_uring_demultiplexer&) = delete;
+
+  void add(socket_type fd, event_type interest) override;
+  void modify(socket_type fd, event_type interest) override;
+  void remove(socket_type fd) override;
+
+  int wait(long timeout, t_ready_events &events) override;
+
+  bool requires_interrupt() const override;
+
+  std::size_t size() const override;
+
+  demultiplexer_type type() const override;
+
+  bool completes_io() const override;
+  void complete_io(socket_type fd, io_operation op) override;
+
+  long receive(socket_type fd, char *buf, std::size_t len) override;
+  long send(socket_type fd, std::list<buffer_view> &buffers, const std::shared_ptr<void> &owner) override;
+  socket_type accept(socket_type fd) override;
+  void close(socket_type fd) override;
+
+  /**
+   * Returns true if the running kernel provides
+   * all io_uring features needed by the
+   * demultiplexer. The check is done once.
+   *
+   * @return True if io_uring is supported
+   */
+  static bool is_supported();
+
+private:
+  enum class entry_mode { POLL, STREAM, ACCEPT };
+  enum class request_state { IDLE, ARMED, CANCELLING };
+
+  struct received_buffer
+  {
+    std::uint16_t id;
+    std::uint32_t size;
+    std::uint32_t offset;
+  };
+
+  struct fd_entry
+  {
+    event_type interest = event_type::NONE_MASK;
+    std::uint32_t sequence = 0;
+    bool registered = false;
+    bool armed = false;
+    bool ready = false;
+
+    // state of a socket handed over with complete_io()
+    entry_mode mode = entry_mode::POLL;
+    request_state input = request_state::IDLE;
+    std::uint32_t input_sequence = 0;
+    bool starved = false;
+    bool eof = false;
+    int error = 0;
+    std::deque<received_buffer> received;
+    std::deque<socket_type> accepted;
+    bool sending = false;
+    std::uint32_t send_sequence = 0;
+    bool sent = false;
+    long send_result = 0;
+    bool writable = false;
+  };
+
+  struct send_request;
+
+  void setup(bool complete_io);
+  bool setup_completion(unsigned int features);
+  void teardown();
+
+  fd_entry& ensure_entry(socket_type fd);
+  fd_entry* find_entry(socket_type fd);
+
+  void update(socket_type fd, fd_entry &entry);
+  bool is_ready(const fd_entry &entry) const;
+  void mark_ready(socket_type fd, fd_entry &entry);
+
+  void arm(socket_type fd, fd_entry &entry, unsigned int poll_events);
+  void disarm(socket_type fd, fd_entry &entry);
+  void arm_receive(socket_type fd, fd_entry &entry);
+  void arm_accept(socket_type fd, fd_entry &entry);
+  void cancel(std::uint64_t user_data);
+  bool submit_send(socket_type fd, fd_entry &entry, std::list<buffer_view> &buffers, const std::shared_ptr<void> &owner);
+
+  void on_poll(socket_type fd, std::uint32_t sequence, int result, t_ready_events &events);
+  void on_receive(socket_type fd, std::uint32_t sequence, const struct io_uring_cqe &cqe);
+  void on_accept(socket_type fd, std::uint32_t sequence, const struct io_uring_cqe &cqe);
+  void on_send(socket_type fd, std::uint32_t sequence, const struct io_uring_cqe &cqe);
+
+  void provide_buffers();
+  void recycle(std::uint16_t id);
+  void resume_starved();
+
+  struct io_uring_sqe* next_sqe();
+  int submit();
+  std::uint32_t next_sequence();
+
+  static std::uint64_t to_user_data(std::uint8_t op, socket_type fd, std::uint32_t sequence);
+  static unsigned int to_poll_events(event_type interest);
+
+private:
+  int ring_fd_ = -1;
+
+  void *sq_ring_ = nullptr;
+  std::size_t sq_ring_size_ = 0;
+  void *cq_ring_ = nullptr;
+  std::size_t cq_ring_size_ = 0;
+  struct io_uring_sqe *sqes_ = nullptr;
+  std::size_t sqes_size_ = 0;
+
+  unsigned *sq_head_ = nullptr;
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_mask_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned sq_entries_ = 0;
+  unsigned to_submit_ = 0;
+
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned *cq_mask_ = nullptr;
+  struct io_uring_cqe *cqes_ = nullptr;
+
+  bool ext_arg_ = false;
+  bool completes_io_ = false;
+  bool multishot_receive_ = true;
+
+  // ring of buffers provided to the kernel
+  void *buffer_ring_ = nullptr;
+  std::size_t buffer_ring_size_ = 0;
+  char *buffers_ = nullptr;
+  std::uint16_t buffer_tail_ = 0;
+  std::vector<socket_type> starved_;
+
+  std::unordered_map<std::uint64_t, std::unique_ptr<send_request>> sends_;
+
+  std::vector<fd_entry> entries_;
+  std::vector<socket_type> fired_;
+  std::vector<socket_type> ready_;
+  std::uint32_t next_sequence_ = 0;
+  std::size_t size_ = 0;
+  bool waiting_ = false;
+  bool woken_ = false;
+
+  mutable std::mutex mutex_;
+};
+
+/// @endcond
+
+}
+
+#endif
+
+#endif //MATADOR_IO_URING_DEMULTIPLEXER_HPP
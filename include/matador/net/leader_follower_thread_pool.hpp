@@ -60,6 +60,14 @@ public:
    */
   void promote_new_leader();
 
+  /**
+   * Binds all threads of the pool to the given
+   * cpu when the pool is started.
+   *
+   * @param cpu Number of the cpu
+   */
+  void cpu_affinity(std::size_t cpu);
+
   /**
    * Returns number of threads.
    *
@@ -67,6 +75,14 @@ public:
    */
   std::size_t size() const;
 
+  /**
+   * Returns the number of threads
+   * started with the pool.
+   *
+   * @return Number of configured threads.
+   */
+  std::size_t num_threads() const;
+
   /**
    * Shuts the thread pool down.
    */
@@ -125,6 +141,8 @@ private:
   matador::logger log_;
 
   std::atomic_size_t follower_{};
+
+  int cpu_ = -1;
 };
 
 }
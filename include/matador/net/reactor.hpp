@@ -3,13 +3,19 @@
 
 #include "matador/net/export.hpp"
 #include "matador/net/event_type.hpp"
+#include "matador/net/demultiplexer.hpp"
 #include "matador/net/select_fdsets.hpp"
 #include "matador/net/socket_interrupter.hpp"
+#include "matador/net/timer_wheel.hpp"
 #include "matador/net/leader_follower_thread_pool.hpp"
 
 #include "matador/logger/logger.hpp"
 
+#include <chrono>
 #include <list>
+#include <deque>
+#include <vector>
+#include <unordered_map>
 #include <memory>
 #include <atomic>
 #include <mutex>
@@ -44,16 +50,54 @@ class handler;
  * to a remote service.
  *
  * It's also possible to handle timeouts on a regularly base.
+ *
+ * The io events are demultiplexed either with select
+ * (available on all platforms) or with epoll (linux). The
+ * backend is chosen on construction. With epoll the interest
+ * of each handler is kept registered within the kernel and
+ * only the ready file descriptors are returned on each
+ * wakeup.
  */
 class OOS_NET_API reactor {
 public:
   using handler_ptr = std::shared_ptr<handler>; /**< Shortcut for shared pointer to handler */
 
   /**
-   * Default constructor
+   * Default constructor. Creates a reactor
+   * using the best demultiplexer available on
+   * the current platform.
    */
   reactor();
 
+  /**
+   * Creates a reactor using the given demultiplexer
+   * type. If the type isn't available on the current
+   * platform select is used.
+   *
+   * @param type Type of the demultiplexer
+   */
+  explicit reactor(demultiplexer_type type);
+
+  /**
+   * Creates a reactor using the given demultiplexer
+   * type and the given number of threads dispatching
+   * the events.
+   *
+   * @param type Type of the demultiplexer
+   * @param num_threads Number of dispatching threads
+   */
+  reactor(demultiplexer_type type, std::size_t num_threads);
+
+  /**
+   * Creates a reactor using the given demultiplexer
+   * and the given number of threads dispatching
+   * the events.
+   *
+   * @param demultiplexer Demultiplexer to use
+   * @param num_threads Number of dispatching threads
+   */
+  reactor(std::unique_ptr<demultiplexer> demultiplexer, std::size_t num_threads);
+
   ~reactor();
   /**
    * Registers a new handler with the reactor for
@@ -81,12 +125,34 @@ public:
    * If the interval is zero the timer is only
    * schedules once.
    *
+   * The handler has one timer of this kind; scheduling
+   * it again replaces the previous one. Its state is
+   * available via handler::next_timeout() and
+   * handler::interval().
+   *
    * @param h Handler to schedule.
    * @param offset Offset for first schedule in seconds.
    * @param interval Interval of the schedule.
    */
   void schedule_timer(const std::shared_ptr<handler>& h, time_t offset, time_t interval);
 
+  /**
+   * Schedules an additional timer for the given
+   * handler with millisecond resolution. A handler
+   * may have any number of these timers. On expiration
+   * handler::on_timer() is called with the returned id.
+   * If the interval is zero the timer expires once.
+   *
+   * Scheduling and cancelling is done in constant time.
+   *
+   * @param h Handler to schedule.
+   * @param offset Offset of the first expiration.
+   * @param interval Interval of the following expirations.
+   * @return The id of the scheduled timer
+   */
+  timer_id schedule_timer(const std::shared_ptr<handler>& h, std::chrono::milliseconds offset,
+                          std::chrono::milliseconds interval = std::chrono::milliseconds::zero());
+
   /**
    * Cancels all timer for a given handler.
    *
@@ -94,6 +160,16 @@ public:
    */
   void cancel_timer(const std::shared_ptr<handler>& h);
 
+  /**
+   * Cancels the timer with the given id of the
+   * given handler.
+   *
+   * @param h Handler owning the timer
+   * @param id Id of the timer to cancel
+   * @return True if the timer was scheduled
+   */
+  bool cancel_timer(const std::shared_ptr<handler>& h, timer_id id);
+
   /**
    * Starts the dispatching process of the
    * reactor. The call to this method only
@@ -121,6 +197,75 @@ public:
    */
   bool is_running() const;
 
+  /**
+   * Returns the type of the demultiplexer
+   * used by the reactor.
+   *
+   * @return The type of the demultiplexer
+   */
+  demultiplexer_type backend() const;
+
+  /**
+   * Returns true if the demultiplexer completes
+   * the io of the handlers' sockets. Handlers
+   * then read, write, accept and close through
+   * the reactor.
+   *
+   * @return True if the demultiplexer completes io
+   */
+  bool completes_io() const;
+
+  /**
+   * Returns the number of threads
+   * dispatching the events.
+   *
+   * @return Number of dispatching threads
+   */
+  std::size_t num_threads() const;
+
+  /**
+   * Binds all dispatching threads to the given
+   * cpu. Must be called before the reactor runs.
+   *
+   * @param cpu Number of the cpu
+   */
+  void cpu_affinity(std::size_t cpu);
+
+  /**
+   * Enables or disables batch dispatching. If enabled
+   * (default) all handlers reported ready by one call to the
+   * demultiplexer are queued. The following leader threads
+   * take the next handler from this queue without
+   * demultiplexing again. If disabled only one ready
+   * handler is dispatched per call to the demultiplexer.
+   *
+   * @param enable True enables batch dispatching
+   */
+  void batch_dispatch(bool enable);
+
+  /**
+   * Returns true if batch dispatching is enabled.
+   *
+   * @return True if batch dispatching is enabled
+   */
+  bool batch_dispatch() const;
+
+  /**
+   * Returns the number of calls to the
+   * demultiplexer waiting for io events.
+   *
+   * @return Number of demultiplexer calls
+   */
+  std::size_t num_waits() const;
+
+  /**
+   * Returns the number of dispatched
+   * handler events.
+   *
+   * @return Number of dispatched events
+   */
+  std::size_t num_dispatched() const;
+
   /**
    * Returns the current internal fd sets for
    * reading, writing and exceptions.
@@ -156,6 +301,24 @@ public:
    */
   void deactivate_handler(const handler_ptr &h, event_type ev);
 
+  /**
+   * Notifies the reactor that the read or write
+   * readiness of the given handler has changed.
+   * The interest registered within the demultiplexer
+   * is updated accordingly.
+   *
+   * @param h Handler which readiness has changed
+   */
+  void update_handler(const handler_ptr &h);
+
+  /// @cond MATADOR_DEV
+  void complete_io(socket_type fd, io_operation op);
+  long receive(socket_type fd, char *buf, std::size_t len);
+  long send(socket_type fd, std::list<buffer_view> &buffers, const std::shared_ptr<void> &owner);
+  socket_type accept(socket_type fd);
+  void close_socket(socket_type fd);
+  /// @endcond
+
   /**
    * Shortcut for handler event type pair
    */
@@ -179,33 +342,68 @@ public:
   void interrupt();
 
 private:
+  struct ready_handler
+  {
+    handler_ptr handler;
+    event_type type;
+    timer_id timer;
+  };
+
 //  void process_handler(int num);
 
-  t_handler_type resolve_next_handler(time_t now, select_fdsets& fd_sets);
+  void resolve_ready_handlers(timer_wheel::clock::time_point now, const demultiplexer::t_ready_events &events);
+  ready_handler next_ready_handler();
+  void finish_dispatch(const ready_handler &rh);
 
   void on_read_mask(const handler_ptr& h);
   void on_write_mask(const handler_ptr& h);
   void on_except_mask(const handler_ptr& h);
-  void on_timeout(const handler_ptr &h, time_t i);
+  void on_timeout(const handler_ptr &h, timer_id id);
 
   void prepare_select_bits(time_t& timeout, select_fdsets& fd_sets) const;
 
+  long next_timeout();
+
+  t_handler_list::iterator add_handler_type(const handler_ptr &h, event_type et);
+  void remove_handler_type(t_handler_list::iterator it);
+
+  void update_interest(t_handler_type &ht);
+  void release_handle(const handler_ptr &h);
+  t_handler_type* registered_handler_type(socket_type fd) const;
+
   void remove_deleted();
 
   void cleanup();
 
-  int select(struct timeval* timeout, select_fdsets& fd_sets);
+  int wait(long timeout, demultiplexer::t_ready_events &events);
 
-  bool is_interrupted(select_fdsets& fd_sets);
+  bool is_interrupted(const demultiplexer::t_ready_events &events);
 
-  bool has_clients_to_handle(time_t timeout, select_fdsets& fd_sets) const;
+  bool has_clients_to_handle(long timeout) const;
 
   void interrupt_without_lock();
 
 private:
   handler_ptr sentinel_;
   t_handler_list handlers_;
+  // constant time lookups into the handler list; list
+  // iterators stay valid while other handlers change
+  std::unordered_map<const handler*, t_handler_list::iterator> handler_index_;
+  // slot per file descriptor registered within the demultiplexer
+  std::vector<t_handler_type*> fd_table_;
   std::list<handler_ptr> handlers_to_delete_;
+  std::deque<ready_handler> ready_handlers_;
+  // handlers currently dispatched; their timers
+  // expire after the dispatch has finished
+  std::unordered_map<const handler*, std::size_t> dispatching_;
+
+  timer_wheel timers_;
+  // point in time the leader wakes up at the latest
+  timer_wheel::clock::time_point next_wakeup_ = timer_wheel::clock::time_point::min();
+
+  std::atomic_bool batch_dispatch_ {true};
+  std::atomic_size_t num_waits_ {0};
+  std::atomic_size_t num_dispatched_ {0};
 
   std::atomic_bool running_ {false};
   std::atomic_bool shutdown_requested_ {false};
@@ -214,6 +412,8 @@ private:
   std::condition_variable shutdown_;
   logger log_;
 
+  std::unique_ptr<demultiplexer> demultiplexer_;
+
   leader_follower_thread_pool thread_pool_;
 
   socket_interrupter interrupter_;
@@ -0,0 +1,48 @@
+#ifndef MATADOR_SELECT_DEMULTIPLEXER_HPP
+#define MATADOR_SELECT_DEMULTIPLEXER_HPP
+
+#include "matador/net/export.hpp"
+#include "matador/net/demultiplexer.hpp"
+#include "matador/net/select_fdsets.hpp"
+
+#include <mutex>
+
+namespace matador {
+
+/// @cond MATADOR_DEV
+
+/**
+ * Demultiplexer based on the select system
+ * call. It is available on all platforms but
+ * limited to FD_SETSIZE file descriptors.
+ */
+class OOS_NET_API select_demultiplexer : public demultiplexer
+{
+public:
+  void add(socket_type fd, event_type interest) override;
+  void modify(socket_type fd, event_type interest) override;
+  void remove(socket_type fd) override;
+
+  int wait(long timeout, t_ready_events &events) override;
+
+  bool requires_interrupt() const override;
+
+  std::size_t size() const override;
+
+  demultiplexer_type type() const override;
+
+private:
+  void prune_invalid();
+
+private:
+  select_fdsets fdsets_;
+  fdset registered_;
+
+  mutable std::mutex mutex_;
+};
+
+/// @endcond
+
+}
+
+#endif //MATADOR_SELECT_DEMULTIPLEXER_HPP
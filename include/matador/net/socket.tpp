@@ -68,7 +68,7 @@ template < class P >
 void socket_base<P>::non_blocking(bool nb)
 {
 #ifdef WIN32
-  unsigned long nonblock = nb ? 0 : 1;
+  unsigned long nonblock = nb ? 1 : 0;
   // fcntl doesn't do the right thing, but the similar ioctl does
   // warning: is that still true? and does it the right thing for
   // set blocking as well?
@@ -82,8 +82,8 @@ void socket_base<P>::non_blocking(bool nb)
     throw std::logic_error("fcntl: couldn't get flags");
   }
 
-  int flag = (nb ? O_NONBLOCK : 0);
-  if (fcntl(sock_, F_SETFL, val | flag) < 0) {
+  int flags = (nb ? val | O_NONBLOCK : val & ~O_NONBLOCK);
+  if (fcntl(sock_, F_SETFL, flags) < 0) {
     std::string err(strerror(errno));
     throw std::logic_error("fcntl: couldn't set flags (" + err + ")");
   }
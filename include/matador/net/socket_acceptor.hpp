@@ -75,10 +75,10 @@ public:
    * Returns zero (0) on success and -1 on error
    * with errno set
    *
-   * @param backlog Number of backlog
+   * @param backlog Maximum length of the queue of pending connections
    * @return Returns zero (0) on success.
    */
-  int listen(int backlog);
+  int listen(int backlog = SOMAXCONN);
 
   /**
    * Returns a pointer to the underlying
@@ -153,6 +153,35 @@ public:
    * @return True if flag is set
    */
   bool reuse_address() const;
+
+  /**
+   * Sets or clears the reuse port flag. With the
+   * flag set several sockets can be bound to the same
+   * address and the kernel distributes new connections
+   * among them. If the socket isn't open yet the flag
+   * is applied when the socket is bound.
+   *
+   * If the platform doesn't support the flag
+   * -1 is returned.
+   *
+   * @param reuse Indicates if the reuse port flag should be set
+   * @return 0 if setting was successful, -1 on error
+   */
+  int reuse_port(bool reuse);
+
+  /**
+   * Returns true if the reuse port flag
+   * is set otherwise false is returned.
+   *
+   * @return True if flag is set
+   */
+  bool reuse_port() const;
+
+private:
+  int apply_reuse_port(socket_type fd) const;
+
+private:
+  bool reuse_port_ = false;
 };
 
 /// @cond MATADOR_DEV
@@ -204,6 +233,10 @@ int socket_acceptor<P>::bind(const char* hostname, unsigned short port)
       throw std::logic_error(strerror(errno));
     }
 
+    if (apply_reuse_port(listenfd) == -1) {
+      throw std::logic_error(strerror(errno));
+    }
+
     ret = ::bind(listenfd, res->ai_addr, res->ai_addrlen);
     if (ret == 0) {
       // success
@@ -244,6 +277,10 @@ int socket_acceptor<P>::bind(peer_type &peer)
     detail::throw_logic_error_with_errno("setsockopt error: %s", errno);
   }
 
+  if (apply_reuse_port(listen_fd) == -1) {
+    detail::throw_logic_error_with_errno("setsockopt error: %s", errno);
+  }
+
   int ret = ::bind(listen_fd, peer.data(), static_cast<int>(peer.size()));
   if (ret == 0) {
     // success
@@ -303,12 +340,18 @@ int socket_acceptor<P>::accept(stream_type &stream)
   struct sockaddr_storage remote_addr = {};
 //    address_type remote_addr;
   socklen_t addrlen = sizeof(remote_addr);
+#ifdef __linux__
+  auto fd = ::accept4(this->id(), (struct sockaddr *)&remote_addr, &addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
   auto fd =  ::accept(this->id(), (struct sockaddr *)&remote_addr, &addrlen);
+#endif
 
   if (is_valid_socket(fd)) {
     stream.assign(fd);
+#ifndef __linux__
     stream.non_blocking(true);
     stream.cloexec(true);
+#endif
 //  } else {
 //    detail::throw_logic_error_with_errno("accept failed: %s", errno);
   }
@@ -320,12 +363,20 @@ template<class P>
 int socket_acceptor<P>::accept(stream_type &stream, peer_type &endpoint)
 {
   auto addr_len = static_cast<socklen_t>(endpoint.size());
+#ifdef __linux__
+  // the new socket is non blocking and closed
+  // on exec without further calls to fcntl
+  auto fd = ::accept4(this->id(), endpoint.data(), &addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
   auto fd = ::accept(this->id(), endpoint.data(), &addr_len);
+#endif
 
   if (is_valid_socket(fd)) {
     stream.assign(fd);
+#ifndef __linux__
     stream.non_blocking(true);
     stream.cloexec(true);
+#endif
 //  } else {
 //    detail::throw_logic_error_with_errno("accept failed: %s", errno);
   }
@@ -350,6 +401,53 @@ bool socket_acceptor<P>::reuse_address() const
   return option > 0;
 }
 
+template < class P >
+int socket_acceptor<P>::reuse_port(bool reuse)
+{
+#ifdef SO_REUSEPORT
+  reuse_port_ = reuse;
+  if (!this->is_open()) {
+    return 0;
+  }
+  const int option(reuse ? 1 : 0);
+  return setsockopt(this->id(), SOL_SOCKET, SO_REUSEPORT, (char*)&option, sizeof(option));
+#else
+  return reuse ? -1 : 0;
+#endif
+}
+
+template < class P >
+bool socket_acceptor<P>::reuse_port() const
+{
+#ifdef SO_REUSEPORT
+  if (!this->is_open()) {
+    return reuse_port_;
+  }
+  int option {};
+  socklen_t i;
+  i = sizeof(option);
+  getsockopt(this->id(), SOL_SOCKET, SO_REUSEPORT, (char*)&option, &i);
+  return option > 0;
+#else
+  return false;
+#endif
+}
+
+template < class P >
+int socket_acceptor<P>::apply_reuse_port(socket_type fd) const
+{
+#ifdef SO_REUSEPORT
+  if (!reuse_port_) {
+    return 0;
+  }
+  const int option(1);
+  return setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (char*)&option, sizeof(option));
+#else
+  (void)fd;
+  return 0;
+#endif
+}
+
 /// @endcond
 
 }
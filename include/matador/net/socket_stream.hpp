@@ -9,6 +9,20 @@
 
 #include "matador/net/socket.hpp"
 
+#include <array>
+#include <cerrno>
+#include <list>
+
+#ifndef _WIN32
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
 namespace matador {
 
 /**
@@ -68,6 +82,58 @@ public:
    */
   template < class Buffer >
   ssize_t send(const Buffer &buffer);
+
+  /**
+   * Sends the data of all given buffers with one
+   * gather write (sendmsg) per IOV_MAX buffers.
+   *
+   * The sent bytes are consumed from the buffers.
+   * Completely sent buffers are removed from the
+   * list, a partially sent buffer is bumped by the
+   * sent size and stays in front of the list. The
+   * method stops as soon as the socket doesn't take
+   * any more data (i.e. it would block).
+   *
+   * If data was sent before an error occurred the number
+   * of sent bytes is returned; the error is reported by
+   * the next call.
+   *
+   * @tparam Buffer type of the buffer objects.
+   * @param buffers List of buffers to send.
+   * @return The number of bytes sent or -1 on error
+   */
+  template < class Buffer >
+  ssize_t send(std::list<Buffer> &buffers);
+
+  /**
+   * Sends the remaining part of the given file. On linux
+   * the data is sent with sendfile(2) without copying it
+   * to user space. Otherwise or if sendfile isn't
+   * supported for the file the data is read with pread
+   * in chunks and sent from a stack buffer.
+   *
+   * The sent bytes are consumed from the file. The
+   * method stops as soon as the socket doesn't take
+   * any more data (i.e. it would block).
+   *
+   * @tparam File type of the file object (i.e. file_body)
+   * @param file File to send
+   * @return The number of bytes sent or -1 on error
+   */
+  template < class File >
+  ssize_t send_file(File &file);
+
+private:
+  template < class File >
+  ssize_t send_file_chunked(File &file);
+
+private:
+#ifdef IOV_MAX
+  static const std::size_t max_iov = IOV_MAX;
+#else
+  static const std::size_t max_iov = 16;
+#endif
+  static const std::size_t file_chunk_size = 16384;
 };
 
 /// @cond MATADOR_DEV
@@ -89,6 +155,145 @@ ssize_t socket_stream<P>::send(const Buffer &buffer)
 {
   return ::send(this->id(), buffer.data(), static_cast<int>(buffer.size()), 0);
 }
+
+template < class P >
+template < class Buffer >
+ssize_t socket_stream<P>::send(std::list<Buffer> &buffers)
+{
+  ssize_t bytes_total = 0;
+#ifdef _WIN32
+  // no gather write; send one buffer after the other
+  while (!buffers.empty()) {
+    Buffer &buffer = buffers.front();
+    if (buffer.capacity() == 0) {
+      buffers.pop_front();
+      continue;
+    }
+    const auto requested = buffer.capacity();
+    auto len = ::send(this->id(), buffer.data(), static_cast<int>(requested), 0);
+    if (len < 0) {
+      return bytes_total > 0 ? bytes_total : len;
+    }
+    bytes_total += len;
+    buffer.bump(static_cast<std::size_t>(len));
+    if (buffer.full()) {
+      buffers.pop_front();
+    }
+    if (static_cast<std::size_t>(len) < requested) {
+      break;
+    }
+  }
+#else
+  std::array<struct iovec, max_iov> iov;
+  while (!buffers.empty()) {
+    std::size_t count = 0;
+    std::size_t requested = 0;
+    for (auto it = buffers.begin(); it != buffers.end() && count < max_iov; ++it) {
+      if (it->capacity() == 0) {
+        continue;
+      }
+      iov[count].iov_base = it->data();
+      iov[count].iov_len = it->capacity();
+      requested += it->capacity();
+      ++count;
+    }
+    if (count == 0) {
+      buffers.clear();
+      break;
+    }
+
+    struct msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = count;
+#ifdef MSG_NOSIGNAL
+    auto len = ::sendmsg(this->id(), &msg, MSG_NOSIGNAL);
+#else
+    auto len = ::sendmsg(this->id(), &msg, 0);
+#endif
+    if (len < 0) {
+      return bytes_total > 0 ? bytes_total : len;
+    }
+    bytes_total += len;
+
+    // consume the sent bytes
+    auto left = static_cast<std::size_t>(len);
+    while (!buffers.empty()) {
+      Buffer &buffer = buffers.front();
+      const auto capacity = buffer.capacity();
+      if (capacity > left) {
+        buffer.bump(left);
+        break;
+      }
+      left -= capacity;
+      buffers.pop_front();
+    }
+    if (static_cast<std::size_t>(len) < requested) {
+      // socket buffer is full
+      break;
+    }
+  }
+#endif
+  return bytes_total;
+}
+
+template < class P >
+template < class File >
+ssize_t socket_stream<P>::send_file(File &file)
+{
+#ifdef __linux__
+  ssize_t bytes_total = 0;
+  while (!file.full()) {
+    auto offset = static_cast<off_t>(file.offset());
+    auto len = ::sendfile(this->id(), file.fd(), &offset, file.capacity());
+    if (len < 0) {
+      if ((errno == EINVAL || errno == ENOSYS) && bytes_total == 0) {
+        // file type isn't supported by sendfile
+        return send_file_chunked(file);
+      }
+      return bytes_total > 0 ? bytes_total : len;
+    }
+    if (len == 0) {
+      // file was truncated
+      errno = EIO;
+      return bytes_total > 0 ? bytes_total : -1;
+    }
+    bytes_total += len;
+    file.bump(static_cast<std::size_t>(len));
+  }
+  return bytes_total;
+#else
+  return send_file_chunked(file);
+#endif
+}
+
+template < class P >
+template < class File >
+ssize_t socket_stream<P>::send_file_chunked(File &file)
+{
+  ssize_t bytes_total = 0;
+  std::array<char, file_chunk_size> chunk;
+  while (!file.full()) {
+    auto nread = file.read(chunk.data(), chunk.size());
+    if (nread <= 0) {
+      if (nread == 0) {
+        // file was truncated
+        errno = EIO;
+      }
+      return bytes_total > 0 ? bytes_total : -1;
+    }
+    auto len = ::send(this->id(), chunk.data(), static_cast<int>(nread), 0);
+    if (len < 0) {
+      return bytes_total > 0 ? bytes_total : len;
+    }
+    bytes_total += len;
+    file.bump(static_cast<std::size_t>(len));
+    if (len < nread) {
+      // socket buffer is full
+      break;
+    }
+  }
+  return bytes_total;
+}
 /// @endcond
 }
 
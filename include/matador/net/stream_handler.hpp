@@ -2,6 +2,7 @@
 #define MATADOR_STREAM_HANDLER_HPP
 
 #include "matador/utils/buffer_view.hpp"
+#include "matador/utils/buffer_chain.hpp"
 
 #include "matador/logger/logger.hpp"
 
@@ -9,6 +10,7 @@
 #include "matador/net/handler.hpp"
 #include "matador/net/ip.hpp"
 #include "matador/net/io_stream.hpp"
+#include "matador/net/file_body.hpp"
 
 #include <atomic>
 #include <mutex>
@@ -29,6 +31,10 @@ class handler_creator;
  * wiring. The user just use the interface
  * provided by the io_service to setup
  * a server.
+ *
+ * If the demultiplexer of the reactor completes
+ * io, the socket is read, written and closed
+ * through the reactor.
  */
 class OOS_NET_API stream_handler : public handler, public io_stream
 {
@@ -55,13 +61,18 @@ public:
   void on_output() override;
   void on_except() override {}
   void on_timeout() override {}
+  void on_timer(timer_id id) override;
   void on_close() override;
   void close() override;
   bool is_ready_write() const override;
   bool is_ready_read() const override;
 
   void read(buffer_view buf, t_read_handler read_handler) override;
+  void read(buffer_chain &chain, t_read_handler read_handler) override;
   void write(std::list<buffer_view> buffers, t_write_handler write_handler) override;
+  void write(std::list<buffer_view> buffers, std::shared_ptr<file_body> file, t_write_handler write_handler) override;
+
+  void read_timeout(std::chrono::milliseconds timeout) override;
 
   void close_stream() override;
 
@@ -69,6 +80,14 @@ public:
 
   std::string name() const override;
 
+private:
+  ssize_t receive(buffer_view &buf);
+  ssize_t send(std::list<buffer_view> &buffers);
+  void close_socket();
+
+  void schedule_read_timer();
+  void cancel_read_timer();
+
 private:
   logger log_;
   tcp::socket stream_;
@@ -77,8 +96,13 @@ private:
   std::string name_;
 
   buffer_view read_buffer_;
+  buffer_chain *read_chain_ = nullptr;
+  std::chrono::milliseconds read_timeout_ { 0 };
+  timer_id read_timer_ = 0;
 
   std::list<buffer_view> write_buffers_;
+  std::shared_ptr<file_body> write_file_;
+  long bytes_written_ = 0;
 
   handler_creator *creator_ = nullptr;
 
@@ -86,6 +110,8 @@ private:
   t_read_handler on_read_;
   t_write_handler on_write_;
 
+  bool completes_io_ = false;
+
   std::atomic_bool is_ready_to_read_ { false };
   std::atomic_bool is_ready_to_write_ { false };
 
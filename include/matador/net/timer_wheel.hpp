@@ -0,0 +1,202 @@
+#ifndef MATADOR_TIMER_WHEEL_HPP
+#define MATADOR_TIMER_WHEEL_HPP
+
+#include "matador/net/export.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace matador {
+
+class handler;
+
+using timer_id = std::uint64_t; /**< Shortcut to the id of a scheduled timer */
+
+/// @cond MATADOR_DEV
+
+/**
+ * Hierarchical timer wheel with a resolution of
+ * one millisecond. It consists of four levels with
+ * 256 slots each. A timer is placed in the slot of
+ * the level matching its distance to the current
+ * tick and moved down one level each time the lower
+ * level wraps around.
+ *
+ * Scheduling and cancelling a timer is done in
+ * constant time. Expired timers are collected in
+ * one pass when the wheel advances.
+ *
+ * The wheel isn't thread safe; the reactor
+ * guards it with its own mutex.
+ */
+class OOS_NET_API timer_wheel
+{
+public:
+  typedef std::chrono::steady_clock clock;    /**< Shortcut to the clock used by the wheel */
+  typedef std::chrono::milliseconds duration; /**< Shortcut to the resolution of the wheel */
+
+  /**
+   * An expired timer
+   */
+  struct expired_timer
+  {
+    timer_id id;                    /**< Id of the expired timer */
+    std::shared_ptr<handler> owner; /**< Handler owning the timer */
+  };
+
+  typedef std::vector<expired_timer> t_expired_timers; /**< Shortcut to a list of expired timers */
+  typedef std::function<bool(const expired_timer&)> t_accept_func; /**< Shortcut to the expired timer accept function */
+
+  /**
+   * Creates an empty timer wheel starting
+   * at the current time.
+   */
+  timer_wheel();
+
+  timer_wheel(const timer_wheel&) = delete;
+  timer_wheel& operator=(const timer_wheel&) = delete;
+
+  ~timer_wheel();
+
+  /**
+   * Schedules a timer for the given handler. The timer
+   * expires after the given offset and afterwards every
+   * interval. An interval of zero schedules the timer once.
+   *
+   * @param owner Handler owning the timer
+   * @param offset Offset of the first expiration
+   * @param interval Interval of the following expirations
+   * @param now Current time
+   * @return The id of the new timer
+   */
+  timer_id schedule(const std::shared_ptr<handler> &owner, duration offset, duration interval, clock::time_point now);
+
+  /**
+   * Cancels the timer with the given id.
+   *
+   * @param id Id of the timer to cancel
+   * @return True if the timer was scheduled
+   */
+  bool cancel(timer_id id);
+
+  /**
+   * Cancels all timers of the given handler.
+   *
+   * @param owner Handler which timers are cancelled
+   * @return Number of cancelled timers
+   */
+  std::size_t cancel(const handler *owner);
+
+  /**
+   * Advances the wheel up to the given time and
+   * appends all expired timers accepted by the given
+   * function to the given list. Interval timers are
+   * rescheduled, one shot timers are removed.
+   *
+   * A timer rejected by the accept function stays
+   * untouched and expires again with the next tick,
+   * i.e. when its handler is busy.
+   *
+   * @param now Current time
+   * @param accept Function deciding if an expired timer is taken
+   * @param expired List receiving the expired timers
+   * @return Number of expired timers
+   */
+  std::size_t expire(clock::time_point now, const t_accept_func &accept, t_expired_timers &expired);
+
+  /**
+   * Returns the number of milliseconds until the wheel
+   * must advance again. This is the time to the next
+   * expiration or to the next move of timers between
+   * two levels. If there is no timer -1 is returned.
+   *
+   * @param now Current time
+   * @return Milliseconds to wait or -1
+   */
+  long next_expiry(clock::time_point now) const;
+
+  /**
+   * Returns true if the given timer is scheduled.
+   *
+   * @param id Id of the timer
+   * @return True if timer is scheduled
+   */
+  bool is_scheduled(timer_id id) const;
+
+  /**
+   * Returns the number of timers of the given handler.
+   *
+   * @param owner Handler of the timers
+   * @return Number of timers of the handler
+   */
+  std::size_t count(const handler *owner) const;
+
+  /**
+   * Returns the number of scheduled timers.
+   *
+   * @return Number of scheduled timers
+   */
+  std::size_t size() const;
+
+  /**
+   * Returns true if no timer is scheduled.
+   *
+   * @return True if no timer is scheduled
+   */
+  bool empty() const;
+
+  /**
+   * Cancels all timers.
+   */
+  void clear();
+
+private:
+  struct timer
+  {
+    timer_id id = 0;
+    std::shared_ptr<handler> owner;
+    std::uint64_t expires = 0;
+    std::uint64_t interval = 0;
+    timer *prev = nullptr;
+    timer *next = nullptr;
+    timer **slot = nullptr;
+    std::size_t level = 0;
+  };
+
+  static const unsigned slot_bits = 8;
+  static const std::size_t slot_count = 1U << slot_bits;
+  static const std::uint64_t slot_mask = slot_count - 1;
+  static const std::size_t level_count = 4;
+
+  typedef std::array<timer*, slot_count> t_level;
+
+  std::uint64_t to_tick(clock::time_point tp) const;
+
+  void insert(timer *t);
+  void unlink(timer *t);
+  timer* detach(std::size_t level, std::size_t index);
+  void cascade(std::size_t level, std::size_t index);
+  void remove(timer *t);
+
+private:
+  clock::time_point start_;
+  std::uint64_t current_ = 0;
+  timer_id next_id_ = 0;
+
+  std::array<t_level, level_count> levels_ {};
+  std::array<std::size_t, level_count> level_sizes_ {};
+
+  std::unordered_map<timer_id, std::unique_ptr<timer>> timers_;
+  std::unordered_map<const handler*, std::vector<timer_id>> owner_timers_;
+};
+
+/// @endcond
+
+}
+
+#endif //MATADOR_TIMER_WHEEL_HPP
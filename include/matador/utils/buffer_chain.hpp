@@ -0,0 +1,193 @@
+#ifndef MATADOR_BUFFER_CHAIN_HPP
+#define MATADOR_BUFFER_CHAIN_HPP
+
+#include "matador/utils/export.hpp"
+#include "matador/utils/buffer_pool.hpp"
+#include "matador/utils/buffer_view.hpp"
+
+#include <deque>
+#include <list>
+#include <string>
+
+namespace matador {
+
+/**
+ * @brief Chain of pooled buffer segments
+ *
+ * The buffer chain holds a sequence of bytes in
+ * segments taken from a buffer_pool. Data which
+ * doesn't fit into the last segment is continued
+ * in a new segment; the chain never copies or moves
+ * bytes once they are written.
+ *
+ * A chain only holds segments while it contains
+ * data. Consumed segments go back to the pool
+ * immediately.
+ *
+ * Copying a chain or taking a part of it with share()
+ * doesn't copy any data. The copy references the
+ * same segments, which are kept alive as long as
+ * any chain refers to them.
+ *
+ * Data is written with prepare() and commit():
+ *
+ * @code
+ * buffer_chain chain;
+ * auto view = chain.prepare();
+ * auto len = socket.receive(view);
+ * chain.commit(len > 0 ? len : 0);
+ * @endcode
+ */
+class OOS_UTILS_API buffer_chain
+{
+public:
+  /**
+   * A contiguous part of the chain
+   * within one segment.
+   */
+  struct slice
+  {
+    segment_ref segment;    /**< Segment holding the data */
+    std::size_t offset = 0; /**< Offset of the data within the segment */
+    std::size_t length = 0; /**< Length of the data */
+
+    /**
+     * Returns a pointer to the first byte of the slice
+     *
+     * @return Pointer to the data of the slice
+     */
+    const char* data() const { return segment.data() + offset; }
+
+    /**
+     * Returns the size of the slice
+     *
+     * @return Size of the slice
+     */
+    std::size_t size() const { return length; }
+  };
+
+  typedef std::deque<slice> t_slice_deque; /**< Shortcut to the sequence of slices */
+
+  /**
+   * Creates an empty chain taking its
+   * segments from the default buffer pool.
+   */
+  buffer_chain();
+
+  /**
+   * Creates an empty chain taking its
+   * segments from the given buffer pool.
+   *
+   * @param pool Pool to take the segments from
+   */
+  explicit buffer_chain(buffer_pool &pool);
+
+  /**
+   * Returns a writable view to the free space at
+   * the end of the chain. If the last segment is
+   * full or shared with another chain a new segment
+   * is taken from the pool.
+   *
+   * The written bytes must be committed with
+   * commit() before the chain is modified again.
+   *
+   * @return View to the free space of the chain
+   */
+  buffer_view prepare();
+
+  /**
+   * Appends the given number of bytes written
+   * into the view returned by prepare() to the
+   * data of the chain. A commit of zero bytes
+   * releases a segment taken by prepare().
+   *
+   * @param size Number of written bytes
+   */
+  void commit(std::size_t size);
+
+  /**
+   * Appends a copy of the given data to the chain
+   *
+   * @param data Data to append
+   * @param size Size of the data
+   */
+  void append(const char *data, std::size_t size);
+
+  /**
+   * Appends a copy of the given string to the chain
+   *
+   * @param str String to append
+   */
+  void append(const std::string &str);
+
+  /**
+   * Removes the given number of bytes from the
+   * beginning of the chain. Segments without data
+   * are released.
+   *
+   * @param size Number of bytes to remove
+   */
+  void consume(std::size_t size);
+
+  /**
+   * Returns a chain referencing the given part
+   * of this chain without copying the data.
+   *
+   * @param offset Offset of the part
+   * @param length Length of the part
+   * @return The chain referencing the part
+   */
+  buffer_chain share(std::size_t offset, std::size_t length) const;
+
+  /**
+   * Returns the slices of the chain
+   *
+   * @return The slices of the chain
+   */
+  const t_slice_deque& slices() const;
+
+  /**
+   * Returns a list of views to the data of
+   * the chain, i.e. to write it to a stream.
+   * The chain must outlive the views.
+   *
+   * @return List of views to the data
+   */
+  std::list<buffer_view> to_buffers() const;
+
+  /**
+   * Returns a copy of the data as string
+   *
+   * @return Data of the chain as string
+   */
+  std::string to_string() const;
+
+  /**
+   * Returns the number of bytes in the chain
+   *
+   * @return Number of bytes in the chain
+   */
+  std::size_t size() const;
+
+  /**
+   * Returns true if the chain doesn't contain data
+   *
+   * @return True if the chain is empty
+   */
+  bool empty() const;
+
+  /**
+   * Removes all data and releases all segments
+   */
+  void clear();
+
+private:
+  buffer_pool *pool_ = nullptr;
+  t_slice_deque slices_;
+  std::size_t size_ = 0;
+  bool prepared_ = false;
+};
+
+}
+
+#endif //MATADOR_BUFFER_CHAIN_HPP
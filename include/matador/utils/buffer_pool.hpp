@@ -0,0 +1,232 @@
+#ifndef MATADOR_BUFFER_POOL_HPP
+#define MATADOR_BUFFER_POOL_HPP
+
+#include "matador/utils/export.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace matador {
+
+class buffer_pool;
+
+/// @cond MATADOR_DEV
+
+/**
+ * A segment of memory taken from a buffer pool.
+ * The segment is reference counted and goes back
+ * to its pool when the last reference is gone.
+ */
+class OOS_UTILS_API buffer_segment
+{
+public:
+  buffer_segment() = default;
+  buffer_segment(const buffer_segment&) = delete;
+  buffer_segment& operator=(const buffer_segment&) = delete;
+
+private:
+  friend class buffer_pool;
+  friend class segment_ref;
+
+  buffer_pool *pool_ = nullptr;
+  char *data_ = nullptr;
+  std::atomic_size_t references_ { 0 };
+  buffer_segment *next_free_ = nullptr;
+};
+
+/// @endcond
+
+/**
+ * Shared reference to a segment of a buffer pool.
+ * Copying the reference increases the reference
+ * count of the segment. Once the last reference
+ * is released the segment goes back to the pool.
+ */
+class OOS_UTILS_API segment_ref
+{
+public:
+  /**
+   * Creates an empty segment reference
+   */
+  segment_ref() = default;
+
+  /**
+   * Copies the reference and increases the
+   * reference count of the segment.
+   *
+   * @param x Reference to copy
+   */
+  segment_ref(const segment_ref &x);
+
+  /**
+   * Moves the reference from x
+   *
+   * @param x Reference to move
+   */
+  segment_ref(segment_ref &&x) noexcept;
+
+  /**
+   * Copy assigns the reference
+   *
+   * @param x Reference to assign
+   * @return The assigned reference
+   */
+  segment_ref& operator=(const segment_ref &x);
+
+  /**
+   * Move assigns the reference
+   *
+   * @param x Reference to assign
+   * @return The assigned reference
+   */
+  segment_ref& operator=(segment_ref &&x) noexcept;
+
+  /**
+   * Releases the reference
+   */
+  ~segment_ref();
+
+  /**
+   * Returns a pointer to the memory of the segment
+   *
+   * @return Pointer to the memory of the segment
+   */
+  char* data() const;
+
+  /**
+   * Returns the size of the segment memory
+   *
+   * @return Size of the segment
+   */
+  std::size_t capacity() const;
+
+  /**
+   * Returns the number of references
+   * to the segment.
+   *
+   * @return Number of references
+   */
+  std::size_t use_count() const;
+
+  /**
+   * Releases the reference. The reference
+   * is empty afterwards.
+   */
+  void reset();
+
+  /**
+   * Returns true if the reference
+   * points to a segment.
+   *
+   * @return True if the reference isn't empty
+   */
+  explicit operator bool() const;
+
+private:
+  friend class buffer_pool;
+
+  explicit segment_ref(buffer_segment *segment);
+
+  void release();
+
+private:
+  buffer_segment *segment_ = nullptr;
+};
+
+/**
+ * @brief Pool of equally sized memory segments
+ *
+ * The pool allocates its segments in slabs of
+ * several segments at once and hands them out
+ * as reference counted segment_ref objects.
+ * Released segments are kept in a free list and
+ * reused with the next acquire.
+ *
+ * The pool is thread safe and must outlive
+ * all segments taken from it.
+ */
+class OOS_UTILS_API buffer_pool
+{
+public:
+  /**
+   * Creates a buffer pool with the given segment
+   * size and number of segments allocated at once.
+   *
+   * @param segment_size Size of one segment
+   * @param segments_per_slab Number of segments allocated at once
+   */
+  explicit buffer_pool(std::size_t segment_size = 16384, std::size_t segments_per_slab = 32);
+
+  buffer_pool(const buffer_pool&) = delete;
+  buffer_pool& operator=(const buffer_pool&) = delete;
+
+  /**
+   * Takes a segment from the pool. If there
+   * is no free segment a new slab is allocated.
+   *
+   * @return Reference to the segment
+   */
+  segment_ref acquire();
+
+  /**
+   * Returns the size of one segment
+   *
+   * @return Size of one segment
+   */
+  std::size_t segment_size() const;
+
+  /**
+   * Returns the number of allocated segments
+   *
+   * @return Number of allocated segments
+   */
+  std::size_t allocated() const;
+
+  /**
+   * Returns the number of segments in use
+   *
+   * @return Number of segments in use
+   */
+  std::size_t in_use() const;
+
+  /**
+   * Returns the number of free segments
+   *
+   * @return Number of free segments
+   */
+  std::size_t available() const;
+
+  /**
+   * Returns the buffer pool shared by all
+   * connections of the process.
+   *
+   * @return The default buffer pool
+   */
+  static buffer_pool& default_pool();
+
+private:
+  friend class segment_ref;
+
+  void allocate_slab();
+  void release(buffer_segment *segment);
+
+private:
+  const std::size_t segment_size_;
+  const std::size_t segments_per_slab_;
+
+  std::vector<std::unique_ptr<char[]>> slabs_;
+  std::vector<std::unique_ptr<buffer_segment[]>> segments_;
+
+  buffer_segment *free_ = nullptr;
+  std::size_t allocated_ = 0;
+  std::size_t in_use_ = 0;
+
+  mutable std::mutex mutex_;
+};
+
+}
+
+#endif //MATADOR_BUFFER_POOL_HPP
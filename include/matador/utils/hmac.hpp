@@ -3,6 +3,8 @@
 
 #include "matador/utils/export.hpp"
 
+#include "matador/utils/sha256.hpp"
+
 #include <string>
 
 namespace matador {
@@ -29,6 +31,72 @@ OOS_UTILS_API std::string hmac(const std::string &key, const std::string &messag
  */
 OOS_UTILS_API std::string hmac(const char *key, size_t keylen, const char *message, size_t msglen);
 
+/**
+ * @brief HMAC-SHA256 key with precomputed key pads
+ *
+ * The inner and outer key pads are hashed once when
+ * the key is created, signing a message only hashes
+ * the message and the inner digest. The key should
+ * be created once and reused for all messages signed
+ * with the same secret. It may be used by more than
+ * one thread.
+ */
+class OOS_UTILS_API hmac_key
+{
+public:
+  static const unsigned int DIGEST_SIZE = ext::SHA256::DIGEST_SIZE;
+
+  /**
+   * Creates the hmac key for the given secret.
+   *
+   * @param key Secret to be used for encoding.
+   */
+  explicit hmac_key(const std::string &key);
+
+  /**
+   * Creates the hmac key for the given secret.
+   *
+   * @param key Secret to be used for encoding.
+   * @param keylen Length of the secret.
+   */
+  hmac_key(const char *key, size_t keylen);
+
+  /**
+   * Encodes the given message and returns the
+   * encoded message as hex string (the same as
+   * hmac() with the secret of this key).
+   *
+   * @param message Message to be encoded.
+   * @return The encoded message.
+   */
+  std::string sign(const std::string &message) const;
+
+  /**
+   * Encodes the given message and returns the
+   * encoded message as hex string.
+   *
+   * @param message Message to be encoded.
+   * @param msglen Length of the message.
+   * @return The encoded message.
+   */
+  std::string sign(const char *message, size_t msglen) const;
+
+  /**
+   * Encodes the given message and writes the
+   * DIGEST_SIZE bytes of the digest to the
+   * given array.
+   *
+   * @param message Message to be encoded.
+   * @param msglen Length of the message.
+   * @param digest Array to write the digest to.
+   */
+  void sign(const char *message, size_t msglen, unsigned char *digest) const;
+
+private:
+  ext::SHA256 inner_ {};
+  ext::SHA256 outer_ {};
+};
+
 }
 
 #endif //MATADOR_HMAC_HPP
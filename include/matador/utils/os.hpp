@@ -3,7 +3,9 @@
 
 #include "matador/utils/export.hpp"
 
+#include <cstdint>
 #include <cstdio>
+#include <ctime>
 #include <string>
 
 namespace matador {
@@ -64,6 +66,16 @@ OOS_UTILS_API bool exists(const char *path);
 
 OOS_UTILS_API size_t file_size(FILE *stream);
 
+struct file_stat
+{
+  std::time_t mtime = 0;
+  std::uint64_t inode = 0;
+  std::size_t size = 0;
+};
+
+OOS_UTILS_API bool stat_file(const std::string &path, file_stat &st);
+OOS_UTILS_API bool stat_file(const char *path, file_stat &st);
+
 OOS_UTILS_API std::string build_path(const std::string &a, const std::string &b);
 
 template <typename ...T>
@@ -38,6 +38,13 @@ public:
   static const unsigned int DIGEST_SIZE = (256 / 8);
   static const unsigned int RESULT_SIZE = 65;
 
+  /*
+   * Returns true if the blocks are processed with
+   * the SHA extensions of the cpu. It is checked
+   * once, otherwise the portable version is used.
+   */
+  static bool accelerated();
+
 protected:
   void transform(const unsigned char *message, unsigned int block_nb);
   unsigned int m_tot_len;
@@ -0,0 +1,200 @@
+#ifndef MATADOR_STRING_SPAN_HPP
+#define MATADOR_STRING_SPAN_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <ostream>
+
+namespace matador {
+
+/**
+ * @brief Non owning reference to a character sequence
+ *
+ * The string span references a sequence of characters
+ * owned by someone else, i.e. a receive buffer. It
+ * never copies or allocates, the referenced data must
+ * outlive the span.
+ *
+ * Use to_string() to get an owned copy of the data.
+ */
+class string_span
+{
+public:
+  /**
+   * Creates an empty span
+   */
+  string_span() = default;
+
+  /**
+   * Creates a span referencing the given
+   * data of the given size.
+   *
+   * @param data Start of the data
+   * @param size Size of the data
+   */
+  string_span(const char *data, std::size_t size)
+    : data_(data), size_(size)
+  {}
+
+  /**
+   * Creates a span referencing the
+   * given null terminated string.
+   *
+   * @param str Null terminated string
+   */
+  string_span(const char *str) // NOLINT(google-explicit-constructor)
+    : data_(str), size_(str != nullptr ? std::strlen(str) : 0)
+  {}
+
+  /**
+   * Creates a span referencing the
+   * data of the given string.
+   *
+   * @param str String to reference
+   */
+  string_span(const std::string &str) // NOLINT(google-explicit-constructor)
+    : data_(str.data()), size_(str.size())
+  {}
+
+  /**
+   * Returns the start of the referenced data
+   *
+   * @return Start of the data
+   */
+  const char* data() const { return data_; }
+
+  /**
+   * Returns the size of the referenced data
+   *
+   * @return Size of the data
+   */
+  std::size_t size() const { return size_; }
+
+  /**
+   * Returns true if the span is empty
+   *
+   * @return True if the span is empty
+   */
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * Returns the character at the given position.
+   * The position isn't checked.
+   *
+   * @param pos Position of the character
+   * @return The character at the given position
+   */
+  char operator[](std::size_t pos) const { return data_[pos]; }
+
+  const char* begin() const { return data_; } /**< Returns the start of the data */
+  const char* end() const { return data_ + size_; } /**< Returns the end of the data */
+
+  /**
+   * Returns the part of the span starting at pos
+   * with a length of at most len characters.
+   *
+   * @param pos Start of the part
+   * @param len Maximum length of the part
+   * @return The part of the span
+   */
+  string_span substr(std::size_t pos, std::size_t len = std::string::npos) const
+  {
+    if (pos > size_) {
+      pos = size_;
+    }
+    return { data_ + pos, len < size_ - pos ? len : size_ - pos };
+  }
+
+  /**
+   * Returns the position of the first occurrence
+   * of the given character or std::string::npos.
+   *
+   * @param c Character to find
+   * @param pos Position to start the search at
+   * @return Position of the character or npos
+   */
+  std::size_t find(char c, std::size_t pos = 0) const
+  {
+    if (pos >= size_) {
+      return std::string::npos;
+    }
+    auto p = static_cast<const char*>(std::memchr(data_ + pos, c, size_ - pos));
+    return p != nullptr ? static_cast<std::size_t>(p - data_) : std::string::npos;
+  }
+
+  /**
+   * Returns the part of the span without leading
+   * and trailing spaces and tabs.
+   *
+   * @return The trimmed span
+   */
+  string_span trim() const
+  {
+    std::size_t first = 0;
+    std::size_t last = size_;
+    while (first < last && (data_[first] == ' ' || data_[first] == '\t')) {
+      ++first;
+    }
+    while (last > first && (data_[last - 1] == ' ' || data_[last - 1] == '\t')) {
+      --last;
+    }
+    return { data_ + first, last - first };
+  }
+
+  /**
+   * Compares the span with the given span
+   * ignoring the case of ASCII characters.
+   *
+   * @param x Span to compare with
+   * @return True if both spans are equal
+   */
+  bool iequals(const string_span &x) const
+  {
+    if (size_ != x.size_) {
+      return false;
+    }
+    for (std::size_t i = 0; i < size_; ++i) {
+      if (to_lower(data_[i]) != to_lower(x.data_[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Returns an owned copy of the referenced data
+   *
+   * @return Copy of the data
+   */
+  std::string to_string() const { return { data_, size_ }; }
+
+  friend bool operator==(const string_span &a, const string_span &b)
+  {
+    return a.size_ == b.size_ && (a.size_ == 0 || std::memcmp(a.data_, b.data_, a.size_) == 0);
+  }
+
+  friend bool operator!=(const string_span &a, const string_span &b)
+  {
+    return !(a == b);
+  }
+
+  friend std::ostream& operator<<(std::ostream &out, const string_span &x)
+  {
+    return out.write(x.data_, static_cast<std::streamsize>(x.size_));
+  }
+
+private:
+  static char to_lower(char c)
+  {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+  }
+
+private:
+  const char *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}
+
+#endif //MATADOR_STRING_SPAN_HPP
@@ -16,6 +16,17 @@ namespace matador {
  */
 OOS_UTILS_API std::size_t acquire_thread_index(std::thread::id id);
 
+/**
+ * Binds the given thread to the given cpu. If the
+ * platform doesn't support thread affinity false
+ * is returned.
+ *
+ * @param thread Thread to bind
+ * @param cpu Number of the cpu
+ * @return True if the thread was bound to the cpu
+ */
+OOS_UTILS_API bool pin_thread_to_cpu(std::thread &thread, std::size_t cpu);
+
 }
 
 #endif //MATADOR_THREAD_HELPER_HPP
@@ -0,0 +1,608 @@
+#include "matador/http/async_client.hpp"
+#include "matador/http/http_client.hpp"
+#include "matador/http/response_parser.hpp"
+
+#include "matador/net/reactor.hpp"
+#include "matador/net/stream_handler.hpp"
+
+#include "matador/logger/log_manager.hpp"
+
+#include "matador/utils/buffer_view.hpp"
+#include "matador/utils/os.hpp"
+#include "matador/utils/string.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <system_error>
+#include <thread>
+
+namespace matador {
+namespace http {
+
+namespace {
+
+bool connect_in_progress()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EINPROGRESS;
+#endif
+}
+
+}
+
+namespace detail {
+
+/*
+ * A request in flight and the
+ * callback receiving its result
+ */
+struct client_exchange
+{
+  client_exchange(request r, async_client::t_response_handler h, std::chrono::milliseconds timeout)
+    : req(std::move(r))
+    , handler(std::move(h))
+    , deadline(std::chrono::steady_clock::now() + timeout)
+    , has_deadline(timeout > std::chrono::milliseconds::zero())
+  {}
+
+  void complete(int ec, const response &resp)
+  {
+    // a timeout may race with the response
+    bool expected = false;
+    if (done.compare_exchange_strong(expected, true)) {
+      handler(ec, resp);
+    }
+  }
+
+  request req;
+  async_client::t_response_handler handler;
+  std::chrono::steady_clock::time_point deadline;
+  bool has_deadline;
+  bool retried = false;
+  std::atomic_bool done { false };
+};
+
+/*
+ * A connection of the async client. Sends one
+ * request after the other and parses the responses.
+ * The connect completes with the first write.
+ *
+ * Requests are handed over from any thread and
+ * started by the reactor owning the connection.
+ */
+class client_connection : public stream_handler
+{
+public:
+  client_connection(tcp::socket sock, const tcp::peer &endpoint, async_client *client)
+    : stream_handler(sock, endpoint, client, [](tcp::peer, io_stream&) {})
+    , client_(client)
+  {}
+
+  void hand_over(std::shared_ptr<client_exchange> exchange, bool reused)
+  {
+    // the expired timer starts the exchange within
+    // the reactor; scheduling it wakes the reactor
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_ = std::move(exchange);
+    pending_reused_ = reused;
+    start_timer_ = get_reactor()->schedule_timer(shared_from_this(), std::chrono::milliseconds::zero());
+  }
+
+  void hand_over_close()
+  {
+    // closed within the reactor, which may dispatch
+    // another event of the connection meanwhile
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    close_timer_ = get_reactor()->schedule_timer(shared_from_this(), std::chrono::milliseconds::zero());
+  }
+
+  void on_timer(timer_id id) override
+  {
+    if (id == deadline_timer_ && id != 0) {
+      on_deadline();
+      return;
+    }
+    std::shared_ptr<client_exchange> pending;
+    bool reused = false;
+    bool close = false;
+    {
+      std::lock_guard<std::mutex> lock(pending_mutex_);
+      if (id == close_timer_ && id != 0) {
+        close_timer_ = 0;
+        close = true;
+      } else if (id == start_timer_) {
+        pending = std::move(pending_);
+        pending_.reset();
+        reused = pending_reused_;
+        start_timer_ = 0;
+      }
+    }
+    if (close) {
+      close_stream();
+    } else if (pending) {
+      start(std::move(pending), reused);
+    } else {
+      stream_handler::on_timer(id);
+    }
+  }
+
+  void on_close() override
+  {
+    if (closed_) {
+      return;
+    }
+    closed_ = true;
+    cancel_deadline();
+    stream_handler::on_close();
+
+    std::shared_ptr<client_exchange> pending;
+    {
+      std::lock_guard<std::mutex> lock(pending_mutex_);
+      pending = std::move(pending_);
+      pending_.reset();
+    }
+    if (pending) {
+      // closed before the request was sent
+      client_->retry(pending);
+    }
+
+    auto exchange = std::move(exchange_);
+    exchange_.reset();
+    if (!exchange) {
+      return;
+    }
+    // the server closed the kept connection before it
+    // answered; only a safe request is sent again
+    if (received_ == 0 && reused_ && !exchange->retried && http::is_safe(exchange->req.method())) {
+      exchange->retried = true;
+      client_->retry(exchange);
+    } else {
+      exchange->complete(connected_ ? ECONNRESET : ECONNREFUSED, response());
+    }
+  }
+
+private:
+  void start(std::shared_ptr<client_exchange> exchange, bool reused)
+  {
+    exchange_ = std::move(exchange);
+    reused_ = reused;
+    received_ = 0;
+    response_ = response();
+    parser_.reset();
+    // scheduled first; the response may
+    // arrive before write() returns
+    if (exchange_->has_deadline) {
+      auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(exchange_->deadline - std::chrono::steady_clock::now());
+      deadline_timer_ = get_reactor()->schedule_timer(shared_from_this(), (std::max)(remaining, std::chrono::milliseconds(1)));
+    }
+    // the buffers refer to the request
+    // kept by the exchange
+    write(exchange_->req.to_buffers(), [this](int ec, long) {
+      if (ec == 0) {
+        connected_ = true;
+        read_response();
+      }
+      // errors are handled by on_close
+    });
+  }
+
+  void on_deadline()
+  {
+    deadline_timer_ = 0;
+    auto exchange = std::move(exchange_);
+    exchange_.reset();
+    if (exchange) {
+      exchange->complete(ETIMEDOUT, response());
+    }
+    close_stream();
+  }
+
+  void read_response()
+  {
+    read(buffer_view(buffer_), [this](int ec, long nread) {
+      if (ec != 0 || !exchange_) {
+        // errors are handled by on_close
+        return;
+      }
+      received_ += static_cast<std::size_t>(nread);
+      auto result = parser_.parse(std::string(buffer_.data(), static_cast<std::size_t>(nread)), response_);
+      if (result == response_parser::INVALID) {
+        auto exchange = std::move(exchange_);
+        exchange_.reset();
+        cancel_deadline();
+        exchange->complete(EPROTO, response());
+        close_stream();
+      } else if (result == response_parser::FINISH) {
+        auto exchange = std::move(exchange_);
+        exchange_.reset();
+        cancel_deadline();
+        response resp = std::move(response_);
+        // released first, so that the callback
+        // can send its next request on it
+        client_->release(std::static_pointer_cast<client_connection>(shared_from_this()), client::is_reusable(resp));
+        exchange->complete(0, resp);
+      } else {
+        read_response();
+      }
+    });
+  }
+
+  void cancel_deadline()
+  {
+    if (deadline_timer_ != 0) {
+      get_reactor()->cancel_timer(shared_from_this(), deadline_timer_);
+      deadline_timer_ = 0;
+    }
+  }
+
+private:
+  async_client *client_;
+  std::shared_ptr<client_exchange> exchange_;
+
+  std::array<char, 16384> buffer_{};
+  response_parser parser_;
+  response response_;
+  std::size_t received_ = 0;
+
+  std::mutex pending_mutex_;
+  std::shared_ptr<client_exchange> pending_;
+  bool pending_reused_ = false;
+  timer_id start_timer_ = 0;
+  timer_id close_timer_ = 0;
+
+  timer_id deadline_timer_ = 0;
+  bool reused_ = false;
+  bool connected_ = false;
+  bool closed_ = false;
+};
+
+}
+
+async_client::async_client(io_service &service, const std::string &host)
+  : service_(service)
+  , host_(host)
+  , log_(matador::create_logger("HttpAsyncClient"))
+{
+  // split host from port (default port is 80)
+  std::vector<std::string> parts;
+  auto count = matador::split(host, ':', parts);
+
+  if (count > 2 || count == 0) {
+    throw std::logic_error("invalid host string");
+  }
+
+  if (count == 2) {
+    host_.assign(parts[0]);
+    port_.assign(parts[1]);
+  }
+
+  resolver_ = [](const std::string &host, const std::string &port) {
+    tcp::resolver resolver;
+    return resolver.resolve(host, port);
+  };
+}
+
+async_client::~async_client()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  // the resolving and expiring threads refer to the client
+  resolved_.wait(lock, [this]() { return !resolving_ && !expiring_; });
+  closing_.swap(idle_);
+  if (service_.is_running()) {
+    // scheduled while locked; a connection closed
+    // meanwhile unregisters after it notified its
+    // close, which cancels the scheduled timer
+    for (auto &conn : closing_) {
+      conn->hand_over_close();
+    }
+    // each connection notifies its close; the
+    // service may be stopped while waiting
+    while (!closing_.empty() && service_.is_running()) {
+      closed_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+  }
+  auto closing = closing_;
+  lock.unlock();
+  // nothing is dispatched anymore
+  for (auto &conn : closing) {
+    conn->close_stream();
+  }
+}
+
+void async_client::get(const std::string &route, t_response_handler handler)
+{
+  execute(request(http::GET, host_, route), std::move(handler));
+}
+
+std::future<response> async_client::get(const std::string &route)
+{
+  return execute(request(http::GET, host_, route));
+}
+
+void async_client::post(const std::string &route, const std::string &body, t_response_handler handler)
+{
+  auto req = request(http::POST, host_, route);
+  req.body(body);
+  execute(std::move(req), std::move(handler));
+}
+
+std::future<response> async_client::post(const std::string &route, const std::string &body)
+{
+  auto req = request(http::POST, host_, route);
+  req.body(body);
+  return execute(std::move(req));
+}
+
+void async_client::put(const std::string &route, const std::string &body, t_response_handler handler)
+{
+  auto req = request(http::PUT, host_, route);
+  req.body(body);
+  execute(std::move(req), std::move(handler));
+}
+
+std::future<response> async_client::put(const std::string &route, const std::string &body)
+{
+  auto req = request(http::PUT, host_, route);
+  req.body(body);
+  return execute(std::move(req));
+}
+
+void async_client::remove(const std::string &route, t_response_handler handler)
+{
+  execute(request(http::DEL, host_, route), std::move(handler));
+}
+
+std::future<response> async_client::remove(const std::string &route)
+{
+  return execute(request(http::DEL, host_, route));
+}
+
+void async_client::execute(request req, t_response_handler handler, std::chrono::milliseconds timeout)
+{
+  send(std::make_shared<detail::client_exchange>(std::move(req), std::move(handler), timeout), true);
+}
+
+void async_client::execute(request req, t_response_handler handler)
+{
+  execute(std::move(req), std::move(handler), timeout_);
+}
+
+std::future<response> async_client::execute(request req)
+{
+  auto promise = std::make_shared<std::promise<response>>();
+  auto result = promise->get_future();
+  execute(std::move(req), [promise](int ec, const response &resp) {
+    if (ec != 0) {
+      promise->set_exception(std::make_exception_ptr(std::system_error(ec, std::generic_category())));
+    } else {
+      promise->set_value(resp);
+    }
+  });
+  return result;
+}
+
+void async_client::timeout(std::chrono::milliseconds timeout)
+{
+  timeout_ = timeout;
+}
+
+std::chrono::milliseconds async_client::timeout() const
+{
+  return timeout_;
+}
+
+void async_client::resolver(t_resolver resolver)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  resolver_ = std::move(resolver);
+}
+
+void async_client::max_idle_connections(std::size_t max_idle)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_idle_ = max_idle;
+}
+
+std::size_t async_client::connections() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return connections_;
+}
+
+std::size_t async_client::idle_connections() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_.size();
+}
+
+void async_client::notify_close(handler *hndlr)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto is_handler = [hndlr](const std::shared_ptr<detail::client_connection> &conn) {
+    return conn.get() == hndlr;
+  };
+  idle_.remove_if(is_handler);
+  if (connections_ > 0) {
+    --connections_;
+  }
+  if (!closing_.empty()) {
+    closing_.remove_if(is_handler);
+    closed_.notify_all();
+  }
+}
+
+void async_client::release(const std::shared_ptr<detail::client_connection> &conn, bool reuse)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (reuse && idle_.size() < max_idle_) {
+      idle_.push_front(conn);
+      return;
+    }
+  }
+  conn->close_stream();
+}
+
+void async_client::retry(const std::shared_ptr<detail::client_exchange> &exchange)
+{
+  log_.debug("%s: kept connection was closed, retrying", host_.c_str());
+  send(exchange, false);
+}
+
+void async_client::send(const std::shared_ptr<detail::client_exchange> &exchange, bool allow_idle)
+{
+  std::shared_ptr<detail::client_connection> conn;
+  if (allow_idle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!idle_.empty()) {
+      conn = idle_.front();
+      idle_.pop_front();
+    }
+  }
+  if (conn) {
+    conn->hand_over(exchange, true);
+  } else {
+    connect(exchange);
+  }
+}
+
+void async_client::connect(const std::shared_ptr<detail::client_exchange> &exchange)
+{
+  std::vector<tcp::peer> endpoints;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (endpoints_.empty()) {
+      // the host is resolved by a thread of its own;
+      // requests wait for the resolved endpoints
+      waiting_.push_back(exchange);
+      if (!resolving_) {
+        resolving_ = true;
+        std::thread([this]() { resolve(); }).detach();
+      }
+      // a waiting request still times out
+      if (exchange->has_deadline) {
+        if (!expiring_) {
+          expiring_ = true;
+          std::thread([this]() { expire(); }).detach();
+        } else {
+          resolved_.notify_all();
+        }
+      }
+      return;
+    }
+    endpoints = endpoints_;
+  }
+  if (!connect(endpoints, exchange)) {
+    exchange->complete(ECONNREFUSED, response());
+  }
+}
+
+bool async_client::connect(const std::vector<tcp::peer> &endpoints, const std::shared_ptr<detail::client_exchange> &exchange)
+{
+  for (const auto &endpoint : endpoints) {
+    tcp::socket sock;
+    if (!is_valid_socket(sock.open(endpoint.protocol()))) {
+      continue;
+    }
+    sock.non_blocking(true);
+    if (!sock.connect(endpoint) && !connect_in_progress()) {
+      char error_buffer[1024];
+      log_.error("couldn't establish connection to: %s (%s)", endpoint.to_string().c_str(), os::strerror(errno, error_buffer, 1024));
+      sock.close();
+      continue;
+    }
+    auto conn = std::make_shared<detail::client_connection>(sock, endpoint, this);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++connections_;
+    }
+    auto &r = service_.shard(next_shard_++ % service_.shards());
+    r.register_handler(conn, event_type::READ_WRITE_MASK);
+    conn->hand_over(exchange, false);
+    return true;
+  }
+  // the host may have moved
+  std::lock_guard<std::mutex> lock(mutex_);
+  endpoints_.clear();
+  return false;
+}
+
+void async_client::resolve()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!waiting_.empty()) {
+    auto resolver = resolver_;
+    lock.unlock();
+    auto endpoints = resolver(host_, port_);
+    // ip v4 first; a refused non blocking connect
+    // is only noticed with the first write
+    std::stable_partition(endpoints.begin(), endpoints.end(), [](const tcp::peer &ep) {
+      return ep.addr().is_v4();
+    });
+    lock.lock();
+    endpoints_ = endpoints;
+    std::list<std::shared_ptr<detail::client_exchange>> waiting;
+    waiting.swap(waiting_);
+    // nothing left to expire
+    resolved_.notify_all();
+    lock.unlock();
+
+    if (endpoints.empty()) {
+      log_.error("couldn't resolve host %s", host_.c_str());
+    }
+    // requests issued meanwhile by the callbacks
+    // of failed requests are handled next round
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto &exchange : waiting) {
+      if (exchange->has_deadline && exchange->deadline <= now) {
+        exchange->complete(ETIMEDOUT, response());
+      } else if (endpoints.empty() || !connect(endpoints, exchange)) {
+        exchange->complete(endpoints.empty() ? EHOSTUNREACH : ECONNREFUSED, response());
+      }
+    }
+    lock.lock();
+  }
+  resolving_ = false;
+  resolved_.notify_all();
+}
+
+void async_client::expire()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    const auto now = std::chrono::steady_clock::now();
+    auto next = std::chrono::steady_clock::time_point::max();
+    std::list<std::shared_ptr<detail::client_exchange>> expired;
+    for (auto it = waiting_.begin(); it != waiting_.end();) {
+      auto current = it++;
+      if (!(*current)->has_deadline) {
+        continue;
+      }
+      if ((*current)->deadline <= now) {
+        expired.splice(expired.end(), waiting_, current);
+      } else {
+        next = (std::min)(next, (*current)->deadline);
+      }
+    }
+    if (!expired.empty()) {
+      // callbacks may send their next request
+      lock.unlock();
+      for (const auto &exchange : expired) {
+        exchange->complete(ETIMEDOUT, response());
+      }
+      lock.lock();
+      continue;
+    }
+    if (next == std::chrono::steady_clock::time_point::max()) {
+      break;
+    }
+    resolved_.wait_until(lock, next);
+  }
+  expiring_ = false;
+  resolved_.notify_all();
+}
+}
+}
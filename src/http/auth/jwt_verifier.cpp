@@ -0,0 +1,223 @@
+#include "matador/http/auth/jwt_verifier.hpp"
+
+#include "matador/json/json_mapper.hpp"
+
+#include "matador/utils/base64.hpp"
+
+#include <stdexcept>
+
+namespace matador {
+namespace http {
+namespace auth {
+
+namespace {
+
+const char *ALGORITHM = "HS256";
+
+// base64url without padding (RFC 7515)
+std::string encode_segment(const char *data, std::size_t size)
+{
+  auto segment = base64::encode_url(data, size);
+  while (!segment.empty() && segment.back() == '.') {
+    segment.pop_back();
+  }
+  return segment;
+}
+
+std::string decode_segment(const std::string &text, std::size_t begin, std::size_t end)
+{
+  std::string segment(text, begin, end - begin);
+  for (const auto c : segment) {
+    const bool valid = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+    if (!valid) {
+      throw std::logic_error("invalid base64url character");
+    }
+  }
+  if (segment.size() % 4 == 1) {
+    throw std::logic_error("invalid base64url length");
+  }
+  segment.append((4 - segment.size() % 4) % 4, '=');
+  return base64::decode(segment);
+}
+
+bool equals(const std::string &a, const char *b, std::size_t size)
+{
+  if (a.size() != size) {
+    return false;
+  }
+  unsigned char diff = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+  }
+  return diff == 0;
+}
+
+std::time_t seconds(const matador::time &t)
+{
+  return t.get_time_info().seconds_since_epoch;
+}
+
+// time claims are numeric dates (seconds since epoch)
+void write_claim(json &payload, const char *claim, const matador::time &t)
+{
+  if (seconds(t) != 0) {
+    payload[claim] = static_cast<long long>(seconds(t));
+  }
+}
+
+void read_claim(const json &payload, const char *claim, matador::time &t)
+{
+  if (payload.contains(claim) && payload.get(claim).is_integer()) {
+    t = matador::time(static_cast<std::time_t>(payload.get(claim).as<long long>()));
+  } else {
+    t = matador::time(0);
+  }
+}
+
+}
+
+jwt_verifier::jwt_verifier(const std::string &secret, std::size_t cache_size)
+  : key_(secret)
+  , cache_size_(cache_size)
+{}
+
+std::string jwt_verifier::encode(const jwt_token &token) const
+{
+  json_mapper mapper;
+
+  const auto header = mapper.to_string(jwt_header(ALGORITHM, "JWT"));
+  auto payload = mapper.to_json(token.payload);
+  write_claim(payload, "exp", token.payload.expiration_time);
+  write_claim(payload, "nbf", token.payload.not_before);
+  write_claim(payload, "iat", token.payload.issued_at);
+  const auto payload_text = mapper.to_string(payload);
+
+  auto text = encode_segment(header.data(), header.size());
+  text.append(".").append(encode_segment(payload_text.data(), payload_text.size()));
+  const auto sig = signature(text.data(), text.size());
+  text.append(".").append(sig);
+  return text;
+}
+
+bool jwt_verifier::verify(const std::string &token)
+{
+  jwt_token result;
+  return verify(token, result);
+}
+
+bool jwt_verifier::verify(const std::string &token, jwt_token &result)
+{
+  const auto now = std::time(nullptr);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(token);
+    if (it != index_.end()) {
+      if (it->second->expires != 0 && it->second->expires <= now) {
+        entries_.erase(it->second);
+        index_.erase(it);
+        return false;
+      }
+      entries_.splice(entries_.begin(), entries_, it->second);
+      result = it->second->token;
+      return true;
+    }
+  }
+
+  jwt_token decoded;
+  if (!decode(token, decoded) || !is_valid(decoded, now)) {
+    return false;
+  }
+  result = decoded;
+
+  if (cache_size_ == 0) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_.find(token) != index_.end()) {
+    return true;
+  }
+  entries_.push_front({ token, std::move(decoded), seconds(result.payload.expiration_time) });
+  index_.emplace(token, entries_.begin());
+  while (entries_.size() > cache_size_) {
+    index_.erase(entries_.back().text);
+    entries_.pop_back();
+  }
+  return true;
+}
+
+std::size_t jwt_verifier::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+std::size_t jwt_verifier::cache_size() const
+{
+  return cache_size_;
+}
+
+void jwt_verifier::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  entries_.clear();
+}
+
+std::string jwt_verifier::signature(const char *data, std::size_t size) const
+{
+  unsigned char digest[hmac_key::DIGEST_SIZE];
+  key_.sign(data, size, digest);
+  return encode_segment(reinterpret_cast<const char*>(digest), hmac_key::DIGEST_SIZE);
+}
+
+bool jwt_verifier::decode(const std::string &text, jwt_token &token) const
+{
+  const auto first = text.find('.');
+  if (first == std::string::npos) {
+    return false;
+  }
+  const auto second = text.find('.', first + 1);
+  if (second == std::string::npos || text.find('.', second + 1) != std::string::npos) {
+    return false;
+  }
+
+  // check the signature before anything is decoded
+  const auto expected = signature(text.data(), second);
+  if (!equals(expected, text.data() + second + 1, text.size() - second - 1)) {
+    return false;
+  }
+
+  try {
+    json_mapper mapper;
+    const auto header = mapper.to_json(decode_segment(text, 0, first));
+    if (!header.is_object() || !header.contains("alg") || header.get("alg").as<std::string>() != ALGORITHM) {
+      return false;
+    }
+    token.header = mapper.to_object<jwt_header>(header);
+
+    const auto payload = mapper.to_json(decode_segment(text, first + 1, second));
+    if (!payload.is_object()) {
+      return false;
+    }
+    token.payload = mapper.to_object<jwt_payload>(payload);
+    read_claim(payload, "exp", token.payload.expiration_time);
+    read_claim(payload, "nbf", token.payload.not_before);
+    read_claim(payload, "iat", token.payload.issued_at);
+  } catch (std::exception &) {
+    return false;
+  }
+  return true;
+}
+
+bool jwt_verifier::is_valid(const jwt_token &token, std::time_t now)
+{
+  const auto expires = seconds(token.payload.expiration_time);
+  if (expires != 0 && expires <= now) {
+    return false;
+  }
+  return seconds(token.payload.not_before) <= now;
+}
+
+}
+}
+}
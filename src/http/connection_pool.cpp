@@ -0,0 +1,176 @@
+#include "matador/http/connection_pool.hpp"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+namespace matador {
+namespace http {
+
+connection_pool::connection_pool(std::size_t max_connections)
+  : max_connections_(max_connections)
+{}
+
+connection_pool::~connection_pool()
+{
+  clear();
+}
+
+bool connection_pool::acquire(const std::string &host, const std::string &port, tcp::socket &sock, std::chrono::milliseconds timeout)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto &entry = hosts_[key(host, port)];
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (true) {
+    const auto now = std::chrono::steady_clock::now();
+    while (!entry.idle.empty()) {
+      auto conn = entry.idle.front();
+      entry.idle.pop_front();
+      // the server may have closed the idle connection
+      if (now - conn.since < idle_timeout_ && !is_closed(conn.sock)) {
+        sock = conn.sock;
+        return true;
+      }
+      conn.sock.close();
+      --entry.connections;
+    }
+    if (entry.connections < max_connections_) {
+      ++entry.connections;
+      return true;
+    }
+    if (timeout == std::chrono::milliseconds::zero()) {
+      released_.wait(lock);
+    } else if (released_.wait_until(lock, deadline) == std::cv_status::timeout) {
+      return false;
+    }
+  }
+}
+
+void connection_pool::release(const std::string &host, const std::string &port, tcp::socket &sock, bool reuse)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &entry = hosts_[key(host, port)];
+    if (reuse && sock.is_open() && entry.connections <= max_connections_) {
+      entry.idle.push_front({ sock, std::chrono::steady_clock::now() });
+      sock.release();
+    } else {
+      sock.close();
+      if (entry.connections > 0) {
+        --entry.connections;
+      }
+    }
+  }
+  released_.notify_one();
+}
+
+std::vector<tcp::peer> connection_pool::endpoints(const std::string &host, const std::string &port)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &entry = hosts_[key(host, port)];
+    if (!entry.endpoints.empty()) {
+      return entry.endpoints;
+    }
+  }
+  // resolved without holding the lock
+  tcp::resolver resolver;
+  auto endpoints = resolver.resolve(host, port);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  hosts_[key(host, port)].endpoints = endpoints;
+  return endpoints;
+}
+
+void connection_pool::invalidate_endpoints(const std::string &host, const std::string &port)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = hosts_.find(key(host, port));
+  if (it != hosts_.end()) {
+    it->second.endpoints.clear();
+  }
+}
+
+void connection_pool::max_connections(std::size_t max_connections)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_connections_ = max_connections;
+  }
+  released_.notify_all();
+}
+
+std::size_t connection_pool::max_connections() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_connections_;
+}
+
+void connection_pool::idle_timeout(std::chrono::milliseconds timeout)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  idle_timeout_ = timeout;
+}
+
+std::chrono::milliseconds connection_pool::idle_timeout() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_timeout_;
+}
+
+std::size_t connection_pool::connections(const std::string &host, const std::string &port) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = hosts_.find(key(host, port));
+  return it != hosts_.end() ? it->second.connections : 0;
+}
+
+std::size_t connection_pool::idle_connections(const std::string &host, const std::string &port) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = hosts_.find(key(host, port));
+  return it != hosts_.end() ? it->second.idle.size() : 0;
+}
+
+void connection_pool::clear()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &host : hosts_) {
+      for (auto &conn : host.second.idle) {
+        conn.sock.close();
+      }
+      host.second.connections -= host.second.idle.size();
+      host.second.idle.clear();
+    }
+  }
+  released_.notify_all();
+}
+
+std::string connection_pool::key(const std::string &host, const std::string &port)
+{
+  return host + ":" + port;
+}
+
+bool connection_pool::is_closed(const tcp::socket &sock)
+{
+  // an idle connection isn't readable unless
+  // the server closed it (or sent garbage)
+#ifdef _WIN32
+  fd_set read_set;
+  FD_ZERO(&read_set);
+  FD_SET(sock.id(), &read_set);
+  struct timeval tv{};
+  return ::select(0, &read_set, nullptr, nullptr, &tv) != 0;
+#else
+  struct pollfd pfd{};
+  pfd.fd = sock.id();
+  pfd.events = POLLIN;
+  return ::poll(&pfd, 1, 0) != 0;
+#endif
+}
+
+}
+}
@@ -0,0 +1,53 @@
+#include "matador/http/detail/header_value.hpp"
+
+#include <string>
+
+namespace matador {
+namespace http {
+namespace detail {
+
+bool match_entity_tag(const string_span &if_none_match, const string_span &etag)
+{
+  std::size_t begin = 0;
+  while (begin < if_none_match.size()) {
+    auto end = if_none_match.find(',', begin);
+    if (end == std::string::npos) {
+      end = if_none_match.size();
+    }
+    auto tag = if_none_match.substr(begin, end - begin).trim();
+    // weak comparison; a weak tag matches as well
+    if (tag.size() > 2 && tag[0] == 'W' && tag[1] == '/') {
+      tag = tag.substr(2);
+    }
+    if (tag == "*" || tag == etag) {
+      return true;
+    }
+    begin = end + 1;
+  }
+  return false;
+}
+
+bool is_persistent_connection(const string_span &connection, int major, int minor)
+{
+  bool keep_alive = major > 1 || (major == 1 && minor >= 1);
+  std::size_t begin = 0;
+  while (begin < connection.size()) {
+    auto end = connection.find(',', begin);
+    if (end == std::string::npos) {
+      end = connection.size();
+    }
+    const auto token = connection.substr(begin, end - begin).trim();
+    if (token.iequals("close")) {
+      return false;
+    }
+    if (token.iequals("keep-alive")) {
+      keep_alive = true;
+    }
+    begin = end + 1;
+  }
+  return keep_alive;
+}
+
+}
+}
+}
@@ -0,0 +1,379 @@
+#include "matador/http/detail/request_scanner.hpp"
+
+#include <atomic>
+#include <array>
+#include <cstring>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATADOR_SCAN_X86 1
+#include <immintrin.h>
+#define MATADOR_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace matador {
+namespace http {
+namespace detail {
+
+namespace {
+
+/*
+ * character classes for the scalar scan
+ * and the tail of the vectorized scan
+ */
+enum char_class : std::uint8_t
+{
+  URL_CHAR = 1,
+  TOKEN_CHAR = 2,
+  VALUE_CHAR = 4
+};
+
+struct char_table
+{
+  char_table()
+  {
+    classes.fill(0);
+    for (int c = 0; c < 256; ++c) {
+      const bool alnum = (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+      if (alnum || (c != 0 && std::strchr("%-._~:/?#[]@!$&'()*+,;=", c) != nullptr)) {
+        classes[c] |= URL_CHAR;
+      }
+      if (alnum || c == '-') {
+        classes[c] |= TOKEN_CHAR;
+      }
+      if (c == '\t' || (c >= 0x20 && c < 0x7f)) {
+        classes[c] |= VALUE_CHAR;
+      }
+    }
+  }
+
+  std::array<std::uint8_t, 256> classes{};
+};
+
+const char_table& table()
+{
+  static const char_table t;
+  return t;
+}
+
+inline const char* find_not_in_class(const char *begin, const char *end, std::uint8_t cls)
+{
+  const auto &classes = table().classes;
+  while (begin != end && (classes[static_cast<unsigned char>(*begin)] & cls) != 0) {
+    ++begin;
+  }
+  return begin;
+}
+
+inline bool is_header_end(const char *p, const char *end)
+{
+  return end - p >= 4 && p[1] == '\n' && p[2] == '\r' && p[3] == '\n';
+}
+
+const char* find_non_url_char_scalar(const char *begin, const char *end)
+{
+  return find_not_in_class(begin, end, URL_CHAR);
+}
+
+const char* find_non_token_char_scalar(const char *begin, const char *end)
+{
+  return find_not_in_class(begin, end, TOKEN_CHAR);
+}
+
+const char* find_non_value_char_scalar(const char *begin, const char *end)
+{
+  return find_not_in_class(begin, end, VALUE_CHAR);
+}
+
+const char* find_header_end_scalar(const char *begin, const char *end)
+{
+  while (end - begin >= 4) {
+    auto cr = static_cast<const char*>(std::memchr(begin, '\r', static_cast<std::size_t>(end - begin - 3)));
+    if (cr == nullptr) {
+      return nullptr;
+    }
+    if (is_header_end(cr, end)) {
+      return cr;
+    }
+    begin = cr + 1;
+  }
+  return nullptr;
+}
+
+#ifdef MATADOR_SCAN_X86
+
+/*
+ * SSE4.2: the string compare instruction checks 16 bytes
+ * against up to eight character ranges at once
+ */
+#define RANGE_MODE (_SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT)
+#define NOT_IN_RANGE_MODE (RANGE_MODE | _SIDD_MASKED_NEGATIVE_POLARITY)
+
+// characters below DEL which aren't valid in an url; DEL
+// and non ASCII bytes don't fit into the eight ranges
+alignas(16) const char URL_STOP_RANGES[16] = {
+  '\x00', '\x20', '\x22', '\x22', '\x3c', '\x3c', '\x3e', '\x3e',
+  '\x5c', '\x5c', '\x5e', '\x5e', '\x60', '\x60', '\x7b', '\x7d'
+};
+// characters which are valid in a header name
+alignas(16) const char TOKEN_RANGES[16] = {
+  '-', '-', '0', '9', 'A', 'Z', 'a', 'z'
+};
+// characters which aren't valid in a header value
+alignas(16) const char VALUE_STOP_RANGES[16] = {
+  '\x00', '\x08', '\x0a', '\x1f', '\x7f', '\xff'
+};
+
+MATADOR_TARGET("sse4.2")
+const char* find_non_url_char_sse42(const char *begin, const char *end)
+{
+  const __m128i ranges = _mm_load_si128(reinterpret_cast<const __m128i*>(URL_STOP_RANGES));
+  const __m128i del = _mm_set1_epi8('\x7f');
+  while (end - begin >= 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const auto in_ranges = static_cast<unsigned>(_mm_cvtsi128_si32(_mm_cmpestrm(ranges, 16, block, 16, RANGE_MODE | _SIDD_BIT_MASK)));
+    // the sign bit is set for DEL and all non ASCII bytes
+    const auto non_ascii = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(block, _mm_cmpeq_epi8(block, del))));
+    const auto mask = (in_ranges | non_ascii) & 0xffffu;
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+    begin += 16;
+  }
+  return find_non_url_char_scalar(begin, end);
+}
+
+MATADOR_TARGET("sse4.2")
+const char* find_non_token_char_sse42(const char *begin, const char *end)
+{
+  const __m128i ranges = _mm_load_si128(reinterpret_cast<const __m128i*>(TOKEN_RANGES));
+  while (end - begin >= 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const int index = _mm_cmpestri(ranges, 8, block, 16, NOT_IN_RANGE_MODE);
+    if (index != 16) {
+      return begin + index;
+    }
+    begin += 16;
+  }
+  return find_non_token_char_scalar(begin, end);
+}
+
+MATADOR_TARGET("sse4.2")
+const char* find_non_value_char_sse42(const char *begin, const char *end)
+{
+  const __m128i ranges = _mm_load_si128(reinterpret_cast<const __m128i*>(VALUE_STOP_RANGES));
+  while (end - begin >= 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const int index = _mm_cmpestri(ranges, 6, block, 16, RANGE_MODE);
+    if (index != 16) {
+      return begin + index;
+    }
+    begin += 16;
+  }
+  return find_non_value_char_scalar(begin, end);
+}
+
+MATADOR_TARGET("sse4.2")
+const char* find_header_end_sse42(const char *begin, const char *end)
+{
+  const __m128i cr = _mm_set1_epi8('\r');
+  while (end - begin >= 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, cr)));
+    while (mask != 0) {
+      const char *p = begin + __builtin_ctz(mask);
+      if (is_header_end(p, end)) {
+        return p;
+      }
+      mask &= mask - 1;
+    }
+    begin += 16;
+  }
+  return find_header_end_scalar(begin, end);
+}
+
+/*
+ * AVX2: 32 bytes at a time; character classes
+ * are built from unsigned range compares. The
+ * upper register halves are cleared before
+ * returning to avoid AVX/SSE transition stalls.
+ */
+MATADOR_TARGET("avx2")
+inline __m256i in_range(__m256i v, char lo, char hi)
+{
+  const __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+  return _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(static_cast<char>(hi - lo))), d);
+}
+
+MATADOR_TARGET("avx2")
+inline __m256i equal(__m256i v, char c)
+{
+  return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c));
+}
+
+MATADOR_TARGET("avx2")
+const char* find_non_url_char_avx2(const char *begin, const char *end)
+{
+  while (end - begin >= 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    const __m256i invalid = _mm256_or_si256(
+      _mm256_or_si256(_mm256_or_si256(equal(v, '"'), equal(v, '<')), _mm256_or_si256(equal(v, '>'), equal(v, '\\'))),
+      _mm256_or_si256(_mm256_or_si256(equal(v, '^'), equal(v, '`')), in_range(v, '{', '}'))
+    );
+    const __m256i valid = _mm256_andnot_si256(invalid, in_range(v, '\x21', '\x7e'));
+    const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(valid));
+    if (mask != 0xffffffffu) {
+      _mm256_zeroupper();
+      return begin + __builtin_ctz(~mask);
+    }
+    begin += 32;
+  }
+  _mm256_zeroupper();
+  return find_non_url_char_scalar(begin, end);
+}
+
+MATADOR_TARGET("avx2")
+const char* find_non_token_char_avx2(const char *begin, const char *end)
+{
+  while (end - begin >= 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    const __m256i valid = _mm256_or_si256(
+      _mm256_or_si256(in_range(v, '0', '9'), in_range(v, 'A', 'Z')),
+      _mm256_or_si256(in_range(v, 'a', 'z'), equal(v, '-'))
+    );
+    const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(valid));
+    if (mask != 0xffffffffu) {
+      _mm256_zeroupper();
+      return begin + __builtin_ctz(~mask);
+    }
+    begin += 32;
+  }
+  _mm256_zeroupper();
+  return find_non_token_char_scalar(begin, end);
+}
+
+MATADOR_TARGET("avx2")
+const char* find_non_value_char_avx2(const char *begin, const char *end)
+{
+  while (end - begin >= 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    const __m256i valid = _mm256_or_si256(in_range(v, '\x20', '\x7e'), equal(v, '\t'));
+    const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(valid));
+    if (mask != 0xffffffffu) {
+      _mm256_zeroupper();
+      return begin + __builtin_ctz(~mask);
+    }
+    begin += 32;
+  }
+  _mm256_zeroupper();
+  return find_non_value_char_scalar(begin, end);
+}
+
+MATADOR_TARGET("avx2")
+const char* find_header_end_avx2(const char *begin, const char *end)
+{
+  while (end - begin >= 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(equal(v, '\r')));
+    while (mask != 0) {
+      const char *p = begin + __builtin_ctz(mask);
+      if (is_header_end(p, end)) {
+        _mm256_zeroupper();
+        return p;
+      }
+      mask &= mask - 1;
+    }
+    begin += 32;
+  }
+  _mm256_zeroupper();
+  return find_header_end_scalar(begin, end);
+}
+
+#endif
+
+struct scanner
+{
+  const char* (*find_non_url_char)(const char*, const char*);
+  const char* (*find_non_token_char)(const char*, const char*);
+  const char* (*find_non_value_char)(const char*, const char*);
+  const char* (*find_header_end)(const char*, const char*);
+};
+
+const scanner scanners[] = {
+  { find_non_url_char_scalar, find_non_token_char_scalar, find_non_value_char_scalar, find_header_end_scalar },
+#ifdef MATADOR_SCAN_X86
+  { find_non_url_char_sse42, find_non_token_char_sse42, find_non_value_char_sse42, find_header_end_sse42 },
+  { find_non_url_char_avx2, find_non_token_char_avx2, find_non_value_char_avx2, find_header_end_avx2 },
+#endif
+};
+
+scan_level detect_scan_level()
+{
+#ifdef MATADOR_SCAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return scan_level::AVX2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return scan_level::SSE42;
+  }
+#endif
+  return scan_level::SCALAR;
+}
+
+std::atomic<const scanner*>& active_scanner()
+{
+  static std::atomic<const scanner*> active(&scanners[static_cast<int>(supported_scan_level())]);
+  return active;
+}
+
+inline const scanner& current()
+{
+  return *active_scanner().load(std::memory_order_relaxed);
+}
+
+}
+
+scan_level supported_scan_level()
+{
+  static const scan_level level = detect_scan_level();
+  return level;
+}
+
+scan_level current_scan_level()
+{
+  return static_cast<scan_level>(&current() - scanners);
+}
+
+bool use_scan_level(scan_level level)
+{
+  if (static_cast<int>(level) > static_cast<int>(supported_scan_level())) {
+    return false;
+  }
+  active_scanner().store(&scanners[static_cast<int>(level)], std::memory_order_relaxed);
+  return true;
+}
+
+const char* find_non_url_char(const char *begin, const char *end)
+{
+  return current().find_non_url_char(begin, end);
+}
+
+const char* find_non_token_char(const char *begin, const char *end)
+{
+  return current().find_non_token_char(begin, end);
+}
+
+const char* find_non_value_char(const char *begin, const char *end)
+{
+  return current().find_non_value_char(begin, end);
+}
+
+const char* find_header_end(const char *begin, const char *end)
+{
+  return current().find_header_end(begin, end);
+}
+
+}
+}
+}
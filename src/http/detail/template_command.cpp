@@ -1,5 +1,6 @@
 #include "matador/http/detail/template_command.hpp"
 #include "matador/http/detail/template_parser.hpp"
+#include "matador/http/detail/template_loader.hpp"
 
 #include "matador/utils/string_cursor.hpp"
 #include "matador/utils/file.hpp"
@@ -127,6 +128,12 @@ std::shared_ptr<template_part> include_command::parse(string_cursor &cursor)
     }
     cursor.next_char();
 
+    auto loader = template_loader::current();
+    if (loader != nullptr) {
+      cursor.skip_whitespace();
+      return loader->load(filepath);
+    }
+
     if (!os::exists(filepath)) {
       throw std::logic_error("file " + filepath + " doesn't exists");
     }
@@ -0,0 +1,72 @@
+#include "matador/http/detail/template_context.hpp"
+
+#include "matador/utils/string.hpp"
+
+#include <stdexcept>
+
+namespace matador {
+namespace http {
+namespace detail {
+
+template_path split_path(const std::string &path)
+{
+  template_path parts;
+  matador::split(path, '.', parts);
+  return parts;
+}
+
+template_context::template_context(const json &data)
+  : data_(data)
+{}
+
+template_context::template_context(const template_value &data)
+  : data_(data)
+{}
+
+template_value template_context::at(const template_path &path) const
+{
+  auto level = scopes_.size();
+  std::size_t index = 0;
+  while (level > 0) {
+    const auto &current = scopes_[level - 1];
+    if (index < path.size() && path[index] == *current.name) {
+      return resolve(current.value, path, index + 1);
+    }
+    if (index + 1 < path.size() && path[index] == "forloop" && path[index + 1] == "parent") {
+      index += 2;
+      --level;
+    } else if (index < path.size()) {
+      throw std::logic_error("object doesn't contain key " + path[index]);
+    } else {
+      throw std::logic_error("couldn't resolve loop scope as value");
+    }
+  }
+  return resolve(data_, path, index);
+}
+
+void template_context::push(const std::string &name, const template_value &value)
+{
+  scopes_.push_back({ &name, value });
+}
+
+void template_context::replace(const template_value &value)
+{
+  scopes_.back().value = value;
+}
+
+void template_context::pop()
+{
+  scopes_.pop_back();
+}
+
+template_value template_context::resolve(template_value value, const template_path &path, std::size_t index)
+{
+  for (; index < path.size(); ++index) {
+    value = value.at(path[index]);
+  }
+  return value;
+}
+
+}
+}
+}
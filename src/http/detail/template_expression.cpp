@@ -23,16 +23,26 @@ bool operator!=(const json &a, const std::string &b)
   return !(a == b);
 }
 
-json_value_expression::json_value_expression(std::string value_name)
-  : value_name_(std::move(value_name))
+bool template_expression::evaluate(const json &data) const
+{
+  return evaluate(template_context(data));
+}
+
+json_value_expression::json_value_expression(const std::string &value_name)
+  : value_path_(split_path(value_name))
 {}
 
-bool json_value_expression::evaluate(const json &data) const
+bool json_value_expression::evaluate(const template_context &context) const
 {
   try {
-    const auto &val = data.at_path(value_name_, '.');
+    const auto value = context.at(value_path_);
+    if (value.is_array() || value.is_object()) {
+      return !value.empty();
+    }
+    json buffer;
+    const auto &val = value.as_json(buffer);
 
-    if (val.is_array() || val.is_object() || val.is_string()) {
+    if (val.is_string()) {
       return !val.empty();
     } else if (val.is_boolean()) {
       return val.as<bool>();
@@ -47,17 +57,20 @@ bool json_value_expression::evaluate(const json &data) const
   }
 }
 
-bool json_compare_expression::evaluate(const json &data) const
+bool json_compare_expression::evaluate(const template_context &context) const
 {
-  const auto &value = data.at_path(value_name_, '.');
+  json buffer;
+  const auto &value = context.at(value_path_).as_json(buffer);
 
   return compare_func_(value);
 }
 
-bool json_json_compare_expression::evaluate(const json &data) const
+bool json_json_compare_expression::evaluate(const template_context &context) const
 {
-  const auto &left = data.at_path(left_name_);
-  const auto &right = data.at_path(right_name_);
+  json left_buffer;
+  json right_buffer;
+  const auto &left = context.at(left_path_).as_json(left_buffer);
+  const auto &right = context.at(right_path_).as_json(right_buffer);
 
   return compare_func_(left, right);
 }
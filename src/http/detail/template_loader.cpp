@@ -0,0 +1,31 @@
+#include "matador/http/detail/template_loader.hpp"
+
+namespace matador {
+namespace http {
+namespace detail {
+
+namespace {
+
+thread_local template_loader *current_loader = nullptr;
+
+}
+
+template_loader *template_loader::current()
+{
+  return current_loader;
+}
+
+template_loader_scope::template_loader_scope(template_loader *loader)
+  : previous_(current_loader)
+{
+  current_loader = loader;
+}
+
+template_loader_scope::~template_loader_scope()
+{
+  current_loader = previous_;
+}
+
+}
+}
+}
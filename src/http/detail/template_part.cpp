@@ -1,10 +1,10 @@
 #include "matador/http/detail/template_part.hpp"
 #include "matador/http/detail/template_expression.hpp"
+#include "matador/http/detail/template_program.hpp"
 
 #include <utility>
 #include <iostream>
 
-#include "matador/utils/stream.hpp"
 #include "matador/json/json.hpp"
 
 namespace matador {
@@ -28,6 +28,11 @@ json template_part::apply_filter(const json &data)
   return data;
 }
 
+const template_filter_ptr &template_part::filter() const
+{
+  return filter_;
+}
+
 /*
  * static part implementation
  */
@@ -40,30 +45,29 @@ std::string static_part::render(const json &)
   return str_;
 }
 
+void static_part::compile(template_program &program) const
+{
+  program.append_text(str_);
+}
+
 /*
  * variable part implementation
  */
-variable_part::variable_part(std::string str)
-  : str_(std::move(str))
+variable_part::variable_part(const std::string &str)
+  : path_(split_path(str))
 {}
 
 std::string variable_part::render(const json &data)
 {
-  const auto &val = apply_filter(data.at_path(str_, '.'));
-
-  if (val.is_integer()) {
-    return std::to_string(val.as<int>());
-  } else if (val.is_real()) {
-    return std::to_string(val.as<double>());
-  } else if (val.is_boolean()) {
-    return std::to_string(val.as<bool>());
-  } else if (val.is_string()) {
-    return val.as<std::string>();
-  } else if (val.is_null()) {
-    return "null";
-  } else {
-    throw std::logic_error("couldn't cats object or array to string");
-  }
+  std::string result;
+  json buffer;
+  append_value(result, apply_filter(template_context(data).at(path_).as_json(buffer)));
+  return result;
+}
+
+void variable_part::compile(template_program &program) const
+{
+  program.append_value(path_, filter());
 }
 
 /*
@@ -76,9 +80,18 @@ void multi_template_part::push_back(const template_part_ptr &part)
 
 std::string multi_template_part::render(const json &data)
 {
-  return make_stream(parts_)
-    .map([&data](const template_part_ptr &part) { return part->render(data); })
-    .join();
+  std::string result;
+  for (const auto &part : parts_) {
+    result.append(part->render(data));
+  }
+  return result;
+}
+
+void multi_template_part::compile(template_program &program) const
+{
+  for (const auto &part : parts_) {
+    part->compile(program);
+  }
 }
 
 std::list<template_part_ptr> &multi_template_part::parts()
@@ -89,17 +102,18 @@ std::list<template_part_ptr> &multi_template_part::parts()
 /*
  * multi part implementation
  */
-loop_template_part::loop_template_part(template_part_ptr part, template_part_ptr on_empty_part, std::string list_name, std::string elem_name)
+loop_template_part::loop_template_part(template_part_ptr part, template_part_ptr on_empty_part, const std::string &list_name, std::string elem_name)
   : part_(std::move(part))
   , loop_part_(std::move(on_empty_part))
-  , list_name_(std::move(list_name))
+  , list_path_(split_path(list_name))
   , elem_name_(std::move(elem_name))
 {
 }
 
 std::string loop_template_part::render(const json &data)
 {
-  const json &cont = data.at_path(list_name_, '.');
+  json buffer;
+  const json &cont = template_context(data).at(list_path_).as_json(buffer);
 
   if (!cont.is_object() && !cont.is_array()) {
     throw std::logic_error("json object isn't of type array or object");
@@ -121,6 +135,19 @@ std::string loop_template_part::render(const json &data)
   }
 }
 
+void loop_template_part::compile(template_program &program) const
+{
+  // LOOP enters the body or jumps to the empty part,
+  // NEXT jumps back to the body or behind the empty part
+  auto loop = program.append_loop(list_path_, elem_name_);
+  auto body = program.label();
+  loop_part_->compile(program);
+  auto next = program.append_next(body);
+  program.jump_to(loop, program.label());
+  part_->compile(program);
+  program.leave_to(next, program.label());
+}
+
 if_template_part::if_template_part(t_expression_list expression_list, template_part_ptr else_part)
   : expression_list_(std::move(expression_list))
   , else_part_(std::move(else_part))
@@ -136,6 +163,24 @@ std::string if_template_part::render(const json &data)
   return else_part_->render(data);
 }
 
+void if_template_part::compile(template_program &program) const
+{
+  // each BRANCH skips its part if the expression
+  // is false, each part jumps behind the else part
+  std::list<std::size_t> jumps;
+  for (const auto &p : expression_list_) {
+    auto branch = program.append_branch(p.first);
+    p.second->compile(program);
+    jumps.push_back(program.append_jump());
+    program.jump_to(branch, program.label());
+  }
+  else_part_->compile(program);
+  auto end = program.label();
+  for (auto jump : jumps) {
+    program.jump_to(jump, end);
+  }
+}
+
+}
 }
 }
-}
\ No newline at end of file
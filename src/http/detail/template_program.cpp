@@ -0,0 +1,194 @@
+#include "matador/http/detail/template_program.hpp"
+#include "matador/http/detail/template_part.hpp"
+#include "matador/http/detail/template_expression.hpp"
+#include "matador/http/detail/template_filter.hpp"
+
+#include "matador/json/json.hpp"
+
+#include <stdexcept>
+
+namespace matador {
+namespace http {
+namespace detail {
+
+std::shared_ptr<template_program> template_program::compile(const template_part &part)
+{
+  auto program = std::make_shared<template_program>();
+  part.compile(*program);
+  return program;
+}
+
+void template_program::render(const template_value &data, std::string &out) const
+{
+  struct loop_state
+  {
+    std::vector<template_value> elements;
+    std::size_t current;
+  };
+
+  out.reserve(out.size() + size_hint_.load());
+  const auto start = out.size();
+
+  template_context context(data);
+  // kept per depth, so the elements of an inner
+  // loop are collected into the same vector
+  std::vector<loop_state> loops;
+  std::size_t depth = 0;
+  json buffer;
+
+  std::size_t index = 0;
+  while (index < instructions_.size()) {
+    const auto &instr = instructions_[index];
+    switch (instr.opcode) {
+      case TEXT:
+        out.append(text_, instr.offset, instr.length);
+        ++index;
+        break;
+      case VALUE: {
+        const auto value = context.at(paths_[instr.offset]);
+        const auto &filter = filters_[instr.length];
+        if (filter) {
+          detail::append_value(out, filter->apply(value.as_json(buffer)));
+        } else {
+          value.append_to(out);
+        }
+        ++index;
+        break;
+      }
+      case LOOP: {
+        const auto cont = context.at(paths_[instr.offset]);
+        if (!cont.is_object() && !cont.is_array()) {
+          throw std::logic_error("json object isn't of type array or object");
+        }
+        if (depth == loops.size()) {
+          loops.emplace_back();
+        }
+        auto &loop = loops[depth];
+        loop.elements.clear();
+        loop.current = 0;
+        cont.elements(loop.elements);
+        if (loop.elements.empty()) {
+          index = instr.target;
+        } else {
+          ++depth;
+          context.push(names_[instr.length], loop.elements.front());
+          ++index;
+        }
+        break;
+      }
+      case NEXT: {
+        auto &loop = loops[depth - 1];
+        if (++loop.current < loop.elements.size()) {
+          context.replace(loop.elements[loop.current]);
+          index = instr.target;
+        } else {
+          context.pop();
+          --depth;
+          index = instr.end;
+        }
+        break;
+      }
+      case BRANCH:
+        index = expressions_[instr.offset]->evaluate(context) ? index + 1 : instr.target;
+        break;
+      case JUMP:
+        index = instr.target;
+        break;
+    }
+  }
+
+  const auto size = out.size() - start;
+  if (size > size_hint_.load()) {
+    size_hint_ = size;
+  }
+}
+
+void template_program::render(const json &data, std::string &out) const
+{
+  render(template_value(data), out);
+}
+
+std::string template_program::render(const json &data) const
+{
+  std::string result;
+  render(data, result);
+  return result;
+}
+
+const std::vector<template_program::instruction> &template_program::instructions() const
+{
+  return instructions_;
+}
+
+void template_program::append_text(const std::string &text)
+{
+  if (text.empty()) {
+    return;
+  }
+  if (!instructions_.empty() && instructions_.back().opcode == TEXT && label_ != instructions_.size()) {
+    // the text pool grows in template order,
+    // so adjacent text is adjacent in the pool
+    instructions_.back().length += text.size();
+  } else {
+    append(TEXT, text_.size(), text.size());
+  }
+  text_.append(text);
+}
+
+void template_program::append_value(const template_path &path, const std::shared_ptr<template_filter> &filter)
+{
+  paths_.push_back(path);
+  filters_.push_back(filter);
+  append(VALUE, paths_.size() - 1, filters_.size() - 1);
+}
+
+std::size_t template_program::append_loop(const template_path &path, const std::string &name)
+{
+  paths_.push_back(path);
+  names_.push_back(name);
+  return append(LOOP, paths_.size() - 1, names_.size() - 1);
+}
+
+std::size_t template_program::append_next(std::size_t body)
+{
+  auto index = append(NEXT);
+  jump_to(index, body);
+  return index;
+}
+
+std::size_t template_program::append_branch(const std::shared_ptr<template_expression> &expression)
+{
+  expressions_.push_back(expression);
+  return append(BRANCH, expressions_.size() - 1);
+}
+
+std::size_t template_program::append_jump()
+{
+  return append(JUMP);
+}
+
+std::size_t template_program::label()
+{
+  label_ = instructions_.size();
+  return label_;
+}
+
+void template_program::jump_to(std::size_t index, std::size_t target)
+{
+  instructions_.at(index).target = target;
+}
+
+void template_program::leave_to(std::size_t index, std::size_t end)
+{
+  instructions_.at(index).end = end;
+}
+
+std::size_t template_program::append(opcode_t opcode, std::size_t offset, std::size_t length)
+{
+  instructions_.push_back({ opcode, offset, length, 0, 0 });
+  return instructions_.size() - 1;
+}
+
+}
+}
+}
@@ -0,0 +1,312 @@
+#include "matador/http/detail/template_value.hpp"
+
+#include "matador/utils/date.hpp"
+#include "matador/utils/string.hpp"
+#include "matador/utils/time.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace matador {
+namespace http {
+namespace detail {
+
+void append_value(std::string &out, const json &value)
+{
+  if (value.is_integer()) {
+    out.append(std::to_string(value.as<int>()));
+  } else if (value.is_real()) {
+    out.append(std::to_string(value.as<double>()));
+  } else if (value.is_boolean()) {
+    out.push_back(value.as<bool>() ? '1' : '0');
+  } else if (value.is_string()) {
+    out.append(value.as<std::string>());
+  } else if (value.is_null()) {
+    out.append("null");
+  } else {
+    throw std::logic_error("couldn't cats object or array to string");
+  }
+}
+
+/*
+ * template value implementation
+ */
+template_value::template_value(const json &data)
+  : ptr_(&data)
+  , type_(&json_template_type::instance())
+{}
+
+template_value::template_value(const void *ptr, const template_type &type)
+  : ptr_(ptr)
+  , type_(&type)
+{}
+
+bool template_value::is_null() const
+{
+  return type_ == nullptr || type_->kind(ptr_) == template_type::NULL_VALUE;
+}
+
+bool template_value::is_object() const
+{
+  return type_ != nullptr && type_->kind(ptr_) == template_type::OBJECT;
+}
+
+bool template_value::is_array() const
+{
+  return type_ != nullptr && type_->kind(ptr_) == template_type::ARRAY;
+}
+
+template_value template_value::at(const std::string &key) const
+{
+  if (type_ == nullptr) {
+    throw std::logic_error("type isn't object");
+  }
+  return type_->at(ptr_, key);
+}
+
+bool template_value::empty() const
+{
+  return type_ == nullptr || type_->empty(ptr_);
+}
+
+void template_value::elements(std::vector<template_value> &elems) const
+{
+  if (type_ == nullptr) {
+    throw std::logic_error("type isn't array");
+  }
+  type_->elements(ptr_, elems);
+}
+
+void template_value::append_to(std::string &out) const
+{
+  if (type_ == nullptr) {
+    out.append("null");
+  } else {
+    type_->append_to(ptr_, out);
+  }
+}
+
+const json &template_value::as_json(json &buffer) const
+{
+  if (type_ == nullptr) {
+    buffer = json(nullptr);
+    return buffer;
+  }
+  return type_->as_json(ptr_, buffer);
+}
+
+/*
+ * template type defaults
+ */
+template_value template_type::at(const void *, const std::string &) const
+{
+  throw std::logic_error("type isn't object");
+}
+
+bool template_type::empty(const void *) const
+{
+  return false;
+}
+
+void template_type::elements(const void *, std::vector<template_value> &) const
+{
+  throw std::logic_error("type isn't array");
+}
+
+void template_type::append_to(const void *, std::string &) const
+{
+  throw std::logic_error("couldn't cats object or array to string");
+}
+
+const json &template_type::as_json(const void *, json &) const
+{
+  throw std::logic_error("couldn't convert object or array to json");
+}
+
+/*
+ * json values
+ */
+const json_template_type &json_template_type::instance()
+{
+  static const json_template_type type;
+  return type;
+}
+
+template_type::kind_t json_template_type::kind(const void *ptr) const
+{
+  const auto &data = *static_cast<const json*>(ptr);
+  if (data.is_object()) {
+    return OBJECT;
+  } else if (data.is_array()) {
+    return ARRAY;
+  } else if (data.is_null()) {
+    return NULL_VALUE;
+  }
+  return SCALAR;
+}
+
+template_value json_template_type::at(const void *ptr, const std::string &key) const
+{
+  return template_value(static_cast<const json*>(ptr)->get(key));
+}
+
+bool json_template_type::empty(const void *ptr) const
+{
+  return static_cast<const json*>(ptr)->empty();
+}
+
+void json_template_type::elements(const void *ptr, std::vector<template_value> &elems) const
+{
+  for (const auto &elem : *static_cast<const json*>(ptr)) {
+    elems.emplace_back(elem);
+  }
+}
+
+void json_template_type::append_to(const void *ptr, std::string &out) const
+{
+  append_value(out, *static_cast<const json*>(ptr));
+}
+
+const json &json_template_type::as_json(const void *ptr, json &) const
+{
+  return *static_cast<const json*>(ptr);
+}
+
+/*
+ * bool values
+ */
+const bool_template_type &bool_template_type::instance()
+{
+  static const bool_template_type type;
+  return type;
+}
+
+template_type::kind_t bool_template_type::kind(const void *) const
+{
+  return SCALAR;
+}
+
+void bool_template_type::append_to(const void *ptr, std::string &out) const
+{
+  out.push_back(*static_cast<const bool*>(ptr) ? '1' : '0');
+}
+
+const json &bool_template_type::as_json(const void *ptr, json &buffer) const
+{
+  buffer = *static_cast<const bool*>(ptr);
+  return buffer;
+}
+
+/*
+ * string values
+ */
+const string_template_type &string_template_type::instance()
+{
+  static const string_template_type type;
+  return type;
+}
+
+template_type::kind_t string_template_type::kind(const void *) const
+{
+  return SCALAR;
+}
+
+bool string_template_type::empty(const void *ptr) const
+{
+  return static_cast<const std::string*>(ptr)->empty();
+}
+
+void string_template_type::append_to(const void *ptr, std::string &out) const
+{
+  out.append(*static_cast<const std::string*>(ptr));
+}
+
+const json &string_template_type::as_json(const void *ptr, json &buffer) const
+{
+  buffer = *static_cast<const std::string*>(ptr);
+  return buffer;
+}
+
+/*
+ * char array values
+ */
+const char_array_template_type &char_array_template_type::instance()
+{
+  static const char_array_template_type type;
+  return type;
+}
+
+template_type::kind_t char_array_template_type::kind(const void *) const
+{
+  return SCALAR;
+}
+
+bool char_array_template_type::empty(const void *ptr) const
+{
+  return *static_cast<const char*>(ptr) == '\0';
+}
+
+void char_array_template_type::append_to(const void *ptr, std::string &out) const
+{
+  out.append(static_cast<const char*>(ptr));
+}
+
+const json &char_array_template_type::as_json(const void *ptr, json &buffer) const
+{
+  buffer = std::string(static_cast<const char*>(ptr));
+  return buffer;
+}
+
+/*
+ * date values
+ */
+const date_template_type &date_template_type::instance()
+{
+  static const date_template_type type;
+  return type;
+}
+
+template_type::kind_t date_template_type::kind(const void *) const
+{
+  return SCALAR;
+}
+
+void date_template_type::append_to(const void *ptr, std::string &out) const
+{
+  out.append(matador::to_string(*static_cast<const date*>(ptr)));
+}
+
+const json &date_template_type::as_json(const void *ptr, json &buffer) const
+{
+  buffer = matador::to_string(*static_cast<const date*>(ptr));
+  return buffer;
+}
+
+/*
+ * time values
+ */
+const time_template_type &time_template_type::instance()
+{
+  static const time_template_type type;
+  return type;
+}
+
+template_type::kind_t time_template_type::kind(const void *) const
+{
+  return SCALAR;
+}
+
+void time_template_type::append_to(const void *ptr, std::string &out) const
+{
+  out.append(matador::to_string(*static_cast<const time*>(ptr)));
+}
+
+const json &time_template_type::as_json(const void *ptr, json &buffer) const
+{
+  buffer = matador::to_string(*static_cast<const time*>(ptr));
+  return buffer;
+}
+
+}
+}
+}
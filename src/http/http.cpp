@@ -37,6 +37,8 @@ std::unordered_map<http::status_t, std::string, detail::enum_class_hash> http::r
   { http::status_t::UNAUTHORIZED, "HTTP/1.1 401 Unauthorized\r\n" },
   { http::status_t::FORBIDDEN, "HTTP/1.1 403 Forbidden\r\n" },
   { http::status_t::NOT_FOUND, "HTTP/1.1 404 Not Found\r\n" },
+  { http::status_t::PAYLOAD_TOO_LARGE, "HTTP/1.1 413 Payload Too Large\r\n" },
+  { http::status_t::REQUEST_HEADER_FIELDS_TOO_LARGE, "HTTP/1.1 431 Request Header Fields Too Large\r\n" },
   { http::status_t::INTERNAL_SERVER_ERROR, "HTTP/1.1 500 Internal Server error\r\n" },
   { http::status_t::NOT_IMPLEMENTED, "HTTP/1.1 501 Not Implemented\r\n" },
   { http::status_t::BAD_GATEWAY, "HTTP/1.1 502 Bad Gateway\r\n" },
@@ -56,6 +58,8 @@ std::unordered_map<http::status_t, std::string, detail::enum_class_hash> http::s
   { http::status_t::UNAUTHORIZED, "Unauthorized" },
   { http::status_t::FORBIDDEN, "Forbidden" },
   { http::status_t::NOT_FOUND, "Not Found" },
+  { http::status_t::PAYLOAD_TOO_LARGE, "Payload Too Large" },
+  { http::status_t::REQUEST_HEADER_FIELDS_TOO_LARGE, "Request Header Fields Too Large" },
   { http::status_t::INTERNAL_SERVER_ERROR, "Internal Server error" },
   { http::status_t::NOT_IMPLEMENTED, "Not Implemented" },
   { http::status_t::BAD_GATEWAY, "Bad Gateway" },
@@ -75,6 +79,8 @@ std::unordered_map<std::string, http::status_t> http::string_status_map_{{ /* NO
   { "401", http::UNAUTHORIZED },
   { "403", http::FORBIDDEN },
   { "404", http::NOT_FOUND },
+  { "413", http::PAYLOAD_TOO_LARGE },
+  { "431", http::REQUEST_HEADER_FIELDS_TOO_LARGE },
   { "500", http::INTERNAL_SERVER_ERROR },
   { "501", http::NOT_IMPLEMENTED },
   { "502", http::BAD_GATEWAY },
@@ -100,6 +106,11 @@ http::method_t http::to_method(const std::string &str)
   return it->second;
 }
 
+bool http::is_safe(method_t m)
+{
+  return m == GET || m == HEAD || m == OPTIONS;
+}
+
 std::string http::to_request_string(http::status_t status)
 {
   return request_status_string_map_.at(status);
@@ -1,14 +1,92 @@
 #include "matador/http/http_client.hpp"
 #include "matador/http/request.hpp"
+#include "matador/http/response_header.hpp"
 #include "matador/http/response_parser.hpp"
 
+#include "matador/http/detail/header_value.hpp"
+
 #include "matador/logger/log_manager.hpp"
 
+#include "matador/utils/string_span.hpp"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#include <sys/time.h>
+#endif
+
 namespace matador {
 namespace http {
 
+namespace {
+
+bool connect_in_progress()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EINPROGRESS;
+#endif
+}
+
+bool wait_until_connected(const tcp::socket &stream, std::chrono::milliseconds timeout)
+{
+#ifdef _WIN32
+  fd_set write_set;
+  fd_set except_set;
+  FD_ZERO(&write_set);
+  FD_ZERO(&except_set);
+  FD_SET(stream.id(), &write_set);
+  FD_SET(stream.id(), &except_set);
+  struct timeval tv{};
+  tv.tv_sec = static_cast<long>(timeout.count() / 1000);
+  tv.tv_usec = static_cast<long>((timeout.count() % 1000) * 1000);
+  if (::select(0, nullptr, &write_set, &except_set, &tv) <= 0) {
+    return false;
+  }
+#else
+  struct pollfd pfd{};
+  pfd.fd = stream.id();
+  pfd.events = POLLOUT;
+  int ret;
+  do {
+    ret = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+  } while (ret < 0 && errno == EINTR);
+  if (ret <= 0) {
+    if (ret == 0) {
+      errno = ETIMEDOUT;
+    }
+    return false;
+  }
+#endif
+  int error = 0;
+  socklen_t len = sizeof(error);
+  if (getsockopt(stream.id(), SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &len) != 0) {
+    return false;
+  }
+  errno = error;
+  return error == 0;
+}
+
+bool is_timeout()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAETIMEDOUT;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+}
+
 client::client(const std::string &host)
+  : client(host, std::make_shared<connection_pool>())
+{}
+
+client::client(const std::string &host, std::shared_ptr<connection_pool> pool)
   : host_(host)
+  , pool_(std::move(pool))
   , log_(matador::create_logger("HttpClient"))
 {
   // split host from port (default port is 80)
@@ -51,36 +129,79 @@ response client::remove(const std::string &route)
   return execute(request(http::DEL, host_, route));
 }
 
-response client::execute(const request& req)
+void client::connect_timeout(std::chrono::milliseconds timeout)
 {
-  tcp::socket connection;
-  connect(connection);
+  connect_timeout_ = timeout;
+}
 
-  if (!connection.is_open()) {
-    throw_logic_error("couldn't establish connection to " << host_ << ":" << port_);
-  }
+std::chrono::milliseconds client::connect_timeout() const
+{
+  return connect_timeout_;
+}
 
-  send_request(connection, req);
+void client::read_timeout(std::chrono::milliseconds timeout)
+{
+  read_timeout_ = timeout;
+}
 
-  if (!connection.is_open()) {
-    throw_logic_error("failed to write request to  " << host_ << ":" << port_);
-  }
+std::chrono::milliseconds client::read_timeout() const
+{
+  return read_timeout_;
+}
 
-  response resp;
-  read_response(connection, resp);
+const std::shared_ptr<connection_pool> &client::pool() const
+{
+  return pool_;
+}
 
-  connection.close();
+response client::execute(const request& req)
+{
+  bool retried = false;
+  while (true) {
+    tcp::socket connection;
+    if (!pool_->acquire(host_, port_, connection, connect_timeout_)) {
+      throw_logic_error("no free connection to " << host_ << ":" << port_);
+    }
+
+    const bool reused = connection.is_open();
+    if (!reused && !connect(connection)) {
+      pool_->release(host_, port_, connection, false);
+      throw_logic_error("couldn't establish connection to " << host_ << ":" << port_);
+    }
+    apply_timeouts(connection);
+
+    response resp;
+    auto result = READ_NOTHING;
+    if (send_request(connection, req)) {
+      result = read_response(connection, resp);
+    }
+
+    if (result == READ_FINISHED) {
+      pool_->release(host_, port_, connection, is_reusable(resp));
+      return resp;
+    }
+    pool_->release(host_, port_, connection, false);
 
-  return resp;
+    // the server closed the pooled connection before
+    // it answered; only a request the server may
+    // safely have processed already is sent again
+    if (result == READ_NOTHING && reused && !retried && http::is_safe(req.method())) {
+      log_.debug("%s: pooled connection was closed, retrying", host_.c_str());
+      retried = true;
+      continue;
+    }
+    if (result == READ_CLOSED) {
+      return resp;
+    }
+    throw_logic_error("failed to execute request to " << host_ << ":" << port_);
+  }
 }
 
-void client::connect(tcp::socket &stream)
+bool client::connect(tcp::socket &stream)
 {
-  tcp::resolver resolver;
-  auto endpoints = resolver.resolve(host_, port_);
+  auto endpoints = pool_->endpoints(host_, port_);
   for (const auto &endpoint : endpoints) {
-    auto ret = matador::connect(stream, endpoint);
-    if (ret != 0) {
+    if (!connect(stream, endpoint)) {
       if (errno > 0) {
         char error_buffer[1024];
         log_.error("couldn't establish connection to: %s (%s)", endpoint.to_string().c_str(), os::strerror(errno, error_buffer, 1024));
@@ -90,67 +211,122 @@ void client::connect(tcp::socket &stream)
       continue;
     } else {
       log_.info("connection established to %s (fd: %d)", endpoint.to_string().c_str(), stream.id());
-      break;
+      return true;
+    }
+  }
+  // the host may have moved
+  pool_->invalidate_endpoints(host_, port_);
+  return false;
+}
+
+bool client::connect(tcp::socket &stream, const tcp::peer &endpoint)
+{
+  tcp::socket sock;
+  if (!is_valid_socket(sock.open(endpoint.protocol()))) {
+    return false;
+  }
+  if (connect_timeout_ == std::chrono::milliseconds::zero()) {
+    if (!sock.connect(endpoint)) {
+      sock.close();
+      return false;
     }
+    stream = sock;
+    return true;
+  }
+
+  // connect non blocking to be able to give up after the timeout
+  sock.non_blocking(true);
+  if (!sock.connect(endpoint) && (!connect_in_progress() || !wait_until_connected(sock, connect_timeout_))) {
+    const auto error = errno;
+    sock.close();
+    errno = error;
+    return false;
   }
+  sock.non_blocking(false);
+  stream = sock;
+  return true;
+}
+
+void client::apply_timeouts(tcp::socket &stream)
+{
+#ifdef _WIN32
+  DWORD timeout = static_cast<DWORD>(read_timeout_.count());
+#else
+  struct timeval timeout{};
+  timeout.tv_sec = static_cast<time_t>(read_timeout_.count() / 1000);
+  timeout.tv_usec = static_cast<suseconds_t>((read_timeout_.count() % 1000) * 1000);
+#endif
+  setsockopt(stream.id(), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+  setsockopt(stream.id(), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
 }
 
-void client::send_request(tcp::socket &stream, const request &req)
+bool client::send_request(tcp::socket &stream, const request &req)
 {
   ssize_t bytes_total = 0;
   auto buffer_list = req.to_buffers();
   while  (!buffer_list.empty()) {
-    buffer_view &bv = buffer_list.front();
-
-    auto len = stream.send(bv);
+    auto len = stream.send(buffer_list);
     log_.trace("%s: sent %d bytes", host_.c_str(), len);
 
-    if (len == 0) {
-      stream.close();
-      return;
-    } else if (len < 0 && errno != EWOULDBLOCK) {
+    if (len < 0) {
+      // the socket is blocking; a blocked write timed out
       char error_buffer[1024];
-      log_.error("%s: error on write: %s", host_.c_str(), os::strerror(errno, error_buffer, 1024));
+      log_.error("%s: error on write: %s", host_.c_str(), is_timeout() ? "timeout" : os::strerror(errno, error_buffer, 1024));
       stream.close();
-      return;
-    } else if (len < 0 && errno == EWOULDBLOCK) {
-      log_.debug("%s: sent %d bytes (blocked)", host_.c_str(), bytes_total);
+      return false;
     } else {
       bytes_total += len;
-      bv.bump(len);
-      if (bv.full()) {
-        buffer_list.pop_front();
-      }
     }
   }
+  log_.trace("%s: sent request (%d bytes)", host_.c_str(), bytes_total);
+  return true;
 }
 
-void client::read_response(tcp::socket &stream, response &resp)
+client::read_result_t client::read_response(tcp::socket &stream, response &resp)
 {
   response_parser::return_t parse_result{};
   response_parser parser;
+  std::size_t bytes_total = 0;
   do {
     buffer result;
     auto nread = stream.receive(result);
     if (nread == 0) {
       stream.close();
-      return;
+      return bytes_total > 0 ? READ_CLOSED : READ_NOTHING;
     } else if (nread < 0) {
       char error_buffer[1024];
-      log_.error("%s: error on read: %s", host_.c_str(), os::strerror(errno, error_buffer, 1024));
+      const bool timeout = is_timeout();
+      log_.error("%s: error on read: %s", host_.c_str(), timeout ? "timeout" : os::strerror(errno, error_buffer, 1024));
       stream.close();
-      return;
+      // a reset connection is treated like a closed one
+      return bytes_total == 0 && !timeout ? READ_NOTHING : READ_FAILED;
     } else {
+      bytes_total += static_cast<std::size_t>(nread);
       std::string msg(result.data(), nread);
 
       parse_result = parser.parse(msg, resp);
       if (parse_result == matador::http::response_parser::INVALID) {
         resp = response::bad_request();
-        break;
+        stream.close();
+        return READ_FINISHED;
       }
     }
   } while (parse_result != matador::http::response_parser::FINISH);
+  return READ_FINISHED;
+}
+
+bool client::is_reusable(const response &resp)
+{
+  // only a body delimited by its length leaves
+  // the connection at the start of the next response
+  auto it = resp.headers().find(response_header::CONTENT_LENGTH);
+  if (it == resp.headers().end() || std::to_string(resp.body().size()) != resp.content().length) {
+    return false;
+  }
+  it = resp.headers().find(response_header::CONNECTION);
+  const string_span connection = it != resp.headers().end() ? string_span(it->second) : string_span();
+  return detail::is_persistent_connection(connection, resp.version().major, resp.version().minor);
 }
 
 }
-}
\ No newline at end of file
+}
@@ -34,7 +34,10 @@ void server::run()
   log_.info("serving content at http://localhost:%d", acceptor_->endpoint().port());
   service_.accept(acceptor_, [this](tcp::peer ep, io_stream &stream) {
     // create echo server connection
-    auto conn = std::make_shared<http_server_connection>(pipeline_, stream, std::move(ep));
+    auto conn = std::make_shared<http_server_connection>(pipeline_, stream, std::move(ep),
+                                                         keep_alive_timeout_, max_keep_alive_requests_);
+    conn->body_settings(router_, max_body_size_);
+    conn->max_header_size(max_header_size_);
     conn->start();
   });
   service_.run();
@@ -59,5 +62,45 @@ void server::add_routing_middleware()
 {
   pipeline_.add(std::make_shared<middlewares::routing_middleware>(router_));
 }
+
+void server::keep_alive_timeout(std::chrono::milliseconds timeout)
+{
+  keep_alive_timeout_ = timeout;
+}
+
+std::chrono::milliseconds server::keep_alive_timeout() const
+{
+  return keep_alive_timeout_;
+}
+
+void server::max_keep_alive_requests(std::size_t max_requests)
+{
+  max_keep_alive_requests_ = max_requests;
+}
+
+std::size_t server::max_keep_alive_requests() const
+{
+  return max_keep_alive_requests_;
+}
+
+void server::max_body_size(std::size_t max_size)
+{
+  max_body_size_ = max_size;
+}
+
+std::size_t server::max_body_size() const
+{
+  return max_body_size_;
+}
+
+void server::max_header_size(std::size_t max_size)
+{
+  max_header_size_ = max_size;
+}
+
+std::size_t server::max_header_size() const
+{
+  return max_header_size_;
+}
 }
 }
@@ -1,5 +1,8 @@
 #include "matador/http/http_server_connection.hpp"
 #include "matador/http/request.hpp"
+#include "matador/http/response_header.hpp"
+
+#include "matador/http/detail/header_value.hpp"
 
 #include "matador/logger/log_manager.hpp"
 
@@ -8,73 +11,371 @@
 #include "matador/utils/os.hpp"
 #include "matador/utils/buffer_view.hpp"
 
+#include <cstdio>
+
 namespace matador {
 namespace http {
 
 http_server_connection::http_server_connection(middleware_pipeline &pipeline, io_stream &stream, matador::tcp::peer endpoint)
+  : http_server_connection(pipeline, stream, std::move(endpoint), std::chrono::milliseconds::zero(), 1)
+{}
+
+http_server_connection::http_server_connection(middleware_pipeline &pipeline, io_stream &stream, matador::tcp::peer endpoint,
+                                               std::chrono::milliseconds keep_alive_timeout, std::size_t max_requests)
   : log_(matador::create_logger("HttpServerConnection"))
   , stream_(stream)
   , endpoint_(std::move(endpoint))
   , pipeline_(pipeline)
+  , keep_alive_timeout_(keep_alive_timeout)
+  , max_requests_(max_requests)
 {}
 
+void http_server_connection::body_settings(const routing_engine &router, std::size_t max_body_size)
+{
+  router_ = &router;
+  max_body_size_ = max_body_size;
+}
+
+void http_server_connection::max_header_size(std::size_t max_size)
+{
+  max_header_size_ = max_size;
+}
+
 void http_server_connection::start()
 {
+  // an idle persistent connection is
+  // closed after the keep alive timeout
+  stream_.read_timeout(keep_alive_timeout_);
   read();
 }
 
 void http_server_connection::read()
 {
   auto self(shared_from_this());
-  stream_.read(matador::buffer_view(buf_), [this, self](int ec, int nread) {
+  stream_.read(input_, [this, self](int ec, long) {
     if (ec == 0) {
-      std::string request_string(buf_.data(), nread);
-      // parse request and prepare response
-      log_.trace("%s: request [%s]", stream_.name().c_str(), request_string.c_str());
-      auto result = parser_.parse(request_string, request_);
-
-      if (result == request_parser::FINISH) {
-        log_.info(
-          "%s: %s %s HTTP/%d.%d",
-          stream_.name().c_str(),
-          http::to_string(request_.method()).c_str(),
-          request_.url().c_str(),
-          request_.version().major,
-          request_.version().minor
-        );
-
-        response_ = process(request_);
-
-        parser_.reset();
-        write();
-      } else if (result == request_parser::INVALID) {
-        log_.debug("invalid request; returning bad request");
-        response_ = response::bad_request();
-        write();
-      } else {
-        // not all data read
-        log_.debug("not all data was read; continue reading");
-        this->
-        read();
+      handle_input();
+    }
+  });
+}
+
+void http_server_connection::handle_input()
+{
+  if (input_.empty()) {
+    read();
+    return;
+  }
+  if (body_state_ != NO_BODY) {
+    handle_body();
+    return;
+  }
+  // the header is parsed in place; only a header
+  // spanning more than one segment is copied
+  const char *data = nullptr;
+  std::size_t size = 0;
+  if (input_.slices().size() == 1 && linear_input_.empty()) {
+    data = input_.slices().front().data();
+    size = input_.slices().front().size();
+  } else {
+    // only the bytes read since the last
+    // partial parse are appended
+    append_linear_input();
+    data = linear_input_.data();
+    size = linear_input_.size();
+  }
+  // the input may contain more than one (pipelined)
+  // request; only the first one is handled here, the
+  // next one after its response was written
+  auto result = parser_.parse_view_header(data, size, view_);
+
+  // a peer never finishing its header must
+  // not grow the input without bound
+  const auto header_size = result == request_parser::FINISH ? parser_.consumed() : size;
+  if (result != request_parser::INVALID && header_size > max_header_size_) {
+    log_.debug("request header exceeds %lu bytes; rejecting request", static_cast<unsigned long>(max_header_size_));
+    reject(response::request_header_fields_too_large());
+    return;
+  }
+
+  if (result == request_parser::FINISH) {
+    log_.info(
+      "%s: %s %.*s HTTP/%d.%d",
+      stream_.name().c_str(),
+      http::to_string(view_.method()).c_str(),
+      static_cast<int>(view_.url().size()), view_.url().data(),
+      view_.version().major,
+      view_.version().minor
+    );
+
+    ++requests_;
+    keep_alive_ = is_keep_alive(view_) && requests_ < max_requests_;
+    // chunked transfer encoding needs HTTP/1.1
+    chunked_ = view_.version().major > 1 || (view_.version().major == 1 && view_.version().minor >= 1);
+    // a chunked body has no content length
+    body_state_ = is_chunked(view_) ? CHUNKED_BODY : (view_.content_length() > 0 ? LENGTH_BODY : NO_BODY);
+    body_remaining_ = body_state_ == LENGTH_BODY ? view_.content_length() : 0;
+    body_size_ = 0;
+    body_too_large_ = false;
+    request_ = view_.to_request();
+    view_.clear();
+    input_.consume(parser_.consumed());
+    linear_input_.clear();
+    parser_.reset();
 
+    if (body_state_ == NO_BODY) {
+      dispatch();
+      return;
+    }
+    if (body_remaining_ > max_body_size_) {
+      // reject before a single byte of the body is read
+      reject(response::payload_too_large());
+      return;
+    }
+    if (router_ != nullptr) {
+      auto route = router_->match(request_);
+      if (router_->valid(route) && (*route)->streams_body()) {
+        body_consumer_ = (*route)->create_body_consumer(request_);
       }
     }
-  });
+    handle_body();
+  } else if (result == request_parser::INVALID) {
+    log_.debug("invalid request; returning bad request");
+    reject(response::bad_request());
+  } else {
+    // not all data read
+    log_.debug("not all data was read; continue reading");
+    read();
+  }
+}
+
+void http_server_connection::append_linear_input()
+{
+  std::size_t skip = linear_input_.size();
+  for (const auto &slice : input_.slices()) {
+    if (skip >= slice.size()) {
+      skip -= slice.size();
+      continue;
+    }
+    linear_input_.append(slice.data() + skip, slice.size() - skip);
+    skip = 0;
+  }
+}
+
+void http_server_connection::handle_body()
+{
+  // the body is passed on segment by segment
+  // without copying it into a linear buffer
+  std::size_t used = 0;
+  auto result = request_parser::PARTIAL;
+  for (const auto &slice : input_.slices()) {
+    if (body_state_ == LENGTH_BODY) {
+      const auto len = (std::min)(body_remaining_, slice.size());
+      used += len;
+      if (!consume_body(slice.data(), len)) {
+        result = request_parser::INVALID;
+        break;
+      }
+      body_remaining_ -= len;
+      if (body_remaining_ == 0) {
+        result = request_parser::FINISH;
+        break;
+      }
+    } else {
+      result = parser_.parse_chunked_body(slice.data(), slice.size(), [this](const char *data, std::size_t size) {
+        return consume_body(data, size);
+      });
+      used += parser_.consumed();
+      if (result != request_parser::PARTIAL) {
+        break;
+      }
+    }
+  }
+
+  if (result == request_parser::INVALID) {
+    log_.debug("invalid request body; rejecting request");
+    reject(body_too_large_ ? response::payload_too_large() : response::bad_request());
+    return;
+  }
+
+  input_.consume(used);
+  if (result == request_parser::PARTIAL) {
+    read();
+    return;
+  }
+
+  body_state_ = NO_BODY;
+  parser_.reset();
+  if (body_consumer_) {
+    auto consumer = std::move(body_consumer_);
+    body_consumer_ = nullptr;
+    if (!consumer(nullptr, 0)) {
+      reject(response::bad_request());
+      return;
+    }
+  } else {
+    parser_.process_body(request_);
+  }
+  dispatch();
+}
+
+bool http_server_connection::consume_body(const char *data, std::size_t size)
+{
+  body_size_ += size;
+  if (body_size_ > max_body_size_) {
+    body_too_large_ = true;
+    return false;
+  }
+  if (body_consumer_) {
+    return body_consumer_(data, size);
+  }
+  request_.body_.append(data, size);
+  return true;
+}
+
+void http_server_connection::dispatch()
+{
+  response_ = process(request_);
+  request_ = request();
+  write();
+}
+
+void http_server_connection::reject(response resp)
+{
+  // the rest of the input can't be
+  // trusted, the connection is closed
+  input_.clear();
+  linear_input_.clear();
+  view_.clear();
+  parser_.reset();
+  body_state_ = NO_BODY;
+  body_consumer_ = nullptr;
+  request_ = request();
+  keep_alive_ = false;
+  response_ = std::move(resp);
+  write();
 }
 
 void http_server_connection::write()
 {
   auto self(shared_from_this());
 
+  if (response_.body_producer() && !chunked_) {
+    // HTTP/1.0 clients get the plain body
+    // delimited by closing the connection
+    response_.remove_header(response_header::TRANSFER_ENCODING);
+    keep_alive_ = false;
+  }
+
+  response_.remove_header(response_header::CONNECTION);
+  response_.add_header(response_header::CONNECTION, keep_alive_ ? "keep-alive" : "close");
+
   std::list<buffer_view> data = response_.to_buffers();
 
-  stream_.write(std::move(data), [this, self](int ec, int) {
-    if (ec == 0) {
-      stream_.close_stream();
+  auto on_written = [this, self](int ec, long) {
+    if (ec != 0) {
+      return;
+    }
+    if (response_.body_producer()) {
+      write_chunk();
+    } else {
+      finish_response();
+    }
+  };
+  if (response_.body_file()) {
+    stream_.write(std::move(data), response_.body_file(), on_written);
+  } else {
+    stream_.write(std::move(data), on_written);
+  }
+}
+
+void http_server_connection::write_chunk()
+{
+  auto self(shared_from_this());
+
+  // the producer is called only after the previous
+  // chunk was written completely; a slow client
+  // therefore throttles the producer
+  bool more = true;
+  chunk_.clear();
+  try {
+    while (chunk_.empty() && more) {
+      more = response_.body_producer()(chunk_);
+    }
+  } catch (std::exception &ex) {
+    // the header is already sent, the only way
+    // to signal the error is to abort the body
+    log_.error("%s: producing response body failed: %s", stream_.name().c_str(), ex.what());
+    stream_.close_stream();
+    return;
+  }
+
+  std::list<buffer_view> data;
+  if (chunked_) {
+    static const char crlf[] = "\r\n";
+    static const char last_chunk[] = "0\r\n\r\n";
+    if (!chunk_.empty()) {
+      char size[2 * sizeof(std::size_t) + 3];
+      auto len = std::snprintf(size, sizeof(size), "%zx\r\n", chunk_.size());
+      chunk_header_.assign(size, static_cast<std::size_t>(len));
+      data.emplace_back(chunk_header_);
+      data.emplace_back(chunk_);
+      data.emplace_back(crlf, 2);
+    }
+    if (!more) {
+      data.emplace_back(last_chunk, 5);
+    }
+  } else if (!chunk_.empty()) {
+    data.emplace_back(chunk_);
+  }
+
+  if (data.empty()) {
+    finish_response();
+    return;
+  }
+
+  stream_.write(std::move(data), [this, self, more](int ec, long) {
+    if (ec != 0) {
+      return;
+    }
+    if (more) {
+      write_chunk();
+    } else {
+      finish_response();
     }
   });
 }
 
+void http_server_connection::finish_response()
+{
+  if (!keep_alive_) {
+    stream_.close_stream();
+    return;
+  }
+  response_ = response();
+  chunk_.clear();
+  if (input_.empty()) {
+    read();
+  } else {
+    // next pipelined request is already read
+    handle_input();
+  }
+}
+
+bool http_server_connection::is_chunked(const request_view &req)
+{
+  // chunked is always the last transfer coding
+  auto value = req.header(request_view::TRANSFER_ENCODING);
+  while (!value.empty() && (value[value.size() - 1] == ' ' || value[value.size() - 1] == '\t')) {
+    value = value.substr(0, value.size() - 1);
+  }
+  return value.size() >= 7 && value.substr(value.size() - 7).iequals("chunked");
+}
+
+bool http_server_connection::is_keep_alive(const request_view &req)
+{
+  return detail::is_persistent_connection(req.header(request_view::CONNECTION), req.version().major, req.version().minor);
+}
+
 response http_server_connection::process(request &req) const
 {
   return pipeline_.process(req);
@@ -0,0 +1,334 @@
+#include "matador/http/middleware/compression_middleware.hpp"
+
+#include "matador/http/request.hpp"
+#include "matador/http/request_header.hpp"
+#include "matador/http/response_header.hpp"
+
+#include "matador/net/file_body.hpp"
+
+#include "matador/utils/string_span.hpp"
+
+#include <cstdlib>
+
+#include <zlib.h>
+
+namespace matador {
+namespace http {
+namespace middlewares {
+
+namespace {
+
+/*
+ * Incremental deflate stream writing
+ * gzip (window bits + 16) or zlib format
+ */
+class deflater
+{
+public:
+  deflater(compression_middleware::encoding_t encoding, int level)
+  {
+    const int window_bits = encoding == compression_middleware::GZIP ? 15 + 16 : 15;
+    valid_ = deflateInit2(&stream_, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+  }
+
+  deflater(const deflater&) = delete;
+  deflater& operator=(const deflater&) = delete;
+
+  ~deflater()
+  {
+    if (valid_) {
+      deflateEnd(&stream_);
+    }
+  }
+
+  bool deflate(const char *data, std::size_t size, int flush, std::string &out)
+  {
+    if (!valid_) {
+      return false;
+    }
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream_.avail_in = static_cast<uInt>(size);
+    do {
+      const auto pos = out.size();
+      const auto chunk = (std::max)(static_cast<std::size_t>(deflateBound(&stream_, stream_.avail_in)), std::size_t(64));
+      out.resize(pos + chunk);
+      stream_.next_out = reinterpret_cast<Bytef*>(&out[pos]);
+      stream_.avail_out = static_cast<uInt>(chunk);
+      const auto ret = ::deflate(&stream_, flush);
+      out.resize(pos + chunk - stream_.avail_out);
+      if (ret == Z_STREAM_ERROR) {
+        return false;
+      }
+      if (ret == Z_STREAM_END) {
+        return true;
+      }
+    } while (stream_.avail_out == 0 || stream_.avail_in > 0);
+    return true;
+  }
+
+private:
+  z_stream stream_{};
+  bool valid_ = false;
+};
+
+void add_vary(response &resp)
+{
+  auto it = resp.headers().find(response_header::VARY);
+  if (it == resp.headers().end()) {
+    resp.add_header(response_header::VARY, request_header::ACCEPT_ENCODING);
+    return;
+  }
+  std::string value = it->second;
+  if (value.find(request_header::ACCEPT_ENCODING) == std::string::npos && value != "*") {
+    value += std::string(", ") + request_header::ACCEPT_ENCODING;
+    resp.remove_header(response_header::VARY);
+    resp.add_header(response_header::VARY, value);
+  }
+}
+
+void set_encoding(response &resp, compression_middleware::encoding_t encoding)
+{
+  resp.add_header(response_header::CONTENT_ENCODING, encoding == compression_middleware::GZIP ? "gzip" : "deflate");
+  // the compressed representation isn't byte
+  // for byte the one the strong tag was made for
+  auto it = resp.headers().find(response_header::ETAG);
+  if (it != resp.headers().end() && it->second.compare(0, 2, "W/") != 0) {
+    const auto etag = "W/" + it->second;
+    resp.remove_header(response_header::ETAG);
+    resp.add_header(response_header::ETAG, etag);
+  }
+}
+
+}
+
+compression_middleware::compression_middleware(int level, std::size_t min_size)
+  : level_(level)
+  , min_size_(min_size)
+  , mime_types_({ "text/", "application/json", "application/javascript", "application/xml", "image/svg+xml" })
+{}
+
+response compression_middleware::process(request &req, const next_func_t &next)
+{
+  auto resp = next();
+
+  if (resp.headers().count(response_header::CONTENT_ENCODING) > 0 || !is_compressible(resp.content().type)) {
+    return resp;
+  }
+  add_vary(resp);
+
+  auto it = req.headers().find(request_header::ACCEPT_ENCODING);
+  const auto encoding = it != req.headers().end() ? negotiate(it->second) : IDENTITY;
+  if (encoding == IDENTITY) {
+    return resp;
+  }
+
+  if (resp.body_producer()) {
+    auto stream = std::make_shared<deflater>(encoding, level_);
+    auto producer = resp.body_producer();
+    resp.body_producer([stream, producer](std::string &chunk) {
+      std::string data;
+      const bool more = producer(data);
+      // each chunk is flushed to keep the body streaming
+      if (!stream->deflate(data.data(), data.size(), more ? Z_SYNC_FLUSH : Z_FINISH, chunk)) {
+        throw std::runtime_error("couldn't compress response body");
+      }
+      return more;
+    });
+    set_encoding(resp, encoding);
+  } else if (resp.body_file()) {
+    if (encoding != GZIP || !precompressed_) {
+      return resp;
+    }
+    auto file = std::make_shared<file_body>(resp.body_file()->path() + ".gz");
+    if (file->is_open()) {
+      resp.body_file(file);
+      set_encoding(resp, encoding);
+    }
+  } else if (resp.body().size() >= min_size_) {
+    if (resp.shared_body()) {
+      auto compressed = compress_shared(resp.shared_body(), encoding);
+      if (compressed) {
+        resp.body(compressed);
+        set_encoding(resp, encoding);
+      }
+    } else {
+      std::string compressed;
+      if (compress(resp.body().data(), resp.body().size(), encoding, level_, compressed)) {
+        resp.body(std::move(compressed));
+        set_encoding(resp, encoding);
+      }
+    }
+  }
+  return resp;
+}
+
+void compression_middleware::level(int level)
+{
+  level_ = level;
+}
+
+int compression_middleware::level() const
+{
+  return level_;
+}
+
+void compression_middleware::min_size(std::size_t min_size)
+{
+  min_size_ = min_size;
+}
+
+std::size_t compression_middleware::min_size() const
+{
+  return min_size_;
+}
+
+void compression_middleware::add_mime_type(const std::string &type)
+{
+  mime_types_.push_back(type);
+}
+
+bool compression_middleware::is_compressible(const std::string &content_type) const
+{
+  // parameters like the charset are ignored
+  const auto type = string_span(content_type).substr(0, content_type.find(';')).trim();
+  for (const auto &mime_type : mime_types_) {
+    if (mime_type.back() == '/') {
+      if (type.size() > mime_type.size() && type.substr(0, mime_type.size()).iequals(mime_type)) {
+        return true;
+      }
+    } else if (type.iequals(mime_type)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void compression_middleware::precompressed(bool enable)
+{
+  precompressed_ = enable;
+}
+
+void compression_middleware::max_cache_size(std::size_t max_size)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_cache_size_ = max_size;
+}
+
+std::size_t compression_middleware::cache_size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cache_size_;
+}
+
+compression_middleware::encoding_t compression_middleware::negotiate(const std::string &accept_encoding)
+{
+  // quality values of gzip, deflate and
+  // the wildcard; -1 if not listed
+  double gzip = -1.0;
+  double deflate = -1.0;
+  double any = -1.0;
+
+  const string_span value(accept_encoding);
+  std::size_t begin = 0;
+  while (begin < value.size()) {
+    auto end = value.find(',', begin);
+    if (end == std::string::npos) {
+      end = value.size();
+    }
+    auto coding = value.substr(begin, end - begin).trim();
+    double quality = 1.0;
+    const auto params = coding.find(';');
+    if (params != std::string::npos) {
+      auto q = coding.substr(params + 1).trim();
+      if (q.size() > 2 && (q[0] == 'q' || q[0] == 'Q') && q[1] == '=') {
+        quality = std::strtod(q.substr(2).to_string().c_str(), nullptr);
+      }
+      coding = coding.substr(0, params).trim();
+    }
+    if (coding.iequals("gzip") || coding.iequals("x-gzip")) {
+      gzip = quality;
+    } else if (coding.iequals("deflate")) {
+      deflate = quality;
+    } else if (coding == "*") {
+      any = quality;
+    }
+    begin = end + 1;
+  }
+
+  if (gzip < 0.0) {
+    gzip = any;
+  }
+  if (deflate < 0.0) {
+    deflate = any;
+  }
+  if (gzip > 0.0 && gzip >= deflate) {
+    return GZIP;
+  }
+  return deflate > 0.0 ? DEFLATE : IDENTITY;
+}
+
+bool compression_middleware::compress(const char *data, std::size_t size, encoding_t encoding, int level, std::string &out)
+{
+  out.clear();
+  if (encoding == IDENTITY) {
+    return false;
+  }
+  deflater stream(encoding, level);
+  return stream.deflate(data, size, Z_FINISH, out);
+}
+
+std::shared_ptr<const std::string> compression_middleware::compress_shared(const std::shared_ptr<const std::string> &body, encoding_t encoding)
+{
+  const t_cache_key key(body.get(), encoding);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_map_.find(key);
+    if (it != cache_map_.end()) {
+      // the address may be reused by another body
+      if (it->second->second.source.lock() == body) {
+        cache_.splice(cache_.begin(), cache_, it->second);
+        return it->second->second.compressed;
+      }
+      cache_size_ -= it->second->second.compressed->size();
+      cache_.erase(it->second);
+      cache_map_.erase(it);
+    }
+  }
+
+  auto compressed = std::make_shared<std::string>();
+  if (!compress(body->data(), body->size(), encoding, level_, *compressed)) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (compressed->size() > max_cache_size_ || cache_map_.count(key) > 0) {
+    return compressed;
+  }
+  cache_entry entry;
+  entry.source = body;
+  entry.compressed = compressed;
+  cache_.emplace_front(key, entry);
+  cache_map_.insert(std::make_pair(key, cache_.begin()));
+  cache_size_ += compressed->size();
+
+  // bodies which are gone are evicted first
+  for (auto i = cache_.begin(); i != cache_.end() && cache_size_ > max_cache_size_;) {
+    if (i->second.source.expired()) {
+      cache_size_ -= i->second.compressed->size();
+      cache_map_.erase(i->first);
+      i = cache_.erase(i);
+    } else {
+      ++i;
+    }
+  }
+  while (cache_size_ > max_cache_size_ && cache_.size() > 1) {
+    cache_size_ -= cache_.back().second.compressed->size();
+    cache_map_.erase(cache_.back().first);
+    cache_.pop_back();
+  }
+  return compressed;
+}
+
+}
+}
+}
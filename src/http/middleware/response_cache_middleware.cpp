@@ -0,0 +1,337 @@
+#include "matador/http/middleware/response_cache_middleware.hpp"
+
+#include "matador/http/request.hpp"
+#include "matador/http/request_header.hpp"
+#include "matador/http/response_header.hpp"
+
+#include "matador/http/detail/header_value.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace matador {
+namespace http {
+namespace middlewares {
+
+namespace {
+
+const std::string* find_header(const t_string_param_map &headers, const char *name)
+{
+  auto it = headers.find(name);
+  return it != headers.end() ? &it->second : nullptr;
+}
+
+std::size_t entry_size(const std::string &key, const response &resp)
+{
+  std::size_t size = key.size() + resp.body().size();
+  for (const auto &header : resp.headers()) {
+    size += header.first.size() + header.second.size();
+  }
+  return size;
+}
+
+}
+
+response_cache_middleware::response_cache_middleware(std::chrono::milliseconds ttl, std::size_t max_size)
+  : default_ttl_(ttl)
+  , max_size_(max_size)
+{}
+
+response response_cache_middleware::process(request &req, const next_func_t &next)
+{
+  if (!is_cacheable(req)) {
+    return next();
+  }
+  const auto path = req.url();
+  const auto route_ttl = ttl(path);
+  if (route_ttl.count() <= 0) {
+    return next();
+  }
+
+  const auto *cache_control = find_header(req.headers(), request_header::CACHE_CONTROL);
+  const bool refresh = cache_control != nullptr && cache_control->find("no-cache") != std::string::npos;
+
+  const auto k = key(req);
+  std::shared_ptr<pending> p;
+  bool leader = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entry_map_.find(k);
+    if (it != entry_map_.end() && !refresh) {
+      auto e = it->second;
+      if (e->expires > std::chrono::steady_clock::now()) {
+        // most recently used first
+        entries_.splice(entries_.begin(), entries_, e);
+        return serve(req, e->resp, e->etag);
+      }
+      remove(e);
+    }
+    auto pit = pending_.find(k);
+    if (pit == pending_.end()) {
+      p = std::make_shared<pending>();
+      pending_.emplace(k, p);
+      leader = true;
+    } else if (!refresh) {
+      p = pit->second;
+    }
+  }
+
+  if (p && !leader) {
+    std::unique_lock<std::mutex> lock(p->mutex);
+    p->ready.wait(lock, [&p]() { return p->done; });
+    if (p->cached) {
+      return serve(req, p->resp, p->etag);
+    }
+    lock.unlock();
+    // the response wasn't cacheable, it might
+    // depend on the request; run the handler
+    return next();
+  }
+
+  const auto finish = [this, &k, &p](bool cached, const response *resp, const std::string *etag) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.erase(k);
+    }
+    {
+      std::lock_guard<std::mutex> lock(p->mutex);
+      p->done = true;
+      p->cached = cached;
+      if (cached) {
+        p->resp = *resp;
+        p->etag = *etag;
+      }
+    }
+    p->ready.notify_all();
+  };
+
+  response resp;
+  try {
+    resp = next();
+  } catch (...) {
+    if (leader) {
+      finish(false, nullptr, nullptr);
+    }
+    throw;
+  }
+
+  const bool cached = is_cacheable(resp);
+  std::string tag;
+  if (cached) {
+    store(k, path, resp, tag, route_ttl);
+  }
+  if (leader) {
+    finish(cached, &resp, &tag);
+  }
+  return cached ? serve(req, resp, tag) : resp;
+}
+
+void response_cache_middleware::ttl(const std::string &route, std::chrono::milliseconds ttl)
+{
+  routes_.emplace_back(route, ttl);
+}
+
+std::chrono::milliseconds response_cache_middleware::ttl(const std::string &path) const
+{
+  for (const auto &route : routes_) {
+    const auto &r = route.first;
+    if (!r.empty() && r.back() == '*') {
+      if (path.compare(0, r.size() - 1, r, 0, r.size() - 1) == 0) {
+        return route.second;
+      }
+    } else if (path == r) {
+      return route.second;
+    }
+  }
+  return default_ttl_;
+}
+
+void response_cache_middleware::vary(const std::string &header)
+{
+  vary_.push_back(header);
+}
+
+void response_cache_middleware::max_size(std::size_t max_size)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_size_ = max_size;
+  while (size_ > max_size_ && !entries_.empty()) {
+    remove(std::prev(entries_.end()));
+  }
+}
+
+std::size_t response_cache_middleware::max_size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_size_;
+}
+
+std::size_t response_cache_middleware::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+std::size_t response_cache_middleware::count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void response_cache_middleware::invalidate(const std::string &path)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto current = it++;
+    if (current->path == path) {
+      remove(current);
+    }
+  }
+}
+
+void response_cache_middleware::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entry_map_.clear();
+  entries_.clear();
+  size_ = 0;
+}
+
+std::string response_cache_middleware::etag(const std::string &body)
+{
+  // FNV-1a
+  unsigned long long hash = 14695981039346656037ULL;
+  for (const auto c : body) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  char tag[64];
+  auto len = std::snprintf(tag, sizeof(tag), "\"%llx-%llx\"",
+                           static_cast<unsigned long long>(body.size()), hash);
+  return std::string(tag, static_cast<std::size_t>(len));
+}
+
+std::string response_cache_middleware::key(const request &req) const
+{
+  std::string k("GET ");
+  k.append(req.url());
+
+  // the order of the query parameters doesn't matter
+  std::vector<std::pair<std::string, std::string>> params(req.query_params().begin(), req.query_params().end());
+  std::sort(params.begin(), params.end());
+  char separator = '?';
+  for (const auto &param : params) {
+    k.push_back(separator);
+    k.append(param.first).push_back('=');
+    k.append(param.second);
+    separator = '&';
+  }
+
+  for (const auto &header : vary_) {
+    const auto *value = find_header(req.headers(), header.c_str());
+    k.push_back('\n');
+    k.append(header).push_back(':');
+    if (value != nullptr) {
+      k.append(*value);
+    }
+  }
+  return k;
+}
+
+bool response_cache_middleware::is_cacheable(const request &req) const
+{
+  if (req.method() != http::GET) {
+    return false;
+  }
+  // responses to authorized requests are only
+  // cached per value of the authorization header
+  if (req.headers().count(request_header::AUTHORIZATION) > 0) {
+    return std::find(vary_.begin(), vary_.end(), request_header::AUTHORIZATION) != vary_.end();
+  }
+  return true;
+}
+
+bool response_cache_middleware::is_cacheable(const response &resp)
+{
+  if (resp.status() != http::OK || resp.body_producer() || resp.body_file()) {
+    return false;
+  }
+  if (resp.headers().count(response_header::SET_COOKIE) > 0) {
+    return false;
+  }
+  const auto *cache_control = find_header(resp.headers(), response_header::CACHE_CONTROL);
+  return cache_control == nullptr ||
+         (cache_control->find("no-store") == std::string::npos && cache_control->find("private") == std::string::npos);
+}
+
+bool response_cache_middleware::is_not_modified(const request &req, const std::string &etag)
+{
+  const auto *if_none_match = find_header(req.headers(), request_header::IF_NONE_MATCH);
+  if (if_none_match == nullptr) {
+    return false;
+  }
+  return detail::match_entity_tag(*if_none_match, etag);
+}
+
+response response_cache_middleware::serve(const request &req, const response &resp, const std::string &etag)
+{
+  if (!is_not_modified(req, etag)) {
+    return resp;
+  }
+  auto not_modified = response::not_modified();
+  not_modified.add_header(response_header::ETAG, etag);
+  const auto *cache_control = find_header(resp.headers(), response_header::CACHE_CONTROL);
+  if (cache_control != nullptr) {
+    not_modified.add_header(response_header::CACHE_CONTROL, *cache_control);
+  }
+  return not_modified;
+}
+
+void response_cache_middleware::store(const std::string &key, const std::string &path, response &resp, std::string &etag, std::chrono::milliseconds ttl)
+{
+  const auto *tag = find_header(resp.headers(), response_header::ETAG);
+  if (tag != nullptr) {
+    etag = *tag;
+  } else {
+    etag = response_cache_middleware::etag(resp.body());
+    resp.add_header(response_header::ETAG, etag);
+  }
+  // the body is shared by all responses served from the cache
+  if (!resp.shared_body()) {
+    resp.body(std::make_shared<const std::string>(resp.body()));
+  }
+
+  entry e;
+  e.key = key;
+  e.path = path;
+  e.resp = resp;
+  e.etag = etag;
+  e.expires = std::chrono::steady_clock::now() + ttl;
+  e.size = entry_size(key, resp);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entry_map_.find(key);
+  if (it != entry_map_.end()) {
+    remove(it->second);
+  }
+  if (e.size > max_size_) {
+    return;
+  }
+  entries_.push_front(std::move(e));
+  entry_map_.emplace(key, entries_.begin());
+  size_ += entries_.front().size;
+  while (size_ > max_size_) {
+    remove(std::prev(entries_.end()));
+  }
+}
+
+void response_cache_middleware::remove(t_entry_list::iterator it)
+{
+  size_ -= it->size;
+  entry_map_.erase(it->key);
+  entries_.erase(it);
+}
+
+}
+}
+}
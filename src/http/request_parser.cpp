@@ -1,10 +1,11 @@
-#include "matador/logger/log_manager.hpp"
-
 #include "matador/http/request_parser.hpp"
 #include "matador/http/request.hpp"
+#include "matador/http/request_view.hpp"
 #include "matador/http/request_header.hpp"
 #include "matador/http/mime_types.hpp"
 
+#include "matador/http/detail/request_scanner.hpp"
+
 #if defined(_WIN32) || defined(_WIN64)
 #define snprintf _snprintf
 #define vsnprintf _vsnprintf
@@ -12,6 +13,10 @@
 #define strncasecmp _strnicmp
 #endif
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 using namespace std;
 
 namespace matador {
@@ -22,7 +27,6 @@ const std::size_t request_parser::HTTP_VERSION_PREFIX_LEN = strlen(request_parse
 
 request_parser::return_t request_parser::parse(const std::string &msg, request &req)
 {
-  logger log(create_logger("RequestParser"));
   /*
    * parse first line and extract
    * - http method
@@ -35,10 +39,18 @@ request_parser::return_t request_parser::parse(const std::string &msg, request &
    */
   return_t result = PARTIAL;
   http_prefix_index_ = 0;
+  consumed_ = msg.size();
   std::string::size_type pos = -1;
   if (state_ != BODY) {
     for (pos = 0; pos < msg.size(); ++pos) {
-      std::string::value_type c = msg.at(pos);
+      if (state_ == URL_PATH || state_ == HEADER_KEY || state_ == HEADER_VALUE) {
+        // take whole runs of plain characters at once
+        pos += take_run(msg.data() + pos, msg.data() + msg.size(), req);
+        if (pos == msg.size()) {
+          break;
+        }
+      }
+      std::string::value_type c = msg[pos];
       if (c == '\0') {
         return result;
       }
@@ -88,6 +100,8 @@ request_parser::return_t request_parser::parse(const std::string &msg, request &
           ret = parse_header_finish(c);
           if (ret) {
             finished = true;
+            // the content length is evaluated once per request
+            ret = parse_content_length(req.content_.length, content_length_);
           }
           break;
         default:
@@ -107,28 +121,29 @@ request_parser::return_t request_parser::parse(const std::string &msg, request &
    * content length (if available) or
    * available data
    */
+  consumed_ = result == FINISH ? pos + 1 : msg.size();
   if (state_ == BODY && (req.method() == http::POST || req.method() == http::PUT)) {
-    auto length = std::stoul(req.content_.length) - req.body_.size();
+    // without content length there is no body
+    auto length = content_length_ > req.body_.size() ? content_length_ - req.body_.size() : 0UL;
     ++pos;
     if (length > 0) {
-      //log_default(log_level::LVL_INFO, "RequestParser", "length: %d, pos+1: %d, msg.length: %d", length, pos + 1, msg.size());
-      // determine body size of message
-      auto remaining_msg_size = msg.size() - pos;
-      req.body_.append(msg.substr(pos, remaining_msg_size));
+      // take only the bytes of this request; following
+      // data belongs to the next (pipelined) request
+      auto remaining_msg_size = (std::min)(msg.size() - pos, length);
+      req.body_.append(msg, pos, remaining_msg_size);
+      pos += remaining_msg_size;
       if (remaining_msg_size == length) {
         process_body(req);
         state_ = METHOD;
         result = FINISH;
-      } else if (remaining_msg_size < length) {
-        result = PARTIAL;
       } else {
-        // should not happen
+        result = PARTIAL;
       }
-    } else if (msg.size() > pos) {
-      req.body_.assign(msg.substr(pos));
+    } else {
       state_ = METHOD;
       result = FINISH;
     }
+    consumed_ = pos;
 //    auto length = std::stoul(req.content_.length);
 //    log.info("length: %d, pos+1: %d, msg.length: %d", length, pos+1, msg.size());
 //    if (length > 0) {
@@ -400,6 +415,47 @@ bool request_parser::parse_header_finish(char c)
   return header_finished;
 }
 
+std::size_t request_parser::take_run(const char *begin, const char *end, request &req)
+{
+  const char *stop = begin;
+  if (state_ == URL_PATH) {
+    stop = detail::find_non_url_char(begin, end);
+    // the query is parsed char by char
+    auto query = static_cast<const char*>(std::memchr(begin, '?', static_cast<std::size_t>(stop - begin)));
+    if (query != nullptr) {
+      stop = query;
+    }
+    req.url_.append(begin, stop);
+  } else if (state_ == HEADER_KEY) {
+    stop = detail::find_non_token_char(begin, end);
+    current_key_.append(begin, stop);
+  } else if (state_ == HEADER_VALUE) {
+    // the run ends at the latest with the CR of the line;
+    // blanks are only added if followed by more content
+    stop = detail::find_non_value_char(begin, end);
+    const char *p = begin;
+    while (p != stop) {
+      const char *blank = p;
+      while (blank != stop && *blank != ' ' && *blank != '\t') {
+        ++blank;
+      }
+      if (blank != p) {
+        if (!blanks_.empty() && !skip_blanks_) {
+          current_value_.append(blanks_);
+        }
+        blanks_.clear();
+        skip_blanks_ = false;
+        current_value_.append(p, blank);
+        p = blank;
+      }
+      while (p != stop && (*p == ' ' || *p == '\t')) {
+        blanks_.push_back(*p++);
+      }
+    }
+  }
+  return static_cast<std::size_t>(stop - begin);
+}
+
 bool request_parser::is_url_char(char c) const
 {
   return isalnum(c) || strchr(URL_SPECIAL_CHAR, c) != nullptr;
@@ -412,7 +468,11 @@ bool request_parser::is_hex_char(char c) const
 
 void request_parser::insert_header(const std::string &key, const std::string &value, request &req)
 {
-  req.headers_.insert(std::make_pair(key, value));
+  insert_header(std::string(key), std::string(value), req);
+}
+
+void request_parser::insert_header(std::string &&key, std::string &&value, request &req)
+{
   if (strcasecmp(key.c_str(), request_header::CONTENT_TYPE) == 0) {
     req.content_.type = value;
   } else if (strcasecmp(key.c_str(), request_header::CONTENT_LENGTH) == 0) {
@@ -422,6 +482,7 @@ void request_parser::insert_header(const std::string &key, const std::string &va
   } else if (strcasecmp(key.c_str(), request_header::HOST) == 0) {
     req.host_ = value;
   }
+  req.headers_.emplace(std::move(key), std::move(value));
 }
 
 void request_parser::apply_method(const std::string &method, request &req)
@@ -439,12 +500,17 @@ void request_parser::process_body(request &req)
 }
 
 bool request_parser::parse_form_data(request &req)
+{
+  return parse_params(req.body_, req.form_data_);
+}
+
+bool request_parser::parse_params(const string_span &data, t_string_param_map &params)
 {
   state_ = URL_QUERY_FIELD;
   std::string::size_type pos;
   bool ret = false;
-  for (pos = 0; pos < req.body_.size(); ++pos) {
-    std::string::value_type c = req.body_.at(pos);
+  for (pos = 0; pos < data.size(); ++pos) {
+    std::string::value_type c = data[pos];
     if (c == '\0') {
       break;
     }
@@ -455,7 +521,7 @@ bool request_parser::parse_form_data(request &req)
         ret = parse_url_query_field(c);
         break;
       case URL_QUERY_VALUE:
-        ret = parse_url_query_value(c, req.form_data_);
+        ret = parse_url_query_value(c, params);
         break;
       case VERSION:
         finished = true;
@@ -468,16 +534,385 @@ bool request_parser::parse_form_data(request &req)
     }
   }
   if (ret && !current_query_field_.empty()) {
-    req.form_data_.insert(std::make_pair(current_query_field_, current_query_value_));
+    params.insert(std::make_pair(current_query_field_, current_query_value_));
   }
   current_query_field_.clear();
-  current_query_field_.clear();
+  current_query_value_.clear();
   return ret;
 }
 
+request_parser::return_t request_parser::parse_view(const char *data, std::size_t size, request_view &req)
+{
+  auto result = parse_view_header(data, size, req);
+  if (result != FINISH) {
+    return result;
+  }
+  const auto header_size = consumed_;
+  if (size - header_size < req.content_length_) {
+    // header is complete but the body is missing; the
+    // next call finds the end of the header right away
+    scanned_ = header_size - 4;
+    consumed_ = 0;
+    return PARTIAL;
+  }
+  req.body_ = string_span(data + header_size, req.content_length_);
+  consumed_ = header_size + req.content_length_;
+  return FINISH;
+}
+
+request_parser::return_t request_parser::parse_view_header(const char *data, std::size_t size, request_view &req)
+{
+  consumed_ = 0;
+  // the last bytes of the previous call may
+  // be the beginning of the header end
+  const auto start = scanned_ > 3 ? scanned_ - 3 : 0;
+  const char *header_end = detail::find_header_end(data + (std::min)(start, size), data + size);
+  if (header_end == nullptr) {
+    scanned_ = size;
+    return PARTIAL;
+  }
+
+  req.clear();
+
+  const char *line = data;
+  const char *eol = static_cast<const char*>(std::memchr(line, '\r', static_cast<std::size_t>(header_end - line)));
+  if (eol == nullptr) {
+    eol = header_end;
+  }
+  if (eol[1] != '\n' || !parse_request_line(string_span(line, static_cast<std::size_t>(eol - line)), req)) {
+    return INVALID;
+  }
+
+  // each header line ends with the first character
+  // which isn't valid in a header value (CR)
+  for (line = eol + 2; line < header_end; line = eol + 2) {
+    eol = parse_header_line(line, header_end, req);
+    if (eol == nullptr) {
+      return INVALID;
+    }
+  }
+
+  if (!parse_content_length(req.header(request_view::CONTENT_LENGTH), req.content_length_)) {
+    return INVALID;
+  }
+
+  consumed_ = static_cast<std::size_t>(header_end - data) + 4;
+  scanned_ = 0;
+  return FINISH;
+}
+
+request_parser::return_t request_parser::parse_chunked_body(const char *data, std::size_t size,
+                                                            const std::function<bool(const char*, std::size_t)> &consumer)
+{
+  const char *pos = data;
+  const char *end = data + size;
+  while (pos != end) {
+    const char c = *pos;
+    switch (chunk_state_) {
+      case CHUNK_SIZE:
+        if (isxdigit(c)) {
+          // more than 15 hex digits would overflow the size
+          if (++chunk_digits_ > 2 * sizeof(std::size_t) - 1) {
+            return INVALID;
+          }
+          chunk_size_ = chunk_size_ * 16 + static_cast<std::size_t>(isdigit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+        } else if (chunk_digits_ > 0 && (c == ';' || c == ' ' || c == '\t')) {
+          chunk_state_ = CHUNK_EXTENSION;
+        } else if (chunk_digits_ > 0 && c == '\r') {
+          chunk_state_ = CHUNK_SIZE_NEWLINE;
+        } else {
+          return INVALID;
+        }
+        ++pos;
+        break;
+      case CHUNK_EXTENSION:
+        // chunk extensions are ignored
+        if (c == '\r') {
+          chunk_state_ = CHUNK_SIZE_NEWLINE;
+        }
+        ++pos;
+        break;
+      case CHUNK_SIZE_NEWLINE:
+        if (c != '\n') {
+          return INVALID;
+        }
+        chunk_state_ = chunk_size_ > 0 ? CHUNK_DATA : CHUNK_TRAILER;
+        ++pos;
+        break;
+      case CHUNK_DATA: {
+        const auto len = (std::min)(chunk_size_, static_cast<std::size_t>(end - pos));
+        if (!consumer(pos, len)) {
+          return INVALID;
+        }
+        pos += len;
+        chunk_size_ -= len;
+        if (chunk_size_ == 0) {
+          chunk_state_ = CHUNK_DATA_CR;
+        }
+        break;
+      }
+      case CHUNK_DATA_CR:
+        if (c != '\r') {
+          return INVALID;
+        }
+        chunk_state_ = CHUNK_DATA_NEWLINE;
+        ++pos;
+        break;
+      case CHUNK_DATA_NEWLINE:
+        if (c != '\n') {
+          return INVALID;
+        }
+        chunk_state_ = CHUNK_SIZE;
+        chunk_digits_ = 0;
+        ++pos;
+        break;
+      case CHUNK_TRAILER:
+        // trailer fields are ignored; an
+        // empty line ends the body
+        chunk_state_ = c == '\r' ? CHUNK_FINISH : CHUNK_TRAILER_LINE;
+        ++pos;
+        break;
+      case CHUNK_TRAILER_LINE:
+        if (c == '\r') {
+          chunk_state_ = CHUNK_TRAILER_NEWLINE;
+        }
+        ++pos;
+        break;
+      case CHUNK_TRAILER_NEWLINE:
+        if (c != '\n') {
+          return INVALID;
+        }
+        chunk_state_ = CHUNK_TRAILER;
+        ++pos;
+        break;
+      case CHUNK_FINISH:
+        if (c != '\n') {
+          return INVALID;
+        }
+        ++pos;
+        consumed_ = static_cast<std::size_t>(pos - data);
+        chunk_state_ = CHUNK_SIZE;
+        chunk_size_ = 0;
+        chunk_digits_ = 0;
+        return FINISH;
+    }
+  }
+  consumed_ = size;
+  return PARTIAL;
+}
+
+void request_parser::apply(const request_view &view, request &req)
+{
+  req.method_ = view.method();
+  req.url_ = view.url().to_string();
+  req.fragment_ = view.fragment().to_string();
+  req.version_ = view.version();
+
+  if (!view.query().empty()) {
+    parse_params(view.query(), req.query_params_);
+  }
+
+  req.headers_.reserve(view.headers().size());
+  for (const auto &field : view.headers()) {
+    if (std::memchr(field.value.data(), '\n', field.value.size()) == nullptr) {
+      insert_header(field.name.to_string(), field.value.to_string(), req);
+      continue;
+    }
+    // unfold values continued on the next line; the
+    // blanks around the line break are removed
+    std::string value;
+    value.reserve(field.value.size());
+    for (std::size_t i = 0; i < field.value.size(); ++i) {
+      const char c = field.value[i];
+      if (c == '\r' || c == '\n') {
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+          value.pop_back();
+        }
+        while (i + 1 < field.value.size() && strchr(" \t\r\n", field.value[i + 1]) != nullptr) {
+          ++i;
+        }
+      } else {
+        value.push_back(c);
+      }
+    }
+    insert_header(field.name.to_string(), std::move(value), req);
+  }
+
+  if (!view.body().empty()) {
+    req.body_ = view.body().to_string();
+    process_body(req);
+  }
+  state_ = METHOD;
+}
+
+bool request_parser::parse_request_line(const string_span &line, request_view &req) const
+{
+  // method
+  auto pos = line.find(' ');
+  if (pos == std::string::npos || pos == 0) {
+    return false;
+  }
+  for (std::size_t i = 0; i < pos; ++i) {
+    if (!isupper(line[i])) {
+      return false;
+    }
+  }
+  const auto method = line.substr(0, pos);
+  if (method == "GET") {
+    req.method_ = http::GET;
+  } else if (method == "POST") {
+    req.method_ = http::POST;
+  } else if (method == "PUT") {
+    req.method_ = http::PUT;
+  } else if (method == "DELETE") {
+    req.method_ = http::DEL;
+  } else if (method == "OPTIONS") {
+    req.method_ = http::OPTIONS;
+  } else if (method == "HEAD") {
+    req.method_ = http::HEAD;
+  } else {
+    req.method_ = http::UNKNOWN;
+  }
+
+  // url with optional query and fragment
+  const auto url_begin = pos + 1;
+  pos = line.find(' ', url_begin);
+  if (pos == std::string::npos || pos == url_begin) {
+    return false;
+  }
+  auto url = line.substr(url_begin, pos - url_begin);
+  if (detail::find_non_url_char(url.begin(), url.end()) != url.end()) {
+    return false;
+  }
+  const auto fragment_pos = url.find('#');
+  if (fragment_pos != std::string::npos) {
+    req.fragment_ = url.substr(fragment_pos + 1);
+    url = url.substr(0, fragment_pos);
+  }
+  const auto query_pos = url.find('?');
+  if (query_pos != std::string::npos) {
+    req.query_ = url.substr(query_pos + 1);
+    url = url.substr(0, query_pos);
+  }
+  req.url_ = url;
+
+  // version
+  const auto version = line.substr(pos + 1);
+  if (version.size() != HTTP_VERSION_PREFIX_LEN + 4 ||
+      std::memcmp(version.data(), HTTP_VERSION_PREFIX, HTTP_VERSION_PREFIX_LEN) != 0 ||
+      version[4] != '/' || !isdigit(version[5]) || version[6] != '.' || !isdigit(version[7])) {
+    return false;
+  }
+  req.version_.major = version[5] - '0';
+  req.version_.minor = version[7] - '0';
+  return true;
+}
+
+const char* request_parser::parse_header_line(const char *line, const char *header_end, request_view &req) const
+{
+  const char *eol = nullptr;
+  if (*line == ' ' || *line == '\t') {
+    // folded value continues the previous header
+    eol = detail::find_non_value_char(line, header_end);
+    if (req.headers_.empty() || (eol != header_end && (eol[0] != '\r' || eol[1] != '\n'))) {
+      return nullptr;
+    }
+    const char *end = eol;
+    while (end > line && (end[-1] == ' ' || end[-1] == '\t')) {
+      --end;
+    }
+    auto &prev = req.headers_.back();
+    if (end > line) {
+      prev.value = string_span(prev.value.data(), static_cast<std::size_t>(end - prev.value.data()));
+    }
+  } else {
+    const char *name_end = detail::find_non_token_char(line, header_end);
+    const char *colon = name_end;
+    while (colon != header_end && *colon == ' ') {
+      ++colon;
+    }
+    if (name_end == line || colon == header_end || *colon != ':') {
+      return nullptr;
+    }
+    eol = detail::find_non_value_char(colon + 1, header_end);
+    if (eol != header_end && (eol[0] != '\r' || eol[1] != '\n')) {
+      return nullptr;
+    }
+    const char *begin = colon + 1;
+    const char *end = eol;
+    while (begin < end && (*begin == ' ' || *begin == '\t')) {
+      ++begin;
+    }
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) {
+      --end;
+    }
+    request_view::header_field field;
+    field.name = string_span(line, static_cast<std::size_t>(name_end - line));
+    field.value = string_span(begin, static_cast<std::size_t>(end - begin));
+    req.headers_.push_back(field);
+  }
+
+  // index known headers; a folded value
+  // updates the already indexed span
+  const auto &field = req.headers_.back();
+  switch (field.name.size()) {
+    case 14:
+      if (field.name.iequals("Content-Length")) {
+        req.known_headers_[request_view::CONTENT_LENGTH] = field.value;
+      }
+      break;
+    case 12:
+      if (field.name.iequals("Content-Type")) {
+        req.known_headers_[request_view::CONTENT_TYPE] = field.value;
+      }
+      break;
+    case 4:
+      if (field.name.iequals("Host")) {
+        req.known_headers_[request_view::HOST] = field.value;
+      }
+      break;
+    case 10:
+      if (field.name.iequals("Connection")) {
+        req.known_headers_[request_view::CONNECTION] = field.value;
+      }
+      break;
+    case 17:
+      if (field.name.iequals("Transfer-Encoding")) {
+        req.known_headers_[request_view::TRANSFER_ENCODING] = field.value;
+      }
+      break;
+    default:
+      break;
+  }
+  return eol;
+}
+
+bool request_parser::parse_content_length(const string_span &value, std::size_t &length)
+{
+  length = 0;
+  for (auto c : value) {
+    if (!isdigit(c) || length > (std::numeric_limits<std::size_t>::max() - 9) / 10) {
+      return false;
+    }
+    length = length * 10 + static_cast<std::size_t>(c - '0');
+  }
+  return true;
+}
+
+std::size_t request_parser::consumed() const
+{
+  return consumed_;
+}
+
 void request_parser::reset()
 {
   state_ = METHOD;
+  consumed_ = 0;
+  scanned_ = 0;
+  content_length_ = 0;
+  chunk_state_ = CHUNK_SIZE;
+  chunk_size_ = 0;
+  chunk_digits_ = 0;
   http_prefix_index_ = 0;
   current_key_.clear();
   current_value_.clear();
@@ -0,0 +1,85 @@
+#include "matador/http/request_view.hpp"
+#include "matador/http/request.hpp"
+#include "matador/http/request_parser.hpp"
+
+namespace matador {
+namespace http {
+
+http::method_t request_view::method() const
+{
+  return method_;
+}
+
+string_span request_view::url() const
+{
+  return url_;
+}
+
+string_span request_view::query() const
+{
+  return query_;
+}
+
+string_span request_view::fragment() const
+{
+  return fragment_;
+}
+
+http::version request_view::version() const
+{
+  return version_;
+}
+
+const request_view::t_header_vector &request_view::headers() const
+{
+  return headers_;
+}
+
+string_span request_view::header(request_view::known_header_t header) const
+{
+  return known_headers_[header];
+}
+
+string_span request_view::header(const string_span &name) const
+{
+  for (const auto &field : headers_) {
+    if (field.name.iequals(name)) {
+      return field.value;
+    }
+  }
+  return {};
+}
+
+std::size_t request_view::content_length() const
+{
+  return content_length_;
+}
+
+string_span request_view::body() const
+{
+  return body_;
+}
+
+request request_view::to_request() const
+{
+  request req;
+  request_parser parser;
+  parser.apply(*this, req);
+  return req;
+}
+
+void request_view::clear()
+{
+  method_ = http::UNKNOWN;
+  url_ = string_span();
+  query_ = string_span();
+  fragment_ = string_span();
+  version_ = http::version();
+  content_length_ = 0;
+  headers_.clear();
+  known_headers_.fill(string_span());
+  body_ = string_span();
+}
+
+}
+}
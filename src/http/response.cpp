@@ -26,9 +26,85 @@ const t_string_param_map &response::headers() const
   return headers_;
 }
 
+bool response::add_header(const std::string &header, const std::string &value)
+{
+  return headers_.insert(std::make_pair(header, value)).second;
+}
+
+bool response::remove_header(const std::string &header)
+{
+  return headers_.erase(header) > 0;
+}
+
 const std::string &response::body() const
 {
-  return body_;
+  return shared_body_ ? *shared_body_ : body_;
+}
+
+void response::body(std::string content)
+{
+  body_ = std::move(content);
+  shared_body_.reset();
+  body_file_.reset();
+  body_producer_ = nullptr;
+  headers_.erase(response_header::TRANSFER_ENCODING);
+  content_.length = std::to_string(body_.size());
+}
+
+void response::body(std::shared_ptr<const std::string> content)
+{
+  body_.clear();
+  shared_body_ = std::move(content);
+  body_file_.reset();
+  body_producer_ = nullptr;
+  headers_.erase(response_header::TRANSFER_ENCODING);
+  content_.length = std::to_string(shared_body_->size());
+}
+
+const std::shared_ptr<const std::string> &response::shared_body() const
+{
+  return shared_body_;
+}
+
+const std::shared_ptr<matador::file_body> &response::body_file() const
+{
+  return body_file_;
+}
+
+void response::body_file(std::shared_ptr<matador::file_body> file)
+{
+  body_.clear();
+  shared_body_.reset();
+  body_file_ = std::move(file);
+  body_producer_ = nullptr;
+  headers_.erase(response_header::TRANSFER_ENCODING);
+  content_.length = std::to_string(body_file_->size());
+}
+
+const t_body_producer &response::body_producer() const
+{
+  return body_producer_;
+}
+
+void response::body_producer(t_body_producer producer)
+{
+  body_.clear();
+  shared_body_.reset();
+  body_file_.reset();
+  body_producer_ = std::move(producer);
+  content_.length.clear();
+  headers_[response_header::TRANSFER_ENCODING] = "chunked";
+}
+
+namespace {
+
+// informational, no content and not modified
+// responses never carry a body
+bool is_bodiless(http::status_t status)
+{
+  return static_cast<int>(status) < 200 || status == http::NO_CONTENT || status == http::NOT_MODIFIED;
+}
+
 }
 
 std::string response::to_string() const
@@ -39,20 +115,29 @@ std::string response::to_string() const
     result += p.first + ": " + p.second + "\r\n";
   }
 
-  if (!body_.empty()) {
+  if (!body().empty() || body_file_) {
     result += response_header::CONTENT_LENGTH + std::string(": ") + content_.length + "\r\n";
     result += response_header::CONTENT_TYPE + std::string(": ") + content_.type + "\r\n";
+  } else if (body_producer_) {
+    result += response_header::CONTENT_TYPE + std::string(": ") + content_.type + "\r\n";
+  } else if (!is_bodiless(status_)) {
+    result += response_header::CONTENT_LENGTH + std::string(": 0\r\n");
   }
 //  result += response_header::CONTENT_LANGUAGE + std::string(": ") + content_type.language + "\r\n\r\n";
 
   result += "\r\n";
-  result += body_;
+  if (body_file_) {
+    result += body_file_->to_string();
+  } else {
+    result += body();
+  }
 
   return result;
 }
 
 const char name_value_separator[] = { ':', ' ' };
 const char crlf[] = { '\r', '\n' };
+const char zero_length[] = { '0' };
 
 std::list<matador::buffer_view> response::to_buffers() const
 {
@@ -66,7 +151,7 @@ std::list<matador::buffer_view> response::to_buffers() const
     buffers.emplace_back(crlf, 2);
   }
 
-  if (!body_.empty()) {
+  if (!body().empty() || body_file_) {
     buffers.emplace_back(response_header::CONTENT_LENGTH);
     buffers.emplace_back(name_value_separator, 2);
     buffers.emplace_back(content_.length);
@@ -75,12 +160,24 @@ std::list<matador::buffer_view> response::to_buffers() const
     buffers.emplace_back(name_value_separator, 2);
     buffers.emplace_back(content_.type);
     buffers.emplace_back(crlf, 2);
+  } else if (body_producer_) {
+    // length is unknown, the body is sent chunked
+    buffers.emplace_back(response_header::CONTENT_TYPE);
+    buffers.emplace_back(name_value_separator, 2);
+    buffers.emplace_back(content_.type);
+    buffers.emplace_back(crlf, 2);
+  } else if (!is_bodiless(status_)) {
+    // the client must know where an empty body ends
+    buffers.emplace_back(response_header::CONTENT_LENGTH);
+    buffers.emplace_back(name_value_separator, 2);
+    buffers.emplace_back(zero_length, 1);
+    buffers.emplace_back(crlf, 2);
   }
 
   buffers.emplace_back(crlf, 2);
 
-  if (!body_.empty()) {
-    buffers.emplace_back(body_);
+  if (!body().empty()) {
+    buffers.emplace_back(body());
   }
 
   return buffers;
@@ -113,21 +210,29 @@ response response::create(http::status_t status, const string &body, mime_types:
   return resp;
 }
 
-response response::from_file(const std::string &file_path)
-{
-  response resp;
+namespace {
 
-  // Determine the file extension.
+std::string file_extension(const std::string &file_path)
+{
   std::size_t last_slash_pos = file_path.find_last_of('/');
   std::size_t last_dot_pos = file_path.find_last_of('.');
-  std::string extension;
   if (last_slash_pos == std::string::npos) {
     last_slash_pos = 0;
   }
-  if (last_dot_pos != std::string::npos && last_dot_pos > last_slash_pos)
-  {
-    extension = file_path.substr(last_dot_pos + 1);
+  if (last_dot_pos != std::string::npos && last_dot_pos > last_slash_pos) {
+    return file_path.substr(last_dot_pos + 1);
   }
+  return "";
+}
+
+}
+
+response response::from_file(const std::string &file_path)
+{
+  response resp;
+
+  // Determine the file extension.
+  std::string extension = file_extension(file_path);
 
   matador::file f(file_path, "r");
 //  matador::file f("." + file_path, "r");
@@ -169,6 +274,40 @@ response response::from_file(const std::string &file_path)
   return resp;
 }
 
+response response::send_file(const std::string &file_path)
+{
+  auto body = std::make_shared<matador::file_body>(file_path);
+  if (!body->is_open()) {
+    return response::not_found();
+  }
+
+  response resp = create(http::OK);
+  resp.content_.type = mime_types::from_file_extension(file_extension(file_path));
+  resp.content_.length = std::to_string(body->size());
+  resp.body_file_ = std::move(body);
+  return resp;
+}
+
+response response::shared(http::status_t status, std::shared_ptr<const std::string> body, const std::string &content_type)
+{
+  response resp = create(status);
+  resp.content_.type = content_type;
+  resp.content_.length = std::to_string(body->size());
+  resp.shared_body_ = std::move(body);
+
+  return resp;
+}
+
+response response::stream(t_body_producer producer, mime_types::types type)
+{
+  response resp = create(http::OK);
+  resp.content_.type = mime_types::from_type(type);
+  resp.headers_.insert(std::make_pair(response_header::TRANSFER_ENCODING, "chunked"));
+  resp.body_producer_ = std::move(producer);
+
+  return resp;
+}
+
 response response::ok(const matador::json &body)
 {
   return ok(body.str(), mime_types::TYPE_APPLICATION_JSON);
@@ -198,6 +337,21 @@ response response::bad_request()
   return create(http::BAD_REQUEST);
 }
 
+response response::not_modified()
+{
+  return create(http::NOT_MODIFIED);
+}
+
+response response::payload_too_large()
+{
+  return create(http::PAYLOAD_TOO_LARGE);
+}
+
+response response::request_header_fields_too_large()
+{
+  return create(http::REQUEST_HEADER_FIELDS_TOO_LARGE);
+}
+
 response response::redirect(const string &location)
 {
   auto resp = create(http::MOVED_TEMPORARILY);
@@ -64,5 +64,20 @@ response route_endpoint::execute(const request &req)
   return request_handler_(req);
 }
 
+void route_endpoint::body_consumer_factory(t_body_consumer_factory factory)
+{
+  body_consumer_factory_ = std::move(factory);
+}
+
+bool route_endpoint::streams_body() const
+{
+  return static_cast<bool>(body_consumer_factory_);
+}
+
+t_body_consumer route_endpoint::create_body_consumer(const request &req) const
+{
+  return body_consumer_factory_ ? body_consumer_factory_(req) : t_body_consumer();
+}
+
 }
 }
@@ -5,6 +5,8 @@
 #include "matador/utils/stream.hpp"
 #include "matador/utils/string.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <regex>
 
 namespace matador {
@@ -14,6 +16,8 @@ bool prepare_route_path_elements(const std::string &path, std::list<std::string>
 
 // ^(\/(([\w]+)|(\{[\w\: \\\+]+\}))*)(\/(([\w]+)|(\{[\w \\\:\+]+\}))+)*\/?
 
+const std::size_t routing_engine::NO_ROUTE = static_cast<std::size_t>(-1);
+
 void routing_engine::add(const std::string &path, http::http::method_t method, const t_request_handler& request_handler)
 {
   auto it = find_internal(path, method);
@@ -22,11 +26,23 @@ void routing_engine::add(const std::string &path, http::http::method_t method, c
     return;
   }
 
+  auto parts = parse_route_spec(path);
   auto endpoint = create_route_endpoint(path, method, request_handler);
 
+  insert(parts, method, routes_.size());
   routes_.push_back(endpoint);
 }
 
+void routing_engine::add(const std::string &path, http::http::method_t method, const t_request_handler &request_handler,
+                         const t_body_consumer_factory &body_consumer_factory)
+{
+  add(path, method, request_handler);
+  auto it = find_internal(path, method);
+  if (it != routes_.end()) {
+    (*it)->body_consumer_factory(body_consumer_factory);
+  }
+}
+
 routing_engine::iterator routing_engine::find(const std::string &path, http::http::method_t method)
 {
   return find_internal(path, method);
@@ -35,10 +51,23 @@ routing_engine::iterator routing_engine::find(const std::string &path, http::htt
 routing_engine::const_iterator
 routing_engine::match(request &req) const
 {
-  auto it = std::find_if(routes_.begin(), routes_.end(), [&req](const route_endpoint_ptr &ep) {
-    return ep->match(req);
-  });
-  return it;
+  auto tree = trees_.find(req.method());
+  const auto &url = req.url();
+  if (tree == trees_.end() || url.empty() || url[0] != '/') {
+    return routes_.end();
+  }
+
+  std::vector<string_span> captures;
+  auto route = NO_ROUTE;
+  if (!match_node(tree->second, url.data() + 1, url.data() + url.size(), true, captures, route)) {
+    return routes_.end();
+  }
+
+  const auto &names = route_param_names_[route];
+  for (std::size_t i = 0; i < names.size() && i < captures.size(); ++i) {
+    req.path_params_.insert(std::make_pair(names[i], captures[i].to_string()));
+  }
+  return routes_.begin() + static_cast<t_route_vector::difference_type>(route);
 }
 
 void routing_engine::dump(std::ostream &out)
@@ -66,29 +95,144 @@ routing_engine::iterator routing_engine::find_internal(
   return it;
 }
 
-routing_engine::route_endpoint_ptr create_route_endpoint(
-  const std::string &path_spec, http::method_t method,
-  const t_request_handler &request_handler
-)
+void routing_engine::insert(const std::vector<route_part> &parts, http::method_t method, std::size_t route)
+{
+  route_node *node = &trees_[method];
+  std::vector<std::string> names;
+
+  for (auto it = parts.begin(); it != parts.end(); ++it) {
+    const auto &part = *it;
+    if (part.type == route_part::WILDCARD) {
+      if (it + 1 != parts.end()) {
+        throw std::logic_error("static files wildcard must be the last route spec part");
+      }
+      if (node->wildcard_route == NO_ROUTE) {
+        node->wildcard_route = route;
+      }
+      route_param_names_.push_back(names);
+      return;
+    } else if (part.type == route_part::PARAM) {
+      // params with the same constraint share their node
+      auto edge = std::find_if(node->params.begin(), node->params.end(), [&part](const param_edge &e) {
+        return e.constraint == part.constraint;
+      });
+      if (edge == node->params.end()) {
+        param_edge e;
+        e.name = part.value;
+        e.constraint = part.constraint;
+        if (!part.constraint.empty()) {
+          e.regex.reset(new std::regex(part.constraint));
+        }
+        e.node.reset(new route_node);
+        node->params.push_back(std::move(e));
+        edge = node->params.end() - 1;
+      }
+      names.push_back(part.value);
+      node = edge->node.get();
+    } else {
+      auto child = std::lower_bound(node->statics.begin(), node->statics.end(), part.value,
+        [](const std::pair<std::string, std::unique_ptr<route_node>> &x, const std::string &value) {
+          return x.first < value;
+        });
+      if (child == node->statics.end() || child->first != part.value) {
+        child = node->statics.insert(child, std::make_pair(part.value, std::unique_ptr<route_node>(new route_node)));
+      }
+      node = child->second.get();
+    }
+  }
+  if (node->route == NO_ROUTE) {
+    node->route = route;
+  }
+  route_param_names_.push_back(names);
+}
+
+namespace {
+
+bool is_word_char(char c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+int compare(const std::string &a, const string_span &b)
+{
+  const auto len = (std::min)(a.size(), b.size());
+  auto result = len > 0 ? std::memcmp(a.data(), b.data(), len) : 0;
+  if (result != 0) {
+    return result;
+  }
+  return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+}
+
+bool routing_engine::match_node(const route_node &node, const char *begin, const char *end, bool has_segment,
+                                std::vector<string_span> &captures, std::size_t &route) const
+{
+  if (!has_segment) {
+    route = node.route;
+    return route != NO_ROUTE;
+  }
+
+  const char *segment_end = static_cast<const char*>(std::memchr(begin, '/', static_cast<std::size_t>(end - begin)));
+  const bool has_next = segment_end != nullptr;
+  if (!has_next) {
+    segment_end = end;
+  }
+  const string_span segment(begin, static_cast<std::size_t>(segment_end - begin));
+  const char *next = has_next ? segment_end + 1 : end;
+
+  // static segments
+  auto child = std::lower_bound(node.statics.begin(), node.statics.end(), segment,
+    [](const std::pair<std::string, std::unique_ptr<route_node>> &x, const string_span &value) {
+      return compare(x.first, value) < 0;
+    });
+  if (child != node.statics.end() && compare(child->first, segment) == 0 &&
+      match_node(*child->second, next, end, has_next, captures, route)) {
+    return true;
+  }
+
+  // path params
+  if (!segment.empty()) {
+    for (const auto &edge : node.params) {
+      if (edge.regex) {
+        if (!std::regex_match(segment.begin(), segment.end(), *edge.regex)) {
+          continue;
+        }
+      } else if (std::find_if_not(segment.begin(), segment.end(), is_word_char) != segment.end()) {
+        continue;
+      }
+      captures.push_back(segment);
+      if (match_node(*edge.node, next, end, has_next, captures, route)) {
+        return true;
+      }
+      captures.pop_back();
+    }
+  }
+
+  // static files take the rest of the url
+  if (node.wildcard_route != NO_ROUTE) {
+    route = node.wildcard_route;
+    return true;
+  }
+  return false;
+}
+
+std::vector<route_part> parse_route_spec(const std::string &path_spec)
 {
   static std::regex route_regex { R"((\*\.\*)|\{(\w+)(:\s*(.*))?\}|([a-zA-Z0-9-_]+))" };
 
-  t_size_string_map path_param_to_index_map;
+  std::vector<route_part> result;
 
-  // check for root path explicitly
+  // the root path is an empty segment
   if (path_spec == "/") {
-    return std::make_shared<route_endpoint>(path_spec, R"(\/)", method, request_handler, path_param_to_index_map);
+    result.emplace_back();
+    return result;
   }
 
-  std::smatch what;
-
   std::list<std::string> parts;
-
   prepare_route_path_elements(path_spec, parts);
 
-  std::string result_regex;
-
-  size_t index = 0;
+  std::smatch what;
   for (const auto &part : parts) {
     if (part.empty()) {
       continue;
@@ -98,25 +242,60 @@ routing_engine::route_endpoint_ptr create_route_endpoint(
       throw std::logic_error("invalid route spec part: " + part);
     }
 
-    result_regex += R"(\/)";
+    route_part rp;
     if (what[1].matched) {
       // static files
-      result_regex += R"(([^?]*))";
+      rp.type = route_part::WILDCARD;
     } else if (what[5].matched) {
       // plain path element
-      result_regex += what[5].str();
-    } else if (what[4].matched) {
-      // path param with regex
-      result_regex += "(" + what[4].str() + ")";
-      // what[2] is path name
-      path_param_to_index_map.insert(std::make_pair(++index, what[2].str()));
+      rp.value = what[5].str();
     } else if (what[2].matched) {
-      // path param
-      result_regex += R"((\w+))";
-      path_param_to_index_map.insert(std::make_pair(++index, what[2].str()));
+      // path param with optional regex
+      rp.type = route_part::PARAM;
+      rp.value = what[2].str();
+      if (what[4].matched) {
+        rp.constraint = what[4].str();
+      }
     } else {
       throw std::logic_error("invalid route spec pattern match");
     }
+    result.push_back(rp);
+  }
+  return result;
+}
+
+routing_engine::route_endpoint_ptr create_route_endpoint(
+  const std::string &path_spec, http::method_t method,
+  const t_request_handler &request_handler
+)
+{
+  t_size_string_map path_param_to_index_map;
+
+  // check for root path explicitly
+  if (path_spec == "/") {
+    return std::make_shared<route_endpoint>(path_spec, R"(\/)", method, request_handler, path_param_to_index_map);
+  }
+
+  std::string result_regex;
+
+  size_t index = 0;
+  for (const auto &part : parse_route_spec(path_spec)) {
+    result_regex += R"(\/)";
+    if (part.type == route_part::WILDCARD) {
+      // static files
+      result_regex += R"(([^?]*))";
+    } else if (part.type == route_part::STATIC) {
+      // plain path element
+      result_regex += part.value;
+    } else if (!part.constraint.empty()) {
+      // path param with regex
+      result_regex += "(" + part.constraint + ")";
+      path_param_to_index_map.insert(std::make_pair(++index, part.value));
+    } else {
+      // path param
+      result_regex += R"((\w+))";
+      path_param_to_index_map.insert(std::make_pair(++index, part.value));
+    }
   }
 
   return std::make_shared<route_endpoint>(path_spec, result_regex, method, request_handler, path_param_to_index_map);
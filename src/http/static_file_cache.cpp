@@ -0,0 +1,313 @@
+#include "matador/http/static_file_cache.hpp"
+#include "matador/http/request.hpp"
+#include "matador/http/request_header.hpp"
+#include "matador/http/response_header.hpp"
+
+#include "matador/http/detail/header_value.hpp"
+
+#include "matador/net/file_body.hpp"
+
+#include "matador/utils/strptime.hpp"
+#include "matador/utils/time.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace matador {
+namespace http {
+
+namespace {
+
+std::string to_http_date(std::time_t t)
+{
+  struct tm tm{};
+  matador::gmtime(t, tm);
+  char buffer[64];
+  auto len = std::strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  return { buffer, len };
+}
+
+bool from_http_date(const std::string &str, std::time_t &t)
+{
+  struct tm tm{};
+  const char *end = matador::detail::strptime(str.c_str(), "%a, %d %b %Y %H:%M:%S", &tm);
+  if (end == nullptr || std::strcmp(end, " GMT") != 0) {
+    return false;
+  }
+  // days since epoch of the civil date (proleptic gregorian calendar)
+  const int year = tm.tm_year + 1900 - (tm.tm_mon < 2 ? 1 : 0);
+  const int era = (year >= 0 ? year : year - 399) / 400;
+  const int year_of_era = year - era * 400;
+  const int day_of_year = (153 * (tm.tm_mon + (tm.tm_mon < 2 ? 10 : -2)) + 2) / 5 + tm.tm_mday - 1;
+  const int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  const long long days = static_cast<long long>(era) * 146097 + day_of_era - 719468;
+  t = static_cast<std::time_t>(days * 86400 + tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec);
+  return true;
+}
+
+const std::string* find_header(const request &req, const char *name)
+{
+  auto it = req.headers().find(name);
+  return it != req.headers().end() ? &it->second : nullptr;
+}
+
+}
+
+static_file_cache::static_file_cache(std::size_t max_size)
+  : max_size_(max_size)
+{}
+
+response static_file_cache::serve(const request &req, const std::string &path)
+{
+  const auto now = std::chrono::steady_clock::now();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto cache_control = cache_control_;
+  auto it = entry_map_.find(path);
+  if (it != entry_map_.end() && now - it->second->checked < revalidate_interval_ && !must_revalidate(req)) {
+    // most recently served first
+    entries_.splice(entries_.begin(), entries_, it->second);
+    const entry e = *it->second;
+    lock.unlock();
+    return respond(req, e, cache_control);
+  }
+  const bool cached = it != entry_map_.end();
+  const auto cached_stat = cached ? it->second->stat : os::file_stat();
+  const auto max_content_size = (std::min)(max_file_size_, max_size_);
+  lock.unlock();
+
+  // disk access without holding the lock
+  os::file_stat st;
+  if (!os::stat_file(path, st)) {
+    lock.lock();
+    remove(path);
+    return response::not_found();
+  }
+
+  if (cached && is_same_file(cached_stat, st)) {
+    lock.lock();
+    it = entry_map_.find(path);
+    if (it != entry_map_.end() && is_same_file(it->second->stat, st)) {
+      it->second->checked = now;
+      entries_.splice(entries_.begin(), entries_, it->second);
+      const entry e = *it->second;
+      lock.unlock();
+      return respond(req, e, cache_control);
+    }
+    lock.unlock();
+  }
+
+  entry loaded;
+  if (!load(path, st, max_content_size, loaded)) {
+    lock.lock();
+    remove(path);
+    return response::not_found();
+  }
+  loaded.checked = now;
+
+  lock.lock();
+  const entry e = *insert(std::move(loaded));
+  lock.unlock();
+  return respond(req, e, cache_control);
+}
+
+void static_file_cache::max_size(std::size_t max_size)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_size_ = max_size;
+  evict();
+}
+
+std::size_t static_file_cache::max_size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_size_;
+}
+
+void static_file_cache::max_file_size(std::size_t max_file_size)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_file_size_ = max_file_size;
+}
+
+std::size_t static_file_cache::max_file_size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_file_size_;
+}
+
+void static_file_cache::revalidate_interval(std::chrono::milliseconds interval)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  revalidate_interval_ = interval;
+}
+
+std::chrono::milliseconds static_file_cache::revalidate_interval() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return revalidate_interval_;
+}
+
+void static_file_cache::cache_control(const std::string &value)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_control_ = value;
+}
+
+const std::string &static_file_cache::cache_control() const
+{
+  return cache_control_;
+}
+
+std::size_t static_file_cache::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+std::size_t static_file_cache::memory_usage() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return memory_usage_;
+}
+
+void static_file_cache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entry_map_.clear();
+  entries_.clear();
+  memory_usage_ = 0;
+}
+
+bool static_file_cache::is_not_modified(const request &req, const entry &e)
+{
+  // a list of entity tags takes precedence over the date
+  const auto *if_none_match = find_header(req, request_header::IF_NONE_MATCH);
+  if (if_none_match != nullptr) {
+    return detail::match_entity_tag(*if_none_match, e.etag);
+  }
+  const auto *if_modified_since = find_header(req, request_header::IF_MODIFIED_SINCE);
+  std::time_t since = 0;
+  return if_modified_since != nullptr && from_http_date(*if_modified_since, since) && e.stat.mtime <= since;
+}
+
+bool static_file_cache::must_revalidate(const request &req)
+{
+  const auto *cache_control = find_header(req, request_header::CACHE_CONTROL);
+  if (cache_control != nullptr) {
+    return cache_control->find("no-cache") != std::string::npos || cache_control->find("max-age=0") != std::string::npos;
+  }
+  const auto *pragma = find_header(req, request_header::PRAGMA);
+  return pragma != nullptr && pragma->find("no-cache") != std::string::npos;
+}
+
+bool static_file_cache::is_same_file(const os::file_stat &a, const os::file_stat &b)
+{
+  return a.mtime == b.mtime && a.inode == b.inode && a.size == b.size;
+}
+
+response static_file_cache::respond(const request &req, const entry &e, const std::string &cache_control)
+{
+  response resp;
+  if (is_not_modified(req, e)) {
+    resp = response::not_modified();
+  } else if (e.content) {
+    resp = response::shared(http::OK, e.content, e.content_type);
+  } else {
+    resp = response::send_file(e.path);
+    if (resp.status() != http::OK) {
+      return resp;
+    }
+  }
+  resp.add_header(response_header::ETAG, e.etag);
+  resp.add_header(response_header::LAST_MODIFIED, e.last_modified);
+  if (!cache_control.empty()) {
+    resp.add_header(response_header::CACHE_CONTROL, cache_control);
+  }
+  return resp;
+}
+
+bool static_file_cache::load(const std::string &path, const os::file_stat &st, std::size_t max_content_size, entry &e)
+{
+  auto resp = response::send_file(path);
+  if (resp.status() != http::OK) {
+    return false;
+  }
+
+  e.path = path;
+  e.stat = st;
+  e.content_type = resp.content().type;
+  if (st.size <= max_content_size) {
+    auto content = std::make_shared<std::string>(resp.body_file()->to_string());
+    if (content->size() != st.size) {
+      // changed while reading; reloaded with the next request
+      e.stat.size = content->size();
+      e.stat.mtime = 0;
+    }
+    e.content = std::move(content);
+  }
+
+  // the entity tag is built from the stat of the file,
+  // which changes with every change of its content
+  char etag[64];
+  auto len = std::snprintf(etag, sizeof(etag), "\"%llx-%llx-%llx\"",
+                           static_cast<unsigned long long>(e.stat.mtime),
+                           static_cast<unsigned long long>(e.stat.size),
+                           static_cast<unsigned long long>(e.stat.inode));
+  e.etag.assign(etag, static_cast<std::size_t>(len));
+  e.last_modified = to_http_date(st.mtime);
+  return true;
+}
+
+static_file_cache::t_entry_list::iterator static_file_cache::insert(entry &&e)
+{
+  auto it = entry_map_.find(e.path);
+  if (it != entry_map_.end()) {
+    // another thread loaded the file meanwhile; keep
+    // the one whose file was checked last
+    if (it->second->checked >= e.checked) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return entries_.begin();
+    }
+    memory_usage_ -= entry_size(*it->second);
+    entries_.erase(it->second);
+    entry_map_.erase(it);
+  }
+  memory_usage_ += entry_size(e);
+  entries_.push_front(std::move(e));
+  entry_map_.insert(std::make_pair(entries_.front().path, entries_.begin()));
+  evict();
+  return entries_.begin();
+}
+
+void static_file_cache::remove(const std::string &path)
+{
+  auto it = entry_map_.find(path);
+  if (it == entry_map_.end()) {
+    return;
+  }
+  memory_usage_ -= entry_size(*it->second);
+  entries_.erase(it->second);
+  entry_map_.erase(it);
+}
+
+std::size_t static_file_cache::entry_size(const entry &e)
+{
+  return sizeof(entry) + e.path.size() + (e.content ? e.content->size() : 0);
+}
+
+void static_file_cache::evict()
+{
+  // the most recently served file is never evicted
+  while (memory_usage_ > max_size_ && entries_.size() > 1) {
+    const auto &e = entries_.back();
+    memory_usage_ -= entry_size(e);
+    entry_map_.erase(e.path);
+    entries_.pop_back();
+  }
+}
+
+}
+}
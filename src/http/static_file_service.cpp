@@ -10,7 +10,8 @@ namespace http {
 
 void serve_static_files_at(const std::string &path, server &s)
 {
-  s.on_get(path, [](const request &req) {
+  auto cache = std::make_shared<static_file_cache>();
+  s.on_get(path, [cache](const request &req) {
     std::string path;
     if (!url::decode(req.url(), path)) {
       return response::bad_request();
@@ -27,7 +28,7 @@ void serve_static_files_at(const std::string &path, server &s)
 
     matador::log(log_level::LVL_DEBUG, "StaticFileService", "serving file %s", path.c_str());
 
-    return response::from_file("." + path);
+    return cache->serve(req, "." + path);
   });
 
 }
@@ -56,7 +57,12 @@ response static_file_service::serve(const request &req)
 
   log_.debug("serving file %s", path.c_str());
 
-  return response::from_file("." + path);
+  return cache_.serve(req, "." + path);
+}
+
+static_file_cache &static_file_service::cache()
+{
+  return cache_;
 }
 }
 }
\ No newline at end of file
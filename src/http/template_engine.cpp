@@ -2,6 +2,7 @@
 
 #include "matador/http/detail/template_parser.hpp"
 #include "matador/http/detail/template_part.hpp"
+#include "matador/http/detail/template_program.hpp"
 
 #include "matador/json/json.hpp"
 #include "matador/utils/string_cursor.hpp"
@@ -52,14 +53,34 @@ std::string template_engine::render(const std::shared_ptr<detail::template_part>
   return part->render(data);
 }
 
+std::string template_engine::render(const std::shared_ptr<detail::template_program> &program, const json &data)
+{
+  return program->render(data);
+}
+
+void template_engine::render(const std::shared_ptr<detail::template_program> &program, const json &data, std::string &out)
+{
+  program->render(data, out);
+}
+
+std::shared_ptr<detail::template_program> template_engine::compile(const std::string &format)
+{
+  return compile(build(format));
+}
+
+std::shared_ptr<detail::template_program> template_engine::compile(const std::shared_ptr<detail::template_part> &part)
+{
+  return detail::template_program::compile(*part);
+}
+
 std::string template_engine::render(const std::string &format, const json &data)
 {
-  return render(build(format), data);
+  return render(compile(format), data);
 }
 
 std::string template_engine::render(const char *format, size_t len, const json &data)
 {
-  return render(build(format, len), data);
+  return render(compile(build(format, len)), data);
 }
 
 }
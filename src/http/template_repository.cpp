@@ -0,0 +1,315 @@
+#include "matador/http/template_repository.hpp"
+
+#include "matador/http/detail/template_loader.hpp"
+#include "matador/http/detail/template_parser.hpp"
+#include "matador/http/detail/template_part.hpp"
+#include "matador/http/detail/template_program.hpp"
+
+#include "matador/json/json.hpp"
+
+#include "matador/utils/file.hpp"
+#include "matador/utils/os.hpp"
+#include "matador/utils/string_cursor.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace matador {
+namespace http {
+
+namespace {
+
+bool ends_with(const std::string &str, const std::string &suffix)
+{
+  return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void list_files(const std::string &dir, const std::string &prefix, std::vector<std::string> &files)
+{
+  const auto path = dir.empty() ? std::string(".") : dir;
+#ifdef _WIN32
+  WIN32_FIND_DATAA data;
+  HANDLE handle = ::FindFirstFileA((path + "\\*").c_str(), &data);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return;
+  }
+  do {
+    const std::string name(data.cFileName);
+    if (name == "." || name == "..") {
+      continue;
+    }
+    if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+      list_files(os::build_path(path, name), prefix + name + "/", files);
+    } else {
+      files.push_back(prefix + name);
+    }
+  } while (::FindNextFileA(handle, &data));
+  ::FindClose(handle);
+#else
+  DIR *d = ::opendir(path.c_str());
+  if (d == nullptr) {
+    return;
+  }
+  while (auto *ent = ::readdir(d)) {
+    const std::string name(ent->d_name);
+    if (name == "." || name == "..") {
+      continue;
+    }
+    const auto child = os::build_path(path, name);
+    struct stat buf{};
+    if (::stat(child.c_str(), &buf) != 0) {
+      continue;
+    }
+    if (S_ISDIR(buf.st_mode)) {
+      list_files(child, prefix + name + "/", files);
+    } else if (S_ISREG(buf.st_mode)) {
+      files.push_back(prefix + name);
+    }
+  }
+  ::closedir(d);
+#endif
+}
+
+}
+
+/*
+ * Resolves the includes of the template currently
+ * parsed through the repository and records them
+ * as dependencies of that template.
+ */
+class template_repository::loader : public detail::template_loader
+{
+public:
+  explicit loader(template_repository &repository)
+    : repository_(repository)
+  {}
+
+  std::shared_ptr<detail::template_part> load(const std::string &path) override
+  {
+    repository_.loading_.back().second.insert(path);
+    return repository_.load(path).part;
+  }
+
+private:
+  template_repository &repository_;
+};
+
+template_repository::template_repository(std::string root)
+  : root_(std::move(root))
+{}
+
+template_repository::~template_repository() = default;
+
+std::shared_ptr<detail::template_program> template_repository::get(const std::string &path)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (auto_reload_) {
+    revalidate(path, std::chrono::steady_clock::now());
+  }
+  auto &e = load(path);
+  if (!e.program) {
+    // included only templates aren't compiled
+    e.program = detail::template_program::compile(*e.part);
+  }
+  return e.program;
+}
+
+std::string template_repository::render(const std::string &path, const json &data)
+{
+  return get(path)->render(data);
+}
+
+void template_repository::render(const std::string &path, const json &data, std::string &out)
+{
+  get(path)->render(data, out);
+}
+
+std::size_t template_repository::prewarm(const std::vector<std::string> &extensions)
+{
+  std::vector<std::string> files;
+  list_files(root_, "", files);
+
+  std::size_t count = 0;
+  for (const auto &f : files) {
+    const auto is_template = std::any_of(extensions.begin(), extensions.end(), [&f](const std::string &ext) {
+      return ends_with(f, ext);
+    });
+    if (is_template) {
+      get(f);
+      ++count;
+    }
+  }
+  return count;
+}
+
+void template_repository::invalidate(const std::string &path)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  remove(path);
+}
+
+std::set<std::string> template_repository::dependencies(const std::string &path) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(path);
+  return it != entries_.end() ? it->second.dependencies : std::set<std::string>();
+}
+
+void template_repository::auto_reload(bool enable)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto_reload_ = enable;
+}
+
+bool template_repository::auto_reload() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return auto_reload_;
+}
+
+void template_repository::revalidate_interval(std::chrono::milliseconds interval)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  revalidate_interval_ = interval;
+}
+
+std::chrono::milliseconds template_repository::revalidate_interval() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return revalidate_interval_;
+}
+
+const std::string &template_repository::root() const
+{
+  return root_;
+}
+
+std::size_t template_repository::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void template_repository::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  dependents_.clear();
+}
+
+std::string template_repository::full_path(const std::string &path) const
+{
+  return root_.empty() ? path : os::build_path(root_, path);
+}
+
+template_repository::entry &template_repository::load(const std::string &path)
+{
+  auto it = entries_.find(path);
+  if (it != entries_.end()) {
+    return it->second;
+  }
+
+  auto cyclic = std::find_if(loading_.begin(), loading_.end(), [&path](const std::pair<std::string, std::set<std::string>> &p) {
+    return p.first == path;
+  });
+  if (cyclic != loading_.end()) {
+    throw std::logic_error("template " + path + " includes itself");
+  }
+
+  entry e;
+  const auto filepath = full_path(path);
+  if (!os::stat_file(filepath, e.stat)) {
+    throw std::logic_error("file " + filepath + " doesn't exists");
+  }
+  file template_file(filepath, "r");
+  std::string content = read_as_text(template_file);
+  template_file.close();
+
+  loading_.emplace_back(path, std::set<std::string>());
+  try {
+    loader l(*this);
+    detail::template_loader_scope scope(&l);
+    detail::template_parser parser;
+    string_cursor cursor(content.c_str());
+    e.part = parser.parse(cursor, [](const std::string&, std::unique_ptr<detail::multi_template_part>&) { return detail::template_parser::NEXT_COMMAND; });
+  } catch (...) {
+    loading_.pop_back();
+    throw;
+  }
+  e.dependencies = std::move(loading_.back().second);
+  loading_.pop_back();
+
+  e.checked = std::chrono::steady_clock::now();
+  for (const auto &dependency : e.dependencies) {
+    dependents_[dependency].insert(path);
+  }
+  return entries_.emplace(path, std::move(e)).first->second;
+}
+
+void template_repository::revalidate(const std::string &path, std::chrono::steady_clock::time_point now)
+{
+  // check the template and all templates it
+  // includes; a changed template is removed
+  // together with everything including it
+  std::vector<std::string> pending { path };
+  std::set<std::string> visited;
+  std::vector<std::string> changed;
+  while (!pending.empty()) {
+    auto current = pending.back();
+    pending.pop_back();
+    if (!visited.insert(current).second) {
+      continue;
+    }
+    auto it = entries_.find(current);
+    if (it == entries_.end()) {
+      continue;
+    }
+    auto &e = it->second;
+    pending.insert(pending.end(), e.dependencies.begin(), e.dependencies.end());
+    if (now - e.checked < revalidate_interval_) {
+      continue;
+    }
+    e.checked = now;
+    os::file_stat st;
+    if (!os::stat_file(full_path(current), st) || st.mtime != e.stat.mtime || st.inode != e.stat.inode || st.size != e.stat.size) {
+      changed.push_back(current);
+    }
+  }
+  for (const auto &p : changed) {
+    remove(p);
+  }
+}
+
+void template_repository::remove(const std::string &path)
+{
+  auto it = entries_.find(path);
+  if (it != entries_.end()) {
+    for (const auto &dependency : it->second.dependencies) {
+      auto dit = dependents_.find(dependency);
+      if (dit != dependents_.end()) {
+        dit->second.erase(path);
+      }
+    }
+    entries_.erase(it);
+  }
+  auto dit = dependents_.find(path);
+  if (dit == dependents_.end()) {
+    return;
+  }
+  auto dependents = std::move(dit->second);
+  dependents_.erase(dit);
+  for (const auto &dependent : dependents) {
+    remove(dependent);
+  }
+}
+
+}
+}
@@ -4,6 +4,9 @@
 
 #include "matador/logger/log_manager.hpp"
 
+#include <algorithm>
+#include <cerrno>
+
 namespace matador {
 
 acceptor::acceptor()
@@ -37,11 +40,53 @@ void acceptor::accecpt(const tcp::peer &endpoint, acceptor::t_accept_handler on_
   accecpt(std::move(on_new_connection));
 }
 
+void acceptor::assign_reactor(t_reactor_assignment assignment)
+{
+  reactor_assignment_ = std::move(assignment);
+}
+
+void acceptor::reuse_port(bool reuse)
+{
+  acceptor_.reuse_port(reuse);
+}
+
+bool acceptor::reuse_port() const
+{
+  return acceptor_.reuse_port();
+}
+
+void acceptor::backlog(int backlog)
+{
+  backlog_ = backlog;
+}
+
+int acceptor::backlog() const
+{
+  return backlog_;
+}
+
+void acceptor::accepts_per_event(std::size_t max_accepts)
+{
+  accepts_per_event_ = (std::max)(max_accepts, std::size_t(1));
+}
+
+std::size_t acceptor::accepts_per_event() const
+{
+  return accepts_per_event_;
+}
+
 void acceptor::open()
 {
   acceptor_.bind(endpoint_);
-  acceptor_.listen(10);
+  // accepting stops when the pending
+  // connection queue is drained
+  acceptor_.non_blocking(true);
+  acceptor_.listen(backlog_);
   name_ += " (fd: " + std::to_string(acceptor_.id()) + ")";
+  completes_io_ = get_reactor()->completes_io();
+  if (completes_io_) {
+    get_reactor()->complete_io(handle(), io_operation::ACCEPT);
+  }
   log_.debug("fd %d: accepting connections", handle());
 }
 
@@ -52,23 +97,32 @@ socket_type acceptor::handle() const
 
 void acceptor::on_input()
 {
-  tcp::socket sock;
-
-  tcp::peer endpoint = create_client_endpoint();
-  log_.debug("fd %d: accepting connection ...", handle());
-  int ret = acceptor_.accept(sock, endpoint);
-
-  if (ret < 0) {
-    char error_buffer[1024];
-    os::strerror(errno, error_buffer, 1024);
-    log_.error("accept failed: %s", error_buffer);
-  } else {
+  log_.debug("fd %d: accepting connections ...", handle());
+  for (std::size_t i = 0; i < accepts_per_event_; ++i) {
+    tcp::socket sock;
+
+    tcp::peer endpoint = create_client_endpoint();
+    int ret = completes_io_ ? accept(sock, endpoint) : acceptor_.accept(sock, endpoint);
+
+    if (ret < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        // connection was reset while pending
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        char error_buffer[1024];
+        os::strerror(errno, error_buffer, 1024);
+        log_.error("accept failed: %s", error_buffer);
+      }
+      break;
+    }
     // create new client handler
     log_.debug("accepted connection from %s", endpoint.to_string().c_str());
 
     auto h = accept_handler_(sock, endpoint, this);
 
-    get_reactor()->register_handler(h, event_type::READ_WRITE_MASK);
+    reactor *r = reactor_assignment_ ? reactor_assignment_() : get_reactor();
+    r->register_handler(h, event_type::READ_WRITE_MASK);
 
     log_.debug("fd %d: accepted socket id %d", handle(), sock.id());
   }
@@ -77,7 +131,11 @@ void acceptor::on_input()
 void acceptor::close()
 {
   log_.debug("closing acceptor %d", acceptor_.id());
-  acceptor_.close();
+  if (completes_io_) {
+    get_reactor()->close_socket(acceptor_.release());
+  } else {
+    acceptor_.close();
+  }
   // Todo: unregister from reactor (maybe observer pattern?)
   // notify()
 }
@@ -97,6 +155,19 @@ const tcp::peer &acceptor::endpoint() const
   return endpoint_;
 }
 
+int acceptor::accept(tcp::socket &sock, tcp::peer &endpoint)
+{
+  // the connection was already accepted by the demultiplexer
+  auto fd = get_reactor()->accept(handle());
+  if (!is_valid_socket(fd)) {
+    return -1;
+  }
+  auto addr_len = static_cast<socklen_t>(endpoint.size());
+  ::getpeername(fd, endpoint.data(), &addr_len);
+  sock.assign(fd);
+  return static_cast<int>(fd);
+}
+
 tcp::peer acceptor::create_client_endpoint() const
 {
   if (endpoint_.addr().is_v4()) {
@@ -0,0 +1,89 @@
+#include "matador/net/demultiplexer.hpp"
+#include "matador/net/select_demultiplexer.hpp"
+#include "matador/net/epoll_demultiplexer.hpp"
+#include "matador/net/io_uring_demultiplexer.hpp"
+
+#include <cerrno>
+
+namespace matador {
+
+bool demultiplexer::completes_io() const
+{
+  return false;
+}
+
+void demultiplexer::complete_io(socket_type, io_operation)
+{}
+
+long demultiplexer::receive(socket_type, char *, std::size_t)
+{
+  errno = ENOTSUP;
+  return -1;
+}
+
+long demultiplexer::send(socket_type, std::list<buffer_view> &, const std::shared_ptr<void> &)
+{
+  errno = ENOTSUP;
+  return -1;
+}
+
+socket_type demultiplexer::accept(socket_type)
+{
+  errno = ENOTSUP;
+  return -1;
+}
+
+void demultiplexer::close(socket_type fd)
+{
+  os::close(fd);
+}
+
+demultiplexer_type default_demultiplexer_type()
+{
+#ifdef MATADOR_HAS_EPOLL
+  return demultiplexer_type::EPOLL;
+#else
+  return demultiplexer_type::SELECT;
+#endif
+}
+
+bool is_demultiplexer_available(demultiplexer_type type)
+{
+  switch (type) {
+    case demultiplexer_type::SELECT:
+      return true;
+#ifdef MATADOR_HAS_EPOLL
+    case demultiplexer_type::EPOLL:
+      return true;
+#endif
+#ifdef MATADOR_HAS_IO_URING
+    case demultiplexer_type::IO_URING:
+      return io_uring_demultiplexer::is_supported();
+#endif
+    default:
+      return false;
+  }
+}
+
+std::unique_ptr<demultiplexer> make_demultiplexer(demultiplexer_type type)
+{
+  switch (type) {
+    case demultiplexer_type::IO_URING:
+#ifdef MATADOR_HAS_IO_URING
+      if (io_uring_demultiplexer::is_supported()) {
+        return std::unique_ptr<demultiplexer>(new io_uring_demultiplexer);
+      }
+#endif
+      // kernel doesn't support io_uring; take the default
+      return make_demultiplexer(default_demultiplexer_type());
+#ifdef MATADOR_HAS_EPOLL
+    case demultiplexer_type::EPOLL:
+      return std::unique_ptr<demultiplexer>(new epoll_demultiplexer);
+#endif
+    case demultiplexer_type::SELECT:
+    default:
+      return std::unique_ptr<demultiplexer>(new select_demultiplexer);
+  }
+}
+
+}
@@ -0,0 +1,118 @@
+#include "matador/net/epoll_demultiplexer.hpp"
+#include "matador/net/error.hpp"
+
+#ifdef MATADOR_HAS_EPOLL
+
+#include <cerrno>
+
+#include <unistd.h>
+
+namespace matador {
+
+namespace {
+const std::size_t max_epoll_events = 256;
+}
+
+epoll_demultiplexer::epoll_demultiplexer()
+  : epoll_fd_(::epoll_create1(EPOLL_CLOEXEC))
+  , epoll_events_(max_epoll_events)
+{
+  if (epoll_fd_ < 0) {
+    detail::throw_logic_error_with_errno("couldn't create epoll instance: %s", errno);
+  }
+}
+
+epoll_demultiplexer::~epoll_demultiplexer()
+{
+  if (epoll_fd_ >= 0) {
+    ::close(epoll_fd_);
+  }
+}
+
+void epoll_demultiplexer::add(socket_type fd, event_type interest)
+{
+  struct epoll_event ev{};
+  ev.events = to_epoll_events(interest);
+  ev.data.fd = fd;
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == 0) {
+    ++size_;
+  } else if (errno == EEXIST) {
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+  } else {
+    detail::throw_logic_error_with_errno("couldn't add fd to epoll: %s", errno);
+  }
+}
+
+void epoll_demultiplexer::modify(socket_type fd, event_type interest)
+{
+  struct epoll_event ev{};
+  ev.events = to_epoll_events(interest);
+  ev.data.fd = fd;
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) != 0 && errno == ENOENT) {
+    // fd was implicitly removed on close and reused afterwards
+    add(fd, interest);
+  }
+}
+
+void epoll_demultiplexer::remove(socket_type fd)
+{
+  // a closed fd is already removed by the kernel; ignore errors
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) == 0 || errno == EBADF || errno == ENOENT) {
+    if (size_ > 0) {
+      --size_;
+    }
+  }
+}
+
+int epoll_demultiplexer::wait(long timeout, t_ready_events &events)
+{
+  int ret = ::epoll_wait(epoll_fd_, epoll_events_.data(), static_cast<int>(epoll_events_.size()), timeout < 0 ? -1 : static_cast<int>(timeout));
+  if (ret < 0) {
+    return ret;
+  }
+
+  for (int i = 0; i < ret; ++i) {
+    const auto &ev = epoll_events_[i];
+    // errors and hang ups are reported as read and write
+    // events; the handler recognizes them on the next io call
+    const bool is_error = (ev.events & (EPOLLERR | EPOLLHUP)) > 0;
+    if ((ev.events & EPOLLOUT) > 0 || is_error) {
+      events.push_back({ev.data.fd, event_type::WRITE_MASK});
+    }
+    if ((ev.events & (EPOLLIN | EPOLLRDHUP)) > 0 || is_error) {
+      events.push_back({ev.data.fd, event_type::READ_MASK});
+    }
+  }
+  return static_cast<int>(events.size());
+}
+
+bool epoll_demultiplexer::requires_interrupt() const
+{
+  return false;
+}
+
+std::size_t epoll_demultiplexer::size() const
+{
+  return size_;
+}
+
+demultiplexer_type epoll_demultiplexer::type() const
+{
+  return demultiplexer_type::EPOLL;
+}
+
+unsigned int epoll_demultiplexer::to_epoll_events(event_type interest)
+{
+  unsigned int events = 0;
+  if (is_event_type_set(interest, event_type::READ_MASK)) {
+    events |= EPOLLIN | EPOLLRDHUP;
+  }
+  if (is_event_type_set(interest, event_type::WRITE_MASK)) {
+    events |= EPOLLOUT;
+  }
+  return events;
+}
+
+}
+
+#endif
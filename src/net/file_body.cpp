@@ -0,0 +1,126 @@
+#include "matador/net/file_body.hpp"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace matador {
+
+file_body::file_body(const std::string &path)
+  : path_(path)
+{
+#ifdef _WIN32
+  fd_ = ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+  struct _stat64 st{};
+  if (fd_ >= 0 && ::_fstat64(fd_, &st) == 0) {
+    size_ = static_cast<std::size_t>(st.st_size);
+  }
+#else
+  fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat st{};
+  if (fd_ >= 0 && ::fstat(fd_, &st) == 0) {
+    if (!S_ISREG(st.st_mode)) {
+      // directories and devices aren't sent
+      ::close(fd_);
+      fd_ = -1;
+    } else {
+      size_ = static_cast<std::size_t>(st.st_size);
+    }
+  }
+#endif
+}
+
+file_body::~file_body()
+{
+  if (fd_ >= 0) {
+#ifdef _WIN32
+    ::_close(fd_);
+#else
+    ::close(fd_);
+#endif
+  }
+}
+
+const std::string &file_body::path() const
+{
+  return path_;
+}
+
+bool file_body::is_open() const
+{
+  return fd_ >= 0;
+}
+
+int file_body::fd() const
+{
+  return fd_;
+}
+
+std::size_t file_body::size() const
+{
+  return size_;
+}
+
+std::size_t file_body::offset() const
+{
+  return offset_;
+}
+
+std::size_t file_body::capacity() const
+{
+  return size_ - offset_;
+}
+
+void file_body::bump(std::size_t len)
+{
+  offset_ += (std::min)(len, capacity());
+}
+
+bool file_body::full() const
+{
+  return offset_ == size_;
+}
+
+long file_body::read(char *buf, std::size_t size) const
+{
+  size = (std::min)(size, capacity());
+#ifdef _WIN32
+  if (::_lseeki64(fd_, static_cast<__int64>(offset_), SEEK_SET) < 0) {
+    return -1;
+  }
+  return ::_read(fd_, buf, static_cast<unsigned int>(size));
+#else
+  return static_cast<long>(::pread(fd_, buf, size, static_cast<off_t>(offset_)));
+#endif
+}
+
+std::string file_body::to_string() const
+{
+  std::string content(size_, '\0');
+  std::size_t pos = 0;
+  while (pos < size_) {
+#ifdef _WIN32
+    if (::_lseeki64(fd_, static_cast<__int64>(pos), SEEK_SET) < 0) {
+      break;
+    }
+    auto len = ::_read(fd_, &content[pos], static_cast<unsigned int>(size_ - pos));
+#else
+    auto len = ::pread(fd_, &content[pos], size_ - pos, static_cast<off_t>(pos));
+#endif
+    if (len <= 0) {
+      break;
+    }
+    pos += static_cast<std::size_t>(len);
+  }
+  content.resize(pos);
+  return content;
+}
+
+}
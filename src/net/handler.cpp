@@ -14,6 +14,11 @@ time_t handler::interval() const
   return interval_;
 }
 
+void handler::on_timer(timer_id)
+{
+  on_timeout();
+}
+
 reactor *handler::get_reactor() const
 {
   return reactor_;
@@ -34,6 +39,7 @@ void handler::cancel_timer()
 {
   next_timeout_ = 0;
   interval_ = 0;
+  timer_ = 0;
 }
 
 void handler::calculate_next_timeout(time_t now)
@@ -42,6 +48,7 @@ void handler::calculate_next_timeout(time_t now)
     next_timeout_ = now + interval_;
   } else {
     next_timeout_ = 0;
+    timer_ = 0;
   }
 }
 
@@ -2,30 +2,115 @@
 
 #include "matador/logger/log_manager.hpp"
 
+#include <algorithm>
+#include <thread>
+
 namespace matador {
 
 io_service::io_service()
   : log_(matador::create_logger("IOService"))
-{}
+{
+  reactors_.emplace_back(new reactor);
+}
+
+io_service::io_service(demultiplexer_type type)
+  : log_(matador::create_logger("IOService"))
+{
+  reactors_.emplace_back(new reactor(type));
+}
+
+io_service::io_service(const io_service_config &config)
+  : log_(matador::create_logger("IOService"))
+  , policy_(config.policy)
+{
+  const std::size_t num_cpus = (std::max)(std::thread::hardware_concurrency(), 1U);
+  const std::size_t num_shards = config.shards > 0 ? config.shards : num_cpus;
+  for (std::size_t i = 0; i < num_shards; ++i) {
+    std::unique_ptr<reactor> r(new reactor(config.demultiplexer, config.threads_per_shard));
+    if (config.pin_threads) {
+      r->cpu_affinity(i % num_cpus);
+    }
+    reactors_.push_back(std::move(r));
+  }
+}
 
 io_service::~io_service()
 {
-  reactor_.shutdown();
+  shutdown();
 }
 
 void io_service::run()
 {
-  reactor_.run();
+  if (reactors_.size() == 1) {
+    reactors_.front()->run();
+    return;
+  }
+
+  log_.info("starting %d shards", static_cast<int>(reactors_.size()));
+  std::vector<std::thread> shard_threads;
+  for (std::size_t i = 1; i < reactors_.size(); ++i) {
+    auto r = reactors_[i].get();
+    shard_threads.emplace_back([r]() { r->run(); });
+  }
+  reactors_.front()->run();
+
+  for (auto &t : shard_threads) {
+    t.join();
+  }
 }
 
 bool io_service::is_running() const
 {
-  return reactor_.is_running();
+  return std::all_of(reactors_.begin(), reactors_.end(), [](const std::unique_ptr<reactor> &r) {
+    return r->is_running();
+  });
 }
 
 void io_service::shutdown()
 {
-  reactor_.shutdown();
+  for (auto &r : reactors_) {
+    r->shutdown();
+  }
+}
+
+std::size_t io_service::shards() const
+{
+  return reactors_.size();
+}
+
+reactor &io_service::shard(std::size_t index)
+{
+  return *reactors_.at(index);
+}
+
+void io_service::register_acceptor(const std::shared_ptr<acceptor> &ac, const acceptor::t_accept_handler &make_handler)
+{
+  if (reactors_.size() == 1) {
+    reactors_.front()->register_handler(ac, event_type::ACCEPT_MASK);
+    return;
+  }
+
+  if (policy_ == shard_policy::ROUND_ROBIN) {
+    ac->assign_reactor([this]() { return &next_reactor(); });
+    reactors_.front()->register_handler(ac, event_type::ACCEPT_MASK);
+    return;
+  }
+
+  // the first acceptor binds the endpoint; a given
+  // port zero is resolved and used by the other shards
+  ac->reuse_port(true);
+  reactors_.front()->register_handler(ac, event_type::ACCEPT_MASK);
+  for (std::size_t i = 1; i < reactors_.size(); ++i) {
+    auto shard_acceptor = std::make_shared<acceptor>(ac->endpoint(), make_handler);
+    shard_acceptor->reuse_port(true);
+    reactors_[i]->register_handler(shard_acceptor, event_type::ACCEPT_MASK);
+    shard_acceptors_.push_back(shard_acceptor);
+  }
 }
 
-}
\ No newline at end of file
+reactor &io_service::next_reactor()
+{
+  return *reactors_[next_shard_++ % reactors_.size()];
+}
+
+}
@@ -0,0 +1,1067 @@
+#include "matador/net/io_uring_demultiplexer.hpp"
+#include "matador/net/error.hpp"
+
+#ifdef MATADOR_HAS_IO_URING
+
+#include "matador/utils/buffer_view.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace matador {
+
+namespace {
+
+const unsigned ring_entries = 256;
+
+// provided buffers receiving the data of stream
+// sockets; the count must be a power of two
+const unsigned buffer_count = 128;
+const std::size_t buffer_size = 16384;
+const std::uint16_t buffer_group = 0;
+
+// received buffers and accepted connections queued
+// per socket before its request is cancelled
+const std::size_t max_received = 4;
+const std::size_t max_accepted = 64;
+
+#ifdef IOV_MAX
+const std::size_t max_iov = IOV_MAX;
+#else
+const std::size_t max_iov = 16;
+#endif
+
+// request kind encoded in the user data; cancels, closes,
+// wake ups and timeouts have zero user data and are ignored
+const std::uint8_t poll_op = 1;
+const std::uint8_t receive_op = 2;
+const std::uint8_t accept_op = 3;
+const std::uint8_t send_op = 4;
+
+int io_uring_setup(unsigned entries, struct io_uring_params *params)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, const void *arg, std::size_t argsz)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz));
+}
+
+#ifdef MATADOR_HAS_IO_URING_COMPLETION
+int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+#endif
+
+unsigned* ring_field(void *ring, unsigned offset)
+{
+  return reinterpret_cast<unsigned*>(static_cast<char*>(ring) + offset);
+}
+
+}
+
+struct io_uring_demultiplexer::send_request
+{
+  // keeps the sent buffers alive until the send completed
+  std::shared_ptr<void> owner;
+  std::vector<struct iovec> iov;
+  struct msghdr msg {};
+};
+
+io_uring_demultiplexer::io_uring_demultiplexer(bool complete_io)
+{
+  setup(complete_io);
+}
+
+io_uring_demultiplexer::~io_uring_demultiplexer()
+{
+  teardown();
+}
+
+void io_uring_demultiplexer::add(socket_type fd, event_type interest)
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  auto &entry = ensure_entry(fd);
+  if (!entry.registered) {
+    entry.registered = true;
+    ++size_;
+  }
+  if (entry.mode == entry_mode::POLL) {
+    disarm(fd, entry);
+  }
+  entry.interest = interest;
+  update(fd, entry);
+  if (submit() < 0) {
+    detail::throw_logic_error_with_errno("couldn't add fd to io_uring: %s", errno);
+  }
+}
+
+void io_uring_demultiplexer::modify(socket_type fd, event_type interest)
+{
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    auto entry = find_entry(fd);
+    if (entry != nullptr && entry->registered) {
+      if (entry->mode == entry_mode::POLL) {
+        if (entry->interest == interest && entry->armed) {
+          return;
+        }
+        disarm(fd, *entry);
+      }
+      entry->interest = interest;
+      update(fd, *entry);
+      if (submit() < 0) {
+        detail::throw_logic_error_with_errno("couldn't modify fd in io_uring: %s", errno);
+      }
+      return;
+    }
+  }
+  add(fd, interest);
+}
+
+void io_uring_demultiplexer::remove(socket_type fd)
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  auto entry = find_entry(fd);
+  if (entry == nullptr || !entry->registered) {
+    return;
+  }
+  // requests of a handed over socket go
+  // on until the socket is closed
+  disarm(fd, *entry);
+  entry->registered = false;
+  entry->interest = event_type::NONE_MASK;
+  --size_;
+  // the fd may already be closed; nothing
+  // to do if the poll removal fails
+  submit();
+}
+
+int io_uring_demultiplexer::wait(long timeout, t_ready_events &events)
+{
+  struct __kernel_timespec ts{};
+  unsigned min_complete = 1;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    // poll requests are one shot; arm descriptors which
+    // fired with the last wait and kept their interest
+    for (auto fd : fired_) {
+      auto entry = find_entry(fd);
+      if (entry != nullptr) {
+        update(fd, *entry);
+      }
+    }
+    fired_.clear();
+    if (!ready_.empty()) {
+      // completed requests are reported without waiting
+      timeout = 0;
+    }
+    if (timeout == 0) {
+      min_complete = 0;
+    } else if (timeout > 0) {
+      ts.tv_sec = timeout / 1000;
+      ts.tv_nsec = (timeout % 1000) * 1000000;
+      if (!ext_arg_) {
+        // the timeout completes the wait at the latest
+        auto sqe = next_sqe();
+        if (sqe != nullptr) {
+          sqe->opcode = IORING_OP_TIMEOUT;
+          sqe->addr = reinterpret_cast<std::uint64_t>(&ts);
+          sqe->len = 1;
+          sqe->off = 1;
+        }
+      }
+    }
+    if (submit() < 0) {
+      return -1;
+    }
+    waiting_ = min_complete > 0;
+    woken_ = false;
+  }
+
+  int ret = 0;
+  if (min_complete > 0) {
+    if (ext_arg_) {
+      struct io_uring_getevents_arg arg{};
+      if (timeout > 0) {
+        arg.ts = reinterpret_cast<std::uint64_t>(&ts);
+      }
+      ret = io_uring_enter(ring_fd_, 0, min_complete, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    } else {
+      ret = io_uring_enter(ring_fd_, 0, min_complete, IORING_ENTER_GETEVENTS, nullptr, 0);
+    }
+  }
+
+  std::lock_guard<std::mutex> l(mutex_);
+  waiting_ = false;
+  if (ret < 0 && errno != ETIME) {
+    return ret;
+  }
+
+  unsigned head = *cq_head_;
+  const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    const auto &cqe = cqes_[head & *cq_mask_];
+    const auto op = static_cast<std::uint8_t>(cqe.user_data >> 56);
+    const auto sequence = static_cast<std::uint32_t>((cqe.user_data >> 32) & 0xffffff);
+    const auto fd = static_cast<socket_type>(cqe.user_data & 0xffffffff);
+    switch (op) {
+      case poll_op:
+        on_poll(fd, sequence, cqe.res, events);
+        break;
+      case receive_op:
+        on_receive(fd, sequence, cqe);
+        break;
+      case accept_op:
+        on_accept(fd, sequence, cqe);
+        break;
+      case send_op:
+        on_send(fd, sequence, cqe);
+        break;
+      default:
+        break;
+    }
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+  // sockets with completed requests; all events
+  // of a socket are reported write before read
+  for (auto fd : ready_) {
+    auto entry = find_entry(fd);
+    if (entry == nullptr || !entry->ready) {
+      continue;
+    }
+    entry->ready = false;
+    if (!entry->registered) {
+      continue;
+    }
+    if (is_event_type_set(entry->interest, event_type::WRITE_MASK) && (entry->sent || entry->writable)) {
+      if (entry->writable) {
+        // polled again if the handler doesn't send
+        entry->writable = false;
+        fired_.push_back(fd);
+      }
+      events.push_back({fd, event_type::WRITE_MASK});
+    }
+    if (is_event_type_set(entry->interest, event_type::READ_MASK) &&
+        (!entry->received.empty() || !entry->accepted.empty() || entry->eof || entry->error != 0)) {
+      events.push_back({fd, event_type::READ_MASK});
+    }
+  }
+  ready_.clear();
+  // requests armed again by the completions
+  submit();
+  return static_cast<int>(events.size());
+}
+
+bool io_uring_demultiplexer::requires_interrupt() const
+{
+  // poll requests are submitted directly and
+  // complete a blocked wait when ready
+  return false;
+}
+
+std::size_t io_uring_demultiplexer::size() const
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  return size_;
+}
+
+demultiplexer_type io_uring_demultiplexer::type() const
+{
+  return demultiplexer_type::IO_URING;
+}
+
+bool io_uring_demultiplexer::completes_io() const
+{
+  return completes_io_;
+}
+
+void io_uring_demultiplexer::complete_io(socket_type fd, io_operation op)
+{
+  if (!completes_io_) {
+    return;
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  auto &entry = ensure_entry(fd);
+  if (entry.mode == entry_mode::POLL) {
+    disarm(fd, entry);
+  }
+  entry.mode = op == io_operation::STREAM ? entry_mode::STREAM : entry_mode::ACCEPT;
+  if (entry.mode == entry_mode::STREAM) {
+    provide_buffers();
+  }
+  update(fd, entry);
+  if (submit() < 0) {
+    detail::throw_logic_error_with_errno("couldn't complete io of fd with io_uring: %s", errno);
+  }
+}
+
+long io_uring_demultiplexer::receive(socket_type fd, char *buf, std::size_t len)
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  auto entry = find_entry(fd);
+  if (entry == nullptr || entry->mode != entry_mode::STREAM) {
+    errno = EBADF;
+    return -1;
+  }
+  std::size_t copied = 0;
+  bool recycled = false;
+  while (copied < len && !entry->received.empty()) {
+    auto &received = entry->received.front();
+    const auto size = (std::min)(len - copied, static_cast<std::size_t>(received.size - received.offset));
+    std::memcpy(buf + copied, buffers_ + received.id * buffer_size + received.offset, size);
+    copied += size;
+    received.offset += static_cast<std::uint32_t>(size);
+    if (received.offset == received.size) {
+      recycle(received.id);
+      entry->received.pop_front();
+      recycled = true;
+    }
+  }
+  if (recycled) {
+    resume_starved();
+  }
+  // receives again below the limit of queued buffers
+  update(fd, *entry);
+  submit();
+
+  if (copied > 0) {
+    return static_cast<long>(copied);
+  }
+  if (entry->error != 0) {
+    errno = entry->error;
+    return -1;
+  }
+  if (entry->eof) {
+    return 0;
+  }
+  errno = EAGAIN;
+  return -1;
+}
+
+long io_uring_demultiplexer::send(socket_type fd, std::list<buffer_view> &buffers, const std::shared_ptr<void> &owner)
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  auto entry = find_entry(fd);
+  if (entry == nullptr || entry->mode != entry_mode::STREAM) {
+    errno = EBADF;
+    return -1;
+  }
+  long result = -1;
+  int error = EAGAIN;
+  if (entry->sent) {
+    // the buffers of the completed send are consumed
+    entry->sent = false;
+    if (entry->send_result < 0) {
+      error = static_cast<int>(-entry->send_result);
+    } else {
+      result = entry->send_result;
+      auto bytes_to_consume = static_cast<std::size_t>(result);
+      while (bytes_to_consume > 0 && !buffers.empty()) {
+        auto &buf = buffers.front();
+        if (buf.capacity() > bytes_to_consume) {
+          buf.bump(bytes_to_consume);
+          bytes_to_consume = 0;
+        } else {
+          bytes_to_consume -= buf.capacity();
+          buffers.pop_front();
+        }
+      }
+    }
+  }
+  entry->writable = false;
+  if (error == EAGAIN && !entry->sending && !buffers.empty() && !submit_send(fd, *entry, buffers, owner)) {
+    error = ENOBUFS;
+  }
+  // polls for writability after a send failing with EAGAIN
+  update(fd, *entry);
+  if (submit() < 0 && result < 0) {
+    error = errno;
+  }
+  if (result < 0) {
+    errno = error;
+  }
+  return result;
+}
+
+socket_type io_uring_demultiplexer::accept(socket_type fd)
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  auto entry = find_entry(fd);
+  if (entry == nullptr || entry->mode != entry_mode::ACCEPT) {
+    errno = EBADF;
+    return -1;
+  }
+  socket_type accepted = -1;
+  int error = EAGAIN;
+  if (!entry->accepted.empty()) {
+    accepted = entry->accepted.front();
+    entry->accepted.pop_front();
+  } else if (entry->error != 0) {
+    // the accept is armed again after the error was taken
+    error = entry->error;
+    entry->error = 0;
+  }
+  update(fd, *entry);
+  submit();
+  if (accepted < 0) {
+    errno = error;
+  }
+  return accepted;
+}
+
+void io_uring_demultiplexer::close(socket_type fd)
+{
+  if (fd <= 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  auto entry = find_entry(fd);
+  if (entry != nullptr) {
+    disarm(fd, *entry);
+    if (entry->input == request_state::ARMED) {
+      cancel(to_user_data(entry->mode == entry_mode::STREAM ? receive_op : accept_op, fd, entry->input_sequence));
+    }
+    if (entry->sending) {
+      cancel(to_user_data(send_op, fd, entry->send_sequence));
+    }
+    for (const auto &received : entry->received) {
+      recycle(received.id);
+    }
+    for (auto accepted : entry->accepted) {
+      ::close(accepted);
+    }
+    const bool recycled = !entry->received.empty();
+    if (entry->registered) {
+      --size_;
+    }
+    // completions of the pending requests are outdated now
+    *entry = fd_entry();
+    if (recycled) {
+      resume_starved();
+    }
+  }
+  auto sqe = next_sqe();
+  if (sqe != nullptr) {
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = fd;
+  } else {
+    ::close(fd);
+  }
+  submit();
+}
+
+bool io_uring_demultiplexer::is_supported()
+{
+  static const bool supported = []() {
+    try {
+      io_uring_demultiplexer demultiplexer(false);
+      return true;
+    } catch (...) {
+      return false;
+    }
+  }();
+  return supported;
+}
+
+void io_uring_demultiplexer::setup(bool complete_io)
+{
+  struct io_uring_params params{};
+  ring_fd_ = io_uring_setup(ring_entries, &params);
+  if (ring_fd_ < 0) {
+    detail::throw_logic_error_with_errno("couldn't create io_uring instance: %s", errno);
+  }
+  if ((params.features & IORING_FEAT_NODROP) == 0) {
+    teardown();
+    detail::throw_logic_error("io_uring of kernel lacks required features");
+  }
+  ext_arg_ = (params.features & IORING_FEAT_EXT_ARG) > 0;
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) > 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = (std::max)(sq_ring_size_, cq_ring_size_);
+  }
+
+  sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    int err = errno;
+    teardown();
+    detail::throw_logic_error_with_errno("couldn't map io_uring submission ring: %s", err);
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      int err = errno;
+      teardown();
+      detail::throw_logic_error_with_errno("couldn't map io_uring completion ring: %s", err);
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  void *sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    int err = errno;
+    teardown();
+    detail::throw_logic_error_with_errno("couldn't map io_uring submission entries: %s", err);
+  }
+  sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+  sq_head_ = ring_field(sq_ring_, params.sq_off.head);
+  sq_tail_ = ring_field(sq_ring_, params.sq_off.tail);
+  sq_mask_ = ring_field(sq_ring_, params.sq_off.ring_mask);
+  sq_array_ = ring_field(sq_ring_, params.sq_off.array);
+  sq_entries_ = params.sq_entries;
+
+  cq_head_ = ring_field(cq_ring_, params.cq_off.head);
+  cq_tail_ = ring_field(cq_ring_, params.cq_off.tail);
+  cq_mask_ = ring_field(cq_ring_, params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<struct io_uring_cqe*>(static_cast<char*>(cq_ring_) + params.cq_off.cqes);
+
+  completes_io_ = complete_io && setup_completion(params.features);
+}
+
+
+bool io_uring_demultiplexer::setup_completion(unsigned int features)
+{
+#ifdef MATADOR_HAS_IO_URING_COMPLETION
+  // requests wait for readiness inside the kernel
+  if ((features & IORING_FEAT_FAST_POLL) == 0) {
+    return false;
+  }
+  std::vector<std::uint64_t> probe_data((sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op)) / sizeof(std::uint64_t), 0);
+  auto probe = reinterpret_cast<struct io_uring_probe*>(probe_data.data());
+  if (io_uring_register(ring_fd_, IORING_REGISTER_PROBE, probe, 256) < 0) {
+    return false;
+  }
+  const std::uint8_t ops[] = { IORING_OP_NOP, IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SENDMSG, IORING_OP_ASYNC_CANCEL, IORING_OP_CLOSE };
+  for (auto op : ops) {
+    if (op > probe->last_op || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0) {
+      return false;
+    }
+  }
+
+  // the buffers of the ring are allocated
+  // with the first stream socket
+  buffer_ring_size_ = buffer_count * sizeof(struct io_uring_buf);
+  void *ring = ::mmap(nullptr, buffer_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ring == MAP_FAILED) {
+    return false;
+  }
+  struct io_uring_buf_reg reg{};
+  reg.ring_addr = reinterpret_cast<std::uint64_t>(ring);
+  reg.ring_entries = buffer_count;
+  reg.bgid = buffer_group;
+  if (io_uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+    ::munmap(ring, buffer_ring_size_);
+    return false;
+  }
+  buffer_ring_ = ring;
+  return true;
+#else
+  (void)features;
+  return false;
+#endif
+}
+
+void io_uring_demultiplexer::teardown()
+{
+  if (sqes_ != nullptr) {
+    ::munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    ::munmap(cq_ring_, cq_ring_size_);
+  }
+  cq_ring_ = nullptr;
+  if (sq_ring_ != nullptr) {
+    ::munmap(sq_ring_, sq_ring_size_);
+    sq_ring_ = nullptr;
+  }
+  if (ring_fd_ >= 0) {
+    ::close(ring_fd_);
+    ring_fd_ = -1;
+  }
+  // the kernel doesn't use the buffers after the ring is closed
+  if (buffers_ != nullptr) {
+    ::munmap(buffers_, buffer_count * buffer_size);
+    buffers_ = nullptr;
+  }
+  if (buffer_ring_ != nullptr) {
+    ::munmap(buffer_ring_, buffer_ring_size_);
+    buffer_ring_ = nullptr;
+  }
+  for (auto &entry : entries_) {
+    for (auto accepted : entry.accepted) {
+      ::close(accepted);
+    }
+  }
+}
+
+io_uring_demultiplexer::fd_entry& io_uring_demultiplexer::ensure_entry(socket_type fd)
+{
+  if (static_cast<std::size_t>(fd) >= entries_.size()) {
+    entries_.resize(static_cast<std::size_t>(fd) + 1);
+  }
+  return entries_[fd];
+}
+
+io_uring_demultiplexer::fd_entry* io_uring_demultiplexer::find_entry(socket_type fd)
+{
+  if (fd < 0 || static_cast<std::size_t>(fd) >= entries_.size()) {
+    return nullptr;
+  }
+  return &entries_[fd];
+}
+
+void io_uring_demultiplexer::update(socket_type fd, fd_entry &entry)
+{
+  switch (entry.mode) {
+    case entry_mode::POLL:
+      if (entry.registered && !entry.armed) {
+        arm(fd, entry, to_poll_events(entry.interest));
+      }
+      return;
+    case entry_mode::STREAM: {
+      if (entry.input == request_state::IDLE && !entry.starved && !entry.eof && entry.error == 0 && entry.received.size() < max_received) {
+        arm_receive(fd, entry);
+      }
+      // a socket is polled for writability only
+      // after a send failed with EAGAIN
+      const bool poll_output = entry.registered && is_event_type_set(entry.interest, event_type::WRITE_MASK) &&
+                               !entry.sending && !entry.sent && !entry.writable;
+      if (poll_output && !entry.armed) {
+        arm(fd, entry, POLLOUT);
+      } else if (!poll_output) {
+        disarm(fd, entry);
+      }
+      break;
+    }
+    case entry_mode::ACCEPT:
+      if (entry.input == request_state::IDLE && entry.error == 0 && entry.accepted.size() < max_accepted) {
+        arm_accept(fd, entry);
+      }
+      break;
+  }
+  if (is_ready(entry)) {
+    mark_ready(fd, entry);
+  }
+}
+
+bool io_uring_demultiplexer::is_ready(const fd_entry &entry) const
+{
+  if (!entry.registered) {
+    return false;
+  }
+  if (is_event_type_set(entry.interest, event_type::WRITE_MASK) && (entry.sent || entry.writable)) {
+    return true;
+  }
+  return is_event_type_set(entry.interest, event_type::READ_MASK) &&
+         (!entry.received.empty() || !entry.accepted.empty() || entry.eof || entry.error != 0);
+}
+
+void io_uring_demultiplexer::mark_ready(socket_type fd, fd_entry &entry)
+{
+  if (entry.ready) {
+    return;
+  }
+  entry.ready = true;
+  ready_.push_back(fd);
+  if (waiting_ && !woken_) {
+    // a blocked wait returns with the completion of a nop
+    woken_ = true;
+    auto sqe = next_sqe();
+    if (sqe != nullptr) {
+      sqe->opcode = IORING_OP_NOP;
+    }
+  }
+}
+
+void io_uring_demultiplexer::arm(socket_type fd, fd_entry &entry, unsigned int poll_events)
+{
+  if (poll_events == 0) {
+    return;
+  }
+  auto sqe = next_sqe();
+  if (sqe == nullptr) {
+    return;
+  }
+  entry.sequence = next_sequence();
+  entry.armed = true;
+
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  poll_events = (poll_events << 16) | (poll_events >> 16);
+#endif
+  sqe->poll32_events = poll_events;
+  sqe->user_data = to_user_data(poll_op, fd, entry.sequence);
+}
+
+void io_uring_demultiplexer::disarm(socket_type fd, fd_entry &entry)
+{
+  if (!entry.armed) {
+    return;
+  }
+  entry.armed = false;
+  auto sqe = next_sqe();
+  if (sqe == nullptr) {
+    return;
+  }
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = to_user_data(poll_op, fd, entry.sequence);
+}
+
+void io_uring_demultiplexer::arm_receive(socket_type fd, fd_entry &entry)
+{
+#ifdef MATADOR_HAS_IO_URING_COMPLETION
+  auto sqe = next_sqe();
+  if (sqe == nullptr) {
+    return;
+  }
+  entry.input_sequence = next_sequence();
+  entry.input = request_state::ARMED;
+
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = buffer_group;
+  // a single shot recv of a non blocking socket
+  // must wait for data instead of failing
+  sqe->ioprio = multishot_receive_ ? IORING_RECV_MULTISHOT : IORING_RECVSEND_POLL_FIRST;
+  sqe->user_data = to_user_data(receive_op, fd, entry.input_sequence);
+#else
+  (void)fd;
+  (void)entry;
+#endif
+}
+
+void io_uring_demultiplexer::arm_accept(socket_type fd, fd_entry &entry)
+{
+#ifdef MATADOR_HAS_IO_URING_COMPLETION
+  auto sqe = next_sqe();
+  if (sqe == nullptr) {
+    return;
+  }
+  entry.input_sequence = next_sequence();
+  entry.input = request_state::ARMED;
+
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = fd;
+  sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+  sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+  sqe->user_data = to_user_data(accept_op, fd, entry.input_sequence);
+#else
+  (void)fd;
+  (void)entry;
+#endif
+}
+
+void io_uring_demultiplexer::cancel(std::uint64_t user_data)
+{
+  auto sqe = next_sqe();
+  if (sqe == nullptr) {
+    return;
+  }
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = user_data;
+}
+
+bool io_uring_demultiplexer::submit_send(socket_type fd, fd_entry &entry, std::list<buffer_view> &buffers, const std::shared_ptr<void> &owner)
+{
+  std::unique_ptr<send_request> request(new send_request);
+  request->owner = owner;
+  for (auto &buf : buffers) {
+    if (request->iov.size() == max_iov) {
+      break;
+    }
+    if (buf.capacity() == 0) {
+      continue;
+    }
+    struct iovec iov{};
+    iov.iov_base = buf.data();
+    iov.iov_len = buf.capacity();
+    request->iov.push_back(iov);
+  }
+  if (request->iov.empty()) {
+    // nothing left to send
+    buffers.clear();
+    return true;
+  }
+  auto sqe = next_sqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  request->msg.msg_iov = request->iov.data();
+  request->msg.msg_iovlen = request->iov.size();
+  entry.send_sequence = next_sequence();
+  entry.sending = true;
+
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<std::uint64_t>(&request->msg);
+  sqe->len = 1;
+  sqe->msg_flags = MSG_NOSIGNAL;
+  sqe->user_data = to_user_data(send_op, fd, entry.send_sequence);
+  sends_[sqe->user_data] = std::move(request);
+  return true;
+}
+
+void io_uring_demultiplexer::on_poll(socket_type fd, std::uint32_t sequence, int result, t_ready_events &events)
+{
+  auto entry = find_entry(fd);
+  if (entry == nullptr || !entry->armed || entry->sequence != sequence) {
+    // completion of an outdated poll request
+    return;
+  }
+  entry->armed = false;
+  if (result < 0) {
+    // stays disarmed until the interest changes
+    return;
+  }
+  if (entry->mode != entry_mode::POLL) {
+    // errors are reported by the next send
+    entry->writable = true;
+    mark_ready(fd, *entry);
+    return;
+  }
+  if (!entry->registered) {
+    return;
+  }
+  fired_.push_back(fd);
+  // errors and hang ups are reported as read and write
+  // events; the handler recognizes them on the next io call
+  const auto revents = static_cast<unsigned>(result);
+  const bool is_error = (revents & (POLLERR | POLLHUP)) > 0;
+  if ((revents & POLLOUT) > 0 || is_error) {
+    events.push_back({fd, event_type::WRITE_MASK});
+  }
+  if ((revents & (POLLIN | POLLRDHUP)) > 0 || is_error) {
+    events.push_back({fd, event_type::READ_MASK});
+  }
+}
+
+void io_uring_demultiplexer::on_receive(socket_type fd, std::uint32_t sequence, const struct io_uring_cqe &cqe)
+{
+#ifdef MATADOR_HAS_IO_URING_COMPLETION
+  const bool has_buffer = (cqe.flags & IORING_CQE_F_BUFFER) > 0;
+  const auto id = static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+  auto entry = find_entry(fd);
+  if (entry == nullptr || entry->mode != entry_mode::STREAM || entry->input == request_state::IDLE || entry->input_sequence != sequence) {
+    // data of a closed socket
+    if (has_buffer) {
+      recycle(id);
+      resume_starved();
+    }
+    return;
+  }
+  if ((cqe.flags & IORING_CQE_F_MORE) == 0) {
+    entry->input = request_state::IDLE;
+  }
+  if (cqe.res > 0 && has_buffer) {
+    entry->received.push_back({id, static_cast<std::uint32_t>(cqe.res), 0});
+    if (entry->received.size() >= max_received && entry->input == request_state::ARMED) {
+      // the handler takes the data first
+      cancel(to_user_data(receive_op, fd, entry->input_sequence));
+      entry->input = request_state::CANCELLING;
+    }
+  } else {
+    if (has_buffer) {
+      recycle(id);
+      resume_starved();
+    }
+    if (cqe.res == 0) {
+      entry->eof = true;
+    } else if (cqe.res == -ENOBUFS) {
+      // receives again when buffers were recycled
+      entry->starved = true;
+      starved_.push_back(fd);
+    } else if (cqe.res == -EINVAL && multishot_receive_) {
+      multishot_receive_ = false;
+    } else if (cqe.res != -ECANCELED && cqe.res != -EAGAIN && cqe.res != -EINTR) {
+      entry->error = -cqe.res;
+    }
+  }
+  update(fd, *entry);
+#else
+  (void)fd;
+  (void)sequence;
+  (void)cqe;
+#endif
+}
+
+void io_uring_demultiplexer::on_accept(socket_type fd, std::uint32_t sequence, const struct io_uring_cqe &cqe)
+{
+#ifdef MATADOR_HAS_IO_URING_COMPLETION
+  auto entry = find_entry(fd);
+  if (entry == nullptr || entry->mode != entry_mode::ACCEPT || entry->input == request_state::IDLE || entry->input_sequence != sequence) {
+    // connection of a closed listening socket
+    if (cqe.res >= 0) {
+      ::close(cqe.res);
+    }
+    return;
+  }
+  if ((cqe.flags & IORING_CQE_F_MORE) == 0) {
+    entry->input = request_state::IDLE;
+  }
+  if (cqe.res >= 0) {
+    entry->accepted.push_back(cqe.res);
+    if (entry->accepted.size() >= max_accepted && entry->input == request_state::ARMED) {
+      cancel(to_user_data(accept_op, fd, entry->input_sequence));
+      entry->input = request_state::CANCELLING;
+    }
+  } else if (cqe.res != -ECANCELED && cqe.res != -EAGAIN && cqe.res != -EINTR) {
+    entry->error = -cqe.res;
+  }
+  update(fd, *entry);
+#else
+  (void)fd;
+  (void)sequence;
+  (void)cqe;
+#endif
+}
+
+void io_uring_demultiplexer::on_send(socket_type fd, std::uint32_t sequence, const struct io_uring_cqe &cqe)
+{
+  // releases the owner of the sent buffers
+  sends_.erase(to_user_data(send_op, fd, sequence));
+  auto entry = find_entry(fd);
+  if (entry == nullptr || entry->mode != entry_mode::STREAM || !entry->sending || entry->send_sequence != sequence) {
+    return;
+  }
+  entry->sending = false;
+  if (cqe.res != -EAGAIN) {
+    entry->sent = true;
+    entry->send_result = cqe.res;
+  }
+  update(fd, *entry);
+}
+
+void io_uring_demultiplexer::provide_buffers()
+{
+  if (buffers_ != nullptr) {
+    return;
+  }
+  void *buffers = ::mmap(nullptr, buffer_count * buffer_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buffers == MAP_FAILED) {
+    detail::throw_logic_error_with_errno("couldn't allocate io_uring buffers: %s", errno);
+  }
+  buffers_ = static_cast<char*>(buffers);
+  for (unsigned i = 0; i < buffer_count; ++i) {
+    recycle(static_cast<std::uint16_t>(i));
+  }
+}
+
+void io_uring_demultiplexer::recycle(std::uint16_t id)
+{
+#ifdef MATADOR_HAS_IO_URING_COMPLETION
+  // the entries are addressed directly; the tail of the
+  // ring overlaps the reserved field of the first entry
+  auto buf = static_cast<struct io_uring_buf*>(buffer_ring_) + (buffer_tail_ & (buffer_count - 1));
+  buf->addr = reinterpret_cast<std::uint64_t>(buffers_ + id * buffer_size);
+  buf->len = static_cast<std::uint32_t>(buffer_size);
+  buf->bid = id;
+  ++buffer_tail_;
+  __atomic_store_n(&static_cast<struct io_uring_buf_ring*>(buffer_ring_)->tail, buffer_tail_, __ATOMIC_RELEASE);
+#else
+  (void)id;
+#endif
+}
+
+void io_uring_demultiplexer::resume_starved()
+{
+  std::vector<socket_type> starved;
+  starved.swap(starved_);
+  for (auto fd : starved) {
+    auto entry = find_entry(fd);
+    if (entry != nullptr && entry->starved) {
+      entry->starved = false;
+      update(fd, *entry);
+    }
+  }
+}
+
+struct io_uring_sqe* io_uring_demultiplexer::next_sqe()
+{
+  unsigned tail = *sq_tail_;
+  if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+    // ring is full; hand the pending entries to the kernel
+    submit();
+    if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+      return nullptr;
+    }
+  }
+  const unsigned index = tail & *sq_mask_;
+  auto sqe = &sqes_[index];
+  std::memset(sqe, 0, sizeof(struct io_uring_sqe));
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++to_submit_;
+  return sqe;
+}
+
+int io_uring_demultiplexer::submit()
+{
+  while (to_submit_ > 0) {
+    int ret = io_uring_enter(ring_fd_, to_submit_, 0, 0, nullptr, 0);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return ret;
+    }
+    if (ret == 0) {
+      break;
+    }
+    to_submit_ -= (std::min)(to_submit_, static_cast<unsigned>(ret));
+  }
+  return 0;
+}
+
+std::uint32_t io_uring_demultiplexer::next_sequence()
+{
+  // the sequence takes 24 bits of the user data
+  next_sequence_ = (next_sequence_ + 1) & 0xffffff;
+  if (next_sequence_ == 0) {
+    ++next_sequence_;
+  }
+  return next_sequence_;
+}
+
+std::uint64_t io_uring_demultiplexer::to_user_data(std::uint8_t op, socket_type fd, std::uint32_t sequence)
+{
+  return (static_cast<std::uint64_t>(op) << 56) | (static_cast<std::uint64_t>(sequence & 0xffffff) << 32) | static_cast<std::uint32_t>(fd);
+}
+
+unsigned int io_uring_demultiplexer::to_poll_events(event_type interest)
+{
+  unsigned int events = 0;
+  if (is_event_type_set(interest, event_type::READ_MASK)) {
+    events |= POLLIN | POLLRDHUP;
+  }
+  if (is_event_type_set(interest, event_type::WRITE_MASK)) {
+    events |= POLLOUT;
+  }
+  return events;
+}
+
+}
+
+#endif
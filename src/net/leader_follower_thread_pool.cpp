@@ -16,10 +16,18 @@ void leader_follower_thread_pool::start()
   is_running_ = true;
   for (std::size_t i = 0; i < num_threads_; ++i) {
     threads_.emplace_back([this] { execute(); });
+    if (cpu_ >= 0 && !pin_thread_to_cpu(threads_.back(), static_cast<std::size_t>(cpu_))) {
+      log_.warn("couldn't bind thread to cpu %d", cpu_);
+    }
   }
   log_.info("thread pool started with %d threads", num_threads_);
 }
 
+void leader_follower_thread_pool::cpu_affinity(std::size_t cpu)
+{
+  cpu_ = static_cast<int>(cpu);
+}
+
 void leader_follower_thread_pool::stop()
 {
   is_running_ = false;
@@ -44,6 +52,11 @@ std::size_t leader_follower_thread_pool::size() const
   return threads_.size();
 }
 
+std::size_t leader_follower_thread_pool::num_threads() const
+{
+  return num_threads_;
+}
+
 void leader_follower_thread_pool::shutdown()
 {
   {
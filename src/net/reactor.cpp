@@ -4,6 +4,7 @@
 #include "matador/logger/log_manager.hpp"
 
 #include <algorithm>
+#include <unordered_map>
 #include <limits>
 #include <cerrno>
 #include <ctime>
@@ -12,10 +13,24 @@
 namespace matador {
 
 reactor::reactor()
+  : reactor(default_demultiplexer_type())
+{}
+
+reactor::reactor(demultiplexer_type type)
+  : reactor(type, 4)
+{}
+
+reactor::reactor(demultiplexer_type type, std::size_t num_threads)
+  : reactor(make_demultiplexer(type), num_threads)
+{}
+
+reactor::reactor(std::unique_ptr<demultiplexer> demultiplexer, std::size_t num_threads)
   : sentinel_(std::shared_ptr<handler>(nullptr))
   , log_(create_logger("Reactor"))
-  , thread_pool_(4, [this]() { handle_events(); })
+  , demultiplexer_(std::move(demultiplexer))
+  , thread_pool_((std::max)(num_threads, std::size_t(1)), [this]() { handle_events(); })
 {
+  demultiplexer_->add(interrupter_.socket_id(), event_type::READ_MASK);
 }
 reactor::~reactor()
 {
@@ -32,12 +47,13 @@ void reactor::register_handler(const handler_ptr& h, event_type et)
   auto it = find_handler_type(h);
 
   if (it == handlers_.end()) {
-    handlers_.emplace_back(h, et);
+    it = add_handler_type(h, et);
   } else if (it->first != h) {
     throw std::logic_error("given handler isn't expected handler");
   } else {
     it->second = it->second | et;
   }
+  update_interest(*it);
   interrupt_without_lock();
 }
 
@@ -48,12 +64,21 @@ void reactor::unregister_handler(const handler_ptr& h, event_type)
 
   if (it != handlers_.end()) {
     (*it).first->close();
-    handlers_.erase(it);
+    remove_handler_type(it);
   }
   interrupt_without_lock();
 }
 
 void reactor::schedule_timer(const std::shared_ptr<handler>& h, time_t offset, time_t interval)
+{
+  if (h->timer_ != 0) {
+    cancel_timer(h, h->timer_);
+  }
+  h->schedule(offset, interval);
+  h->timer_ = schedule_timer(h, std::chrono::seconds(offset), std::chrono::seconds(interval));
+}
+
+timer_id reactor::schedule_timer(const std::shared_ptr<handler>& h, std::chrono::milliseconds offset, std::chrono::milliseconds interval)
 {
   h->register_reactor(this);
 
@@ -61,10 +86,20 @@ void reactor::schedule_timer(const std::shared_ptr<handler>& h, time_t offset, t
   auto it = find_handler_type(h);
 
   if (it == handlers_.end()) {
-    handlers_.emplace_back(h, event_type::TIMEOUT_MASK);
+    add_handler_type(h, event_type::TIMEOUT_MASK);
+  } else {
+    it->second |= event_type::TIMEOUT_MASK;
   }
 
-  h->schedule(offset, interval);
+  const auto now = timer_wheel::clock::now();
+  auto id = timers_.schedule(h, offset, interval, now);
+
+  // wake up a leader waiting longer than the new timer
+  if (now + offset < next_wakeup_) {
+    next_wakeup_ = now + offset;
+    interrupt_without_lock();
+  }
+  return id;
 }
 
 void reactor::cancel_timer(const std::shared_ptr<handler>& h)
@@ -73,12 +108,22 @@ void reactor::cancel_timer(const std::shared_ptr<handler>& h)
   auto it = find_handler_type(h);
 
   if (it != handlers_.end()) {
-    handlers_.erase(it);
+    remove_handler_type(it);
   }
+  timers_.cancel(h.get());
 
   h->cancel_timer();
 }
 
+bool reactor::cancel_timer(const std::shared_ptr<handler>& h, timer_id id)
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  if (h->timer_ == id) {
+    h->cancel_timer();
+  }
+  return timers_.cancel(id);
+}
+
 void reactor::run()
 {
 //  log_.info("start dispatching all clients");
@@ -96,97 +141,64 @@ void reactor::run()
 
 void reactor::handle_events()
 {
-//  std::cout << this << " start handle events\n" << std::flush;
-
-//  log_.info("handle events");
-
   running_ = true;
-  time_t timeout;
-  select_fdsets fd_sets;
-  prepare_select_bits(timeout, fd_sets);
 
-//  std::cout << this << " fd sets r: " << fd_sets.read_set().count() << ", w: " << fd_sets.write_set().count() << ", e: " << fd_sets.except_set().count() << ", max: " << fd_sets.maxp1() << "\n" << std::flush;
+  // take the next handler of the current batch
+  // without demultiplexing again
+  ready_handler rh = next_ready_handler();
 
-//  log_.debug("fds [r: %d, w: %d, e: %d]",
-//             fdsets_.read_set().count(),
-//             fdsets_.write_set().count(),
-//             fdsets_.except_set().count());
+  if (!rh.handler) {
+    long timeout = next_timeout();
 
-//  if (timeout != (std::numeric_limits<time_t>::max)()) {
-//    log_.debug("next timeout in %d sec", timeout);
-//  }
-  struct timeval tselect{};
-  struct timeval* p = nullptr;
-  if (timeout < (std::numeric_limits<time_t>::max)()) {
-    tselect.tv_sec = timeout;
-    tselect.tv_usec = 0;
-    p = &tselect;
-//    std::cout << this << " next timeout in " << p->tv_sec << " seconds\n" << std::flush;
-  }
-
-  if (!has_clients_to_handle(timeout, fd_sets)) {
-//    std::cout << this << " no clients to handle; returning\n" << std::flush;
-//    log_.info("no clients to handle, exiting");
-    return;
-  }
+    if (!has_clients_to_handle(timeout)) {
+      return;
+    }
 
-  int ret;
-  while ((ret = select(p, fd_sets)) < 0) {
-//    std::cout << this << " select returned with error " << ret << "\n" << std::flush;
-    if(errno != EINTR) {
-      char error_buffer[1024];
-      log_.warn("select failed: %s", os::strerror(errno, error_buffer, 1024));
-      shutdown();
-    } else {
+    demultiplexer::t_ready_events events;
+    int ret;
+    while ((ret = wait(timeout, events)) < 0) {
+      if(errno != EINTR) {
+        char error_buffer[1024];
+        log_.warn("demultiplexing failed: %s", os::strerror(errno, error_buffer, 1024));
+        shutdown();
+      }
       return;
     }
-  }
 
-//  std::cout << this << " select returned with active requests " << ret << "\n" << std::flush;
+    bool interrupted = is_interrupted(events);
 
-  bool interrupted = is_interrupted(fd_sets);
+    if (interrupted && shutdown_requested_) {
+      shutdown_.notify_one();
+      return;
+    }
+
+    resolve_ready_handlers(timer_wheel::clock::now(), events);
 
-  if (interrupted) {
-    if (!shutdown_requested_) {
-//      std::cout << this << " reactor was interrupted - promote new leader\n" << std::flush;
-//      log_.info("reactor was interrupted");
+    if (interrupted) {
       thread_pool_.promote_new_leader();
       return;
-    } else {
-//      std::cout << this << " reactor was interrupted for shutdown\n" << std::flush;
-//      log_.info("shutting down");
-//      cleanup();
-      shutdown_.notify_one();
-      return;
     }
+    rh = next_ready_handler();
   }
 
-  time_t now = ::time(nullptr);
-  t_handler_type handler_type = resolve_next_handler(now, fd_sets);
-
-  if (handler_type.first) {
-    deactivate_handler(handler_type.first, handler_type.second);
-//    std::cout << this << " handling client " << handler_type.first->name() << " - promoting new leader\n" << std::flush;
-
-    thread_pool_.promote_new_leader();
-//    log_.info("start handling event");
-    // handle event
-    if (handler_type.second == event_type::WRITE_MASK) {
-      on_write_mask(handler_type.first);
-    } else if (handler_type.second == event_type::READ_MASK) {
-      on_read_mask(handler_type.first);
-    } else if (handler_type.second == event_type::TIMEOUT_MASK) {
-      on_timeout(handler_type.first, now);
-    } else {
-//      log_.info("unknown event type");
-    }
-    activate_handler(handler_type.first, handler_type.second);
-    remove_deleted();
-  } else {
+  thread_pool_.promote_new_leader();
+
+  if (!rh.handler) {
     // no handler found
-//    log_.info("no handler found");
-    thread_pool_.promote_new_leader();
+    return;
   }
+
+  // handle event
+  if (rh.type == event_type::WRITE_MASK) {
+    on_write_mask(rh.handler);
+  } else if (rh.type == event_type::READ_MASK) {
+    on_read_mask(rh.handler);
+  } else if (rh.type == event_type::TIMEOUT_MASK) {
+    on_timeout(rh.handler, rh.timer);
+  }
+  ++num_dispatched_;
+  finish_dispatch(rh);
+  remove_deleted();
 }
 
 void reactor::shutdown()
@@ -205,12 +217,55 @@ bool reactor::is_running() const
   return running_;
 }
 
+demultiplexer_type reactor::backend() const
+{
+  return demultiplexer_->type();
+}
+
+bool reactor::completes_io() const
+{
+  return demultiplexer_->completes_io();
+}
+
+std::size_t reactor::num_threads() const
+{
+  return thread_pool_.num_threads();
+}
+
+void reactor::cpu_affinity(std::size_t cpu)
+{
+  thread_pool_.cpu_affinity(cpu);
+}
+
+void reactor::batch_dispatch(bool enable)
+{
+  batch_dispatch_ = enable;
+}
+
+bool reactor::batch_dispatch() const
+{
+  return batch_dispatch_;
+}
+
+std::size_t reactor::num_waits() const
+{
+  return num_waits_;
+}
+
+std::size_t reactor::num_dispatched() const
+{
+  return num_dispatched_;
+}
+
 void reactor::prepare_select_bits(time_t& timeout, select_fdsets& fd_sets) const
 {
   std::lock_guard<std::mutex> l(mutex_);
   fd_sets.reset();
-  time_t now = ::time(nullptr);
   timeout = (std::numeric_limits<time_t>::max)();
+  auto next_expiry = timers_.next_expiry(timer_wheel::clock::now());
+  if (next_expiry >= 0) {
+    timeout = static_cast<time_t>((next_expiry + 999) / 1000);
+  }
 
   // set interrupter fd
   fd_sets.read_set().set(interrupter_.socket_id());
@@ -225,30 +280,119 @@ void reactor::prepare_select_bits(time_t& timeout, select_fdsets& fd_sets) const
     if (h.first->is_ready_write() && is_event_type_set(h.second, event_type::WRITE_MASK)) {
       fd_sets.write_set().set(h.first->handle());
     }
-    if (h.first->next_timeout() > 0 && is_event_type_set(h.second, event_type::TIMEOUT_MASK)) {
-      timeout = (std::min)(timeout, h.first->next_timeout() <= now ? 0 : (h.first->next_timeout() - now));
+  }
+}
+
+long reactor::next_timeout()
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  const auto now = timer_wheel::clock::now();
+  long timeout = timers_.next_expiry(now);
+  next_wakeup_ = timeout < 0 ? timer_wheel::clock::time_point::max() : now + std::chrono::milliseconds(timeout);
+  return timeout;
+}
+
+reactor::t_handler_list::iterator reactor::add_handler_type(const handler_ptr &h, event_type et)
+{
+  auto it = handlers_.emplace(handlers_.end(), h, et);
+  handler_index_.emplace(h.get(), it);
+  return it;
+}
+
+void reactor::remove_handler_type(t_handler_list::iterator it)
+{
+  release_handle(it->first);
+  handler_index_.erase(it->first.get());
+  timers_.cancel(it->first.get());
+  handlers_.erase(it);
+}
+
+void reactor::update_interest(t_handler_type &ht)
+{
+  const auto &h = ht.first;
+  const auto mask = ht.second;
+  socket_type fd = h->handle();
+  event_type interest = event_type::NONE_MASK;
+  if (fd > 0) {
+    if (is_event_type_set(mask, event_type::READ_MASK) && h->is_ready_read()) {
+      interest |= event_type::READ_MASK;
     }
+    if (is_event_type_set(mask, event_type::WRITE_MASK) && h->is_ready_write()) {
+      interest |= event_type::WRITE_MASK;
+    }
+  }
+
+  if (h->registered_handle_ > 0 && (h->registered_handle_ != fd || interest == event_type::NONE_MASK)) {
+    release_handle(h);
+  }
+  if (interest == event_type::NONE_MASK || interest == h->registered_interest_) {
+    return;
+  }
+  // a blocking select only recognizes added
+  // interest after it was interrupted
+  const bool added = (interest & ~h->registered_interest_) != event_type::NONE_MASK;
+  if (h->registered_handle_ == 0) {
+    demultiplexer_->add(fd, interest);
+  } else {
+    demultiplexer_->modify(fd, interest);
+  }
+  h->registered_handle_ = fd;
+  h->registered_interest_ = interest;
+  if (static_cast<std::size_t>(fd) >= fd_table_.size()) {
+    fd_table_.resize(static_cast<std::size_t>(fd) + 1, nullptr);
+  }
+  fd_table_[fd] = &ht;
+  if (added && demultiplexer_->requires_interrupt()) {
+    interrupt_without_lock();
+  }
+}
+
+void reactor::release_handle(const handler_ptr &h)
+{
+  if (h->registered_handle_ == 0) {
+    return;
+  }
+  // the fd may already be closed and reused
+  // by another handler; keep its registration
+  auto ht = registered_handler_type(h->registered_handle_);
+  if (ht != nullptr && ht->first == h) {
+    demultiplexer_->remove(h->registered_handle_);
+    fd_table_[h->registered_handle_] = nullptr;
+  }
+  h->registered_handle_ = 0;
+  h->registered_interest_ = event_type::NONE_MASK;
+}
+
+reactor::t_handler_type* reactor::registered_handler_type(socket_type fd) const
+{
+  if (fd <= 0 || static_cast<std::size_t>(fd) >= fd_table_.size()) {
+    return nullptr;
   }
+  return fd_table_[fd];
 }
 
 void reactor::remove_deleted()
 {
+  std::lock_guard<std::mutex> l(mutex_);
   while (!handlers_to_delete_.empty()) {
     auto h = handlers_to_delete_.front();
     handlers_to_delete_.pop_front();
-    auto fi = std::find_if(handlers_.begin(), handlers_.end(), [&h](const t_handler_type &ht) {
-      return ht.first.get() == h.get();
-    });
+    auto fi = find_handler_type(h);
 
     if (fi != handlers_.end()) {
       log_.debug("removing handler %d", fi->first->handle());
-      handlers_.erase(fi);
+      remove_handler_type(fi);
     }
   }
 }
 
 void reactor::cleanup()
 {
+  ready_handlers_.clear();
+  dispatching_.clear();
+  handler_index_.clear();
+  timers_.clear();
+  fd_table_.clear();
   while (!handlers_.empty()) {
     auto hndlr = handlers_.front();
     handlers_.pop_front();
@@ -256,16 +400,11 @@ void reactor::cleanup()
   }
 }
 
-int reactor::select(struct timeval *timeout, select_fdsets& fd_sets)
+int reactor::wait(long timeout, demultiplexer::t_ready_events &events)
 {
-  log_.debug("calling select; waiting for io events");
-  return ::select(
-    static_cast<int>(fd_sets.maxp1()) + 1,
-    fd_sets.read_set().get(),
-    fd_sets.write_set().get(),
-    fd_sets.except_set().get(),
-    timeout
-  );
+  log_.debug("waiting for io events");
+  ++num_waits_;
+  return demultiplexer_->wait(timeout, events);
 }
 
 
@@ -291,21 +430,80 @@ int reactor::select(struct timeval *timeout, select_fdsets& fd_sets)
 //  handlers_.pop_front();
 //}
 
-reactor::t_handler_type reactor::resolve_next_handler(time_t now, select_fdsets& fd_sets)
+void reactor::resolve_ready_handlers(timer_wheel::clock::time_point now, const demultiplexer::t_ready_events &events)
 {
   std::lock_guard<std::mutex> l(mutex_);
-  for (auto &h : handlers_) {
-    if (h.first->handle() > 0 && fd_sets.write_set().is_set(h.first->handle())) {
-      return std::make_pair(h.first, event_type::WRITE_MASK);
+
+  // all ready handlers are deactivated for their event
+  // and queued; thus the following leaders take them
+  // from the queue without waiting for events again
+  auto enqueue = [this](t_handler_type &ht, event_type ev, timer_id timer) {
+    ht.second &= ~ev;
+    update_interest(ht);
+    ready_handlers_.push_back({ht.first, ev, timer});
+    return batch_dispatch_.load();
+  };
+
+  // events of one fd are consecutive with write first;
+  // only one event per handler is dispatched at a time
+  socket_type last_fd = 0;
+  for (const auto &ev : events) {
+    if (ev.fd == last_fd) {
+      continue;
     }
-    if (h.first->handle() > 0 && fd_sets.read_set().is_set(h.first->handle())) {
-      return std::make_pair(h.first, event_type::READ_MASK);
+    auto ht = registered_handler_type(ev.fd);
+    if (ht == nullptr || ht->first->handle() != ev.fd) {
+      continue;
     }
-    if (h.first->next_timeout() > 0 && h.first->next_timeout() <= now) {
-      return std::make_pair(h.first, event_type::TIMEOUT_MASK);
+    if (!is_event_type_set(ht->second, ev.type) ||
+        (ev.type == event_type::WRITE_MASK && !ht->first->is_ready_write()) ||
+        (ev.type == event_type::READ_MASK && !ht->first->is_ready_read())) {
+      continue;
+    }
+    last_fd = ev.fd;
+    if (!enqueue(*ht, ev.type, 0)) {
+      return;
     }
   }
-  return std::make_pair(nullptr, event_type::NONE_MASK);
+
+  // expired timers are taken in one pass; a timer of a
+  // handler already queued or still in dispatch expires
+  // again with the next tick
+  const auto io_count = static_cast<std::ptrdiff_t>(ready_handlers_.size());
+  bool accept_more = true;
+  timer_wheel::t_expired_timers expired;
+  timers_.expire(now, [&](const timer_wheel::expired_timer &et) {
+    if (!accept_more) {
+      return false;
+    }
+    auto it = find_handler_type(et.owner);
+    if (it == handlers_.end() || !is_event_type_set(it->second, event_type::TIMEOUT_MASK)) {
+      return false;
+    }
+    if (std::any_of(ready_handlers_.begin(), ready_handlers_.begin() + io_count, [&et](const ready_handler &queued) { return queued.handler == et.owner; })) {
+      return false;
+    }
+    if (dispatching_.find(et.owner.get()) != dispatching_.end()) {
+      return false;
+    }
+    accept_more = enqueue(*it, event_type::TIMEOUT_MASK, et.id);
+    return true;
+  }, expired);
+}
+
+reactor::ready_handler reactor::next_ready_handler()
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  while (!ready_handlers_.empty()) {
+    auto rh = ready_handlers_.front();
+    ready_handlers_.pop_front();
+    // skip handlers removed in the meantime
+    if (find_handler_type(rh.handler) != handlers_.end()) {
+      ++dispatching_[rh.handler.get()];
+      return rh;
+    }
+  }
+  return {nullptr, event_type::NONE_MASK, 0};
 }
 
 void reactor::on_read_mask(const handler_ptr& handler)
@@ -328,12 +526,14 @@ void reactor::on_except_mask(const handler_ptr& /*handler*/)
 
 }
 
-void reactor::on_timeout(const handler_ptr &h, time_t now)
+void reactor::on_timeout(const handler_ptr &h, timer_id id)
 {
 //  log_.debug("timeout expired for handler %d; handle timeout", h->handle());
 //  std::cout << this << " (handler " << h.get() << "): handle timeout\n" << std::flush;
-  h->calculate_next_timeout(now);
-  h->on_timeout();
+  if (id == h->timer_) {
+    h->calculate_next_timeout(::time(nullptr));
+  }
+  h->on_timer(id);
 }
 
 select_fdsets reactor::fdsets() const
@@ -350,10 +550,13 @@ void reactor::mark_handler_for_delete(const handler_ptr& h)
   handlers_to_delete_.push_back(h);
 }
 
-bool reactor::is_interrupted(select_fdsets& fd_sets)
+bool reactor::is_interrupted(const demultiplexer::t_ready_events &events)
 {
   std::lock_guard<std::mutex> l(mutex_);
-  if (fd_sets.read_set().is_set(interrupter_.socket_id())) {
+  auto it = std::find_if(events.begin(), events.end(), [this](const demultiplexer::ready_event &ev) {
+    return ev.fd == interrupter_.socket_id();
+  });
+  if (it != events.end()) {
     log_.debug("interrupt byte received; resetting interrupter");
     if (shutdown_requested_) {
       running_ = false;
@@ -363,16 +566,29 @@ bool reactor::is_interrupted(select_fdsets& fd_sets)
   return false;
 }
 
-bool reactor::has_clients_to_handle(time_t timeout, select_fdsets& fd_sets) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return fd_sets.maxp1() > 0 || timeout != (std::numeric_limits<time_t>::max)();
+bool reactor::has_clients_to_handle(long timeout) const {
+  return demultiplexer_->size() > 0 || timeout >= 0;
 }
 
 std::list<reactor::t_handler_type>::iterator reactor::find_handler_type(const reactor::handler_ptr &h)
 {
-  return std::find_if(handlers_.begin(), handlers_.end(), [&h](const t_handler_type &ht) {
-    return ht.first.get() == h.get();
-  });
+  auto it = handler_index_.find(h.get());
+  return it == handler_index_.end() ? handlers_.end() : it->second;
+}
+
+void reactor::finish_dispatch(const ready_handler &rh)
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  auto di = dispatching_.find(rh.handler.get());
+  if (di != dispatching_.end() && --di->second == 0) {
+    dispatching_.erase(di);
+  }
+  auto it = find_handler_type(rh.handler);
+  if (it == handlers_.end()) {
+    return;
+  }
+  it->second |= rh.type;
+  update_interest(*it);
 }
 
 void reactor::activate_handler(const reactor::handler_ptr &h, event_type ev)
@@ -383,6 +599,7 @@ void reactor::activate_handler(const reactor::handler_ptr &h, event_type ev)
     return;
   }
   it->second |= ev;
+  update_interest(*it);
 }
 
 void reactor::deactivate_handler(const reactor::handler_ptr &h, event_type ev)
@@ -393,6 +610,46 @@ void reactor::deactivate_handler(const reactor::handler_ptr &h, event_type ev)
     return;
   }
   it->second &= ~ev;
+  update_interest(*it);
+}
+
+void reactor::update_handler(const reactor::handler_ptr &h)
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = find_handler_type(h);
+  if (it != handlers_.end()) {
+    update_interest(*it);
+  }
+}
+
+// the io calls don't take the reactor lock; handlers
+// are closed by cleanup() while the lock is held
+void reactor::complete_io(socket_type fd, io_operation op)
+{
+  demultiplexer_->complete_io(fd, op);
+}
+
+long reactor::receive(socket_type fd, char *buf, std::size_t len)
+{
+  return demultiplexer_->receive(fd, buf, len);
+}
+
+long reactor::send(socket_type fd, std::list<buffer_view> &buffers, const std::shared_ptr<void> &owner)
+{
+  return demultiplexer_->send(fd, buffers, owner);
+}
+
+socket_type reactor::accept(socket_type fd)
+{
+  return demultiplexer_->accept(fd);
+}
+
+void reactor::close_socket(socket_type fd)
+{
+  if (fd <= 0) {
+    return;
+  }
+  demultiplexer_->close(fd);
 }
 
 void reactor::interrupt()
@@ -0,0 +1,130 @@
+#include "matador/net/select_demultiplexer.hpp"
+
+#include <stdexcept>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
+
+namespace matador {
+
+void select_demultiplexer::add(socket_type fd, event_type interest)
+{
+#ifndef _WIN32
+  if (fd >= FD_SETSIZE) {
+    throw std::logic_error("select demultiplexer: fd " + std::to_string(fd) + " exceeds FD_SETSIZE");
+  }
+#endif
+  modify(fd, interest);
+}
+
+void select_demultiplexer::modify(socket_type fd, event_type interest)
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  registered_.set(fd);
+  if (is_event_type_set(interest, event_type::READ_MASK)) {
+    fdsets_.read_set().set(fd);
+  } else {
+    fdsets_.read_set().clear(fd);
+  }
+  if (is_event_type_set(interest, event_type::WRITE_MASK)) {
+    fdsets_.write_set().set(fd);
+  } else {
+    fdsets_.write_set().clear(fd);
+  }
+}
+
+void select_demultiplexer::remove(socket_type fd)
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  registered_.clear(fd);
+  fdsets_.read_set().clear(fd);
+  fdsets_.write_set().clear(fd);
+}
+
+int select_demultiplexer::wait(long timeout, t_ready_events &events)
+{
+  fd_set read_set;
+  fd_set write_set;
+  socket_type maxp1;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    read_set = *fdsets_.read_set().get();
+    write_set = *fdsets_.write_set().get();
+    maxp1 = fdsets_.maxp1();
+  }
+
+  struct timeval tselect{};
+  struct timeval* p = nullptr;
+  if (timeout >= 0) {
+    tselect.tv_sec = timeout / 1000;
+    tselect.tv_usec = (timeout % 1000) * 1000;
+    p = &tselect;
+  }
+
+  int ret = ::select(static_cast<int>(maxp1) + 1, &read_set, &write_set, nullptr, p);
+
+  if (ret < 0) {
+    if (errno == EBADF) {
+      // a registered fd was closed before it
+      // was removed; drop it and try again
+      prune_invalid();
+      return 0;
+    }
+    return ret;
+  }
+
+  int count = 0;
+  for (socket_type fd = 0; fd <= maxp1 && count < ret; ++fd) {
+    bool is_set = false;
+    if (FD_ISSET(fd, &write_set)) {
+      events.push_back({fd, event_type::WRITE_MASK});
+      is_set = true;
+    }
+    if (FD_ISSET(fd, &read_set)) {
+      events.push_back({fd, event_type::READ_MASK});
+      is_set = true;
+    }
+    if (is_set) {
+      ++count;
+    }
+  }
+  return static_cast<int>(events.size());
+}
+
+bool select_demultiplexer::requires_interrupt() const
+{
+  return true;
+}
+
+std::size_t select_demultiplexer::size() const
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  return registered_.count();
+}
+
+demultiplexer_type select_demultiplexer::type() const
+{
+  return demultiplexer_type::SELECT;
+}
+
+void select_demultiplexer::prune_invalid()
+{
+#ifndef _WIN32
+  std::lock_guard<std::mutex> l(mutex_);
+  const socket_type maxp1 = registered_.maxp1();
+  for (socket_type fd = 0; fd <= maxp1; ++fd) {
+    if (!registered_.is_set(fd)) {
+      continue;
+    }
+    if (::fcntl(fd, F_GETFD) < 0 && errno == EBADF) {
+      registered_.clear(fd);
+      fdsets_.read_set().clear(fd);
+      fdsets_.write_set().clear(fd);
+    }
+  }
+#endif
+}
+
+}
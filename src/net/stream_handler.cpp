@@ -26,6 +26,11 @@ stream_handler::stream_handler(tcp::socket sock, tcp::peer endpoint, handler_cre
 
 void stream_handler::open()
 {
+  // the demultiplexer may read and write the socket itself
+  completes_io_ = get_reactor()->completes_io();
+  if (completes_io_) {
+    get_reactor()->complete_io(stream_.id(), io_operation::STREAM);
+  }
   init_handler_(endpoint_, *this);
 }
 
@@ -36,19 +41,36 @@ socket_type stream_handler::handle() const
 
 void stream_handler::on_input()
 {
-  auto len = stream_.receive(read_buffer_);
+  ssize_t len;
+  if (read_chain_ != nullptr) {
+    auto view = read_chain_->prepare();
+    len = receive(view);
+    // a commit of nothing releases the taken segment
+    read_chain_->commit(len > 0 ? static_cast<std::size_t>(len) : 0);
+  } else {
+    len = receive(read_buffer_);
+  }
   log_.trace("%s: read %d bytes", name().c_str(), len);
+  if (len >= 0 || (errno != EWOULDBLOCK && errno != EAGAIN)) {
+    cancel_read_timer();
+  }
   if (len == 0) {
     on_close();
-  } else if (len < 0 && errno != EWOULDBLOCK) {
+  } else if (len < 0 && errno != EWOULDBLOCK && errno != EAGAIN) {
     char error_buffer[1024];
     log_.error("%s: error on read: %s", name().c_str(), os::strerror(errno, error_buffer, 1024));
     is_ready_to_read_ = false;
     on_read_(static_cast<long>(len), static_cast<long>(len));
     on_close();
+  } else if (len < 0) {
+    // nothing to read yet; wait for the next input
+    log_.trace("%s: read would block", name().c_str());
   } else {
-    log_.debug("%s: received %d bytes (data: %s)", name().c_str(), len, read_buffer_.data());
-    read_buffer_.bump(len);
+    // the received data isn't terminated; it's not logged
+    log_.debug("%s: received %d bytes", name().c_str(), len);
+    if (read_chain_ == nullptr) {
+      read_buffer_.bump(len);
+    }
     is_ready_to_read_ = false;
     on_read_(0, static_cast<long>(len));
   }
@@ -56,43 +78,66 @@ void stream_handler::on_input()
 
 void stream_handler::on_output()
 {
-  ssize_t bytes_total = 0;
   auto start = std::chrono::high_resolution_clock::now();
-  while (!write_buffers_.empty()) {
-    buffer_view &bv = write_buffers_.front();
-
-    auto len = stream_.send(bv);
-    log_.trace("%s: sent %d bytes", name().c_str(), len);
-
-    if (len == 0) {
-      on_close();
-    } else if (len < 0 && errno != EWOULDBLOCK) {
-      char error_buffer[1024];
-      log_.error("%s: error on write: %s", name().c_str(), os::strerror(errno, error_buffer, 1024));
-      on_close();
-      is_ready_to_write_ = false;
-      on_write_(static_cast<long>(len), static_cast<long>(len));
-    } else if (len < 0 && errno == EWOULDBLOCK) {
-      log_.debug("%s: sent %d bytes (blocked)", name().c_str(), bytes_total);
-    } else {
-      bytes_total += len;
-      bv.bump(len);
-      if (bv.full()) {
-        write_buffers_.pop_front();
-      }
+  ssize_t len = 0;
+  if (!write_buffers_.empty()) {
+    len = send(write_buffers_);
+  }
+  if (write_buffers_.empty() && write_file_) {
+    // buffers are out; continue with the file
+    if (len > 0) {
+      bytes_written_ += len;
     }
+    len = stream_.send_file(*write_file_);
   }
+  log_.trace("%s: sent %d bytes", name().c_str(), len);
+
+  if (len < 0 && errno != EWOULDBLOCK && errno != EAGAIN) {
+    char error_buffer[1024];
+    log_.error("%s: error on write: %s", name().c_str(), os::strerror(errno, error_buffer, 1024));
+    is_ready_to_write_ = false;
+    on_close();
+    on_write_(static_cast<long>(len), static_cast<long>(len));
+    return;
+  }
+  if (len > 0) {
+    bytes_written_ += len;
+  }
+  if (!write_buffers_.empty() || (write_file_ && !write_file_->full())) {
+    // socket would block; continue when
+    // the socket is writable again
+    log_.debug("%s: sent %d bytes (blocked)", name().c_str(), bytes_written_);
+    return;
+  }
+
   auto end = std::chrono::high_resolution_clock::now();
   auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  auto bytes_total = bytes_written_;
+  bytes_written_ = 0;
+  write_file_.reset();
   log_.debug("%s: sent %d bytes (%dms)", name().c_str(), bytes_total, elapsed);
   is_ready_to_write_ = false;
   on_write_(0, static_cast<long>(bytes_total));
 }
 
+void stream_handler::on_timer(timer_id id)
+{
+  if (id != read_timer_) {
+    handler::on_timer(id);
+    return;
+  }
+  read_timer_ = 0;
+  if (is_ready_to_read_) {
+    log_.debug("%s: no data within %dms; closing connection", name().c_str(), read_timeout_.count());
+    is_ready_to_read_ = false;
+    on_close();
+  }
+}
+
 void stream_handler::on_close()
 {
   log_.debug("%s: closing connection", name().c_str(), handle());
-  stream_.close();
+  close_socket();
   creator_->notify_close( this );
   auto self = shared_from_this();
   get_reactor()->mark_handler_for_delete(self);
@@ -105,34 +150,62 @@ void stream_handler::close()
     return;
   }
   log_.debug("%s: closing connection", name().c_str(), handle());
-  stream_.close();
+  close_socket();
   creator_->notify_close( this );
 }
 
 bool stream_handler::is_ready_write() const
 {
-  return is_ready_to_write_ && !write_buffers_.empty();
+  return is_ready_to_write_ && (!write_buffers_.empty() || (write_file_ && !write_file_->full()));
 }
 
 bool stream_handler::is_ready_read() const
 {
-  return is_ready_to_read_ && !read_buffer_.full();
+  return is_ready_to_read_ && (read_chain_ != nullptr || !read_buffer_.full());
 }
 
 void stream_handler::read(buffer_view buf, t_read_handler read_handler)
 {
   on_read_ = std::move(read_handler);
   read_buffer_ = std::move(buf);
+  read_chain_ = nullptr;
   is_ready_to_read_ = true;
-  get_reactor()->interrupt();
+  schedule_read_timer();
+  get_reactor()->update_handler(shared_from_this());
+}
+
+void stream_handler::read(buffer_chain &chain, t_read_handler read_handler)
+{
+  on_read_ = std::move(read_handler);
+  read_chain_ = &chain;
+  is_ready_to_read_ = true;
+  schedule_read_timer();
+  get_reactor()->update_handler(shared_from_this());
 }
 
 void stream_handler::write(std::list<buffer_view> buffers, io_stream::t_write_handler write_handler)
 {
   on_write_ = std::move(write_handler);
   write_buffers_ = std::move(buffers);
+  write_file_.reset();
+  bytes_written_ = 0;
+  is_ready_to_write_ = true;
+  get_reactor()->update_handler(shared_from_this());
+}
+
+void stream_handler::write(std::list<buffer_view> buffers, std::shared_ptr<file_body> file, io_stream::t_write_handler write_handler)
+{
+  on_write_ = std::move(write_handler);
+  write_buffers_ = std::move(buffers);
+  write_file_ = std::move(file);
+  bytes_written_ = 0;
   is_ready_to_write_ = true;
-  get_reactor()->interrupt();
+  get_reactor()->update_handler(shared_from_this());
+}
+
+void stream_handler::read_timeout(std::chrono::milliseconds timeout)
+{
+  read_timeout_ = timeout;
 }
 
 void stream_handler::close_stream()
@@ -150,4 +223,46 @@ std::string stream_handler::name() const
   return name_;
 }
 
+ssize_t stream_handler::receive(buffer_view &buf)
+{
+  if (completes_io_) {
+    return get_reactor()->receive(stream_.id(), buf.data(), buf.capacity());
+  }
+  return stream_.receive(buf);
+}
+
+ssize_t stream_handler::send(std::list<buffer_view> &buffers)
+{
+  if (completes_io_) {
+    // the handler keeps the buffers alive until the send completed
+    return get_reactor()->send(stream_.id(), buffers, shared_from_this());
+  }
+  return stream_.send(buffers);
+}
+
+void stream_handler::close_socket()
+{
+  if (completes_io_) {
+    get_reactor()->close_socket(stream_.release());
+  } else {
+    stream_.close();
+  }
+}
+
+void stream_handler::schedule_read_timer()
+{
+  cancel_read_timer();
+  if (read_timeout_.count() > 0) {
+    read_timer_ = get_reactor()->schedule_timer(shared_from_this(), read_timeout_);
+  }
+}
+
+void stream_handler::cancel_read_timer()
+{
+  if (read_timer_ != 0) {
+    get_reactor()->cancel_timer(shared_from_this(), read_timer_);
+    read_timer_ = 0;
+  }
+}
+
 }
@@ -0,0 +1,271 @@
+#include "matador/net/timer_wheel.hpp"
+
+#include <algorithm>
+
+namespace matador {
+
+timer_wheel::timer_wheel()
+  : start_(clock::now())
+{}
+
+timer_wheel::~timer_wheel()
+{
+  clear();
+}
+
+timer_id timer_wheel::schedule(const std::shared_ptr<handler> &owner, duration offset, duration interval, clock::time_point now)
+{
+  std::unique_ptr<timer> t(new timer);
+  t->id = ++next_id_;
+  t->owner = owner;
+  t->expires = to_tick(now) + static_cast<std::uint64_t>((std::max)(offset.count(), static_cast<duration::rep>(0)));
+  t->interval = static_cast<std::uint64_t>((std::max)(interval.count(), static_cast<duration::rep>(0)));
+
+  if (timers_.empty()) {
+    // nothing to process between the last
+    // advance and now; move on directly
+    current_ = (std::max)(current_, to_tick(now));
+  }
+
+  insert(t.get());
+  owner_timers_[owner.get()].push_back(t->id);
+  auto id = t->id;
+  timers_.emplace(id, std::move(t));
+  return id;
+}
+
+bool timer_wheel::cancel(timer_id id)
+{
+  auto it = timers_.find(id);
+  if (it == timers_.end()) {
+    return false;
+  }
+  remove(it->second.get());
+  return true;
+}
+
+std::size_t timer_wheel::cancel(const handler *owner)
+{
+  auto it = owner_timers_.find(owner);
+  if (it == owner_timers_.end()) {
+    return 0;
+  }
+  auto ids = std::move(it->second);
+  owner_timers_.erase(it);
+  std::size_t count = 0;
+  for (auto id : ids) {
+    auto ti = timers_.find(id);
+    if (ti == timers_.end()) {
+      continue;
+    }
+    unlink(ti->second.get());
+    timers_.erase(ti);
+    ++count;
+  }
+  return count;
+}
+
+std::size_t timer_wheel::expire(clock::time_point now, const t_accept_func &accept, t_expired_timers &expired)
+{
+  const auto now_tick = to_tick(now);
+  const auto size_before = expired.size();
+  std::vector<timer*> rejected;
+
+  while (current_ <= now_tick && !timers_.empty()) {
+    const auto index = static_cast<std::size_t>(current_ & slot_mask);
+    if (index == 0) {
+      // level zero wrapped around; move the timers
+      // of the next slot of the upper levels down
+      for (std::size_t level = 1; level < level_count; ++level) {
+        const auto level_index = static_cast<std::size_t>((current_ >> (level * slot_bits)) & slot_mask);
+        cascade(level, level_index);
+        if (level_index != 0) {
+          break;
+        }
+      }
+    }
+
+    timer *t = detach(0, index);
+    while (t != nullptr) {
+      timer *next = t->next;
+      t->prev = t->next = nullptr;
+      t->slot = nullptr;
+
+      expired_timer et{t->id, t->owner};
+      if (!accept(et)) {
+        rejected.push_back(t);
+      } else if (t->interval > 0) {
+        expired.push_back(std::move(et));
+        t->expires += t->interval;
+        if (t->expires <= now_tick) {
+          // the wheel is behind; don't fire the missed expirations
+          t->expires = now_tick + t->interval;
+        }
+        insert(t);
+      } else {
+        expired.push_back(std::move(et));
+        remove(t);
+      }
+      t = next;
+    }
+    ++current_;
+  }
+
+  if (timers_.empty()) {
+    current_ = (std::max)(current_, now_tick + 1);
+  }
+
+  // rejected timers expire again with the next tick
+  for (auto t : rejected) {
+    insert(t);
+  }
+
+  return expired.size() - size_before;
+}
+
+long timer_wheel::next_expiry(clock::time_point now) const
+{
+  if (timers_.empty()) {
+    return -1;
+  }
+  const auto now_tick = to_tick(now);
+
+  const bool upper_levels_empty = timers_.size() == level_sizes_[0];
+  std::uint64_t tick = current_;
+  for (std::size_t i = 0; i < slot_count; ++i, ++tick) {
+    // either a timer expires or timers must be
+    // moved down from the upper levels
+    if (levels_[0][tick & slot_mask] != nullptr || ((tick & slot_mask) == 0 && !upper_levels_empty)) {
+      break;
+    }
+  }
+  return tick > now_tick ? static_cast<long>(tick - now_tick) : 0;
+}
+
+bool timer_wheel::is_scheduled(timer_id id) const
+{
+  return timers_.find(id) != timers_.end();
+}
+
+std::size_t timer_wheel::count(const handler *owner) const
+{
+  auto it = owner_timers_.find(owner);
+  return it == owner_timers_.end() ? 0 : it->second.size();
+}
+
+std::size_t timer_wheel::size() const
+{
+  return timers_.size();
+}
+
+bool timer_wheel::empty() const
+{
+  return timers_.empty();
+}
+
+void timer_wheel::clear()
+{
+  for (auto &level : levels_) {
+    level.fill(nullptr);
+  }
+  level_sizes_.fill(0);
+  timers_.clear();
+  owner_timers_.clear();
+}
+
+std::uint64_t timer_wheel::to_tick(clock::time_point tp) const
+{
+  if (tp <= start_) {
+    return 0;
+  }
+  return static_cast<std::uint64_t>(std::chrono::duration_cast<duration>(tp - start_).count());
+}
+
+void timer_wheel::insert(timer *t)
+{
+  // expired timers are placed into the current slot
+  const auto expires = (std::max)(t->expires, current_);
+  const auto delta = expires - current_;
+
+  std::size_t level = 0;
+  while (level < level_count - 1 && delta >= (std::uint64_t(1) << ((level + 1) * slot_bits))) {
+    ++level;
+  }
+  auto position = expires;
+  if (level == level_count - 1) {
+    // timers beyond the range of the wheel are moved
+    // down when the top level slot is reached and
+    // placed again according to their expiration
+    position = current_ + (std::min)(delta, (std::uint64_t(1) << (level_count * slot_bits)) - 1);
+  }
+  auto &slot = levels_[level][static_cast<std::size_t>((position >> (level * slot_bits)) & slot_mask)];
+
+  t->prev = nullptr;
+  t->next = slot;
+  if (slot != nullptr) {
+    slot->prev = t;
+  }
+  slot = t;
+  t->slot = &slot;
+  t->level = level;
+  ++level_sizes_[level];
+}
+
+void timer_wheel::unlink(timer *t)
+{
+  if (t->slot == nullptr) {
+    return;
+  }
+  if (t->prev != nullptr) {
+    t->prev->next = t->next;
+  } else {
+    *t->slot = t->next;
+  }
+  if (t->next != nullptr) {
+    t->next->prev = t->prev;
+  }
+  t->prev = t->next = nullptr;
+  t->slot = nullptr;
+  --level_sizes_[t->level];
+}
+
+timer_wheel::timer* timer_wheel::detach(std::size_t level, std::size_t index)
+{
+  timer *head = levels_[level][index];
+  levels_[level][index] = nullptr;
+  for (timer *t = head; t != nullptr; t = t->next) {
+    t->slot = nullptr;
+    --level_sizes_[level];
+  }
+  return head;
+}
+
+void timer_wheel::cascade(std::size_t level, std::size_t index)
+{
+  timer *t = detach(level, index);
+  while (t != nullptr) {
+    timer *next = t->next;
+    insert(t);
+    t = next;
+  }
+}
+
+void timer_wheel::remove(timer *t)
+{
+  unlink(t);
+  auto oi = owner_timers_.find(t->owner.get());
+  if (oi != owner_timers_.end()) {
+    auto &ids = oi->second;
+    auto it = std::find(ids.begin(), ids.end(), t->id);
+    if (it != ids.end()) {
+      *it = ids.back();
+      ids.pop_back();
+    }
+    if (ids.empty()) {
+      owner_timers_.erase(oi);
+    }
+  }
+  timers_.erase(t->id);
+}
+
+}
@@ -0,0 +1,147 @@
+#include "matador/utils/buffer_chain.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace matador {
+
+buffer_chain::buffer_chain()
+  : buffer_chain(buffer_pool::default_pool())
+{}
+
+buffer_chain::buffer_chain(buffer_pool &pool)
+  : pool_(&pool)
+{}
+
+buffer_view buffer_chain::prepare()
+{
+  if (slices_.empty() ||
+      slices_.back().segment.use_count() > 1 ||
+      slices_.back().offset + slices_.back().length == slices_.back().segment.capacity()) {
+    // segment is full or shared; writing into it
+    // would change the data of another chain
+    slice s;
+    s.segment = pool_->acquire();
+    slices_.push_back(std::move(s));
+  }
+  prepared_ = true;
+  auto &tail = slices_.back();
+  const auto used = tail.offset + tail.length;
+  return buffer_view(tail.segment.data() + used, tail.segment.capacity() - used);
+}
+
+void buffer_chain::commit(std::size_t size)
+{
+  if (!prepared_ || slices_.empty()) {
+    return;
+  }
+  prepared_ = false;
+  auto &tail = slices_.back();
+  size = (std::min)(size, tail.segment.capacity() - tail.offset - tail.length);
+  tail.length += size;
+  size_ += size;
+  if (tail.length == 0) {
+    slices_.pop_back();
+  }
+}
+
+void buffer_chain::append(const char *data, std::size_t size)
+{
+  while (size > 0) {
+    auto view = prepare();
+    const auto len = (std::min)(size, view.capacity());
+    std::memcpy(view.data(), data, len);
+    commit(len);
+    data += len;
+    size -= len;
+  }
+}
+
+void buffer_chain::append(const std::string &str)
+{
+  append(str.data(), str.size());
+}
+
+void buffer_chain::consume(std::size_t size)
+{
+  while (size > 0 && !slices_.empty()) {
+    auto &head = slices_.front();
+    if (head.length > size) {
+      head.offset += size;
+      head.length -= size;
+      size_ -= size;
+      return;
+    }
+    size -= head.length;
+    size_ -= head.length;
+    slices_.pop_front();
+  }
+}
+
+buffer_chain buffer_chain::share(std::size_t offset, std::size_t length) const
+{
+  buffer_chain part(*pool_);
+  for (const auto &s : slices_) {
+    if (length == 0) {
+      break;
+    }
+    if (offset >= s.length) {
+      offset -= s.length;
+      continue;
+    }
+    slice ps;
+    ps.segment = s.segment;
+    ps.offset = s.offset + offset;
+    ps.length = (std::min)(s.length - offset, length);
+    offset = 0;
+    length -= ps.length;
+    part.size_ += ps.length;
+    part.slices_.push_back(std::move(ps));
+  }
+  return part;
+}
+
+const buffer_chain::t_slice_deque &buffer_chain::slices() const
+{
+  return slices_;
+}
+
+std::list<buffer_view> buffer_chain::to_buffers() const
+{
+  std::list<buffer_view> buffers;
+  for (const auto &s : slices_) {
+    if (s.length > 0) {
+      buffers.emplace_back(s.data(), s.length);
+    }
+  }
+  return buffers;
+}
+
+std::string buffer_chain::to_string() const
+{
+  std::string str;
+  str.reserve(size_);
+  for (const auto &s : slices_) {
+    str.append(s.data(), s.length);
+  }
+  return str;
+}
+
+std::size_t buffer_chain::size() const
+{
+  return size_;
+}
+
+bool buffer_chain::empty() const
+{
+  return size_ == 0;
+}
+
+void buffer_chain::clear()
+{
+  slices_.clear();
+  size_ = 0;
+  prepared_ = false;
+}
+
+}
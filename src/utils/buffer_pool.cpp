@@ -0,0 +1,157 @@
+#include "matador/utils/buffer_pool.hpp"
+
+namespace matador {
+
+segment_ref::segment_ref(buffer_segment *segment)
+  : segment_(segment)
+{
+  if (segment_ != nullptr) {
+    segment_->references_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+segment_ref::segment_ref(const segment_ref &x)
+  : segment_ref(x.segment_)
+{}
+
+segment_ref::segment_ref(segment_ref &&x) noexcept
+  : segment_(x.segment_)
+{
+  x.segment_ = nullptr;
+}
+
+segment_ref &segment_ref::operator=(const segment_ref &x)
+{
+  if (this != &x) {
+    if (x.segment_ != nullptr) {
+      x.segment_->references_.fetch_add(1, std::memory_order_relaxed);
+    }
+    release();
+    segment_ = x.segment_;
+  }
+  return *this;
+}
+
+segment_ref &segment_ref::operator=(segment_ref &&x) noexcept
+{
+  if (this != &x) {
+    release();
+    segment_ = x.segment_;
+    x.segment_ = nullptr;
+  }
+  return *this;
+}
+
+segment_ref::~segment_ref()
+{
+  release();
+}
+
+char *segment_ref::data() const
+{
+  return segment_ != nullptr ? segment_->data_ : nullptr;
+}
+
+std::size_t segment_ref::capacity() const
+{
+  return segment_ != nullptr ? segment_->pool_->segment_size() : 0;
+}
+
+std::size_t segment_ref::use_count() const
+{
+  return segment_ != nullptr ? segment_->references_.load(std::memory_order_acquire) : 0;
+}
+
+void segment_ref::reset()
+{
+  release();
+}
+
+segment_ref::operator bool() const
+{
+  return segment_ != nullptr;
+}
+
+void segment_ref::release()
+{
+  if (segment_ == nullptr) {
+    return;
+  }
+  if (segment_->references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    segment_->pool_->release(segment_);
+  }
+  segment_ = nullptr;
+}
+
+buffer_pool::buffer_pool(std::size_t segment_size, std::size_t segments_per_slab)
+  : segment_size_(segment_size > 0 ? segment_size : 1)
+  , segments_per_slab_(segments_per_slab > 0 ? segments_per_slab : 1)
+{}
+
+segment_ref buffer_pool::acquire()
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  if (free_ == nullptr) {
+    allocate_slab();
+  }
+  buffer_segment *segment = free_;
+  free_ = segment->next_free_;
+  segment->next_free_ = nullptr;
+  ++in_use_;
+  return segment_ref(segment);
+}
+
+std::size_t buffer_pool::segment_size() const
+{
+  return segment_size_;
+}
+
+std::size_t buffer_pool::allocated() const
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  return allocated_;
+}
+
+std::size_t buffer_pool::in_use() const
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  return in_use_;
+}
+
+std::size_t buffer_pool::available() const
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  return allocated_ - in_use_;
+}
+
+buffer_pool &buffer_pool::default_pool()
+{
+  static buffer_pool pool;
+  return pool;
+}
+
+void buffer_pool::allocate_slab()
+{
+  std::unique_ptr<char[]> slab(new char[segment_size_ * segments_per_slab_]);
+  std::unique_ptr<buffer_segment[]> segments(new buffer_segment[segments_per_slab_]);
+  for (std::size_t i = 0; i < segments_per_slab_; ++i) {
+    auto &segment = segments[i];
+    segment.pool_ = this;
+    segment.data_ = slab.get() + i * segment_size_;
+    segment.next_free_ = free_;
+    free_ = &segment;
+  }
+  slabs_.push_back(std::move(slab));
+  segments_.push_back(std::move(segments));
+  allocated_ += segments_per_slab_;
+}
+
+void buffer_pool::release(buffer_segment *segment)
+{
+  std::lock_guard<std::mutex> l(mutex_);
+  segment->next_free_ = free_;
+  free_ = segment;
+  --in_use_;
+}
+
+}
@@ -2,7 +2,6 @@
 #include "matador/utils/sha256.hpp"
 
 #include <cstring>
-#include <vector>
 
 namespace matador {
 
@@ -12,29 +11,31 @@ std::string hmac(const std::string &key, const std::string &message)
 }
 
 std::string hmac(const char *key, size_t keylen, const char *message, size_t msglen)
+{
+  return hmac_key(key, keylen).sign(message, msglen);
+}
+
+hmac_key::hmac_key(const std::string &key)
+  : hmac_key(key.data(), key.length())
+{}
+
+hmac_key::hmac_key(const char *key, size_t keylen)
 {
   const unsigned long BLOCK_SIZE = 64;
-  const unsigned long HASH_SIZE = 32;
 
-  char keystr[BLOCK_SIZE] {};
+  unsigned char keystr[BLOCK_SIZE] {};
 
-  // prepare keystati
+  // prepare keystati; a long key is replaced
+  // by its hex encoded hash (64 characters)
   if (keylen > BLOCK_SIZE) {
-    auto enc = ext::sha256(key);
+    auto enc = ext::sha256(key, keylen);
     memcpy(keystr, enc.data(), BLOCK_SIZE);
-  } else if (keylen < BLOCK_SIZE) {
-#ifdef _MSC_VER
-    strcpy_s(keystr, BLOCK_SIZE, key);
-#else
-    strcpy(keystr, key);
-#endif
-    memset(keystr + keylen, '\0', BLOCK_SIZE - keylen);
   } else {
     memcpy(keystr, key, keylen);
   }
 
-  char o_key_pad[BLOCK_SIZE] {}; //setup the o_key_pad
-  char i_key_pad[BLOCK_SIZE] {}; //setup the i_key_pad
+  unsigned char o_key_pad[BLOCK_SIZE] {}; //setup the o_key_pad
+  unsigned char i_key_pad[BLOCK_SIZE] {}; //setup the i_key_pad
   memset(i_key_pad, 0x36, BLOCK_SIZE);
   memset(o_key_pad, 0x5c, BLOCK_SIZE);
 
@@ -43,22 +44,44 @@ std::string hmac(const char *key, size_t keylen, const char *message, size_t msg
     i_key_pad[i] ^= keystr[i];
   }
 
-  const size_t tmplen = BLOCK_SIZE + msglen;
-  std::vector<char> tmp1(BLOCK_SIZE + tmplen);
-  //char tmp1[BLOCK_SIZE + tmplen];
+  // both pads fill exactly one block, the hash
+  // states after the pads are kept for signing
+  inner_.init();
+  inner_.update(i_key_pad, BLOCK_SIZE);
+  outer_.init();
+  outer_.update(o_key_pad, BLOCK_SIZE);
+}
 
-  memcpy(tmp1.data(), i_key_pad, BLOCK_SIZE);
-  memcpy(tmp1.data() + BLOCK_SIZE, message, msglen);
+std::string hmac_key::sign(const std::string &message) const
+{
+  return sign(message.data(), message.length());
+}
 
-  unsigned char h1[HASH_SIZE] {};
-  ext::sha256(tmp1.data(), tmplen, h1, HASH_SIZE);
+std::string hmac_key::sign(const char *message, size_t msglen) const
+{
+  unsigned char digest[DIGEST_SIZE];
+  sign(message, msglen, digest);
 
-  char tmp2[BLOCK_SIZE * HASH_SIZE];
+  static const char hex[] = "0123456789abcdef";
+  std::string result(2 * DIGEST_SIZE, '\0');
+  for (unsigned int i = 0; i < DIGEST_SIZE; ++i) {
+    result[2 * i] = hex[digest[i] >> 4];
+    result[2 * i + 1] = hex[digest[i] & 0x0f];
+  }
+  return result;
+}
 
-  memcpy(tmp2, o_key_pad, BLOCK_SIZE);
-  memcpy(tmp2 + BLOCK_SIZE, h1, HASH_SIZE);
+void hmac_key::sign(const char *message, size_t msglen, unsigned char *digest) const
+{
+  unsigned char h1[DIGEST_SIZE] {};
 
-  auto result = ext::sha256(tmp2, BLOCK_SIZE + HASH_SIZE);
-  return result;
+  auto inner = inner_;
+  inner.update(reinterpret_cast<const unsigned char*>(message), static_cast<unsigned int>(msglen));
+  inner.final(h1);
+
+  auto outer = outer_;
+  outer.update(h1, DIGEST_SIZE);
+  outer.final(digest);
 }
+
 }
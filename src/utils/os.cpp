@@ -278,6 +278,30 @@ size_t file_size(FILE *stream)
 #endif
 }
 
+bool stat_file(const std::string &path, file_stat &st)
+{
+  return stat_file(path.c_str(), st);
+}
+
+bool stat_file(const char *path, file_stat &st)
+{
+#ifdef _WIN32
+  struct _stat64 buf{};
+  if (::_stat64(path, &buf) != 0 || (buf.st_mode & _S_IFREG) == 0) {
+    return false;
+  }
+#else
+  struct stat buf{};
+  if (::stat(path, &buf) != 0 || !S_ISREG(buf.st_mode)) {
+    return false;
+  }
+#endif
+  st.mtime = buf.st_mtime;
+  st.inode = static_cast<std::uint64_t>(buf.st_ino);
+  st.size = static_cast<std::size_t>(buf.st_size);
+  return true;
+}
+
 std::string build_path(const std::string &a, const std::string &b)
 {
   return a + DIR_SEPARATOR_STRING + b;
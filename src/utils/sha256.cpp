@@ -14,6 +14,18 @@
 
 #include <cstring>
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MATADOR_SHA256_SHANI
+#define MATADOR_SHANI_TARGET __attribute__((target("sha,sse4.1")))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER)
+#define MATADOR_SHA256_SHANI
+#define MATADOR_SHANI_TARGET
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
 namespace matador {
 namespace ext {
 
@@ -35,8 +47,111 @@ const unsigned int SHA256::sha256_k[64] = //UL = uint32
    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
 
+#ifdef MATADOR_SHA256_SHANI
+namespace {
+
+bool has_sha_extensions()
+{
+  unsigned int info[4] {};
+#ifdef _MSC_VER
+  int regs[4];
+  __cpuid(regs, 0);
+  if (regs[0] < 7) {
+    return false;
+  }
+  __cpuid(regs, 1);
+  info[2] = static_cast<unsigned int>(regs[2]);
+  __cpuidex(regs, 7, 0);
+  info[1] = static_cast<unsigned int>(regs[1]);
+#else
+  if (__get_cpuid_max(0, nullptr) < 7) {
+    return false;
+  }
+  unsigned int eax, ebx, ecx, edx;
+  __cpuid(1, eax, ebx, ecx, edx);
+  info[2] = ecx;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  info[1] = ebx;
+#endif
+  const bool ssse3 = (info[2] & (1u << 9)) != 0;
+  const bool sse41 = (info[2] & (1u << 19)) != 0;
+  const bool sha = (info[1] & (1u << 29)) != 0;
+  return ssse3 && sse41 && sha;
+}
+
+/*
+ * Processes the blocks with the x86 SHA extensions. The state
+ * is kept as ABEF/CDGH register pair, each sha256rnds2 does two
+ * rounds and the message schedule is four words per register.
+ */
+MATADOR_SHANI_TARGET
+void transform_sha_extensions(unsigned int *h, const unsigned int *k, const unsigned char *message, unsigned int block_nb)
+{
+  const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&h[0]));
+  __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&h[4]));
+  tmp = _mm_shuffle_epi32(tmp, 0xB1);
+  state1 = _mm_shuffle_epi32(state1, 0x1B);
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+  __m128i w[16];
+  for (unsigned int i = 0; i < block_nb; ++i) {
+    const unsigned char *sub_block = message + (i << 6);
+    const __m128i abef = state0;
+    const __m128i cdgh = state1;
+
+    for (int j = 0; j < 16; ++j) {
+      if (j < 4) {
+        w[j] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sub_block + (j << 4))), mask);
+      } else {
+        __m128i x = _mm_sha256msg1_epu32(w[j - 4], w[j - 3]);
+        x = _mm_add_epi32(x, _mm_alignr_epi8(w[j - 1], w[j - 2], 4));
+        w[j] = _mm_sha256msg2_epu32(x, w[j - 1]);
+      }
+      __m128i msg = _mm_add_epi32(w[j], _mm_loadu_si128(reinterpret_cast<const __m128i*>(&k[j << 2])));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+      msg = _mm_shuffle_epi32(msg, 0x0E);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    }
+
+    state0 = _mm_add_epi32(state0, abef);
+    state1 = _mm_add_epi32(state1, cdgh);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1B);
+  state1 = _mm_shuffle_epi32(state1, 0xB1);
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+  state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&h[0]), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&h[4]), state1);
+}
+
+}
+#endif
+
+bool SHA256::accelerated()
+{
+#ifdef MATADOR_SHA256_SHANI
+  static const bool sha_extensions = has_sha_extensions();
+  return sha_extensions;
+#else
+  return false;
+#endif
+}
+
 void SHA256::transform(const unsigned char *message, unsigned int block_nb)
 {
+#ifdef MATADOR_SHA256_SHANI
+  if (accelerated()) {
+    if (block_nb > 0) {
+      transform_sha_extensions(m_h, sha256_k, message, block_nb);
+    }
+    return;
+  }
+#endif
   uint32 w[64];
   uint32 wv[8];
   uint32 t1, t2;
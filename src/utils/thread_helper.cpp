@@ -3,6 +3,13 @@
 #include <mutex>
 #include <map>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
 namespace matador {
 std::size_t acquire_thread_index(std::thread::id id)
 {
@@ -16,4 +23,20 @@ std::size_t acquire_thread_index(std::thread::id id)
   return ids[id];
 }
 
+bool pin_thread_to_cpu(std::thread &thread, std::size_t cpu)
+{
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu % CPU_SETSIZE, &cpuset);
+  return pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset) == 0;
+#elif defined(_WIN32)
+  return SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (cpu % (sizeof(DWORD_PTR) * 8))) != 0;
+#else
+  (void)thread;
+  (void)cpu;
+  return false;
+#endif
+}
+
 }
@@ -0,0 +1,304 @@
+#include "AsyncClientTest.hpp"
+
+#include "../NetUtils.hpp"
+
+#include "matador/http/async_client.hpp"
+#include "matador/http/http_server.hpp"
+
+#include "matador/net/io_service.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace matador;
+using namespace ::detail;
+
+namespace {
+
+void add_routes(http::server &s)
+{
+  s.add_routing_middleware();
+  s.on_get("/test/{name}", [](const http::request &req) {
+    return http::response::ok("<h1>hello " + req.path_params().at("name") + "</h1>", http::mime_types::TYPE_TEXT_HTML);
+  });
+  s.on_post("/test", [](const http::request &req) {
+    return http::response::ok(req.body(), http::mime_types::TYPE_TEXT_PLAIN);
+  });
+  s.on_get("/slow", [](const http::request &) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    return http::response::ok("slow", http::mime_types::TYPE_TEXT_PLAIN);
+  });
+}
+
+}
+
+AsyncClientTest::AsyncClientTest()
+  : matador::unit_test("http_async_client", "http async client test")
+{
+  add_test("get", [this]() { test_get(); }, "http async client get test");
+  add_test("concurrent", [this]() { test_concurrent(); }, "http async client concurrent requests test");
+  add_test("threads", [this]() { test_threads(); }, "http async client requests from many threads test");
+  add_test("timeout", [this]() { test_timeout(); }, "http async client request timeout test");
+  add_test("refused", [this]() { test_refused(); }, "http async client connection refused test");
+  add_test("resolve_timeout", [this]() { test_resolve_timeout(); }, "http async client timeout while resolving test");
+}
+
+void AsyncClientTest::test_get()
+{
+  http::server s(7799);
+  utils::ThreadRunner server_runner([&s] {
+    add_routes(s);
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  io_service service;
+  utils::ThreadRunner client_runner([&service] {
+    service.run();
+  }, [&service] {
+    service.shutdown();
+  });
+  UNIT_ASSERT_TRUE(utils::wait_until_running(service));
+
+  http::async_client c(service, "localhost:7799");
+
+  auto resp = c.get("/test/world").get();
+  UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+  UNIT_ASSERT_EQUAL("<h1>hello world</h1>", resp.body());
+
+  resp = c.post("/test", "hello").get();
+  UNIT_ASSERT_EQUAL("hello", resp.body());
+
+  // the connection was kept
+  UNIT_ASSERT_EQUAL(1UL, c.connections());
+  UNIT_ASSERT_EQUAL(1UL, c.idle_connections());
+
+  std::promise<std::string> result;
+  c.get("/test/callback", [&result](int ec, const http::response &r) {
+    result.set_value(ec == 0 ? r.body() : std::string("error"));
+  });
+  UNIT_ASSERT_EQUAL("<h1>hello callback</h1>", result.get_future().get());
+  UNIT_ASSERT_EQUAL(1UL, c.connections());
+}
+
+void AsyncClientTest::test_concurrent()
+{
+  http::server s(7799);
+  utils::ThreadRunner server_runner([&s] {
+    add_routes(s);
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  io_service service;
+  utils::ThreadRunner client_runner([&service] {
+    service.run();
+  }, [&service] {
+    service.shutdown();
+  });
+  UNIT_ASSERT_TRUE(utils::wait_until_running(service));
+
+  http::async_client c(service, "localhost:7799");
+  c.max_idle_connections(200);
+
+  const int count = 200;
+  std::mutex mutex;
+  std::condition_variable finished;
+  int completed = 0;
+  std::atomic<int> succeeded { 0 };
+
+  // all requests are in flight at once and
+  // dispatched by the one io service thread
+  for (int i = 0; i < count; ++i) {
+    const auto name = std::to_string(i);
+    c.get("/test/" + name, [&, name](int ec, const http::response &resp) {
+      if (ec == 0 && resp.body() == "<h1>hello " + name + "</h1>") {
+        ++succeeded;
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      ++completed;
+      finished.notify_one();
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    UNIT_ASSERT_TRUE(finished.wait_for(lock, std::chrono::seconds(30), [&] { return completed == count; }));
+  }
+  UNIT_ASSERT_EQUAL(count, succeeded.load());
+  UNIT_ASSERT_TRUE(c.idle_connections() > 0);
+  UNIT_ASSERT_TRUE(c.connections() <= static_cast<std::size_t>(count));
+
+  // a second round reuses the kept connections
+  const auto connections = c.connections();
+  auto resp = c.get("/test/again").get();
+  UNIT_ASSERT_EQUAL("<h1>hello again</h1>", resp.body());
+  UNIT_ASSERT_EQUAL(connections, c.connections());
+}
+
+void AsyncClientTest::test_threads()
+{
+  http::server s(7799);
+  utils::ThreadRunner server_runner([&s] {
+    add_routes(s);
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  io_service service;
+  utils::ThreadRunner client_runner([&service] {
+    service.run();
+  }, [&service] {
+    service.shutdown();
+  });
+  UNIT_ASSERT_TRUE(utils::wait_until_running(service));
+
+  http::async_client c(service, "localhost:7799");
+
+  // each thread waits for its response before it sends
+  // the next request; the kept connections are handed
+  // over from thread to thread
+  const int thread_count = 8;
+  const int count = 25;
+  std::atomic<int> succeeded { 0 };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&c, &succeeded, t] {
+      for (int i = 0; i < count; ++i) {
+        const auto name = std::to_string(t) + "_" + std::to_string(i);
+        try {
+          if (c.get("/test/" + name).get().body() == "<h1>hello " + name + "</h1>") {
+            ++succeeded;
+          }
+        } catch (std::system_error &) {
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  UNIT_ASSERT_EQUAL(thread_count * count, succeeded.load());
+  UNIT_ASSERT_TRUE(c.connections() <= static_cast<std::size_t>(thread_count));
+  UNIT_ASSERT_EQUAL(c.connections(), c.idle_connections());
+}
+
+void AsyncClientTest::test_timeout()
+{
+  http::server s(7799);
+  utils::ThreadRunner server_runner([&s] {
+    add_routes(s);
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  io_service service;
+  utils::ThreadRunner client_runner([&service] {
+    service.run();
+  }, [&service] {
+    service.shutdown();
+  });
+  UNIT_ASSERT_TRUE(utils::wait_until_running(service));
+
+  http::async_client c(service, "localhost:7799");
+
+  std::promise<int> result;
+  c.execute(http::request(http::http::GET, "localhost", "/slow"), [&result](int ec, const http::response &) {
+    result.set_value(ec);
+  }, std::chrono::milliseconds(100));
+  UNIT_ASSERT_EQUAL(ETIMEDOUT, result.get_future().get());
+
+  c.timeout(std::chrono::milliseconds(100));
+  UNIT_ASSERT_EQUAL(100, c.timeout().count());
+  auto future = c.get("/slow");
+  UNIT_ASSERT_EXCEPTION(future.get(), std::system_error, "Connection timed out");
+
+  // the timed out connections are closed
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  UNIT_ASSERT_EQUAL(0UL, c.connections());
+
+  c.timeout(std::chrono::seconds(5));
+  UNIT_ASSERT_EQUAL("slow", c.get("/slow").get().body());
+}
+
+void AsyncClientTest::test_refused()
+{
+  io_service service;
+  utils::ThreadRunner client_runner([&service] {
+    service.run();
+  }, [&service] {
+    service.shutdown();
+  });
+  UNIT_ASSERT_TRUE(utils::wait_until_running(service));
+
+  // nobody listens
+  http::async_client c(service, "localhost:7800");
+  std::promise<int> result;
+  c.get("/", [&result](int ec, const http::response &) {
+    result.set_value(ec);
+  });
+  UNIT_ASSERT_EQUAL(ECONNREFUSED, result.get_future().get());
+  UNIT_ASSERT_EQUAL(0UL, c.connections());
+}
+
+void AsyncClientTest::test_resolve_timeout()
+{
+  http::server s(7799);
+  utils::ThreadRunner server_runner([&s] {
+    add_routes(s);
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  io_service service;
+  utils::ThreadRunner client_runner([&service] {
+    service.run();
+  }, [&service] {
+    service.shutdown();
+  });
+  UNIT_ASSERT_TRUE(utils::wait_until_running(service));
+
+  // the host is resolved once the test allows it
+  std::promise<void> resolvable;
+  auto resolved = resolvable.get_future().share();
+  http::async_client c(service, "localhost:7799");
+  c.resolver([resolved](const std::string &host, const std::string &port) {
+    resolved.wait();
+    tcp::resolver resolver;
+    return resolver.resolve(host, port);
+  });
+
+  // times out while the host is still resolved
+  std::promise<int> result;
+  c.execute(http::request(http::http::GET, "localhost", "/test/one"), [&result](int ec, const http::response &) {
+    result.set_value(ec);
+  }, std::chrono::milliseconds(100));
+  auto late = c.execute(http::request(http::http::GET, "localhost", "/test/two"));
+
+  auto future = result.get_future();
+  UNIT_ASSERT_TRUE(future.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+  UNIT_ASSERT_EQUAL(ETIMEDOUT, future.get());
+
+  // requests with time left are sent once resolved
+  resolvable.set_value();
+  UNIT_ASSERT_EQUAL("<h1>hello two</h1>", late.get().body());
+}
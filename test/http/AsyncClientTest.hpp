@@ -0,0 +1,20 @@
+#ifndef MATADOR_ASYNCCLIENTTEST_HPP
+#define MATADOR_ASYNCCLIENTTEST_HPP
+
+#include "matador/unit/unit_test.hpp"
+
+class AsyncClientTest : public matador::unit_test
+{
+public:
+  AsyncClientTest();
+
+  void test_get();
+  void test_concurrent();
+  void test_threads();
+  void test_timeout();
+  void test_refused();
+  void test_resolve_timeout();
+};
+
+
+#endif //MATADOR_ASYNCCLIENTTEST_HPP
@@ -0,0 +1,326 @@
+#include "CompressionMiddlewareTest.hpp"
+
+#if defined(MATADOR_ZLIB)
+
+#include "matador/http/middleware/compression_middleware.hpp"
+#include "matador/http/request.hpp"
+#include "matador/http/request_header.hpp"
+#include "matador/http/response_header.hpp"
+#include "matador/http/mime_types.hpp"
+
+#include "matador/net/file_body.hpp"
+
+#include "matador/utils/file.hpp"
+#include "matador/utils/os.hpp"
+
+#include <zlib.h>
+
+using namespace matador;
+using namespace matador::http;
+using namespace matador::http::middlewares;
+
+namespace {
+
+void write_file(const std::string &path, const std::string &content)
+{
+  file f(path, "w");
+  ::fwrite(content.c_str(), sizeof(char), content.size(), f.stream());
+}
+
+std::string inflate(const std::string &data, bool gzip)
+{
+  z_stream stream{};
+  if (inflateInit2(&stream, gzip ? 15 + 16 : 15) != Z_OK) {
+    return "";
+  }
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  std::string result;
+  char buf[1024];
+  int ret;
+  do {
+    stream.next_out = reinterpret_cast<Bytef*>(buf);
+    stream.avail_out = sizeof(buf);
+    ret = ::inflate(&stream, Z_NO_FLUSH);
+    result.append(buf, sizeof(buf) - stream.avail_out);
+  } while (ret == Z_OK);
+  inflateEnd(&stream);
+  return ret == Z_STREAM_END ? result : "";
+}
+
+request create_request(const std::string &accept_encoding)
+{
+  request req(http::http::GET, "localhost", "/");
+  if (!accept_encoding.empty()) {
+    req.add_header(request_header::ACCEPT_ENCODING, accept_encoding);
+  }
+  return req;
+}
+
+class body_middleware : public middleware
+{
+public:
+  explicit body_middleware(std::string body) : body_(std::move(body)) {}
+
+  response process(request &, const next_func_t &) override
+  {
+    return response::ok(body_, mime_types::TYPE_TEXT_HTML);
+  }
+
+private:
+  std::string body_;
+};
+
+std::string text(std::size_t size)
+{
+  std::string result;
+  while (result.size() < size) {
+    result += "the quick brown fox jumps over the lazy dog ";
+  }
+  result.resize(size);
+  return result;
+}
+
+}
+
+CompressionMiddlewareTest::CompressionMiddlewareTest()
+  : matador::unit_test("compression_middleware", "compression middleware test")
+{
+  add_test("negotiate", [this] { test_negotiate(); }, "compression middleware negotiate test");
+  add_test("compress", [this] { test_compress(); }, "compression middleware compress test");
+  add_test("eligible", [this] { test_eligible(); }, "compression middleware eligible response test");
+  add_test("shared", [this] { test_shared_body(); }, "compression middleware shared body test");
+  add_test("precompressed", [this] { test_precompressed(); }, "compression middleware precompressed file test");
+  add_test("stream", [this] { test_stream(); }, "compression middleware streamed body test");
+}
+
+void CompressionMiddlewareTest::initialize()
+{
+  os::mkdir("compression_test");
+}
+
+void CompressionMiddlewareTest::finalize()
+{
+  for (const auto &name : { "app.js", "app.js.gz", "style.css" }) {
+    auto path = std::string("compression_test/") + name;
+    if (os::exists(path)) {
+      os::remove(path);
+    }
+  }
+  os::rmdir("compression_test");
+}
+
+void CompressionMiddlewareTest::test_negotiate()
+{
+  UNIT_ASSERT_EQUAL(compression_middleware::GZIP, compression_middleware::negotiate("gzip, deflate, br"));
+  UNIT_ASSERT_EQUAL(compression_middleware::GZIP, compression_middleware::negotiate("deflate, gzip"));
+  UNIT_ASSERT_EQUAL(compression_middleware::GZIP, compression_middleware::negotiate("x-gzip"));
+  UNIT_ASSERT_EQUAL(compression_middleware::DEFLATE, compression_middleware::negotiate("deflate"));
+  UNIT_ASSERT_EQUAL(compression_middleware::DEFLATE, compression_middleware::negotiate("gzip;q=0.5, deflate"));
+  UNIT_ASSERT_EQUAL(compression_middleware::DEFLATE, compression_middleware::negotiate("gzip;q=0, *"));
+  UNIT_ASSERT_EQUAL(compression_middleware::GZIP, compression_middleware::negotiate("*"));
+  UNIT_ASSERT_EQUAL(compression_middleware::IDENTITY, compression_middleware::negotiate("br, identity"));
+  UNIT_ASSERT_EQUAL(compression_middleware::IDENTITY, compression_middleware::negotiate("*;q=0"));
+  UNIT_ASSERT_EQUAL(compression_middleware::IDENTITY, compression_middleware::negotiate(""));
+}
+
+void CompressionMiddlewareTest::test_compress()
+{
+  const auto data = text(10000);
+
+  std::string compressed;
+  UNIT_ASSERT_TRUE(compression_middleware::compress(data.data(), data.size(), compression_middleware::GZIP, -1, compressed));
+  UNIT_ASSERT_TRUE(compressed.size() < data.size());
+  UNIT_ASSERT_EQUAL(data, inflate(compressed, true));
+
+  UNIT_ASSERT_TRUE(compression_middleware::compress(data.data(), data.size(), compression_middleware::DEFLATE, 9, compressed));
+  UNIT_ASSERT_EQUAL(data, inflate(compressed, false));
+
+  UNIT_ASSERT_FALSE(compression_middleware::compress(data.data(), data.size(), compression_middleware::IDENTITY, -1, compressed));
+
+  // the last added middleware runs first
+  middleware_pipeline pipeline;
+  pipeline.add(std::make_shared<body_middleware>(data));
+  pipeline.add(std::make_shared<compression_middleware>());
+
+  auto req = create_request("gzip");
+  auto resp = pipeline.process(req);
+
+  UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+  UNIT_ASSERT_EQUAL("gzip", resp.headers().at(response_header::CONTENT_ENCODING));
+  UNIT_ASSERT_EQUAL(request_header::ACCEPT_ENCODING, resp.headers().at(response_header::VARY));
+  UNIT_ASSERT_EQUAL(std::to_string(resp.body().size()), resp.content().length);
+  UNIT_ASSERT_EQUAL(data, inflate(resp.body(), true));
+
+  req = create_request("deflate");
+  resp = pipeline.process(req);
+  UNIT_ASSERT_EQUAL("deflate", resp.headers().at(response_header::CONTENT_ENCODING));
+  UNIT_ASSERT_EQUAL(data, inflate(resp.body(), false));
+
+  // not accepted
+  req = create_request("");
+  resp = pipeline.process(req);
+  UNIT_ASSERT_TRUE(resp.headers().count(response_header::CONTENT_ENCODING) == 0);
+  UNIT_ASSERT_EQUAL(request_header::ACCEPT_ENCODING, resp.headers().at(response_header::VARY));
+  UNIT_ASSERT_EQUAL(data, resp.body());
+}
+
+void CompressionMiddlewareTest::test_eligible()
+{
+  compression_middleware cm;
+  UNIT_ASSERT_TRUE(cm.is_compressible("text/html"));
+  UNIT_ASSERT_TRUE(cm.is_compressible("text/plain; charset=utf-8"));
+  UNIT_ASSERT_TRUE(cm.is_compressible("application/json"));
+  UNIT_ASSERT_TRUE(cm.is_compressible("image/svg+xml"));
+  UNIT_ASSERT_FALSE(cm.is_compressible("image/png"));
+  UNIT_ASSERT_FALSE(cm.is_compressible("application/json-seq"));
+  UNIT_ASSERT_FALSE(cm.is_compressible("text/"));
+  UNIT_ASSERT_FALSE(cm.is_compressible(""));
+  cm.add_mime_type("application/wasm");
+  UNIT_ASSERT_TRUE(cm.is_compressible("application/wasm"));
+
+  auto req = create_request("gzip");
+
+  // too small
+  auto resp = cm.process(req, []() { return response::ok("small", mime_types::TYPE_TEXT_PLAIN); });
+  UNIT_ASSERT_TRUE(resp.headers().count(response_header::CONTENT_ENCODING) == 0);
+  UNIT_ASSERT_EQUAL("small", resp.body());
+
+  cm.min_size(0);
+  UNIT_ASSERT_EQUAL(0UL, cm.min_size());
+  resp = cm.process(req, []() { return response::ok("small", mime_types::TYPE_TEXT_PLAIN); });
+  UNIT_ASSERT_EQUAL("gzip", resp.headers().at(response_header::CONTENT_ENCODING));
+  UNIT_ASSERT_EQUAL("small", inflate(resp.body(), true));
+
+  // not compressible
+  const auto data = text(2000);
+  resp = cm.process(req, [&data]() { return response::ok(data, mime_types::TYPE_IMAGE_PNG); });
+  UNIT_ASSERT_TRUE(resp.headers().count(response_header::CONTENT_ENCODING) == 0);
+  UNIT_ASSERT_TRUE(resp.headers().count(response_header::VARY) == 0);
+  UNIT_ASSERT_EQUAL(data, resp.body());
+
+  // already encoded
+  resp = cm.process(req, [&data]() {
+    auto r = response::ok(data, mime_types::TYPE_TEXT_PLAIN);
+    r.add_header(response_header::CONTENT_ENCODING, "br");
+    return r;
+  });
+  UNIT_ASSERT_EQUAL("br", resp.headers().at(response_header::CONTENT_ENCODING));
+  UNIT_ASSERT_EQUAL(data, resp.body());
+
+  // vary is merged and a strong etag becomes weak
+  resp = cm.process(req, [&data]() {
+    auto r = response::ok(data, mime_types::TYPE_TEXT_PLAIN);
+    r.add_header(response_header::VARY, "Origin");
+    r.add_header(response_header::ETAG, "\"abc\"");
+    return r;
+  });
+  UNIT_ASSERT_EQUAL("Origin, Accept-Encoding", resp.headers().at(response_header::VARY));
+  UNIT_ASSERT_EQUAL("W/\"abc\"", resp.headers().at(response_header::ETAG));
+}
+
+void CompressionMiddlewareTest::test_shared_body()
+{
+  auto body = std::make_shared<const std::string>(text(5000));
+
+  compression_middleware cm;
+  auto req = create_request("gzip");
+  const auto next = [&body]() { return response::shared(http::http::OK, body, "text/css"); };
+
+  auto resp = cm.process(req, next);
+  UNIT_ASSERT_EQUAL("gzip", resp.headers().at(response_header::CONTENT_ENCODING));
+  UNIT_ASSERT_EQUAL(*body, inflate(resp.body(), true));
+  const auto compressed = resp.shared_body();
+  UNIT_ASSERT_TRUE(compressed != nullptr);
+  UNIT_ASSERT_EQUAL(compressed->size(), cm.cache_size());
+
+  // compressed once
+  resp = cm.process(req, next);
+  UNIT_ASSERT_TRUE(resp.shared_body() == compressed);
+  UNIT_ASSERT_EQUAL(compressed->size(), cm.cache_size());
+
+  // one cached body per encoding
+  req = create_request("deflate");
+  resp = cm.process(req, next);
+  UNIT_ASSERT_EQUAL(*body, inflate(resp.body(), false));
+  UNIT_ASSERT_TRUE(cm.cache_size() > compressed->size());
+
+  // a changed body is compressed again
+  body = std::make_shared<const std::string>(text(6000));
+  req = create_request("gzip");
+  resp = cm.process(req, next);
+  UNIT_ASSERT_TRUE(resp.shared_body() != compressed);
+  UNIT_ASSERT_EQUAL(*body, inflate(resp.body(), true));
+
+  // only the most recent body is kept
+  cm.max_cache_size(0);
+  resp = cm.process(req, next);
+  UNIT_ASSERT_EQUAL(*body, inflate(resp.body(), true));
+}
+
+void CompressionMiddlewareTest::test_precompressed()
+{
+  const auto data = text(3000);
+  std::string compressed;
+  compression_middleware::compress(data.data(), data.size(), compression_middleware::GZIP, 9, compressed);
+  write_file("compression_test/app.js", data);
+  write_file("compression_test/app.js.gz", compressed);
+  write_file("compression_test/style.css", data);
+
+  compression_middleware cm;
+  auto req = create_request("gzip, deflate");
+
+  auto resp = cm.process(req, []() { return response::send_file("compression_test/app.js"); });
+  UNIT_ASSERT_EQUAL("gzip", resp.headers().at(response_header::CONTENT_ENCODING));
+  UNIT_ASSERT_TRUE(resp.body_file() != nullptr);
+  UNIT_ASSERT_EQUAL(compressed.size(), resp.body_file()->size());
+  UNIT_ASSERT_EQUAL(std::to_string(compressed.size()), resp.content().length);
+  UNIT_ASSERT_EQUAL(data, inflate(resp.body_file()->to_string(), true));
+
+  // no precompressed sibling
+  resp = cm.process(req, []() { return response::send_file("compression_test/style.css"); });
+  UNIT_ASSERT_TRUE(resp.headers().count(response_header::CONTENT_ENCODING) == 0);
+  UNIT_ASSERT_EQUAL(data.size(), resp.body_file()->size());
+
+  // deflate only
+  req = create_request("deflate");
+  resp = cm.process(req, []() { return response::send_file("compression_test/app.js"); });
+  UNIT_ASSERT_TRUE(resp.headers().count(response_header::CONTENT_ENCODING) == 0);
+  UNIT_ASSERT_EQUAL(data.size(), resp.body_file()->size());
+
+  cm.precompressed(false);
+  req = create_request("gzip");
+  resp = cm.process(req, []() { return response::send_file("compression_test/app.js"); });
+  UNIT_ASSERT_TRUE(resp.headers().count(response_header::CONTENT_ENCODING) == 0);
+}
+
+void CompressionMiddlewareTest::test_stream()
+{
+  compression_middleware cm;
+  auto req = create_request("gzip");
+
+  auto resp = cm.process(req, []() {
+    auto count = std::make_shared<int>(0);
+    return response::stream([count](std::string &chunk) {
+      chunk = "chunk " + std::to_string(*count) + "\n";
+      return ++(*count) < 3;
+    }, mime_types::TYPE_TEXT_PLAIN);
+  });
+
+  UNIT_ASSERT_EQUAL("gzip", resp.headers().at(response_header::CONTENT_ENCODING));
+  UNIT_ASSERT_EQUAL("chunked", resp.headers().at(response_header::TRANSFER_ENCODING));
+
+  std::string compressed;
+  std::string chunk;
+  bool more = true;
+  while (more) {
+    chunk.clear();
+    more = resp.body_producer()(chunk);
+    // every chunk is flushed
+    UNIT_ASSERT_FALSE(chunk.empty());
+    compressed += chunk;
+  }
+  UNIT_ASSERT_EQUAL("chunk 0\nchunk 1\nchunk 2\n", inflate(compressed, true));
+}
+
+#endif
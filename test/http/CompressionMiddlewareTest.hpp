@@ -0,0 +1,23 @@
+#ifndef MATADOR_COMPRESSIONMIDDLEWARETEST_HPP
+#define MATADOR_COMPRESSIONMIDDLEWARETEST_HPP
+
+#include "matador/unit/unit_test.hpp"
+
+class CompressionMiddlewareTest : public matador::unit_test
+{
+public:
+  CompressionMiddlewareTest();
+
+  void initialize() override;
+  void finalize() override;
+
+  void test_negotiate();
+  void test_compress();
+  void test_eligible();
+  void test_shared_body();
+  void test_precompressed();
+  void test_stream();
+};
+
+
+#endif //MATADOR_COMPRESSIONMIDDLEWARETEST_HPP
@@ -3,6 +3,11 @@
 #include "HttpTestServer.hpp"
 
 #include "matador/http/http_client.hpp"
+#include "matador/http/http_server.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
 
 #include "../NetUtils.hpp"
 
@@ -16,6 +21,10 @@ HttpClientTest::HttpClientTest()
   add_test("post", [this]() { test_post(); }, "http client post test");
   add_test("put", [this]() { test_put(); }, "http client put test");
   add_test("delete", [this]() { test_delete(); }, "http client delete test");
+  add_test("keep_alive", [this]() { test_keep_alive(); }, "http client keep alive connection test");
+  add_test("reconnect", [this]() { test_reconnect(); }, "http client reconnect closed connection test");
+  add_test("max_connections", [this]() { test_max_connections(); }, "http client max connections per host test");
+  add_test("read_timeout", [this]() { test_read_timeout(); }, "http client read timeout test");
 }
 
 void HttpClientTest::test_get() {
@@ -101,3 +110,167 @@ void HttpClientTest::test_delete() {
 
   UNIT_ASSERT_TRUE(utils::wait_until_stopped(server));
 }
+
+void HttpClientTest::test_keep_alive()
+{
+  http::server s(7794);
+
+  utils::ThreadRunner runner([&s] {
+    s.add_routing_middleware();
+    s.on_get("/test/{name}", [](const http::request &req) {
+      return http::response::ok("<h1>hello " + req.path_params().at("name") + "</h1>", http::mime_types::TYPE_TEXT_HTML);
+    });
+    s.on_post("/test", [](const http::request &req) {
+      return http::response::ok(req.body(), http::mime_types::TYPE_TEXT_PLAIN);
+    });
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  http::client c("localhost:7794");
+  for (int i = 0; i < 10; ++i) {
+    auto resp = c.get("/test/" + std::to_string(i));
+    UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+    UNIT_ASSERT_EQUAL("<h1>hello " + std::to_string(i) + "</h1>", resp.body());
+  }
+  auto resp = c.post("/test", "hello");
+  UNIT_ASSERT_EQUAL("hello", resp.body());
+
+  // all requests were sent on one connection
+  UNIT_ASSERT_EQUAL(1UL, c.pool()->connections("localhost", "7794"));
+  UNIT_ASSERT_EQUAL(1UL, c.pool()->idle_connections("localhost", "7794"));
+
+  // a second client shares the pool
+  http::client other("localhost:7794", c.pool());
+  resp = other.get("/test/other");
+  UNIT_ASSERT_EQUAL("<h1>hello other</h1>", resp.body());
+  UNIT_ASSERT_EQUAL(1UL, c.pool()->connections("localhost", "7794"));
+
+  c.pool()->clear();
+  UNIT_ASSERT_EQUAL(0UL, c.pool()->connections("localhost", "7794"));
+}
+
+void HttpClientTest::test_reconnect()
+{
+  http::server s(7795);
+  s.keep_alive_timeout(std::chrono::milliseconds(100));
+  s.max_keep_alive_requests(3);
+
+  utils::ThreadRunner runner([&s] {
+    s.add_routing_middleware();
+    s.on_get("/test/{name}", [](const http::request &req) {
+      return http::response::ok("<h1>hello " + req.path_params().at("name") + "</h1>", http::mime_types::TYPE_TEXT_HTML);
+    });
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  http::client c("localhost:7795");
+  auto resp = c.get("/test/one");
+  UNIT_ASSERT_EQUAL("<h1>hello one</h1>", resp.body());
+  UNIT_ASSERT_EQUAL(1UL, c.pool()->idle_connections("localhost", "7795"));
+
+  // the server closes the idle connection
+  std::this_thread::sleep_for(std::chrono::milliseconds(400));
+  resp = c.get("/test/two");
+  UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+  UNIT_ASSERT_EQUAL("<h1>hello two</h1>", resp.body());
+  UNIT_ASSERT_EQUAL(1UL, c.pool()->connections("localhost", "7795"));
+
+  // the server closes the connection after three requests
+  for (int i = 0; i < 5; ++i) {
+    resp = c.get("/test/" + std::to_string(i));
+    UNIT_ASSERT_EQUAL("<h1>hello " + std::to_string(i) + "</h1>", resp.body());
+  }
+  UNIT_ASSERT_TRUE(c.pool()->connections("localhost", "7795") <= 1);
+}
+
+void HttpClientTest::test_max_connections()
+{
+  http::server s(7796);
+
+  utils::ThreadRunner runner([&s] {
+    s.add_routing_middleware();
+    s.on_get("/test/{name}", [](const http::request &req) {
+      return http::response::ok("<h1>hello " + req.path_params().at("name") + "</h1>", http::mime_types::TYPE_TEXT_HTML);
+    });
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  auto pool = std::make_shared<http::connection_pool>(2);
+  UNIT_ASSERT_EQUAL(2UL, pool->max_connections());
+
+  std::atomic<int> succeeded { 0 };
+  std::atomic<std::size_t> max_used { 0 };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&pool, &succeeded, &max_used] {
+      http::client c("localhost:7796", pool);
+      for (int i = 0; i < 20; ++i) {
+        auto resp = c.get("/test/" + std::to_string(i));
+        if (resp.body() == "<h1>hello " + std::to_string(i) + "</h1>") {
+          ++succeeded;
+        }
+        auto used = pool->connections("localhost", "7796");
+        if (used > max_used.load()) {
+          max_used = used;
+        }
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  UNIT_ASSERT_EQUAL(80, succeeded.load());
+  UNIT_ASSERT_TRUE(max_used.load() <= 2);
+  UNIT_ASSERT_TRUE(pool->idle_connections("localhost", "7796") <= 2);
+}
+
+void HttpClientTest::test_read_timeout()
+{
+  http::server s(7797);
+
+  utils::ThreadRunner runner([&s] {
+    s.add_routing_middleware();
+    s.on_get("/slow", [](const http::request &) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+      return http::response::ok("slow", http::mime_types::TYPE_TEXT_PLAIN);
+    });
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  http::client c("localhost:7797");
+  c.read_timeout(std::chrono::milliseconds(100));
+  UNIT_ASSERT_EQUAL(100, c.read_timeout().count());
+  UNIT_ASSERT_EXCEPTION(c.get("/slow"), std::logic_error, "failed to execute request to localhost:7797");
+  UNIT_ASSERT_EQUAL(0UL, c.pool()->connections("localhost", "7797"));
+
+  c.read_timeout(std::chrono::seconds(2));
+  auto resp = c.get("/slow");
+  UNIT_ASSERT_EQUAL("slow", resp.body());
+
+  // nobody listens
+  http::client unreachable("localhost:7798");
+  unreachable.connect_timeout(std::chrono::milliseconds(200));
+  UNIT_ASSERT_EXCEPTION(unreachable.get("/"), std::logic_error, "couldn't establish connection to localhost:7798");
+  UNIT_ASSERT_EQUAL(0UL, unreachable.pool()->connections("localhost", "7798"));
+}
@@ -12,6 +12,10 @@ public:
   void test_post();
   void test_put();
   void test_delete();
+  void test_keep_alive();
+  void test_reconnect();
+  void test_max_connections();
+  void test_read_timeout();
 };
 
 
@@ -5,13 +5,19 @@
 #include "matador/http/http_server.hpp"
 #include "matador/http/http.hpp"
 #include "matador/http/response.hpp"
+#include "matador/http/response_header.hpp"
 #include "matador/http/request.hpp"
 #include "matador/http/response_parser.hpp"
+#include "matador/http/static_file_service.hpp"
+
+#include "matador/utils/file.hpp"
+#include "matador/utils/os.hpp"
 
 #include "matador/logger/log_manager.hpp"
 
 #include <chrono>
 #include <thread>
+#include <vector>
 
 using namespace matador;
 using namespace ::detail;
@@ -24,6 +30,12 @@ HttpServerTest::HttpServerTest()
   add_test("post", [this]() { test_post(); }, "http server post test");
   add_test("put", [this]() { test_put(); }, "http server put test");
   add_test("delete", [this]() { test_delete(); }, "http server delete test");
+  add_test("static_file", [this]() { test_static_file(); }, "http server static file test");
+  add_test("keep_alive", [this]() { test_keep_alive(); }, "http server keep alive and pipelining test");
+  add_test("empty_body", [this]() { test_empty_body(); }, "http server keep alive with empty response bodies test");
+  add_test("chunked", [this]() { test_chunked(); }, "http server chunked streaming response test");
+  add_test("request_body", [this]() { test_request_body(); }, "http server streamed and limited request body test");
+  add_test("header_size", [this]() { test_header_size(); }, "http server limited request header test");
 }
 
 void HttpServerTest::initialize()
@@ -179,6 +191,466 @@ void HttpServerTest::test_delete()
   s.shutdown();
 }
 
+void HttpServerTest::test_static_file()
+{
+  matador::os::mkdir("static_test");
+  std::string data;
+  for (int i = 0; data.size() < 1024 * 1024; ++i) {
+    data += "var line" + std::to_string(i) + " = " + std::to_string(i * 7) + ";\n";
+  }
+  {
+    file f("static_test/bundle.js", "w");
+    ::fwrite(data.c_str(), sizeof(char), data.size(), f.stream());
+  }
+
+  http::server s(7790);
+
+  utils::ThreadRunner runner([&s] {
+    s.add_routing_middleware();
+
+    http::serve_static_files_at("/static_test/*.*", s);
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  http::request req(http::http::GET, "localhost:7790", "/static_test/bundle.js");
+  http::response response;
+
+  send_request(7790, req, response);
+
+  UNIT_ASSERT_EQUAL(http::http::OK, response.status());
+  UNIT_ASSERT_EQUAL(std::to_string(data.size()), response.content().length);
+  UNIT_ASSERT_EQUAL(data.size(), response.body().size());
+  UNIT_ASSERT_TRUE(data == response.body());
+
+  http::request missing(http::http::GET, "localhost:7790", "/static_test/missing.js");
+  http::response not_found;
+
+  send_request(7790, missing, not_found);
+
+  UNIT_ASSERT_EQUAL(http::http::NOT_FOUND, not_found.status());
+
+  s.shutdown();
+
+  matador::os::remove("static_test/bundle.js");
+  matador::os::rmdir("static_test");
+}
+
+namespace {
+
+std::string receive_responses(tcp::socket &client, std::size_t count, std::vector<http::response> &responses)
+{
+  std::string msg;
+  while (responses.size() < count) {
+    buffer result;
+    auto nread = client.receive(result);
+    if (nread <= 0) {
+      break;
+    }
+    msg.append(result.data(), nread);
+    // split the received data into responses
+    bool done = false;
+    while (!done && responses.size() < count) {
+      auto pos = msg.find("\r\n\r\n");
+      if (pos == std::string::npos) {
+        break;
+      }
+      http::response resp;
+      http::response_parser parser;
+      auto header_end = pos + 4;
+      if (parser.parse(msg.substr(0, header_end), resp) == http::response_parser::INVALID) {
+        break;
+      }
+      // without a length the end of the response is unknown
+      if (resp.headers().find(http::response_header::CONTENT_LENGTH) == resp.headers().end()) {
+        return msg;
+      }
+      auto length = std::stoul(resp.content().length);
+      if (msg.size() < header_end + length) {
+        done = true;
+        continue;
+      }
+      resp = http::response();
+      parser = http::response_parser();
+      parser.parse(msg.substr(0, header_end + length), resp);
+      responses.push_back(resp);
+      msg.erase(0, header_end + length);
+    }
+  }
+  return msg;
+}
+
+}
+
+void HttpServerTest::test_keep_alive()
+{
+  http::server s(7791);
+  s.max_keep_alive_requests(4);
+
+  utils::ThreadRunner runner([&s] {
+    s.add_routing_middleware();
+
+    s.on_get("/test/{name}", [](const http::request &req) {
+      return http::response::ok("<h1>hello " + req.path_params().at("name") + "</h1>",
+                                http::mime_types::TYPE_TEXT_HTML);
+    });
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  tcp::socket client;
+  UNIT_ASSERT_TRUE(matador::is_valid_socket(client.open(tcp::v4())));
+  UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), 7791)));
+
+  // two requests one after another on the same connection
+  std::vector<http::response> responses;
+  std::string req("GET /test/one HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  receive_responses(client, 1, responses);
+  req = "GET /test/two HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  receive_responses(client, 2, responses);
+
+  UNIT_ASSERT_EQUAL(2UL, responses.size());
+  UNIT_ASSERT_EQUAL("<h1>hello one</h1>", responses[0].body());
+  UNIT_ASSERT_EQUAL("keep-alive", responses[0].headers().at(http::response_header::CONNECTION));
+  UNIT_ASSERT_EQUAL("<h1>hello two</h1>", responses[1].body());
+
+  // two pipelined requests in one write; the
+  // second one reaches the request limit
+  req = "GET /test/three HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET /test/four HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  receive_responses(client, 4, responses);
+
+  UNIT_ASSERT_EQUAL(4UL, responses.size());
+  UNIT_ASSERT_EQUAL("<h1>hello three</h1>", responses[2].body());
+  UNIT_ASSERT_EQUAL("<h1>hello four</h1>", responses[3].body());
+  UNIT_ASSERT_EQUAL("close", responses[3].headers().at(http::response_header::CONNECTION));
+
+  // server closes the connection
+  buffer result;
+  UNIT_ASSERT_TRUE(client.receive(result) <= 0);
+  client.close();
+
+  // HTTP/1.0 without keep alive is closed after the response
+  UNIT_ASSERT_TRUE(matador::is_valid_socket(client.open(tcp::v4())));
+  UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), 7791)));
+  responses.clear();
+  req = "GET /test/five HTTP/1.0\r\n\r\n";
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  receive_responses(client, 1, responses);
+  UNIT_ASSERT_EQUAL(1UL, responses.size());
+  UNIT_ASSERT_EQUAL("close", responses[0].headers().at(http::response_header::CONNECTION));
+  UNIT_ASSERT_TRUE(client.receive(result) <= 0);
+  client.close();
+
+  s.shutdown();
+}
+
+namespace {
+
+std::string receive_all(tcp::socket &client)
+{
+  std::string data;
+  buffer result;
+  long nread;
+  while ((nread = client.receive(result)) > 0) {
+    data.append(result.data(), static_cast<std::size_t>(nread));
+    result.clear();
+  }
+  return data;
+}
+
+}
+
+void HttpServerTest::test_empty_body()
+{
+  http::server s(7801);
+
+  utils::ThreadRunner runner([&s] {
+    s.add_routing_middleware();
+
+    s.on_get("/test/{name}", [](const http::request &req) {
+      return http::response::ok("<h1>hello " + req.path_params().at("name") + "</h1>",
+                                http::mime_types::TYPE_TEXT_HTML);
+    });
+    s.on_get("/empty", [](const http::request &) {
+      return http::response::ok("", http::mime_types::TYPE_TEXT_PLAIN);
+    });
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  tcp::socket client;
+  UNIT_ASSERT_TRUE(matador::is_valid_socket(client.open(tcp::v4())));
+  UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), 7801)));
+
+  // responses without a body are followed by the
+  // next pipelined response on the same connection
+  std::vector<http::response> responses;
+  std::string req("GET /unknown HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                  "GET /test/one HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                  "GET /empty HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                  "GET /test/two HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  receive_responses(client, 4, responses);
+  client.close();
+
+  UNIT_ASSERT_EQUAL(4UL, responses.size());
+  UNIT_ASSERT_EQUAL(http::http::NOT_FOUND, responses[0].status());
+  UNIT_ASSERT_EQUAL("0", responses[0].headers().at(http::response_header::CONTENT_LENGTH));
+  UNIT_ASSERT_EQUAL("keep-alive", responses[0].headers().at(http::response_header::CONNECTION));
+  UNIT_ASSERT_EQUAL(http::http::OK, responses[1].status());
+  UNIT_ASSERT_EQUAL("<h1>hello one</h1>", responses[1].body());
+  UNIT_ASSERT_EQUAL(http::http::OK, responses[2].status());
+  UNIT_ASSERT_EQUAL("0", responses[2].headers().at(http::response_header::CONTENT_LENGTH));
+  UNIT_ASSERT_TRUE(responses[2].body().empty());
+  UNIT_ASSERT_EQUAL("<h1>hello two</h1>", responses[3].body());
+
+  s.shutdown();
+}
+
+void HttpServerTest::test_chunked()
+{
+  http::server s(7792);
+
+  // about 2MB in parts of different size
+  std::string expected;
+  for (std::size_t i = 0; i < 2000; ++i) {
+    expected += std::string(i % 1500 + 1, static_cast<char>('a' + i % 26));
+  }
+
+  utils::ThreadRunner runner([&s, &expected] {
+    s.add_routing_middleware();
+
+    s.on_get("/stream", [&expected](const http::request &) {
+      std::size_t pos = 0;
+      std::size_t part = 0;
+      return http::response::stream([&expected, pos, part](std::string &chunk) mutable {
+        auto len = (std::min)(part++ % 1500 + 1, expected.size() - pos);
+        chunk.append(expected, pos, len);
+        pos += len;
+        return pos < expected.size();
+      }, http::mime_types::TYPE_TEXT_PLAIN);
+    });
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  tcp::socket client;
+  UNIT_ASSERT_TRUE(matador::is_valid_socket(client.open(tcp::v4())));
+  UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), 7792)));
+
+  std::string req("GET /stream HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  auto data = receive_all(client);
+  client.close();
+
+  auto header_end = data.find("\r\n\r\n");
+  UNIT_ASSERT_NOT_EQUAL(std::string::npos, header_end);
+  auto header = data.substr(0, header_end);
+  UNIT_ASSERT_NOT_EQUAL(std::string::npos, header.find("Transfer-Encoding: chunked"));
+  UNIT_ASSERT_EQUAL(std::string::npos, header.find("Content-Length"));
+
+  // decode the chunks
+  std::string body;
+  auto pos = header_end + 4;
+  while (true) {
+    auto eol = data.find("\r\n", pos);
+    UNIT_ASSERT_NOT_EQUAL(std::string::npos, eol);
+    auto size = std::stoul(data.substr(pos, eol - pos), nullptr, 16);
+    pos = eol + 2;
+    if (size == 0) {
+      break;
+    }
+    body.append(data, pos, size);
+    pos += size;
+    UNIT_ASSERT_EQUAL("\r\n", data.substr(pos, 2));
+    pos += 2;
+  }
+  UNIT_ASSERT_EQUAL("\r\n", data.substr(pos));
+  UNIT_ASSERT_EQUAL(expected.size(), body.size());
+  UNIT_ASSERT_TRUE(expected == body);
+
+  // HTTP/1.0 gets the plain body and the connection is closed
+  UNIT_ASSERT_TRUE(matador::is_valid_socket(client.open(tcp::v4())));
+  UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), 7792)));
+  req = "GET /stream HTTP/1.0\r\n\r\n";
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  data = receive_all(client);
+  client.close();
+
+  header_end = data.find("\r\n\r\n");
+  UNIT_ASSERT_NOT_EQUAL(std::string::npos, header_end);
+  header = data.substr(0, header_end);
+  UNIT_ASSERT_EQUAL(std::string::npos, header.find("Transfer-Encoding"));
+  UNIT_ASSERT_NOT_EQUAL(std::string::npos, header.find("Connection: close"));
+  UNIT_ASSERT_TRUE(expected == data.substr(header_end + 4));
+
+  s.shutdown();
+}
+
+void HttpServerTest::test_request_body()
+{
+  http::server s(7793);
+  s.max_body_size(64 * 1024);
+
+  std::string uploaded;
+  std::size_t parts = 0;
+  bool complete = false;
+
+  utils::ThreadRunner runner([&] {
+    s.add_routing_middleware();
+
+    s.on_post("/upload/{name}", [&](const http::request &) {
+      uploaded.clear();
+      return [&](const char *data, std::size_t size) {
+        if (size == 0) {
+          complete = true;
+        } else {
+          ++parts;
+          uploaded.append(data, size);
+        }
+        return true;
+      };
+    }, [&](const http::request &req) {
+      return http::response::ok(req.path_params().at("name") + ":" + std::to_string(req.body().size()),
+                                http::mime_types::TYPE_TEXT_PLAIN);
+    });
+    s.on_post("/echo", [](const http::request &req) {
+      return http::response::ok(req.body(), http::mime_types::TYPE_TEXT_PLAIN);
+    });
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  tcp::socket client;
+  UNIT_ASSERT_TRUE(matador::is_valid_socket(client.open(tcp::v4())));
+  UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), 7793)));
+
+  // streamed into the consumer, the request body stays empty
+  std::string body;
+  for (std::size_t i = 0; i < 60000; ++i) {
+    body.push_back(static_cast<char>('a' + i % 26));
+  }
+  std::vector<http::response> responses;
+  std::string req("POST /upload/data HTTP/1.1\r\nContent-Length: 60000\r\n\r\n" + body);
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  receive_responses(client, 1, responses);
+  UNIT_ASSERT_EQUAL(1UL, responses.size());
+  UNIT_ASSERT_EQUAL("data:0", responses[0].body());
+  UNIT_ASSERT_TRUE(complete);
+  UNIT_ASSERT_TRUE(parts > 0);
+  UNIT_ASSERT_TRUE(body == uploaded);
+
+  // chunked body on the same connection
+  req = "POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n7\r\n, world\r\n0\r\n\r\n";
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  receive_responses(client, 2, responses);
+  UNIT_ASSERT_EQUAL(2UL, responses.size());
+  UNIT_ASSERT_EQUAL(http::http::OK, responses[1].status());
+  UNIT_ASSERT_EQUAL("hello, world", responses[1].body());
+
+  // declared content length exceeds the limit;
+  // rejected before the body is sent
+  req = "POST /echo HTTP/1.1\r\nContent-Length: 100000\r\n\r\n";
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  receive_responses(client, 3, responses);
+  UNIT_ASSERT_EQUAL(3UL, responses.size());
+  UNIT_ASSERT_EQUAL(http::http::PAYLOAD_TOO_LARGE, responses[2].status());
+  UNIT_ASSERT_EQUAL("close", responses[2].headers().at(http::response_header::CONNECTION));
+  buffer result;
+  UNIT_ASSERT_TRUE(client.receive(result) <= 0);
+  client.close();
+
+  // chunked body exceeds the limit with its last chunk
+  UNIT_ASSERT_TRUE(matador::is_valid_socket(client.open(tcp::v4())));
+  UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), 7793)));
+  responses.clear();
+  req = "POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n10000\r\n" +
+        std::string(64 * 1024, 'x') + "\r\n1\r\ny\r\n0\r\n\r\n";
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  receive_responses(client, 1, responses);
+  UNIT_ASSERT_EQUAL(1UL, responses.size());
+  UNIT_ASSERT_EQUAL(http::http::PAYLOAD_TOO_LARGE, responses[0].status());
+  client.close();
+
+  s.shutdown();
+}
+
+void HttpServerTest::test_header_size()
+{
+  http::server s(7800);
+  s.max_header_size(48 * 1024);
+
+  utils::ThreadRunner runner([&s] {
+    s.add_routing_middleware();
+    s.on_get("/header", [](const http::request &req) {
+      return http::response::ok(std::to_string(req.headers().at("X-Large").size()), http::mime_types::TYPE_TEXT_PLAIN);
+    });
+    s.run();
+  }, [&s] {
+    s.shutdown();
+    utils::wait_until_stopped(s);
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(s));
+
+  tcp::socket client;
+  UNIT_ASSERT_TRUE(matador::is_valid_socket(client.open(tcp::v4())));
+  UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), 7800)));
+
+  // a header spanning several input segments
+  // sent in parts is within the limit
+  std::vector<http::response> responses;
+  std::string req("GET /header HTTP/1.1\r\nX-Large: " + std::string(40 * 1024, 'x'));
+  for (std::size_t pos = 0; pos < req.size(); pos += 8 * 1024) {
+    const auto part = req.substr(pos, 8 * 1024);
+    UNIT_ASSERT_EQUAL(part.size(), (size_t)client.send(buffer_view(part)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  req = "\r\n\r\n";
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  receive_responses(client, 1, responses);
+  UNIT_ASSERT_EQUAL(1UL, responses.size());
+  UNIT_ASSERT_EQUAL(http::http::OK, responses[0].status());
+  UNIT_ASSERT_EQUAL(std::to_string(40 * 1024), responses[0].body());
+
+  // a header never finished is rejected
+  // as soon as it exceeds the limit
+  req = "GET /header HTTP/1.1\r\nX-Large: " + std::string(64 * 1024, 'x');
+  UNIT_ASSERT_EQUAL(req.size(), (size_t)client.send(buffer_view(req)));
+  receive_responses(client, 2, responses);
+  UNIT_ASSERT_EQUAL(2UL, responses.size());
+  UNIT_ASSERT_EQUAL(http::http::REQUEST_HEADER_FIELDS_TOO_LARGE, responses[1].status());
+  buffer result;
+  UNIT_ASSERT_TRUE(client.receive(result) <= 0);
+  client.close();
+
+  s.shutdown();
+}
+
 void HttpServerTest::send_request(unsigned int port, const http::request &request, http::response &response)
 {
   tcp::socket client;
@@ -23,6 +23,12 @@ public:
   void test_post();
   void test_put();
   void test_delete();
+  void test_static_file();
+  void test_keep_alive();
+  void test_empty_body();
+  void test_chunked();
+  void test_request_body();
+  void test_header_size();
 
 private:
   void send_request(unsigned int port, const matador::http::request &request, matador::http::response &response);
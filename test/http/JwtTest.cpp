@@ -3,11 +3,18 @@
 #include "matador/json/json_mapper.hpp"
 
 #include "matador/http/auth/jwt_token.hpp"
+#include "matador/http/auth/jwt_verifier.hpp"
+
+#include <chrono>
+#include <ctime>
+#include <thread>
 
 JwtTest::JwtTest()
   : matador::unit_test("jwt", "jwt test")
 {
   add_test("token", [this]() { test_jwt_token(); }, "jwt token test");
+  add_test("verify", [this]() { test_verify(); }, "jwt verify test");
+  add_test("verify_cache", [this]() { test_verify_cache(); }, "jwt verify cache test");
 }
 
 using namespace matador::http::auth;
@@ -38,3 +45,104 @@ void JwtTest::test_jwt_token()
   UNIT_ASSERT_EQUAL( p.subject, parsed_jwt_payload.subject );
   UNIT_ASSERT_EQUAL( p.name, parsed_jwt_payload.name );
 }
+
+void JwtTest::test_verify()
+{
+  jwt_verifier verifier("your-256-bit-secret");
+
+  // example token of jwt.io
+  const std::string external {
+    "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9."
+    "eyJzdWIiOiIxMjM0NTY3ODkwIiwibmFtZSI6IkpvaG4gRG9lIiwiaWF0IjoxNTE2MjM5MDIyfQ."
+    "SflKxwRJSMeKKF2QT4fwpMeJf36POk6yJV_adQssw5c"
+  };
+
+  jwt_token token;
+  UNIT_ASSERT_TRUE(verifier.verify(external, token));
+  UNIT_ASSERT_EQUAL("HS256", token.header.algorithm);
+  UNIT_ASSERT_EQUAL("1234567890", token.payload.subject);
+  UNIT_ASSERT_EQUAL("John Doe", token.payload.name);
+  UNIT_ASSERT_EQUAL(1516239022L, static_cast<long>(token.payload.issued_at.get_time_info().seconds_since_epoch));
+
+  jwt_verifier other("other secret");
+  UNIT_ASSERT_FALSE(other.verify(external));
+
+  auto tampered = external;
+  tampered[40] = tampered[40] == 'x' ? 'y' : 'x';
+  UNIT_ASSERT_FALSE(verifier.verify(tampered));
+  UNIT_ASSERT_FALSE(verifier.verify("abc"));
+  UNIT_ASSERT_FALSE(verifier.verify("a.b.c.d"));
+
+  jwt_token t;
+  t.payload.issuer = "www.example.com";
+  t.payload.subject = "123456789";
+  t.payload.expiration_time = matador::time(std::time(nullptr) + 3600);
+
+  auto encoded = verifier.encode(t);
+
+  jwt_token decoded;
+  UNIT_ASSERT_TRUE(verifier.verify(encoded, decoded));
+  UNIT_ASSERT_EQUAL("JWT", decoded.header.type);
+  UNIT_ASSERT_EQUAL(t.payload.issuer, decoded.payload.issuer);
+  UNIT_ASSERT_EQUAL(t.payload.subject, decoded.payload.subject);
+  UNIT_ASSERT_EQUAL(t.payload.expiration_time.get_time_info().seconds_since_epoch, decoded.payload.expiration_time.get_time_info().seconds_since_epoch);
+
+  t.payload.expiration_time = matador::time(std::time(nullptr) - 10);
+  UNIT_ASSERT_FALSE(verifier.verify(verifier.encode(t)));
+
+  t.payload.expiration_time = matador::time(0);
+  t.payload.not_before = matador::time(std::time(nullptr) + 3600);
+  UNIT_ASSERT_FALSE(verifier.verify(verifier.encode(t)));
+}
+
+void JwtTest::test_verify_cache()
+{
+  jwt_verifier verifier("secret", 2);
+
+  UNIT_ASSERT_EQUAL(2UL, verifier.cache_size());
+  UNIT_ASSERT_EQUAL(0UL, verifier.size());
+
+  jwt_token t;
+  t.payload.subject = "first";
+  t.payload.expiration_time = matador::time(std::time(nullptr) + 3600);
+  const auto first = verifier.encode(t);
+  t.payload.subject = "second";
+  const auto second = verifier.encode(t);
+  t.payload.subject = "third";
+  const auto third = verifier.encode(t);
+
+  jwt_token result;
+  UNIT_ASSERT_TRUE(verifier.verify(first, result));
+  UNIT_ASSERT_EQUAL(1UL, verifier.size());
+  UNIT_ASSERT_TRUE(verifier.verify(first, result));
+  UNIT_ASSERT_EQUAL("first", result.payload.subject);
+  UNIT_ASSERT_EQUAL(1UL, verifier.size());
+
+  UNIT_ASSERT_TRUE(verifier.verify(second, result));
+  UNIT_ASSERT_TRUE(verifier.verify(third, result));
+  UNIT_ASSERT_EQUAL(2UL, verifier.size());
+  UNIT_ASSERT_EQUAL("third", result.payload.subject);
+
+  // least recently used token was removed, it's verified again
+  UNIT_ASSERT_TRUE(verifier.verify(first, result));
+  UNIT_ASSERT_EQUAL("first", result.payload.subject);
+  UNIT_ASSERT_EQUAL(2UL, verifier.size());
+
+  // a cached token with a modified signature isn't taken from the cache
+  auto modified = first;
+  modified.back() = modified.back() == 'A' ? 'B' : 'A';
+  UNIT_ASSERT_FALSE(verifier.verify(modified));
+
+  // tokens expire in the cache as well
+  t.payload.subject = "short";
+  t.payload.expiration_time = matador::time(std::time(nullptr) + 1);
+  const auto short_lived = verifier.encode(t);
+  UNIT_ASSERT_TRUE(verifier.verify(short_lived));
+  UNIT_ASSERT_EQUAL(2UL, verifier.size());
+  std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+  UNIT_ASSERT_FALSE(verifier.verify(short_lived));
+  UNIT_ASSERT_EQUAL(1UL, verifier.size());
+
+  verifier.clear();
+  UNIT_ASSERT_EQUAL(0UL, verifier.size());
+}
@@ -9,6 +9,8 @@ public:
   JwtTest();
 
   void test_jwt_token();
+  void test_verify();
+  void test_verify_cache();
 };
 
 
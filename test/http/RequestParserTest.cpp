@@ -4,8 +4,13 @@
 #include "matador/http/request_parser.hpp"
 #include "matador/http/request_header.hpp"
 #include "matador/http/request.hpp"
+#include "matador/http/request_view.hpp"
 #include "matador/http/mime_types.hpp"
 
+#include "matador/http/detail/request_scanner.hpp"
+
+#include <vector>
+
 using namespace matador::http;
 
 RequestParserTest::RequestParserTest()
@@ -20,6 +25,15 @@ RequestParserTest::RequestParserTest()
   add_test("post_xml", [this] { test_xml_post_request(); }, "parse post xml request");
   add_test("post_xml_partial", [this] { test_xml_post_partial_request(); }, "parse post xml partial request");
   add_test("post_xml_partial_2", [this] { test_xml_post_partial_request_2(); }, "parse post xml partial request 2");
+  add_test("pipelined", [this] { test_pipelined_requests(); }, "parse pipelined requests");
+  add_test("view_get", [this] { test_view_get_request(); }, "parse get request into view");
+  add_test("view_post", [this] { test_view_post_request(); }, "parse post request into view");
+  add_test("view_partial", [this] { test_view_partial_request(); }, "parse partial request into view");
+  add_test("view_pipelined", [this] { test_view_pipelined_requests(); }, "parse pipelined requests into view");
+  add_test("view_invalid", [this] { test_view_invalid_request(); }, "parse invalid requests into view");
+  add_test("scan_levels", [this] { test_scan_levels(); }, "compare vectorized and scalar request scanning");
+  add_test("view_header", [this] { test_view_header(); }, "parse only the header of a request into view");
+  add_test("chunked_body", [this] { test_chunked_body(); }, "decode chunked request body");
 }
 
 void RequestParserTest::test_reset_request_parser()
@@ -238,3 +252,292 @@ void RequestParserTest::test_xml_post_partial_request_2()
   UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse(RequestData::POST_PARTIAL_END_2, req));
   UNIT_ASSERT_EQUAL(expected_content_length, req.body().size());
 }
+
+void RequestParserTest::test_pipelined_requests()
+{
+  std::string first(RequestData::POST_QUERY_BODY);
+  std::string second("GET /second HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  std::string msg = first + second;
+
+  request_parser parser;
+  request req;
+
+  UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse(msg, req));
+  UNIT_ASSERT_EQUAL("home=Cosby&favorite+flavor=flies", req.body());
+  UNIT_ASSERT_EQUAL(first.size(), parser.consumed());
+
+  msg.erase(0, parser.consumed());
+  parser.reset();
+  req = request();
+
+  UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse(msg, req));
+  UNIT_ASSERT_EQUAL(http::GET, req.method());
+  UNIT_ASSERT_EQUAL("/second", req.url());
+  UNIT_ASSERT_EQUAL(second.size(), parser.consumed());
+}
+
+void RequestParserTest::test_view_get_request()
+{
+  std::string msg(RequestData::GET_COMMON_QUERY);
+  request_parser parser;
+  request_view view;
+
+  UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse_view(msg.data(), msg.size(), view));
+  UNIT_ASSERT_EQUAL(msg.size(), parser.consumed());
+  UNIT_ASSERT_EQUAL(http::GET, view.method());
+  UNIT_ASSERT_EQUAL("/api", view.url());
+  UNIT_ASSERT_EQUAL("field=a%3D%3D3%26%26c%3C%3D9&orderby=name", view.query());
+  UNIT_ASSERT_EQUAL("fragment", view.fragment());
+  UNIT_ASSERT_EQUAL(1, view.version().major);
+  UNIT_ASSERT_EQUAL(1, view.version().minor);
+  UNIT_ASSERT_EQUAL(4UL, view.headers().size());
+  UNIT_ASSERT_EQUAL("de.wikipedia.org", view.header(request_view::HOST));
+  UNIT_ASSERT_EQUAL("application/x-www-form-urlencoded", view.header(request_view::CONTENT_TYPE));
+  UNIT_ASSERT_TRUE(view.header(request_view::CONNECTION).empty());
+  UNIT_ASSERT_EQUAL("HTTPTool/1.0", view.header("user-agent"));
+  UNIT_ASSERT_TRUE(view.body().empty());
+
+  // the view references the parsed buffer
+  UNIT_ASSERT_TRUE(view.url().data() >= msg.data() && view.url().data() < msg.data() + msg.size());
+
+  auto req = view.to_request();
+  UNIT_ASSERT_EQUAL(http::GET, req.method());
+  UNIT_ASSERT_EQUAL("/api", req.url());
+  UNIT_ASSERT_EQUAL(2UL, req.query_params().size());
+  UNIT_ASSERT_EQUAL("a==3&&c<=9", req.query_params().at("field"));
+  UNIT_ASSERT_EQUAL("name", req.query_params().at("orderby"));
+  UNIT_ASSERT_EQUAL("fragment", req.fragment());
+  UNIT_ASSERT_EQUAL("de.wikipedia.org", req.host());
+  UNIT_ASSERT_EQUAL("frog@jmarshall.com", req.headers().at(request_header::FROM));
+}
+
+void RequestParserTest::test_view_post_request()
+{
+  std::string msg(RequestData::POST_XML_BODY);
+  request_parser parser;
+  request_view view;
+
+  UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse_view(msg.data(), msg.size(), view));
+  UNIT_ASSERT_EQUAL(http::POST, view.method());
+  UNIT_ASSERT_EQUAL(6UL, view.headers().size());
+  UNIT_ASSERT_EQUAL("Basic XXX", view.header(request_header::AUTHORIZATION));
+  UNIT_ASSERT_EQUAL("254", view.header(request_view::CONTENT_LENGTH));
+  UNIT_ASSERT_EQUAL(254UL, view.content_length());
+  UNIT_ASSERT_EQUAL(254UL, view.body().size());
+
+  // folded header value is unfolded in the owned request
+  auto req = view.to_request();
+  UNIT_ASSERT_EQUAL("application/vnd.bonfire+xml;charset=utf-8", req.content().type);
+  UNIT_ASSERT_EQUAL("254", req.content().length);
+  UNIT_ASSERT_EQUAL(254UL, req.body().size());
+
+  msg = RequestData::POST_FORM_DATA;
+  parser.reset();
+  UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse_view(msg.data(), msg.size(), view));
+  req = view.to_request();
+  UNIT_ASSERT_EQUAL(2UL, req.form_data().size());
+  UNIT_ASSERT_EQUAL("carl", req.form_data().at("username"));
+  UNIT_ASSERT_EQUAL("secret123", req.form_data().at("password"));
+}
+
+void RequestParserTest::test_view_partial_request()
+{
+  std::string msg(RequestData::POST_PARTIAL_BEGIN_2);
+  request_parser parser;
+  request_view view;
+
+  UNIT_ASSERT_EQUAL(request_parser::PARTIAL, parser.parse_view(msg.data(), msg.size(), view));
+  UNIT_ASSERT_EQUAL(0UL, parser.consumed());
+
+  // header is complete, body is missing
+  msg += RequestData::POST_PARTIAL_MIDDLE_2;
+  UNIT_ASSERT_EQUAL(request_parser::PARTIAL, parser.parse_view(msg.data(), msg.size(), view));
+
+  msg += RequestData::POST_PARTIAL_END_2;
+  UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse_view(msg.data(), msg.size(), view));
+  UNIT_ASSERT_EQUAL(msg.size(), parser.consumed());
+  UNIT_ASSERT_EQUAL("*/*", view.header("Accept"));
+  UNIT_ASSERT_EQUAL(254UL, view.body().size());
+}
+
+void RequestParserTest::test_view_pipelined_requests()
+{
+  std::string first(RequestData::POST_QUERY_BODY);
+  std::string second("GET /second HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+  std::string msg = first + second;
+
+  request_parser parser;
+  request_view view;
+
+  UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse_view(msg.data(), msg.size(), view));
+  UNIT_ASSERT_EQUAL(first.size(), parser.consumed());
+  UNIT_ASSERT_EQUAL("home=Cosby&favorite+flavor=flies", view.body());
+
+  auto offset = parser.consumed();
+  parser.reset();
+  UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse_view(msg.data() + offset, msg.size() - offset, view));
+  UNIT_ASSERT_EQUAL(second.size(), parser.consumed());
+  UNIT_ASSERT_EQUAL("/second", view.url());
+  UNIT_ASSERT_EQUAL(0, view.version().minor);
+  UNIT_ASSERT_EQUAL("keep-alive", view.header(request_view::CONNECTION));
+  UNIT_ASSERT_TRUE(view.header(request_view::CONTENT_LENGTH).empty());
+}
+
+void RequestParserTest::test_view_invalid_request()
+{
+  const char *invalid[] = {
+    "get /api HTTP/1.1\r\n\r\n",
+    "GET /a pi HTTP/1.1\r\n\r\n",
+    "GET /api HTTX/1.1\r\n\r\n",
+    "GET /api HTTP/1.1\r\nHost de.wikipedia.org\r\n\r\n",
+    "POST /api HTTP/1.1\r\nContent-Length: 12a\r\n\r\n"
+  };
+
+  for (auto msg : invalid) {
+    request_parser parser;
+    request_view view;
+    UNIT_ASSERT_EQUAL(request_parser::INVALID, parser.parse_view(msg, strlen(msg), view));
+  }
+}
+
+void RequestParserTest::test_scan_levels()
+{
+  using namespace matador::http::detail;
+
+  const auto initial_level = current_scan_level();
+  std::vector<scan_level> levels { scan_level::SCALAR };
+  if (supported_scan_level() != scan_level::SCALAR) {
+    levels.push_back(scan_level::SSE42);
+  }
+  if (supported_scan_level() == scan_level::AVX2) {
+    levels.push_back(scan_level::AVX2);
+  }
+
+  typedef const char* (*t_find_func)(const char*, const char*);
+  const t_find_func finders[] = { find_non_url_char, find_non_token_char, find_non_value_char };
+
+  // every byte value at every position of a buffer longer than
+  // two vectors must be found at the same position as by the
+  // scalar scan
+  std::string buffer(70, 'a');
+  for (int c = 0; c < 256; ++c) {
+    for (std::size_t pos = 0; pos < buffer.size(); ++pos) {
+      buffer.assign(70, 'a');
+      buffer[pos] = static_cast<char>(c);
+      const char *begin = buffer.data();
+      const char *end = begin + buffer.size();
+      for (auto find : finders) {
+        UNIT_ASSERT_TRUE(use_scan_level(scan_level::SCALAR));
+        auto expected = find(begin, end);
+        for (auto level : levels) {
+          UNIT_ASSERT_TRUE(use_scan_level(level));
+          UNIT_ASSERT_TRUE(expected == find(begin, end));
+        }
+      }
+    }
+  }
+
+  // header end at every position, with and without
+  // preceding line ends
+  for (std::size_t pos = 0; pos + 4 <= 80; ++pos) {
+    std::string msg(80, 'x');
+    msg.replace(pos, 4, "\r\n\r\n");
+    if (pos > 2) {
+      msg.replace(pos - 3, 2, "\r\n");
+    }
+    for (auto level : levels) {
+      UNIT_ASSERT_TRUE(use_scan_level(level));
+      UNIT_ASSERT_TRUE(msg.data() + pos == find_header_end(msg.data(), msg.data() + msg.size()));
+      UNIT_ASSERT_TRUE(nullptr == find_header_end(msg.data(), msg.data() + pos + 3));
+    }
+  }
+
+  // both parsers return the same result on all levels
+  for (auto level : levels) {
+    UNIT_ASSERT_TRUE(use_scan_level(level));
+    request_parser parser;
+    request req;
+    UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse(RequestData::POST_XML_BODY, req));
+    UNIT_ASSERT_EQUAL("/experiments", req.url());
+    UNIT_ASSERT_EQUAL("Basic XXX", req.headers().at(request_header::AUTHORIZATION));
+    UNIT_ASSERT_EQUAL("gzip, deflate", req.headers().at(request_header::ACCEPT_ENCODING));
+    UNIT_ASSERT_EQUAL("application/vnd.bonfire+xml;charset=utf-8", req.content().type);
+
+    std::string msg(RequestData::GET_COMMON_QUERY);
+    request_view view;
+    parser.reset();
+    UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse_view(msg.data(), msg.size(), view));
+    UNIT_ASSERT_EQUAL("/api", view.url());
+    UNIT_ASSERT_EQUAL("HTTPTool/1.0", view.header(request_header::USER_AGENT));
+  }
+
+  use_scan_level(initial_level);
+}
+
+void RequestParserTest::test_view_header()
+{
+  std::string msg(RequestData::POST_PARTIAL_BEGIN_2);
+  msg += RequestData::POST_PARTIAL_MIDDLE_2;
+  request_parser parser;
+  request_view view;
+
+  // the body isn't needed to finish the header
+  UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse_view_header(msg.data(), msg.size(), view));
+  UNIT_ASSERT_EQUAL(254UL, view.content_length());
+  UNIT_ASSERT_TRUE(view.body().empty());
+  UNIT_ASSERT_EQUAL(msg.find("\r\n\r\n") + 4, parser.consumed());
+
+  parser.reset();
+  msg = "POST /upload HTTP/1.1\r\nContent-Length: 12x\r\n\r\n";
+  UNIT_ASSERT_EQUAL(request_parser::INVALID, parser.parse_view_header(msg.data(), msg.size(), view));
+
+  parser.reset();
+  msg = "POST /upload HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\n\r\n";
+  UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse_view_header(msg.data(), msg.size(), view));
+  UNIT_ASSERT_EQUAL("gzip, chunked", view.header(request_view::TRANSFER_ENCODING));
+}
+
+void RequestParserTest::test_chunked_body()
+{
+  const std::string msg("5;name=value\r\nhello\r\n7\r\n, world\r\n0\r\nExpires: never\r\n\r\nGET / HTTP/1.1");
+  const std::size_t body_size = msg.find("GET");
+
+  request_parser parser;
+  std::string body;
+  auto append = [&body](const char *data, std::size_t size) {
+    body.append(data, size);
+    return true;
+  };
+
+  UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse_chunked_body(msg.data(), msg.size(), append));
+  UNIT_ASSERT_EQUAL("hello, world", body);
+  UNIT_ASSERT_EQUAL(body_size, parser.consumed());
+
+  // every split of the body gives the same result
+  for (std::size_t split = 1; split < body_size; ++split) {
+    body.clear();
+    UNIT_ASSERT_EQUAL(request_parser::PARTIAL, parser.parse_chunked_body(msg.data(), split, append));
+    UNIT_ASSERT_EQUAL(split, parser.consumed());
+    UNIT_ASSERT_EQUAL(request_parser::FINISH, parser.parse_chunked_body(msg.data() + split, msg.size() - split, append));
+    UNIT_ASSERT_EQUAL(body_size - split, parser.consumed());
+    UNIT_ASSERT_EQUAL("hello, world", body);
+  }
+
+  parser.reset();
+  std::string invalid("5\r\nhello!\r\n0\r\n\r\n");
+  UNIT_ASSERT_EQUAL(request_parser::INVALID, parser.parse_chunked_body(invalid.data(), invalid.size(), append));
+
+  parser.reset();
+  invalid = "x\r\n";
+  UNIT_ASSERT_EQUAL(request_parser::INVALID, parser.parse_chunked_body(invalid.data(), invalid.size(), append));
+
+  parser.reset();
+  invalid = "fffffffffffffffff\r\n";
+  UNIT_ASSERT_EQUAL(request_parser::INVALID, parser.parse_chunked_body(invalid.data(), invalid.size(), append));
+
+  // the consumer rejects the body
+  parser.reset();
+  UNIT_ASSERT_EQUAL(request_parser::INVALID, parser.parse_chunked_body(msg.data(), msg.size(), [](const char*, std::size_t) {
+    return false;
+  }));
+}
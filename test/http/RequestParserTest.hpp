@@ -17,6 +17,15 @@ public:
   void test_xml_post_request();
   void test_xml_post_partial_request();
   void test_xml_post_partial_request_2();
+  void test_pipelined_requests();
+  void test_view_get_request();
+  void test_view_post_request();
+  void test_view_partial_request();
+  void test_view_pipelined_requests();
+  void test_view_invalid_request();
+  void test_scan_levels();
+  void test_view_header();
+  void test_chunked_body();
 };
 
 
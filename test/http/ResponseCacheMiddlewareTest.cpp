@@ -0,0 +1,373 @@
+#include "ResponseCacheMiddlewareTest.hpp"
+
+#include "matador/http/middleware/response_cache_middleware.hpp"
+#include "matador/http/request.hpp"
+#include "matador/http/request_header.hpp"
+#include "matador/http/request_parser.hpp"
+#include "matador/http/response_header.hpp"
+#include "matador/http/mime_types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace matador;
+using namespace matador::http;
+using namespace matador::http::middlewares;
+
+namespace {
+
+/*
+ * Answers each request with a new body containing
+ * the number of handled requests
+ */
+class counting_middleware : public middleware
+{
+public:
+  using t_response_func = std::function<response(int)>;
+
+  explicit counting_middleware(t_response_func func = nullptr, std::chrono::milliseconds delay = std::chrono::milliseconds(0))
+    : func_(std::move(func))
+    , delay_(delay)
+  {}
+
+  response process(request &, const next_func_t &) override
+  {
+    const auto count = ++count_;
+    if (delay_.count() > 0) {
+      std::this_thread::sleep_for(delay_);
+    }
+    if (func_) {
+      return func_(count);
+    }
+    return response::ok("response " + std::to_string(count), mime_types::TYPE_TEXT_PLAIN);
+  }
+
+  int count() const { return count_; }
+
+private:
+  std::atomic_int count_ { 0 };
+  t_response_func func_;
+  std::chrono::milliseconds delay_;
+};
+
+request create_request(const std::string &url)
+{
+  request req;
+  request_parser parser;
+  parser.parse("GET " + url + " HTTP/1.1\r\nHost: localhost\r\n\r\n", req);
+  return req;
+}
+
+}
+
+ResponseCacheMiddlewareTest::ResponseCacheMiddlewareTest()
+  : matador::unit_test("response_cache", "response cache middleware test")
+{
+  add_test("cache", [this] { test_cache(); }, "response cache middleware cache test");
+  add_test("key", [this] { test_key(); }, "response cache middleware key test");
+  add_test("ttl", [this] { test_ttl(); }, "response cache middleware time to live test");
+  add_test("not_modified", [this] { test_not_modified(); }, "response cache middleware not modified test");
+  add_test("eviction", [this] { test_eviction(); }, "response cache middleware eviction test");
+  add_test("coalescing", [this] { test_coalescing(); }, "response cache middleware request coalescing test");
+  add_test("uncacheable", [this] { test_uncacheable(); }, "response cache middleware uncacheable response test");
+}
+
+void ResponseCacheMiddlewareTest::test_cache()
+{
+  auto handler = std::make_shared<counting_middleware>();
+  auto cache = std::make_shared<response_cache_middleware>();
+
+  middleware_pipeline mp;
+  mp.add(handler);
+  mp.add(cache);
+
+  auto req = create_request("/items");
+  auto first = mp.process(req);
+  auto second = mp.process(req);
+
+  UNIT_ASSERT_EQUAL(1, handler->count());
+  UNIT_ASSERT_EQUAL(http::http::OK, second.status());
+  UNIT_ASSERT_EQUAL("response 1", first.body());
+  UNIT_ASSERT_EQUAL("response 1", second.body());
+  UNIT_ASSERT_EQUAL(mime_types::TEXT_PLAIN, second.content().type);
+
+  // the body is shared, not copied
+  UNIT_ASSERT_TRUE(second.shared_body() != nullptr);
+  UNIT_ASSERT_TRUE(first.shared_body() == second.shared_body());
+
+  UNIT_ASSERT_EQUAL(response_cache_middleware::etag("response 1"), second.headers().at(response_header::ETAG));
+  UNIT_ASSERT_EQUAL(1UL, cache->count());
+  UNIT_ASSERT_TRUE(cache->size() > 0);
+
+  // other methods aren't cached
+  request post(http::http::POST, "localhost", "/items");
+  mp.process(post);
+  UNIT_ASSERT_EQUAL(2, handler->count());
+
+  cache->invalidate("/items");
+  UNIT_ASSERT_EQUAL(0UL, cache->count());
+  UNIT_ASSERT_EQUAL(0UL, cache->size());
+  UNIT_ASSERT_EQUAL("response 3", mp.process(req).body());
+}
+
+void ResponseCacheMiddlewareTest::test_key()
+{
+  auto handler = std::make_shared<counting_middleware>();
+  auto cache = std::make_shared<response_cache_middleware>();
+  cache->vary(request_header::ACCEPT_LANGUAGE);
+
+  middleware_pipeline mp;
+  mp.add(handler);
+  mp.add(cache);
+
+  // the order of the query parameters doesn't matter
+  auto req1 = create_request("/items?a=1&b=2");
+  auto req2 = create_request("/items?b=2&a=1");
+  auto req3 = create_request("/items?a=2");
+  UNIT_ASSERT_EQUAL("response 1", mp.process(req1).body());
+  UNIT_ASSERT_EQUAL("response 1", mp.process(req2).body());
+  UNIT_ASSERT_EQUAL("response 2", mp.process(req3).body());
+
+  // vary headers are part of the key
+  auto en = create_request("/page");
+  en.add_header(request_header::ACCEPT_LANGUAGE, "en");
+  auto de = create_request("/page");
+  de.add_header(request_header::ACCEPT_LANGUAGE, "de");
+  UNIT_ASSERT_EQUAL("response 3", mp.process(en).body());
+  UNIT_ASSERT_EQUAL("response 4", mp.process(de).body());
+  UNIT_ASSERT_EQUAL("response 3", mp.process(en).body());
+  UNIT_ASSERT_EQUAL("response 4", mp.process(de).body());
+
+  // authorized requests bypass the cache
+  auto auth = create_request("/items?a=1&b=2");
+  auth.add_header(request_header::AUTHORIZATION, "Bearer abc");
+  UNIT_ASSERT_EQUAL("response 5", mp.process(auth).body());
+  UNIT_ASSERT_EQUAL("response 6", mp.process(auth).body());
+  UNIT_ASSERT_EQUAL(4, static_cast<int>(cache->count()));
+}
+
+void ResponseCacheMiddlewareTest::test_ttl()
+{
+  auto handler = std::make_shared<counting_middleware>();
+  auto cache = std::make_shared<response_cache_middleware>(std::chrono::minutes(5));
+  cache->ttl("/live", std::chrono::milliseconds(0));
+  cache->ttl("/short/*", std::chrono::milliseconds(100));
+
+  UNIT_ASSERT_TRUE(cache->ttl("/items") == std::chrono::minutes(5));
+  UNIT_ASSERT_TRUE(cache->ttl("/live") == std::chrono::milliseconds(0));
+  UNIT_ASSERT_TRUE(cache->ttl("/short/items") == std::chrono::milliseconds(100));
+
+  middleware_pipeline mp;
+  mp.add(handler);
+  mp.add(cache);
+
+  auto live = create_request("/live");
+  UNIT_ASSERT_EQUAL("response 1", mp.process(live).body());
+  UNIT_ASSERT_EQUAL("response 2", mp.process(live).body());
+
+  auto short_lived = create_request("/short/items");
+  UNIT_ASSERT_EQUAL("response 3", mp.process(short_lived).body());
+  UNIT_ASSERT_EQUAL("response 3", mp.process(short_lived).body());
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  UNIT_ASSERT_EQUAL("response 4", mp.process(short_lived).body());
+  UNIT_ASSERT_EQUAL(1UL, cache->count());
+
+  // no-cache replaces the cached response
+  short_lived.add_header(request_header::CACHE_CONTROL, "no-cache");
+  UNIT_ASSERT_EQUAL("response 5", mp.process(short_lived).body());
+  auto cached = create_request("/short/items");
+  UNIT_ASSERT_EQUAL("response 5", mp.process(cached).body());
+  UNIT_ASSERT_EQUAL(1UL, cache->count());
+}
+
+void ResponseCacheMiddlewareTest::test_not_modified()
+{
+  auto handler = std::make_shared<counting_middleware>();
+  auto cache = std::make_shared<response_cache_middleware>();
+
+  middleware_pipeline mp;
+  mp.add(handler);
+  mp.add(cache);
+
+  auto req = create_request("/items");
+  auto resp = mp.process(req);
+  const auto etag = resp.headers().at(response_header::ETAG);
+
+  auto conditional = create_request("/items");
+  conditional.add_header(request_header::IF_NONE_MATCH, "\"other\", W/" + etag);
+  resp = mp.process(conditional);
+  UNIT_ASSERT_EQUAL(http::http::NOT_MODIFIED, resp.status());
+  UNIT_ASSERT_EQUAL(etag, resp.headers().at(response_header::ETAG));
+  UNIT_ASSERT_TRUE(resp.body().empty());
+  UNIT_ASSERT_EQUAL(1, handler->count());
+
+  // a stale tag gets the full response
+  auto stale = create_request("/items");
+  stale.add_header(request_header::IF_NONE_MATCH, "\"other\"");
+  resp = mp.process(stale);
+  UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+  UNIT_ASSERT_EQUAL("response 1", resp.body());
+
+  // a miss is answered with 304 as well
+  cache->clear();
+  conditional = create_request("/items");
+  conditional.add_header(request_header::IF_NONE_MATCH, response_cache_middleware::etag("response 2"));
+  resp = mp.process(conditional);
+  UNIT_ASSERT_EQUAL(http::http::NOT_MODIFIED, resp.status());
+  UNIT_ASSERT_EQUAL(2, handler->count());
+}
+
+void ResponseCacheMiddlewareTest::test_eviction()
+{
+  const std::string body(1000, 'x');
+  auto handler = std::make_shared<counting_middleware>([&body](int count) {
+    return response::ok(body + std::to_string(count), mime_types::TYPE_TEXT_PLAIN);
+  });
+  auto cache = std::make_shared<response_cache_middleware>(std::chrono::minutes(1), 3500);
+
+  middleware_pipeline mp;
+  mp.add(handler);
+  mp.add(cache);
+
+  auto a = create_request("/a");
+  auto b = create_request("/b");
+  auto c = create_request("/c");
+  auto d = create_request("/d");
+  mp.process(a);
+  mp.process(b);
+  mp.process(c);
+  UNIT_ASSERT_EQUAL(3UL, cache->count());
+  UNIT_ASSERT_TRUE(cache->size() <= cache->max_size());
+
+  // a was used recently, b is evicted
+  mp.process(a);
+  mp.process(d);
+  UNIT_ASSERT_EQUAL(4, handler->count());
+  UNIT_ASSERT_EQUAL(3UL, cache->count());
+  mp.process(a);
+  mp.process(c);
+  UNIT_ASSERT_EQUAL(4, handler->count());
+  mp.process(b);
+  UNIT_ASSERT_EQUAL(5, handler->count());
+
+  // a response larger than the cache isn't cached
+  cache->max_size(500);
+  UNIT_ASSERT_EQUAL(0UL, cache->count());
+  mp.process(a);
+  mp.process(a);
+  UNIT_ASSERT_EQUAL(7, handler->count());
+  UNIT_ASSERT_EQUAL(0UL, cache->size());
+}
+
+void ResponseCacheMiddlewareTest::test_coalescing()
+{
+  auto handler = std::make_shared<counting_middleware>(nullptr, std::chrono::milliseconds(200));
+  auto cache = std::make_shared<response_cache_middleware>();
+
+  middleware_pipeline mp;
+  mp.add(handler);
+  mp.add(cache);
+
+  std::vector<std::thread> threads;
+  std::vector<std::string> bodies(8);
+  for (std::size_t i = 0; i < bodies.size(); ++i) {
+    threads.emplace_back([&mp, &bodies, i]() {
+      auto req = create_request("/slow");
+      bodies[i] = mp.process(req).body();
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  UNIT_ASSERT_EQUAL(1, handler->count());
+  for (const auto &body : bodies) {
+    UNIT_ASSERT_EQUAL("response 1", body);
+  }
+
+  // uncacheable responses aren't shared
+  auto private_handler = std::make_shared<counting_middleware>([](int count) {
+    auto resp = response::ok("private " + std::to_string(count), mime_types::TYPE_TEXT_PLAIN);
+    resp.add_header(response_header::CACHE_CONTROL, "private");
+    return resp;
+  }, std::chrono::milliseconds(100));
+
+  middleware_pipeline private_mp;
+  private_mp.add(private_handler);
+  private_mp.add(std::make_shared<response_cache_middleware>());
+
+  threads.clear();
+  for (std::size_t i = 0; i < 4; ++i) {
+    threads.emplace_back([&private_mp]() {
+      auto req = create_request("/private");
+      private_mp.process(req);
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  UNIT_ASSERT_EQUAL(4, private_handler->count());
+}
+
+void ResponseCacheMiddlewareTest::test_uncacheable()
+{
+  std::function<response(int)> func;
+  auto handler = std::make_shared<counting_middleware>([&func](int count) { return func(count); });
+  auto cache = std::make_shared<response_cache_middleware>();
+
+  middleware_pipeline mp;
+  mp.add(handler);
+  mp.add(cache);
+
+  auto req = create_request("/items");
+
+  func = [](int) { return response::not_found(); };
+  mp.process(req);
+  mp.process(req);
+  UNIT_ASSERT_EQUAL(2, handler->count());
+
+  func = [](int count) {
+    auto resp = response::ok("no store " + std::to_string(count), mime_types::TYPE_TEXT_PLAIN);
+    resp.add_header(response_header::CACHE_CONTROL, "no-store");
+    return resp;
+  };
+  mp.process(req);
+  mp.process(req);
+  UNIT_ASSERT_EQUAL(4, handler->count());
+
+  func = [](int count) {
+    auto resp = response::ok("cookie " + std::to_string(count), mime_types::TYPE_TEXT_PLAIN);
+    resp.add_header(response_header::SET_COOKIE, "session=1");
+    return resp;
+  };
+  mp.process(req);
+  mp.process(req);
+  UNIT_ASSERT_EQUAL(6, handler->count());
+
+  func = [](int count) {
+    response resp = response::ok("", mime_types::TYPE_TEXT_PLAIN);
+    resp.body_producer([count](std::string &chunk) {
+      chunk = "stream " + std::to_string(count);
+      return false;
+    });
+    return resp;
+  };
+  mp.process(req);
+  mp.process(req);
+  UNIT_ASSERT_EQUAL(8, handler->count());
+  UNIT_ASSERT_EQUAL(0UL, cache->count());
+
+  // a tag set by the handler is kept
+  func = [](int count) {
+    auto resp = response::ok("tagged " + std::to_string(count), mime_types::TYPE_TEXT_PLAIN);
+    resp.add_header(response_header::ETAG, "\"v1\"");
+    return resp;
+  };
+  UNIT_ASSERT_EQUAL("\"v1\"", mp.process(req).headers().at(response_header::ETAG));
+  req.add_header(request_header::IF_NONE_MATCH, "\"v1\"");
+  UNIT_ASSERT_EQUAL(http::http::NOT_MODIFIED, mp.process(req).status());
+  UNIT_ASSERT_EQUAL(9, handler->count());
+}
@@ -0,0 +1,21 @@
+#ifndef MATADOR_RESPONSECACHEMIDDLEWARETEST_HPP
+#define MATADOR_RESPONSECACHEMIDDLEWARETEST_HPP
+
+#include "matador/unit/unit_test.hpp"
+
+class ResponseCacheMiddlewareTest : public matador::unit_test
+{
+public:
+  ResponseCacheMiddlewareTest();
+
+  void test_cache();
+  void test_key();
+  void test_ttl();
+  void test_not_modified();
+  void test_eviction();
+  void test_coalescing();
+  void test_uncacheable();
+};
+
+
+#endif //MATADOR_RESPONSECACHEMIDDLEWARETEST_HPP
@@ -16,6 +16,7 @@ ResponseParserTest::ResponseParserTest()
   add_test("empty_body", [this]() { test_empty_response(); }, "test empty body response");
   add_test("body", [this]() { test_body_response(); }, "test filled body response");
   add_test("from_file", [this]() { test_from_file_response(); }, "test from file response");
+  add_test("send_file", [this]() { test_send_file_response(); }, "test send file response");
   add_test("partial_header", [this]() { test_partial_response_header(); }, "test partial header response");
   add_test("partial_body", [this]() { test_partial_response_body(); }, "test partial body response");
   add_test("partial_body_2", [this]() { test_partial_response_body_2(); }, "test partial body response 2");
@@ -101,6 +102,33 @@ void ResponseParserTest::test_from_file_response()
   UNIT_ASSERT_FALSE(matador::os::exists(filename));
 }
 
+void ResponseParserTest::test_send_file_response()
+{
+  const std::string filename { "dummy.css" };
+
+  file f(filename, "w");
+
+  const std::string data { "body { color: red; }" };
+  ::fwrite(data.c_str(), sizeof(char), data.size(), f.stream());
+  f.close();
+
+  http::response resp = http::response::send_file(filename);
+
+  UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+  UNIT_ASSERT_TRUE(resp.body().empty());
+  UNIT_ASSERT_TRUE(resp.body_file() != nullptr);
+  UNIT_ASSERT_EQUAL(data.size(), resp.body_file()->size());
+  UNIT_ASSERT_EQUAL(std::to_string(data.size()), resp.content().length);
+  UNIT_ASSERT_EQUAL(http::mime_types::TEXT_CSS, resp.content().type);
+  UNIT_ASSERT_EQUAL(data, resp.body_file()->to_string());
+
+  matador::os::remove(filename);
+
+  resp = http::response::send_file(filename);
+  UNIT_ASSERT_EQUAL(http::http::NOT_FOUND, resp.status());
+  UNIT_ASSERT_TRUE(resp.body_file() == nullptr);
+}
+
 void ResponseParserTest::test_partial_response_header()
 {
   http::response_parser parser;
@@ -11,6 +11,9 @@ RouteEngineTest::RouteEngineTest()
   : matador::unit_test("route_engine", "route engine test")
 {
   add_test("routes", [this] { test_routes(); }, "test route engine");
+  add_test("static_files", [this] { test_static_files(); }, "test route engine static files wildcard");
+  add_test("precedence", [this] { test_precedence(); }, "test route engine match precedence");
+  add_test("many_routes", [this] { test_many_routes(); }, "test route engine with many routes");
 }
 
 http::response dummy(const http::request &)
@@ -18,6 +21,16 @@ http::response dummy(const http::request &)
   return http::response();
 }
 
+namespace {
+
+http::routing_engine::const_iterator match(const http::routing_engine &re, http::http::method_t method, const std::string &url, http::request &req)
+{
+  req = http::request(method, "localhost", url);
+  return re.match(req);
+}
+
+}
+
 void RouteEngineTest::test_routes()
 {
   http::routing_engine re;
@@ -123,3 +136,124 @@ void RouteEngineTest::test_routes()
   rep = re.match(req);
   UNIT_ASSERT_FALSE(re.valid(rep));
 }
+
+void RouteEngineTest::test_static_files()
+{
+  http::routing_engine re;
+
+  re.add("/app/*.*", http::http::GET, dummy);
+  re.add("/app/{version}/info", http::http::GET, dummy);
+
+  http::request req;
+  auto rep = match(re, http::http::GET, "/app/index.html", req);
+  UNIT_ASSERT_TRUE(re.valid(rep));
+  UNIT_ASSERT_EQUAL("/app/*.*", (*rep)->path_spec());
+
+  rep = match(re, http::http::GET, "/app/js/lib/bundle.js", req);
+  UNIT_ASSERT_TRUE(re.valid(rep));
+  UNIT_ASSERT_EQUAL("/app/*.*", (*rep)->path_spec());
+  UNIT_ASSERT_TRUE(req.path_params().empty());
+
+  rep = match(re, http::http::GET, "/app/", req);
+  UNIT_ASSERT_TRUE(re.valid(rep));
+
+  // the param route is tried before the wildcard
+  rep = match(re, http::http::GET, "/app/v2/info", req);
+  UNIT_ASSERT_TRUE(re.valid(rep));
+  UNIT_ASSERT_EQUAL("/app/{version}/info", (*rep)->path_spec());
+  UNIT_ASSERT_EQUAL("v2", req.path_params().at("version"));
+
+  // falls back to the wildcard if the param route doesn't match
+  rep = match(re, http::http::GET, "/app/v2/about", req);
+  UNIT_ASSERT_TRUE(re.valid(rep));
+  UNIT_ASSERT_EQUAL("/app/*.*", (*rep)->path_spec());
+
+  rep = match(re, http::http::GET, "/app", req);
+  UNIT_ASSERT_FALSE(re.valid(rep));
+
+  rep = match(re, http::http::POST, "/app/index.html", req);
+  UNIT_ASSERT_FALSE(re.valid(rep));
+
+  UNIT_ASSERT_EXCEPTION(re.add("/app/*.*/more", http::http::GET, dummy), std::logic_error, "static files wildcard must be the last route spec part");
+}
+
+void RouteEngineTest::test_precedence()
+{
+  http::routing_engine re;
+
+  re.add("/api/user/{id}", http::http::GET, dummy);
+  re.add("/api/user/me", http::http::GET, dummy);
+  re.add("/api/user/{id: \\d+}/roles", http::http::GET, dummy);
+  re.add("/api/user/{name}/groups", http::http::GET, dummy);
+  re.add("/api/user/{id}", http::http::DEL, dummy);
+
+  http::request req;
+  // static segment before path param
+  auto rep = match(re, http::http::GET, "/api/user/me", req);
+  UNIT_ASSERT_TRUE(re.valid(rep));
+  UNIT_ASSERT_EQUAL("/api/user/me", (*rep)->path_spec());
+  UNIT_ASSERT_TRUE(req.path_params().empty());
+
+  rep = match(re, http::http::GET, "/api/user/you", req);
+  UNIT_ASSERT_TRUE(re.valid(rep));
+  UNIT_ASSERT_EQUAL("/api/user/{id}", (*rep)->path_spec());
+  UNIT_ASSERT_EQUAL("you", req.path_params().at("id"));
+
+  // same param position with different names
+  rep = match(re, http::http::GET, "/api/user/17/roles", req);
+  UNIT_ASSERT_TRUE(re.valid(rep));
+  UNIT_ASSERT_EQUAL("17", req.path_params().at("id"));
+
+  rep = match(re, http::http::GET, "/api/user/admins/groups", req);
+  UNIT_ASSERT_TRUE(re.valid(rep));
+  UNIT_ASSERT_EQUAL(1UL, req.path_params().size());
+  UNIT_ASSERT_EQUAL("admins", req.path_params().at("name"));
+
+  rep = match(re, http::http::GET, "/api/user/admins/roles", req);
+  UNIT_ASSERT_FALSE(re.valid(rep));
+
+  // trailing slash and invalid param characters
+  rep = match(re, http::http::GET, "/api/user/", req);
+  UNIT_ASSERT_FALSE(re.valid(rep));
+  rep = match(re, http::http::GET, "/api/user/a.b", req);
+  UNIT_ASSERT_FALSE(re.valid(rep));
+
+  // routes are separated by method
+  rep = match(re, http::http::DEL, "/api/user/me", req);
+  UNIT_ASSERT_TRUE(re.valid(rep));
+  UNIT_ASSERT_EQUAL(http::http::DEL, (*rep)->method());
+  UNIT_ASSERT_EQUAL("me", req.path_params().at("id"));
+}
+
+void RouteEngineTest::test_many_routes()
+{
+  http::routing_engine re;
+
+  for (int i = 0; i < 100; ++i) {
+    const auto resource = "/api/v1/resource" + std::to_string(i);
+    re.add(resource, http::http::GET, dummy);
+    re.add(resource + "/{id}", http::http::GET, dummy);
+    re.add(resource + "/{id}/items/{item: \\d+}", http::http::PUT, dummy);
+  }
+
+  http::request req;
+  for (int i = 0; i < 100; ++i) {
+    const auto resource = "/api/v1/resource" + std::to_string(i);
+
+    auto rep = match(re, http::http::GET, resource, req);
+    UNIT_ASSERT_TRUE(re.valid(rep));
+    UNIT_ASSERT_EQUAL(resource, (*rep)->path_spec());
+
+    rep = match(re, http::http::GET, resource + "/x" + std::to_string(i), req);
+    UNIT_ASSERT_TRUE(re.valid(rep));
+    UNIT_ASSERT_EQUAL(resource + "/{id}", (*rep)->path_spec());
+    UNIT_ASSERT_EQUAL("x" + std::to_string(i), req.path_params().at("id"));
+
+    rep = match(re, http::http::PUT, resource + "/x/items/" + std::to_string(i), req);
+    UNIT_ASSERT_TRUE(re.valid(rep));
+    UNIT_ASSERT_EQUAL(std::to_string(i), req.path_params().at("item"));
+
+    rep = match(re, http::http::PUT, resource + "/x/items/y", req);
+    UNIT_ASSERT_FALSE(re.valid(rep));
+  }
+}
@@ -9,6 +9,9 @@ public:
   RouteEngineTest();
 
   void test_routes();
+  void test_static_files();
+  void test_precedence();
+  void test_many_routes();
 };
 
 
@@ -0,0 +1,282 @@
+#include "StaticFileCacheTest.hpp"
+
+#include "matador/http/static_file_cache.hpp"
+#include "matador/http/request.hpp"
+#include "matador/http/request_header.hpp"
+#include "matador/http/response_header.hpp"
+
+#include "matador/utils/file.hpp"
+#include "matador/utils/os.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace matador;
+
+namespace {
+
+void write_file(const std::string &path, const std::string &content)
+{
+  file f(path, "w");
+  ::fwrite(content.c_str(), sizeof(char), content.size(), f.stream());
+}
+
+http::request create_request(const std::string &url)
+{
+  return { http::http::GET, "localhost", url };
+}
+
+}
+
+StaticFileCacheTest::StaticFileCacheTest()
+  : matador::unit_test("static_file_cache", "static file cache test")
+{
+  add_test("serve", [this] { test_serve(); }, "static file cache serve test");
+  add_test("conditional", [this] { test_conditional(); }, "static file cache conditional request test");
+  add_test("invalidate", [this] { test_invalidate(); }, "static file cache invalidate test");
+  add_test("eviction", [this] { test_eviction(); }, "static file cache lru eviction test");
+  add_test("large_file", [this] { test_large_file(); }, "static file cache large file test");
+  add_test("concurrent", [this] { test_concurrent(); }, "static file cache concurrent load test");
+}
+
+void StaticFileCacheTest::initialize()
+{
+  os::mkdir("static_cache_test");
+}
+
+void StaticFileCacheTest::finalize()
+{
+  for (const auto &name : { "index.html", "a.txt", "b.txt", "c.txt", "large.js" }) {
+    auto path = std::string("static_cache_test/") + name;
+    if (os::exists(path)) {
+      os::remove(path);
+    }
+  }
+  os::rmdir("static_cache_test");
+}
+
+void StaticFileCacheTest::test_serve()
+{
+  write_file("static_cache_test/index.html", "<h1>hello</h1>");
+
+  http::static_file_cache cache;
+  cache.cache_control("public, max-age=60");
+
+  auto req = create_request("/index.html");
+  auto resp = cache.serve(req, "static_cache_test/index.html");
+
+  UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+  UNIT_ASSERT_EQUAL("<h1>hello</h1>", resp.body());
+  UNIT_ASSERT_EQUAL("14", resp.content().length);
+  UNIT_ASSERT_EQUAL("text/html", resp.content().type);
+  UNIT_ASSERT_TRUE(resp.body_file() == nullptr);
+  UNIT_ASSERT_EQUAL("public, max-age=60", resp.headers().at(http::response_header::CACHE_CONTROL));
+  UNIT_ASSERT_TRUE(resp.headers().count(http::response_header::LAST_MODIFIED) == 1);
+
+  const auto etag = resp.headers().at(http::response_header::ETAG);
+  UNIT_ASSERT_EQUAL('"', etag.front());
+  UNIT_ASSERT_EQUAL('"', etag.back());
+  UNIT_ASSERT_EQUAL(1UL, cache.size());
+
+  // served from the cache
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+  UNIT_ASSERT_EQUAL("<h1>hello</h1>", resp.body());
+  UNIT_ASSERT_EQUAL(etag, resp.headers().at(http::response_header::ETAG));
+  UNIT_ASSERT_EQUAL(1UL, cache.size());
+
+  resp = cache.serve(req, "static_cache_test/missing.html");
+  UNIT_ASSERT_EQUAL(http::http::NOT_FOUND, resp.status());
+  resp = cache.serve(req, "static_cache_test");
+  UNIT_ASSERT_EQUAL(http::http::NOT_FOUND, resp.status());
+  UNIT_ASSERT_EQUAL(1UL, cache.size());
+}
+
+void StaticFileCacheTest::test_conditional()
+{
+  write_file("static_cache_test/index.html", "<h1>hello</h1>");
+
+  http::static_file_cache cache;
+
+  auto req = create_request("/index.html");
+  auto resp = cache.serve(req, "static_cache_test/index.html");
+  const auto etag = resp.headers().at(http::response_header::ETAG);
+  const auto last_modified = resp.headers().at(http::response_header::LAST_MODIFIED);
+
+  req.add_header(http::request_header::IF_NONE_MATCH, etag);
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL(http::http::NOT_MODIFIED, resp.status());
+  UNIT_ASSERT_TRUE(resp.body().empty());
+  UNIT_ASSERT_EQUAL(etag, resp.headers().at(http::response_header::ETAG));
+
+  req = create_request("/index.html");
+  req.add_header(http::request_header::IF_NONE_MATCH, "\"other\", W/" + etag);
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL(http::http::NOT_MODIFIED, resp.status());
+
+  req = create_request("/index.html");
+  req.add_header(http::request_header::IF_NONE_MATCH, "*");
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL(http::http::NOT_MODIFIED, resp.status());
+
+  req = create_request("/index.html");
+  req.add_header(http::request_header::IF_MODIFIED_SINCE, last_modified);
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL(http::http::NOT_MODIFIED, resp.status());
+
+  req = create_request("/index.html");
+  req.add_header(http::request_header::IF_MODIFIED_SINCE, "Sat, 01 Jan 2000 00:00:00 GMT");
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+  UNIT_ASSERT_EQUAL("<h1>hello</h1>", resp.body());
+
+  // entity tags take precedence over the date
+  req = create_request("/index.html");
+  req.add_header(http::request_header::IF_NONE_MATCH, "\"other\"");
+  req.add_header(http::request_header::IF_MODIFIED_SINCE, last_modified);
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+
+  req = create_request("/index.html");
+  req.add_header(http::request_header::IF_MODIFIED_SINCE, "invalid date");
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+}
+
+void StaticFileCacheTest::test_invalidate()
+{
+  write_file("static_cache_test/index.html", "<h1>hello</h1>");
+
+  http::static_file_cache cache;
+  cache.revalidate_interval(std::chrono::hours(1));
+
+  auto req = create_request("/index.html");
+  auto resp = cache.serve(req, "static_cache_test/index.html");
+  const auto etag = resp.headers().at(http::response_header::ETAG);
+
+  write_file("static_cache_test/index.html", "<h1>hello world</h1>");
+
+  // not checked before the interval elapsed
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL("<h1>hello</h1>", resp.body());
+
+  // unless the client asks to
+  req.add_header(http::request_header::CACHE_CONTROL, "no-cache");
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL("<h1>hello world</h1>", resp.body());
+  UNIT_ASSERT_NOT_EQUAL(etag, resp.headers().at(http::response_header::ETAG));
+  UNIT_ASSERT_EQUAL(1UL, cache.size());
+
+  // checked on every request
+  cache.revalidate_interval(std::chrono::milliseconds::zero());
+  req = create_request("/index.html");
+  write_file("static_cache_test/index.html", "<h1>hi</h1>");
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL("<h1>hi</h1>", resp.body());
+
+  os::remove("static_cache_test/index.html");
+  resp = cache.serve(req, "static_cache_test/index.html");
+  UNIT_ASSERT_EQUAL(http::http::NOT_FOUND, resp.status());
+  UNIT_ASSERT_EQUAL(0UL, cache.size());
+  UNIT_ASSERT_EQUAL(0UL, cache.memory_usage());
+}
+
+void StaticFileCacheTest::test_eviction()
+{
+  const std::string content(1000, 'x');
+  write_file("static_cache_test/a.txt", content);
+  write_file("static_cache_test/b.txt", content);
+  write_file("static_cache_test/c.txt", content);
+
+  http::static_file_cache cache;
+  cache.revalidate_interval(std::chrono::hours(1));
+
+  auto req = create_request("/a.txt");
+  cache.serve(req, "static_cache_test/a.txt");
+  const auto entry_size = cache.memory_usage();
+  UNIT_ASSERT_TRUE(entry_size >= content.size());
+
+  // room for two files
+  cache.max_size(2 * entry_size + entry_size / 2);
+  cache.serve(req, "static_cache_test/b.txt");
+  cache.serve(req, "static_cache_test/a.txt");
+  cache.serve(req, "static_cache_test/c.txt");
+
+  UNIT_ASSERT_EQUAL(2UL, cache.size());
+  UNIT_ASSERT_TRUE(cache.memory_usage() <= cache.max_size());
+
+  // a and c are served from memory, b was least recently used
+  os::remove("static_cache_test/a.txt");
+  os::remove("static_cache_test/b.txt");
+  os::remove("static_cache_test/c.txt");
+  UNIT_ASSERT_EQUAL(http::http::OK, cache.serve(req, "static_cache_test/a.txt").status());
+  UNIT_ASSERT_EQUAL(http::http::OK, cache.serve(req, "static_cache_test/c.txt").status());
+  UNIT_ASSERT_EQUAL(http::http::NOT_FOUND, cache.serve(req, "static_cache_test/b.txt").status());
+
+  cache.clear();
+  UNIT_ASSERT_EQUAL(0UL, cache.size());
+  UNIT_ASSERT_EQUAL(0UL, cache.memory_usage());
+}
+
+void StaticFileCacheTest::test_large_file()
+{
+  const std::string content(4096, 'y');
+  write_file("static_cache_test/large.js", content);
+
+  http::static_file_cache cache;
+  cache.max_file_size(1024);
+
+  auto req = create_request("/large.js");
+  auto resp = cache.serve(req, "static_cache_test/large.js");
+
+  // sent from disk, only the validators are cached
+  UNIT_ASSERT_EQUAL(http::http::OK, resp.status());
+  UNIT_ASSERT_TRUE(resp.body().empty());
+  UNIT_ASSERT_TRUE(resp.body_file() != nullptr);
+  UNIT_ASSERT_EQUAL(content.size(), resp.body_file()->size());
+  UNIT_ASSERT_TRUE(cache.memory_usage() < content.size());
+
+  const auto etag = resp.headers().at(http::response_header::ETAG);
+  req.add_header(http::request_header::IF_NONE_MATCH, etag);
+  resp = cache.serve(req, "static_cache_test/large.js");
+  UNIT_ASSERT_EQUAL(http::http::NOT_MODIFIED, resp.status());
+  UNIT_ASSERT_TRUE(resp.body_file() == nullptr);
+}
+
+void StaticFileCacheTest::test_concurrent()
+{
+  write_file("static_cache_test/a.txt", "aaaa");
+
+  http::static_file_cache single;
+  single.serve(create_request("/a.txt"), "static_cache_test/a.txt");
+
+  // every request checks the file; concurrent loads
+  // of the same file end up in one entry
+  http::static_file_cache cache;
+  cache.revalidate_interval(std::chrono::milliseconds(0));
+
+  std::atomic<int> served { 0 };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&cache, &served] {
+      for (int j = 0; j < 50; ++j) {
+        auto resp = cache.serve(create_request("/a.txt"), "static_cache_test/a.txt");
+        if (resp.status() == http::http::OK && resp.body() == "aaaa") {
+          ++served;
+        }
+        if (j % 10 == 0) {
+          cache.clear();
+        }
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  UNIT_ASSERT_EQUAL(200, served.load());
+  cache.serve(create_request("/a.txt"), "static_cache_test/a.txt");
+  UNIT_ASSERT_EQUAL(1UL, cache.size());
+  UNIT_ASSERT_EQUAL(single.memory_usage(), cache.memory_usage());
+}
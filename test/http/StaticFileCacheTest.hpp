@@ -0,0 +1,22 @@
+#ifndef MATADOR_STATICFILECACHETEST_HPP
+#define MATADOR_STATICFILECACHETEST_HPP
+
+#include "matador/unit/unit_test.hpp"
+
+class StaticFileCacheTest : public matador::unit_test
+{
+public:
+  StaticFileCacheTest();
+
+  void initialize() override;
+  void finalize() override;
+
+  void test_serve();
+  void test_conditional();
+  void test_invalidate();
+  void test_eviction();
+  void test_large_file();
+  void test_concurrent();
+};
+
+#endif //MATADOR_STATICFILECACHETEST_HPP
@@ -5,6 +5,16 @@
 #include "matador/utils/os.hpp"
 
 #include "matador/http/template_engine.hpp"
+#include "matador/http/detail/template_program.hpp"
+
+#include "matador/object/object_store.hpp"
+#include "matador/object/object_view.hpp"
+
+#include "matador/utils/access.hpp"
+#include "matador/utils/date.hpp"
+#include "matador/utils/string.hpp"
+
+#include <vector>
 
 TemplateEngineTest::TemplateEngineTest()
   : matador::unit_test("template_engine", "template engine test")
@@ -16,10 +26,117 @@ TemplateEngineTest::TemplateEngineTest()
   add_test("if_else", [this] { test_if_else(); }, "test if else");
   add_test("include", [this] { test_include(); }, "test include");
   add_test("filter", [this] { test_filter(); }, "test filter");
+  add_test("compile", [this] { test_compile(); }, "test compiled template");
+  add_test("objects", [this] { test_objects(); }, "test render serializable objects");
+  add_test("object_store", [this] { test_object_store(); }, "test render containers and views of an object store");
 }
 
 using namespace matador;
 
+namespace {
+
+struct template_actor
+{
+  std::string name;
+  matador::date birthday;
+
+  template < class Operator >
+  void process(Operator &op)
+  {
+    matador::access::attribute(op, "name", name);
+    matador::access::attribute(op, "birthday", birthday);
+  }
+};
+
+struct template_movie
+{
+  unsigned long id = 0;
+  std::string name;
+  int year = 0;
+  double rating = 0.0;
+  bool released = false;
+  std::vector<std::string> actors;
+
+  template < class Operator >
+  void process(Operator &op)
+  {
+    matador::access::primary_key(op, "id", id);
+    matador::access::attribute(op, "name", name, 255);
+    matador::access::attribute(op, "year", year);
+    matador::access::attribute(op, "rating", rating);
+    matador::access::attribute(op, "released", released);
+    matador::access::attribute(op, "actors", actors);
+  }
+};
+
+struct template_movies
+{
+  std::string title;
+  long current = 0;
+  template_actor star;
+  object_ptr<template_actor> director;
+  std::vector<template_movie> movies;
+
+  template < class Operator >
+  void process(Operator &op)
+  {
+    matador::access::attribute(op, "title", title);
+    matador::access::attribute(op, "current", current);
+    matador::access::attribute(op, "star", star);
+    matador::access::has_one(op, "director", director, cascade_type::NONE);
+    matador::access::attribute(op, "movies", movies);
+  }
+};
+
+struct template_film
+{
+  unsigned long id = 0;
+  std::string name;
+  int year = 0;
+
+  template < class Operator >
+  void process(Operator &op)
+  {
+    matador::access::primary_key(op, "id", id);
+    matador::access::attribute(op, "name", name, 255);
+    matador::access::attribute(op, "year", year);
+  }
+};
+
+struct template_studio
+{
+  unsigned long id = 0;
+  std::string name;
+  container<template_film> films;
+
+  template < class Operator >
+  void process(Operator &op)
+  {
+    matador::access::primary_key(op, "id", id);
+    matador::access::attribute(op, "name", name, 255);
+    matador::access::has_many(op, "films", films, "studio_id", "film_id", cascade_type::ALL);
+  }
+};
+
+struct template_catalog
+{
+  explicit template_catalog(object_store &store)
+    : studios(store)
+  {}
+
+  std::string title;
+  object_view<template_studio> studios;
+
+  template < class Operator >
+  void process(Operator &op)
+  {
+    matador::access::attribute(op, "title", title);
+    matador::access::attribute(op, "studios", studios);
+  }
+};
+
+}
+
 void TemplateEngineTest::test_replace_var()
 {
   std::string no_replace { "no_replace" };
@@ -358,3 +475,161 @@ void TemplateEngineTest::test_filter()
 
   UNIT_ASSERT_EQUAL("My name is george.", result);
 }
+
+void TemplateEngineTest::test_compile()
+{
+  std::string format {
+    "<h1>{{ title|upper }}</h1><ul>"
+    "{% for movie in movies %}"
+    "<li>{{ movie.name }}{% if movie.year < 2000 %} (classic){% elif movie.year == forloop.parent.current %} (new){% else %}{% endif %}: "
+    "{% for actor in movie.actors %}{{ actor }} of {{ forloop.parent.movie.name }};{% empty %}nobody{% endfor %}</li>"
+    "{% empty %}<li>no movies</li>{% endfor %}</ul>"
+  };
+
+  json data {
+    { "title", "movies" },
+    { "current", 2020 },
+    { "movies", { {
+      { "name", "Alien" },
+      { "year", 1979 },
+      { "actors", { "Ripley", "Ash" } }
+    }, {
+      { "name", "Tenet" },
+      { "year", 2020 },
+      { "actors", json::array() }
+    }, {
+      { "name", "Dune" },
+      { "year", 2021 },
+      { "actors", { "Paul" } }
+    } } }
+  };
+
+  std::string expected_result {
+    "<h1>MOVIES</h1><ul>"
+    "<li>Alien (classic): Ripley of Alien;Ash of Alien;</li>"
+    "<li>Tenet (new): nobody</li>"
+    "<li>Dune: Paul of Dune;</li>"
+    "</ul>"
+  };
+
+  auto part = http::template_engine::build(format);
+  auto program = http::template_engine::compile(part);
+
+  UNIT_ASSERT_EQUAL(expected_result, http::template_engine::render(part, data));
+  UNIT_ASSERT_EQUAL(expected_result, http::template_engine::render(program, data));
+
+  // adjacent static text is merged into one instruction
+  const auto &instructions = program->instructions();
+  UNIT_ASSERT_EQUAL(http::detail::template_program::TEXT, instructions.front().opcode);
+  UNIT_ASSERT_EQUAL(4UL, instructions.front().length);
+  UNIT_ASSERT_EQUAL(http::detail::template_program::TEXT, instructions.back().opcode);
+  UNIT_ASSERT_EQUAL(5UL, instructions.back().length);
+
+  // rendering appends to the given buffer
+  std::string out { "<!DOCTYPE html>" };
+  http::template_engine::render(program, data, out);
+  UNIT_ASSERT_EQUAL("<!DOCTYPE html>" + expected_result, out);
+
+  // a compiled template is rendered with any data
+  data["movies"] = json::array();
+  UNIT_ASSERT_EQUAL("<h1>MOVIES</h1><ul><li>no movies</li></ul>", http::template_engine::render(program, data));
+
+  data.erase("movies");
+  UNIT_ASSERT_EXCEPTION(http::template_engine::render(program, data), std::logic_error, "object doesn't contain key movies");
+}
+
+void TemplateEngineTest::test_objects()
+{
+  std::string format {
+    "<h1>{{ title|upper }}</h1><ul>"
+    "{% for movie in movies %}"
+    "<li>{{ movie.id }} {{ movie.name }}{% if movie.year < 2000 %} (classic){% elif movie.year == forloop.parent.current %} (new){% else %}{% endif %}: "
+    "{% for actor in movie.actors %}{{ actor }} of {{ forloop.parent.movie.name }};{% empty %}nobody{% endfor %}</li>"
+    "{% empty %}<li>no movies</li>{% endfor %}</ul>"
+  };
+
+  template_movies data;
+  data.title = "movies";
+  data.current = 2020;
+  data.movies.push_back({ 1, "Alien", 1979, 8.5, true, { "Ripley", "Ash" } });
+  data.movies.push_back({ 2, "Tenet", 2020, 7.3, true, {} });
+  data.movies.push_back({ 3, "Dune", 2021, 8.0, false, { "Paul" } });
+
+  std::string expected_result {
+    "<h1>MOVIES</h1><ul>"
+    "<li>1 Alien (classic): Ripley of Alien;Ash of Alien;</li>"
+    "<li>2 Tenet (new): nobody</li>"
+    "<li>3 Dune: Paul of Dune;</li>"
+    "</ul>"
+  };
+
+  auto program = http::template_engine::compile(format);
+
+  UNIT_ASSERT_EQUAL(expected_result, http::template_engine::render(program, data));
+  UNIT_ASSERT_EQUAL(expected_result, http::template_engine::render(format, data));
+
+  std::string out { "<!DOCTYPE html>" };
+  http::template_engine::render(program, data, out);
+  UNIT_ASSERT_EQUAL("<!DOCTYPE html>" + expected_result, out);
+
+  data.movies.clear();
+  UNIT_ASSERT_EQUAL("<h1>MOVIES</h1><ul><li>no movies</li></ul>", http::template_engine::render(program, data));
+
+  // scalar fields, nested objects and object pointers
+  std::string details {
+    "{{ star.name }} ({{ star.birthday }}){% if director %} by {{ director.name }}{% else %} without director{% endif %}"
+  };
+
+  data.star.name = "Sigourney";
+
+  data.star.birthday.set(8, 10, 1949);
+
+  UNIT_ASSERT_EQUAL("Sigourney (" + to_string(data.star.birthday) + ") without director", http::template_engine::render(details, data));
+
+  data.director = object_ptr<template_actor>(new template_actor{ "Ridley", date(30, 11, 1937) });
+
+  UNIT_ASSERT_EQUAL("Sigourney (" + to_string(data.star.birthday) + ") by Ridley", http::template_engine::render(details, data));
+
+  std::string movie_format { "{{ name }} {{ year }} {{ rating }} {{ released }}{% if released %} released{% endif %}" };
+
+  template_movie movie { 4, "Alien", 1979, 8.5, true, {} };
+  UNIT_ASSERT_EQUAL("Alien 1979 8.500000 1 released", http::template_engine::render(movie_format, movie));
+}
+
+void TemplateEngineTest::test_object_store()
+{
+  object_store store;
+  store.attach<template_film>("film");
+  store.attach<template_studio>("studio");
+
+  auto ghibli = store.insert(new template_studio{ 0, "Ghibli", {} });
+  ghibli.modify()->films.push_back(new template_film{ 0, "Totoro", 1988 });
+  ghibli.modify()->films.push_back(new template_film{ 0, "Spirited Away", 2001 });
+  store.insert(new template_studio{ 0, "Aardman", {} });
+
+  std::string format {
+    "{{ title }}:{% for studio in studios %} {{ studio.name }} ["
+    "{% for film in studio.films %}{{ film.name }} {{ film.year }};{% empty %}none{% endfor %}]"
+    "{% empty %} no studios{% endfor %}"
+  };
+
+  auto program = http::template_engine::compile(format);
+
+  // loop over an object view and the containers of its objects
+  template_catalog catalog(store);
+  catalog.title = "studios";
+
+  UNIT_ASSERT_EQUAL("studios: Aardman [none] Ghibli [Totoro 1988;Spirited Away 2001;]", http::template_engine::render(program, catalog));
+
+  // loop over the container of an object pointer
+  std::string films { "{{ name }}:{% for film in films %} {{ film.name }}{% endfor %}" };
+
+  UNIT_ASSERT_EQUAL("Ghibli: Totoro Spirited Away", http::template_engine::render(films, ghibli));
+
+  store.clear();
+
+  template_catalog empty_catalog(store);
+  empty_catalog.title = "studios";
+
+  UNIT_ASSERT_EQUAL("studios: no studios", http::template_engine::render(program, empty_catalog));
+}
@@ -15,6 +15,9 @@ public:
   void test_if_else();
   void test_include();
   void test_filter();
+  void test_compile();
+  void test_objects();
+  void test_object_store();
 };
 
 
@@ -0,0 +1,154 @@
+#include "TemplateRepositoryTest.hpp"
+
+#include "matador/http/template_repository.hpp"
+#include "matador/http/detail/template_program.hpp"
+
+#include "matador/json/json.hpp"
+
+#include "matador/utils/file.hpp"
+#include "matador/utils/os.hpp"
+
+using namespace matador;
+
+namespace {
+
+const std::string root { "template_repository_test" };
+
+void write_template(const std::string &name, const std::string &content)
+{
+  file f(os::build_path(root, name), "w");
+  ::fwrite(content.c_str(), sizeof(char), content.size(), f.stream());
+  f.close();
+}
+
+void remove_template(const std::string &name)
+{
+  auto path = os::build_path(root, name);
+  if (os::exists(path)) {
+    os::remove(path);
+  }
+}
+
+}
+
+TemplateRepositoryTest::TemplateRepositoryTest()
+  : matador::unit_test("template_repository", "template repository test")
+{
+  add_test("get", [this] { test_get(); }, "test get compiled template");
+  add_test("reload", [this] { test_reload(); }, "test reload changed templates and their dependents");
+  add_test("prewarm", [this] { test_prewarm(); }, "test prewarm templates");
+  add_test("cyclic_include", [this] { test_cyclic_include(); }, "test cyclic include");
+}
+
+void TemplateRepositoryTest::finalize()
+{
+  for (const auto &name : { "header.html", "page.html", "other.html", "notes.txt", "a.html", "b.html", "sub/footer.html" }) {
+    remove_template(name);
+  }
+  os::rmdir(os::build_path(root, "sub"));
+  os::rmdir(root);
+}
+
+void TemplateRepositoryTest::test_get()
+{
+  os::mkpath(root);
+  write_template("header.html", "<title>{{ title }}</title>");
+  write_template("page.html", R"(<head>{% include "header.html" %}</head><h1>Hello {{ name }}</h1>)");
+
+  http::template_repository repo(root);
+
+  json data {
+    { "title", "My first Page" },
+    { "name", "George" }
+  };
+
+  UNIT_ASSERT_EQUAL("<head><title>My first Page</title></head><h1>Hello George</h1>", repo.render("page.html", data));
+
+  // the included template is cached as well
+  UNIT_ASSERT_EQUAL(2UL, repo.size());
+  UNIT_ASSERT_EQUAL(1UL, repo.dependencies("page.html").size());
+  UNIT_ASSERT_EQUAL("header.html", *repo.dependencies("page.html").begin());
+  UNIT_ASSERT_TRUE(repo.dependencies("header.html").empty());
+
+  auto program = repo.get("page.html");
+  UNIT_ASSERT_TRUE(program == repo.get("page.html"));
+
+  std::string out { "<!DOCTYPE html>" };
+  repo.render("page.html", data, out);
+  UNIT_ASSERT_EQUAL("<!DOCTYPE html><head><title>My first Page</title></head><h1>Hello George</h1>", out);
+
+  UNIT_ASSERT_EXCEPTION(repo.get("missing.html"), std::logic_error, "file " + os::build_path(root, "missing.html") + " doesn't exists");
+}
+
+void TemplateRepositoryTest::test_reload()
+{
+  os::mkpath(root);
+  write_template("header.html", "<title>{{ title }}</title>");
+  write_template("page.html", R"(<head>{% include "header.html" %}</head>)");
+  write_template("other.html", "<p>{{ title }}</p>");
+
+  http::template_repository repo(root);
+  repo.revalidate_interval(std::chrono::milliseconds::zero());
+
+  json data { { "title", "Title" } };
+
+  auto page = repo.get("page.html");
+  auto other = repo.get("other.html");
+  UNIT_ASSERT_EQUAL(3UL, repo.size());
+
+  // a changed include recompiles the including template
+  write_template("header.html", "<title>New {{ title }}</title>");
+  UNIT_ASSERT_EQUAL("<head><title>New Title</title></head>", repo.render("page.html", data));
+  UNIT_ASSERT_FALSE(page == repo.get("page.html"));
+  UNIT_ASSERT_TRUE(other == repo.get("other.html"));
+
+  // without auto reload the files aren't checked
+  repo.auto_reload(false);
+  UNIT_ASSERT_FALSE(repo.auto_reload());
+  page = repo.get("page.html");
+  write_template("header.html", "<title>Newer {{ title }}</title>");
+  UNIT_ASSERT_TRUE(page == repo.get("page.html"));
+  UNIT_ASSERT_EQUAL("<head><title>New Title</title></head>", repo.render("page.html", data));
+
+  // invalidating the include removes its dependents
+  repo.invalidate("header.html");
+  UNIT_ASSERT_EQUAL(1UL, repo.size());
+  UNIT_ASSERT_EQUAL("<head><title>Newer Title</title></head>", repo.render("page.html", data));
+
+  repo.clear();
+  UNIT_ASSERT_EQUAL(0UL, repo.size());
+}
+
+void TemplateRepositoryTest::test_prewarm()
+{
+  os::mkpath(os::build_path(root, "sub"));
+  write_template("header.html", "<title>{{ title }}</title>");
+  write_template("page.html", R"(<head>{% include "header.html" %}</head>)");
+  write_template("notes.txt", "no template");
+  write_template("sub/footer.html", "<footer>{{ title }}</footer>");
+
+  http::template_repository repo(root);
+  repo.auto_reload(false);
+
+  UNIT_ASSERT_EQUAL(3UL, repo.prewarm());
+  UNIT_ASSERT_EQUAL(3UL, repo.size());
+
+  // no file is read after prewarm
+  finalize();
+
+  json data { { "title", "Title" } };
+  UNIT_ASSERT_EQUAL("<head><title>Title</title></head>", repo.render("page.html", data));
+  UNIT_ASSERT_EQUAL("<footer>Title</footer>", repo.render("sub/footer.html", data));
+}
+
+void TemplateRepositoryTest::test_cyclic_include()
+{
+  os::mkpath(root);
+  write_template("a.html", R"(a{% include "b.html" %})");
+  write_template("b.html", R"(b{% include "a.html" %})");
+
+  http::template_repository repo(root);
+
+  UNIT_ASSERT_EXCEPTION(repo.get("a.html"), std::logic_error, "template a.html includes itself");
+  UNIT_ASSERT_EQUAL(0UL, repo.size());
+}
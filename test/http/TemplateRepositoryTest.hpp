@@ -0,0 +1,20 @@
+#ifndef MATADOR_TEMPLATEREPOSITORYTEST_HPP
+#define MATADOR_TEMPLATEREPOSITORYTEST_HPP
+
+#include "matador/unit/unit_test.hpp"
+
+class TemplateRepositoryTest : public matador::unit_test
+{
+public:
+  TemplateRepositoryTest();
+
+  void finalize() override;
+
+  void test_get();
+  void test_reload();
+  void test_prewarm();
+  void test_cyclic_include();
+};
+
+
+#endif //MATADOR_TEMPLATEREPOSITORYTEST_HPP
@@ -10,6 +10,14 @@ IOEchoServer::IOEchoServer(unsigned short port)
 {
 }
 
+IOEchoServer::IOEchoServer(unsigned short port, const io_service_config &config)
+  : service_(config)
+  , acceptor_(std::make_shared<acceptor>(tcp::peer(address::v4::any(), port)))
+  , connector_(std::make_shared<connector>())
+  , port_(port)
+{
+}
+
 IOEchoServer::~IOEchoServer()
 {
   stop();
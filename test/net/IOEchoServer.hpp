@@ -9,6 +9,7 @@ class IOEchoServer
 {
 public:
   explicit IOEchoServer(unsigned short port);
+  IOEchoServer(unsigned short port, const matador::io_service_config &config);
   ~IOEchoServer();
 
   void start();
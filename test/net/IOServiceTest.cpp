@@ -19,6 +19,8 @@ IOServiceTest::IOServiceTest()
   add_test("shutdown", [this] { test_shutdown(); }, "io service shutdown test");
   add_test("acceptor", [this] { test_acceptor(); }, "io service acceptor send and receive test");
   add_test("connector", [this] { test_connector(); }, "io service connector send and receive test");
+  add_test("sharded_round_robin", [this] { test_sharded_round_robin(); }, "sharded io service with round robin assignment test");
+  add_test("sharded_reuse_port", [this] { test_sharded_reuse_port(); }, "sharded io service with reuse port acceptors test");
 }
 
 void IOServiceTest::test_shutdown()
@@ -117,3 +119,61 @@ void IOServiceTest::test_connector()
 
   UNIT_ASSERT_TRUE(utils::wait_until_stopped(server.service()));
 }
+
+void IOServiceTest::test_sharded_round_robin()
+{
+  verify_sharded_echo(shard_policy::ROUND_ROBIN, 7892);
+}
+
+void IOServiceTest::test_sharded_reuse_port()
+{
+  verify_sharded_echo(shard_policy::REUSE_PORT, 7893);
+}
+
+void IOServiceTest::verify_sharded_echo(shard_policy policy, unsigned short port)
+{
+  io_service_config config;
+  config.shards = 4;
+  config.threads_per_shard = 1;
+  config.policy = policy;
+  config.pin_threads = true;
+
+  IOEchoServer server(port, config);
+  UNIT_ASSERT_EQUAL(4UL, server.service().shards());
+  UNIT_ASSERT_EQUAL(1UL, server.service().shard(0).num_threads());
+
+  server.accept();
+  server.start();
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(server.service()));
+
+  const std::size_t num_clients = 8;
+  for (std::size_t i = 0; i < num_clients; ++i) {
+    tcp::socket client;
+
+    auto ret = client.open(tcp::v4());
+    UNIT_ASSERT_TRUE(matador::is_valid_socket(ret));
+    auto srv = tcp::peer(address::v4::loopback(), port);
+    ret = client.connect(srv);
+    UNIT_ASSERT_FALSE(ret < 0);
+    buffer data;
+    data.append("hallo", 5);
+    size_t len = client.send(data);
+    UNIT_ASSERT_EQUAL(5UL, len);
+    data.clear();
+    len = client.receive(data);
+    UNIT_ASSERT_EQUAL(5UL, len);
+    client.close();
+  }
+
+  if (policy == shard_policy::ROUND_ROBIN) {
+    // the connections are spread over all shards
+    for (std::size_t i = 0; i < server.service().shards(); ++i) {
+      UNIT_ASSERT_GREATER(server.service().shard(i).num_dispatched(), 0UL);
+    }
+  }
+
+  server.stop();
+
+  UNIT_ASSERT_TRUE(utils::wait_until_stopped(server.service()));
+}
@@ -3,6 +3,8 @@
 
 #include "matador/unit/unit_test.hpp"
 
+#include "matador/net/io_service.hpp"
+
 #include <thread>
 
 class IOServiceTest : public matador::unit_test
@@ -13,6 +15,11 @@ public:
   void test_shutdown();
   void test_acceptor();
   void test_connector();
+  void test_sharded_round_robin();
+  void test_sharded_reuse_port();
+
+private:
+  void verify_sharded_echo(matador::shard_policy policy, unsigned short port);
 };
 
 
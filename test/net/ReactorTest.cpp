@@ -5,15 +5,24 @@
 #include "matador/net/reactor.hpp"
 #include "matador/net/acceptor.hpp"
 #include "matador/net/connector.hpp"
+#include "matador/net/epoll_demultiplexer.hpp"
+#include "matador/net/io_uring_demultiplexer.hpp"
 
 #include "matador/logger/log_manager.hpp"
 
 #include "EchoServer.hpp"
+#include "IOEchoServer.hpp"
 
+#include <atomic>
+#include <cerrno>
+#include <list>
+#include <map>
 #include <thread>
 #include <utility>
 
 #ifndef _WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 #endif
@@ -21,17 +30,130 @@
 using namespace matador;
 using namespace ::detail;
 
+namespace {
+
+/*
+ * Handler reading exactly once from
+ * its socket and counting the read
+ */
+class ReadOnceHandler : public handler
+{
+public:
+  ReadOnceHandler(tcp::socket sock, std::atomic_size_t &counter)
+    : stream_(std::move(sock))
+    , counter_(counter)
+  {}
+
+  void open() override {}
+  socket_type handle() const override { return stream_.id(); }
+  void on_input() override
+  {
+    buffer buf;
+    stream_.receive(buf);
+    done_ = true;
+    ++counter_;
+  }
+  void on_output() override {}
+  void on_except() override {}
+  void on_timeout() override {}
+  void on_close() override {}
+  void close() override { stream_.close(); }
+  bool is_ready_write() const override { return false; }
+  bool is_ready_read() const override { return !done_; }
+  std::string name() const override { return "ReadOnceHandler"; }
+
+private:
+  tcp::socket stream_;
+  std::atomic_size_t &counter_;
+  std::atomic_bool done_ { false };
+};
+
+/*
+ * Handler counting the expirations
+ * of each of its timers
+ */
+class TimerHandler : public handler
+{
+public:
+  void open() override {}
+  socket_type handle() const override { return 0; }
+  void on_input() override {}
+  void on_output() override {}
+  void on_except() override {}
+  void on_timeout() override {}
+  void on_timer(timer_id id) override
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    ++expirations_[id];
+  }
+  void on_close() override {}
+  void close() override {}
+  bool is_ready_write() const override { return false; }
+  bool is_ready_read() const override { return false; }
+  std::string name() const override { return "TimerHandler"; }
+
+  std::size_t expirations(timer_id id) const
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    auto it = expirations_.find(id);
+    return it == expirations_.end() ? 0 : it->second;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::map<timer_id, std::size_t> expirations_;
+};
+
+bool send_all(tcp::socket &sock, const char *data, std::size_t size)
+{
+  while (size > 0) {
+    auto len = ::send(sock.id(), data, static_cast<int>(size), 0);
+    if (len <= 0) {
+      return false;
+    }
+    data += len;
+    size -= static_cast<std::size_t>(len);
+  }
+  return true;
+}
+
+std::string receive_all(tcp::socket &sock, std::size_t size)
+{
+  std::string data;
+  char buf[16384];
+  while (data.size() < size) {
+    auto len = ::recv(sock.id(), buf, sizeof(buf), 0);
+    if (len <= 0) {
+      break;
+    }
+    data.append(buf, static_cast<std::size_t>(len));
+  }
+  return data;
+}
+
+}
+
 ReactorTest::ReactorTest()
   : matador::unit_test("reactor", "reactor test unit")
 {
   add_test("event_types", [this] { test_event_types(); }, "event types test");
   add_test("fdsets", [this] { test_fdset(); }, "reactor fdsets test");
   add_test("handler", [this] { test_handler(); }, "reactor handler test");
+  add_test("handler_table", [this] { test_handler_table(); }, "reactor handler table test");
   add_test("connector", [this] { test_connector(); }, "connector test");
   add_test("shutdown", [this] { test_shutdown(); }, "reactor shutdown test");
   add_test("reactor_acceptor", [this] { test_reactor_acceptor(); }, "reactor acceptor send and receive test");
   add_test("reactor_connector", [this] { test_reactor_connector(); }, "reactor connector send and receive test");
   add_test("timeout", [this] { test_timeout(); }, "reactor schedule timeout test");
+  add_test("timers", [this] { test_timers(); }, "reactor schedule multiple millisecond timers test");
+  add_test("select_acceptor", [this] { test_select_acceptor(); }, "reactor with select demultiplexer send and receive test");
+  add_test("epoll_acceptor", [this] { test_epoll_acceptor(); }, "reactor with epoll demultiplexer send and receive test");
+  add_test("io_uring_acceptor", [this] { test_io_uring_acceptor(); }, "reactor with io_uring demultiplexer send and receive test");
+  add_test("io_uring_completion", [this] { test_io_uring_completion(); }, "io_uring demultiplexer completes receive, send, accept and close test");
+  add_test("io_uring_poll_fallback", [this] { test_io_uring_poll_fallback(); }, "reactor with polling io_uring demultiplexer send and receive test");
+  add_test("io_uring_stream", [this] { test_io_uring_stream(); }, "io service with io_uring demultiplexer streams large payloads test");
+  add_test("batch_dispatch", [this] { test_batch_dispatch(); }, "reactor batch dispatch test");
+  add_test("accept_backlog", [this] { test_accept_backlog(); }, "reactor acceptor drains backlog test");
 
 }
 
@@ -77,6 +199,39 @@ void ReactorTest::test_handler()
   UNIT_ASSERT_TRUE(is_event_type_set(it->second, event_type::READ_MASK));
 }
 
+void ReactorTest::test_handler_table()
+{
+  reactor r;
+
+  std::vector<std::shared_ptr<EchoServer>> handlers;
+  for (int i = 0; i < 1000; ++i) {
+    handlers.push_back(std::make_shared<EchoServer>());
+    r.register_handler(handlers.back(), event_type::READ_WRITE_MASK);
+  }
+
+  for (std::size_t i = 0; i < handlers.size(); i += 2) {
+    r.unregister_handler(handlers[i], event_type::READ_WRITE_MASK);
+  }
+
+  for (std::size_t i = 1; i < handlers.size(); i += 2) {
+    r.deactivate_handler(handlers[i], event_type::READ_MASK);
+  }
+
+  for (std::size_t i = 1; i < handlers.size(); i += 2) {
+    auto it = r.find_handler_type(handlers[i]);
+    UNIT_ASSERT_EQUAL(handlers[i].get(), it->first.get());
+    UNIT_ASSERT_FALSE(is_event_type_set(it->second, event_type::READ_MASK));
+    UNIT_ASSERT_TRUE(is_event_type_set(it->second, event_type::WRITE_MASK));
+  }
+
+  // register a removed handler again
+  r.register_handler(handlers[0], event_type::READ_MASK);
+
+  auto it = r.find_handler_type(handlers[0]);
+  UNIT_ASSERT_EQUAL(handlers[0].get(), it->first.get());
+  UNIT_ASSERT_TRUE(is_event_type_set(it->second, event_type::READ_MASK));
+}
+
 void ReactorTest::test_connector()
 {
   connector c;
@@ -259,3 +414,446 @@ void ReactorTest::test_timeout()
 
   UNIT_ASSERT_TRUE(echo_conn->timeout_called());
 }
+
+void ReactorTest::test_timers()
+{
+  auto h = std::make_shared<TimerHandler>();
+
+  reactor r;
+
+  utils::ThreadRunner runner([&r]() {
+    r.run();
+  }, [&r]() {
+    r.shutdown();
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(r));
+
+  auto once = r.schedule_timer(h, std::chrono::milliseconds(20));
+  auto cancelled = r.schedule_timer(h, std::chrono::milliseconds(1000));
+  auto periodic = r.schedule_timer(h, std::chrono::milliseconds(10), std::chrono::milliseconds(10));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds (100));
+
+  UNIT_ASSERT_TRUE(r.cancel_timer(h, cancelled));
+  UNIT_ASSERT_FALSE(r.cancel_timer(h, once));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds (100));
+
+  r.cancel_timer(h);
+
+  r.shutdown();
+
+  UNIT_ASSERT_EQUAL(1UL, h->expirations(once));
+  UNIT_ASSERT_EQUAL(0UL, h->expirations(cancelled));
+  UNIT_ASSERT_GREATER(h->expirations(periodic), 5UL);
+}
+
+void ReactorTest::test_select_acceptor()
+{
+  verify_echo(demultiplexer_type::SELECT, 7781);
+}
+
+void ReactorTest::test_epoll_acceptor()
+{
+#ifdef MATADOR_HAS_EPOLL
+  verify_echo(demultiplexer_type::EPOLL, 7782);
+#else
+  reactor r(demultiplexer_type::EPOLL);
+  UNIT_ASSERT_TRUE(r.backend() == demultiplexer_type::SELECT);
+#endif
+}
+
+void ReactorTest::test_io_uring_acceptor()
+{
+  if (is_demultiplexer_available(demultiplexer_type::IO_URING)) {
+    verify_echo(demultiplexer_type::IO_URING, 7787);
+  } else {
+    // kernel without io_uring support
+    reactor r(demultiplexer_type::IO_URING);
+    UNIT_ASSERT_TRUE(r.backend() == default_demultiplexer_type());
+  }
+}
+
+void ReactorTest::test_io_uring_completion()
+{
+#ifdef MATADOR_HAS_IO_URING_COMPLETION
+  if (!io_uring_demultiplexer::is_supported()) {
+    UNIT_ASSERT_FALSE(is_demultiplexer_available(demultiplexer_type::IO_URING));
+    return;
+  }
+  io_uring_demultiplexer poll_only(false);
+  UNIT_ASSERT_FALSE(poll_only.completes_io());
+
+  io_uring_demultiplexer demux;
+  if (!demux.completes_io()) {
+    // kernel without buffer rings
+    return;
+  }
+
+  auto wait_for = [&demux](socket_type fd, event_type type) {
+    for (int i = 0; i < 20; ++i) {
+      demultiplexer::t_ready_events events;
+      demux.wait(100, events);
+      for (const auto &ev : events) {
+        if (ev.fd == fd && ev.type == type) {
+          return true;
+        }
+      }
+    }
+    return false;
+  };
+
+  int fds[2];
+  UNIT_ASSERT_EQUAL(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+  demux.complete_io(fds[0], io_operation::STREAM);
+  demux.add(fds[0], event_type::READ_MASK);
+  UNIT_ASSERT_EQUAL(1UL, demux.size());
+
+  // nothing received yet
+  char buf[64];
+  UNIT_ASSERT_EQUAL(-1L, demux.receive(fds[0], buf, sizeof(buf)));
+  UNIT_ASSERT_EQUAL(EAGAIN, errno);
+
+  UNIT_ASSERT_EQUAL(5L, static_cast<long>(::write(fds[1], "hallo", 5)));
+  UNIT_ASSERT_TRUE(wait_for(fds[0], event_type::READ_MASK));
+  UNIT_ASSERT_EQUAL(3L, demux.receive(fds[0], buf, 3));
+  UNIT_ASSERT_EQUAL(2L, demux.receive(fds[0], buf + 3, sizeof(buf) - 3));
+  UNIT_ASSERT_EQUAL("hallo", std::string(buf, 5));
+
+  // more data than buffers are queued per socket
+  std::string payload(256 * 1024, '\0');
+  for (std::size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>('a' + i % 26);
+  }
+  std::string received;
+  std::size_t written = 0;
+  for (int i = 0; i < 200 && received.size() < payload.size(); ++i) {
+    if (written < payload.size()) {
+      auto len = ::write(fds[1], payload.data() + written, payload.size() - written);
+      if (len > 0) {
+        written += static_cast<std::size_t>(len);
+      }
+    }
+    demultiplexer::t_ready_events events;
+    demux.wait(50, events);
+    char chunk[8192];
+    long len;
+    while ((len = demux.receive(fds[0], chunk, sizeof(chunk))) > 0) {
+      received.append(chunk, static_cast<std::size_t>(len));
+    }
+  }
+  UNIT_ASSERT_TRUE(payload == received);
+
+  // the buffers are sent without copying them; the
+  // owner is kept until the send completed
+  demux.modify(fds[0], event_type::READ_WRITE_MASK);
+  auto owner = std::make_shared<int>(0);
+  std::list<buffer_view> buffers;
+  buffers.emplace_back(payload.data(), 100000);
+  buffers.emplace_back(payload.data() + 100000, 100000);
+  UNIT_ASSERT_EQUAL(-1L, demux.send(fds[0], buffers, owner));
+  UNIT_ASSERT_EQUAL(EAGAIN, errno);
+  UNIT_ASSERT_EQUAL(2L, owner.use_count());
+
+  std::string echoed;
+  long sent = 0;
+  for (int i = 0; i < 200 && (!buffers.empty() || echoed.size() < 200000); ++i) {
+    demultiplexer::t_ready_events events;
+    demux.wait(50, events);
+    char chunk[65536];
+    ssize_t len;
+    while ((len = ::read(fds[1], chunk, sizeof(chunk))) > 0) {
+      echoed.append(chunk, static_cast<std::size_t>(len));
+    }
+    auto ret = demux.send(fds[0], buffers, owner);
+    if (ret > 0) {
+      sent += ret;
+    }
+  }
+  UNIT_ASSERT_EQUAL(200000L, sent);
+  UNIT_ASSERT_TRUE(buffers.empty());
+  UNIT_ASSERT_TRUE(payload.substr(0, 200000) == echoed);
+  UNIT_ASSERT_EQUAL(1L, owner.use_count());
+
+  // closed by the peer
+  ::close(fds[1]);
+  UNIT_ASSERT_TRUE(wait_for(fds[0], event_type::READ_MASK));
+  UNIT_ASSERT_EQUAL(0L, demux.receive(fds[0], buf, sizeof(buf)));
+
+  demux.remove(fds[0]);
+  UNIT_ASSERT_EQUAL(0UL, demux.size());
+  demux.close(fds[0]);
+  UNIT_ASSERT_EQUAL(-1, ::fcntl(fds[0], F_GETFD));
+
+  // connections are accepted by the ring
+  tcp::acceptor listener;
+  tcp::peer local(address::v4::loopback(), 7789);
+  UNIT_ASSERT_EQUAL(0, listener.bind(local));
+  UNIT_ASSERT_EQUAL(0, listener.listen(5));
+  listener.non_blocking(true);
+  demux.complete_io(listener.id(), io_operation::ACCEPT);
+  demux.add(listener.id(), event_type::READ_MASK);
+
+  tcp::socket client;
+  client.open(tcp::v4());
+  UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), 7789)));
+  UNIT_ASSERT_TRUE(wait_for(listener.id(), event_type::READ_MASK));
+  auto accepted = demux.accept(listener.id());
+  UNIT_ASSERT_TRUE(is_valid_socket(accepted));
+  UNIT_ASSERT_EQUAL(-1, demux.accept(listener.id()));
+  UNIT_ASSERT_EQUAL(EAGAIN, errno);
+  ::close(accepted);
+  client.close();
+
+  demux.remove(listener.id());
+  demux.close(listener.release());
+#else
+  UNIT_ASSERT_FALSE(make_demultiplexer(demultiplexer_type::IO_URING)->completes_io());
+#endif
+}
+
+void ReactorTest::test_io_uring_poll_fallback()
+{
+#ifdef MATADOR_HAS_IO_URING
+  if (!io_uring_demultiplexer::is_supported()) {
+    UNIT_ASSERT_FALSE(is_demultiplexer_available(demultiplexer_type::IO_URING));
+    return;
+  }
+  // the ring only polls; handlers read and write themselves
+  reactor r(std::unique_ptr<demultiplexer>(new io_uring_demultiplexer(false)), 4);
+  UNIT_ASSERT_TRUE(r.backend() == demultiplexer_type::IO_URING);
+  UNIT_ASSERT_FALSE(r.completes_io());
+  verify_echo(r, 7788);
+#else
+  reactor r(demultiplexer_type::IO_URING);
+  UNIT_ASSERT_FALSE(r.completes_io());
+#endif
+}
+
+void ReactorTest::test_io_uring_stream()
+{
+  io_service_config config;
+  config.shards = 1;
+  config.threads_per_shard = 2;
+  config.demultiplexer = demultiplexer_type::IO_URING;
+
+  if (!is_demultiplexer_available(demultiplexer_type::IO_URING)) {
+    io_service service(config);
+    UNIT_ASSERT_TRUE(service.shard(0).backend() == default_demultiplexer_type());
+    return;
+  }
+
+  IOEchoServer server(7790, config);
+#ifdef MATADOR_HAS_IO_URING
+  UNIT_ASSERT_EQUAL(io_uring_demultiplexer().completes_io(), server.service().shard(0).completes_io());
+#endif
+  server.accept();
+  server.start();
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(server.service()));
+
+  std::string payload(256 * 1024, '\0');
+  for (std::size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>('a' + i % 26);
+  }
+
+  // two connections echo chunks larger than
+  // the buffers queued per socket in turn
+  const std::size_t chunk = 64 * 1024;
+  tcp::socket clients[2];
+  for (auto &client : clients) {
+    UNIT_ASSERT_TRUE(matador::is_valid_socket(client.open(tcp::v4())));
+    UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), 7790)));
+  }
+  for (std::size_t offset = 0; offset < payload.size(); offset += chunk) {
+    for (auto &client : clients) {
+      UNIT_ASSERT_TRUE(send_all(client, payload.data() + offset, chunk));
+      UNIT_ASSERT_TRUE(payload.substr(offset, chunk) == receive_all(client, chunk));
+    }
+  }
+  for (auto &client : clients) {
+    client.close();
+  }
+
+  server.stop();
+
+  UNIT_ASSERT_TRUE(utils::wait_until_stopped(server.service()));
+}
+
+void ReactorTest::verify_echo(demultiplexer_type type, unsigned short port)
+{
+  reactor r(type);
+  UNIT_ASSERT_TRUE(r.backend() == type);
+  if (type != demultiplexer_type::IO_URING) {
+    UNIT_ASSERT_FALSE(r.completes_io());
+  }
+  verify_echo(r, port);
+}
+
+void ReactorTest::verify_echo(reactor &r, unsigned short port)
+{
+  auto ep = tcp::peer(address::v4::any(), port);
+  auto ac = std::make_shared<acceptor>(ep, [](tcp::socket sock, tcp::peer p, acceptor *) {
+    auto cl = std::make_shared<EchoServer>();
+    cl->init(std::move(sock), std::move(p));
+    return cl;
+  });
+
+  r.register_handler(ac, event_type::ACCEPT_MASK);
+
+  utils::ThreadRunner runner([&r]() {
+    r.run();
+  }, [&r]() {
+    r.shutdown();
+  });
+
+  UNIT_ASSERT_TRUE(utils::wait_until_running(r));
+
+  // several clients one after another
+  for (int i = 0; i < 3; ++i) {
+    tcp::socket client;
+
+    auto ret = client.open(tcp::v4());
+    UNIT_ASSERT_FALSE(ret < 0);
+    auto srv = tcp::peer(address::v4::loopback(), port);
+    ret = client.connect(srv);
+    UNIT_ASSERT_FALSE(ret < 0);
+    buffer data;
+    data.append("hallo");
+    size_t len = client.send(data);
+    UNIT_ASSERT_EQUAL(5UL, len);
+    data.clear();
+    len = client.receive(data);
+    UNIT_ASSERT_EQUAL(5UL, len);
+    client.close();
+  }
+
+  r.shutdown();
+
+  UNIT_ASSERT_TRUE(utils::wait_until_stopped(r));
+}
+
+void ReactorTest::test_batch_dispatch()
+{
+  const std::size_t num_events = 32;
+
+  auto single_waits = count_waits(false, 7783, num_events);
+  auto batch_waits = count_waits(true, 7784, num_events);
+
+  // one wait per event without batching
+  UNIT_ASSERT_TRUE(single_waits >= num_events);
+  // all events ready at once are dispatched with a few waits
+  UNIT_ASSERT_TRUE(batch_waits <= num_events / 4);
+}
+
+std::size_t ReactorTest::count_waits(bool batch_dispatch, unsigned short port, std::size_t num_events)
+{
+  tcp::acceptor acceptor;
+  tcp::peer local(address::v4::loopback(), port);
+  UNIT_ASSERT_EQUAL(0, acceptor.bind(local));
+  UNIT_ASSERT_EQUAL(0, acceptor.listen(static_cast<int>(num_events)));
+
+  reactor r;
+  r.batch_dispatch(batch_dispatch);
+  UNIT_ASSERT_EQUAL(batch_dispatch, r.batch_dispatch());
+
+  // connect all clients and send data before the
+  // reactor starts; thus all handlers are ready at once
+  std::atomic_size_t counter { 0 };
+  std::vector<tcp::socket> clients(num_events);
+  for (auto &client : clients) {
+    client.open(tcp::v4());
+    UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), port)));
+    tcp::socket remote;
+    UNIT_ASSERT_TRUE(acceptor.accept(remote) > 0);
+    buffer data;
+    data.append("x");
+    UNIT_ASSERT_EQUAL(1L, static_cast<long>(client.send(data)));
+    r.register_handler(std::make_shared<ReadOnceHandler>(std::move(remote), counter), event_type::READ_MASK);
+  }
+
+  {
+    utils::ThreadRunner runner([&r]() {
+      r.run();
+    }, [&r]() {
+      r.shutdown();
+    });
+
+    UNIT_ASSERT_TRUE(utils::wait_until_running(r));
+
+    int retries = 50;
+    while (counter < num_events && retries-- > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds (100));
+    }
+    UNIT_ASSERT_EQUAL(num_events, counter.load());
+    UNIT_ASSERT_TRUE(r.num_dispatched() >= num_events);
+  }
+
+  for (auto &client : clients) {
+    client.close();
+  }
+  acceptor.close();
+
+  return r.num_waits();
+}
+
+void ReactorTest::test_accept_backlog()
+{
+  const std::size_t num_connections = 40;
+
+  // all pending connections are accepted with one event
+  auto dispatches = count_accept_dispatches(64, 7785, num_connections);
+  UNIT_ASSERT_LESS(dispatches, 4UL);
+
+  // at most eight connections are accepted per event
+  dispatches = count_accept_dispatches(8, 7786, num_connections);
+  UNIT_ASSERT_GREATER(dispatches, 4UL);
+}
+
+std::size_t ReactorTest::count_accept_dispatches(std::size_t accepts_per_event, unsigned short port, std::size_t num_connections)
+{
+  reactor r;
+
+  std::atomic_size_t accepted { 0 };
+  auto ac = std::make_shared<acceptor>(tcp::peer(address::v4::loopback(), port), [&accepted](tcp::socket sock, tcp::peer, acceptor *) {
+    ++accepted;
+    auto h = std::make_shared<EchoServer>();
+    h->init(std::move(sock), tcp::peer());
+    return h;
+  });
+  ac->accepts_per_event(accepts_per_event);
+  UNIT_ASSERT_EQUAL(accepts_per_event, ac->accepts_per_event());
+  UNIT_ASSERT_EQUAL(SOMAXCONN, ac->backlog());
+
+  r.register_handler(ac, event_type::ACCEPT_MASK);
+
+  // fill the backlog before the reactor starts
+  std::vector<tcp::socket> clients(num_connections);
+  for (auto &client : clients) {
+    client.open(tcp::v4());
+    UNIT_ASSERT_TRUE(client.connect(tcp::peer(address::v4::loopback(), port)));
+  }
+
+  {
+    utils::ThreadRunner runner([&r]() {
+      r.run();
+    }, [&r]() {
+      r.shutdown();
+    });
+
+    UNIT_ASSERT_TRUE(utils::wait_until_running(r));
+
+    int retries = 50;
+    while (accepted < num_connections && retries-- > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds (100));
+    }
+    UNIT_ASSERT_EQUAL(num_connections, accepted.load());
+  }
+
+  for (auto &client : clients) {
+    client.close();
+  }
+
+  return r.num_dispatched();
+}
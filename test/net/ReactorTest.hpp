@@ -3,8 +3,14 @@
 
 #include "matador/unit/unit_test.hpp"
 
+#include "matador/net/demultiplexer.hpp"
+
 #include <thread>
 
+namespace matador {
+class reactor;
+}
+
 class ReactorTest : public matador::unit_test
 {
 public:
@@ -13,11 +19,27 @@ public:
   void test_event_types();
   void test_fdset();
   void test_handler();
+  void test_handler_table();
   void test_connector();
   void test_shutdown();
   void test_reactor_acceptor();
   void test_reactor_connector();
   void test_timeout();
+  void test_timers();
+  void test_select_acceptor();
+  void test_epoll_acceptor();
+  void test_io_uring_acceptor();
+  void test_io_uring_completion();
+  void test_io_uring_poll_fallback();
+  void test_io_uring_stream();
+  void test_batch_dispatch();
+  void test_accept_backlog();
+
+private:
+  void verify_echo(matador::demultiplexer_type type, unsigned short port);
+  void verify_echo(matador::reactor &r, unsigned short port);
+  std::size_t count_waits(bool batch_dispatch, unsigned short port, std::size_t num_events);
+  std::size_t count_accept_dispatches(std::size_t accepts_per_event, unsigned short port, std::size_t num_connections);
 };
 
 
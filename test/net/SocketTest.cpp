@@ -2,6 +2,13 @@
 
 #include "matador/net/ip.hpp"
 
+#include "matador/utils/buffer_view.hpp"
+
+#include <array>
+#include <list>
+#include <string>
+#include <vector>
+
 using namespace matador;
 
 SocketTest::SocketTest()
@@ -9,6 +16,7 @@ SocketTest::SocketTest()
 {
   add_test("socket_v4", [this] { test_socket_v4(); }, "socket v4 test");
   add_test("acceptor_v4", [this] { test_acceptor_v4(); }, "acceptor v4 test");
+  add_test("gather_send", [this] { test_gather_send(); }, "socket gather send test");
 }
 
 void SocketTest::test_socket_v4()
@@ -26,6 +34,8 @@ void SocketTest::test_socket_v4()
   UNIT_ASSERT_FALSE(ts2.non_blocking());
   ts2.non_blocking(true);
   UNIT_ASSERT_TRUE(ts2.non_blocking());
+  ts2.non_blocking(false);
+  UNIT_ASSERT_FALSE(ts2.non_blocking());
 
   auto fd = ts1.id();
 
@@ -59,3 +69,52 @@ void SocketTest::test_acceptor_v4()
   UNIT_ASSERT_TRUE(acceptor.accept(remote) > 0);
   UNIT_ASSERT_TRUE(remote.id() > 0);
 }
+
+void SocketTest::test_gather_send()
+{
+  tcp::acceptor acceptor;
+
+  tcp::peer local(address::v4::any(), 12346);
+  UNIT_ASSERT_EQUAL(0, acceptor.bind(local));
+  UNIT_ASSERT_EQUAL(0, acceptor.listen(5));
+
+  tcp::peer localhost12346(address::v4::loopback(), 12346);
+  tcp::socket s(tcp::v4());
+  UNIT_ASSERT_TRUE(s.connect(localhost12346));
+
+  tcp::socket remote;
+  UNIT_ASSERT_TRUE(acceptor.accept(remote) > 0);
+
+  // more buffers than fit into one gather write
+  std::vector<std::string> chunks;
+  std::string expected;
+  for (int i = 0; i < 3000; ++i) {
+    chunks.push_back(std::to_string(i) + ";");
+    expected += chunks.back();
+  }
+  std::list<buffer_view> buffers;
+  for (const auto &chunk : chunks) {
+    buffers.emplace_back(chunk);
+  }
+  // partially sent buffer
+  buffers.front().bump(1);
+  expected.erase(0, 1);
+
+  ssize_t bytes_total = 0;
+  while (!buffers.empty()) {
+    auto len = s.send(buffers);
+    UNIT_ASSERT_GREATER(len, 0);
+    bytes_total += len;
+  }
+  UNIT_ASSERT_EQUAL(static_cast<ssize_t>(expected.size()), bytes_total);
+
+  std::string received;
+  std::array<char, 4096> data{};
+  while (received.size() < expected.size()) {
+    buffer_view buf(data);
+    auto len = remote.receive(buf);
+    UNIT_ASSERT_GREATER(len, 0);
+    received.append(data.data(), static_cast<std::size_t>(len));
+  }
+  UNIT_ASSERT_EQUAL(expected, received);
+}
@@ -10,6 +10,7 @@ public:
 
   void test_socket_v4();
   void test_acceptor_v4();
+  void test_gather_send();
 };
 
 
@@ -0,0 +1,162 @@
+#include "TimerWheelTest.hpp"
+
+#include "EchoServer.hpp"
+
+#include "matador/net/timer_wheel.hpp"
+
+using namespace matador;
+using namespace std::chrono;
+
+namespace {
+
+bool accept_all(const timer_wheel::expired_timer&)
+{
+  return true;
+}
+
+}
+
+TimerWheelTest::TimerWheelTest()
+  : matador::unit_test("timer_wheel", "timer wheel test unit")
+{
+  add_test("schedule", [this] { test_schedule(); }, "timer wheel schedule test");
+  add_test("interval", [this] { test_interval(); }, "timer wheel interval test");
+  add_test("cancel", [this] { test_cancel(); }, "timer wheel cancel test");
+  add_test("cascade", [this] { test_cascade(); }, "timer wheel cascade test");
+  add_test("reject", [this] { test_reject(); }, "timer wheel reject expired timer test");
+  add_test("next_expiry", [this] { test_next_expiry(); }, "timer wheel next expiry test");
+}
+
+void TimerWheelTest::test_schedule()
+{
+  timer_wheel wheel;
+  auto h = std::make_shared<EchoServer>();
+  auto start = timer_wheel::clock::now();
+
+  auto first = wheel.schedule(h, milliseconds(10), milliseconds::zero(), start);
+  auto second = wheel.schedule(h, milliseconds(20), milliseconds::zero(), start);
+
+  UNIT_ASSERT_EQUAL(2UL, wheel.size());
+  UNIT_ASSERT_EQUAL(2UL, wheel.count(h.get()));
+  UNIT_ASSERT_TRUE(wheel.is_scheduled(first));
+
+  timer_wheel::t_expired_timers expired;
+  UNIT_ASSERT_EQUAL(0UL, wheel.expire(start + milliseconds(9), accept_all, expired));
+  UNIT_ASSERT_EQUAL(1UL, wheel.expire(start + milliseconds(10), accept_all, expired));
+  UNIT_ASSERT_EQUAL(first, expired.front().id);
+  UNIT_ASSERT_EQUAL(h.get(), expired.front().owner.get());
+  UNIT_ASSERT_FALSE(wheel.is_scheduled(first));
+
+  expired.clear();
+  UNIT_ASSERT_EQUAL(1UL, wheel.expire(start + milliseconds(25), accept_all, expired));
+  UNIT_ASSERT_EQUAL(second, expired.front().id);
+  UNIT_ASSERT_TRUE(wheel.empty());
+  UNIT_ASSERT_EQUAL(0UL, wheel.count(h.get()));
+}
+
+void TimerWheelTest::test_interval()
+{
+  timer_wheel wheel;
+  auto h = std::make_shared<EchoServer>();
+  auto start = timer_wheel::clock::now();
+
+  auto id = wheel.schedule(h, milliseconds(5), milliseconds(5), start);
+
+  timer_wheel::t_expired_timers expired;
+  UNIT_ASSERT_EQUAL(1UL, wheel.expire(start + milliseconds(5), accept_all, expired));
+  UNIT_ASSERT_EQUAL(1UL, wheel.expire(start + milliseconds(10), accept_all, expired));
+  // missed expirations are collapsed into one
+  UNIT_ASSERT_EQUAL(1UL, wheel.expire(start + milliseconds(27), accept_all, expired));
+  UNIT_ASSERT_EQUAL(0UL, wheel.expire(start + milliseconds(31), accept_all, expired));
+  UNIT_ASSERT_EQUAL(1UL, wheel.expire(start + milliseconds(32), accept_all, expired));
+  UNIT_ASSERT_TRUE(wheel.is_scheduled(id));
+  UNIT_ASSERT_EQUAL(4UL, expired.size());
+}
+
+void TimerWheelTest::test_cancel()
+{
+  timer_wheel wheel;
+  auto h1 = std::make_shared<EchoServer>();
+  auto h2 = std::make_shared<EchoServer>();
+  auto start = timer_wheel::clock::now();
+
+  auto id1 = wheel.schedule(h1, milliseconds(10), milliseconds::zero(), start);
+  wheel.schedule(h1, milliseconds(10), milliseconds(10), start);
+  wheel.schedule(h1, milliseconds(1000), milliseconds::zero(), start);
+  auto id4 = wheel.schedule(h2, milliseconds(10), milliseconds::zero(), start);
+
+  UNIT_ASSERT_TRUE(wheel.cancel(id1));
+  UNIT_ASSERT_FALSE(wheel.cancel(id1));
+  UNIT_ASSERT_EQUAL(2UL, wheel.count(h1.get()));
+
+  UNIT_ASSERT_EQUAL(2UL, wheel.cancel(h1.get()));
+  UNIT_ASSERT_EQUAL(0UL, wheel.count(h1.get()));
+  UNIT_ASSERT_EQUAL(1UL, wheel.size());
+
+  timer_wheel::t_expired_timers expired;
+  UNIT_ASSERT_EQUAL(1UL, wheel.expire(start + milliseconds(2000), accept_all, expired));
+  UNIT_ASSERT_EQUAL(id4, expired.front().id);
+}
+
+void TimerWheelTest::test_cascade()
+{
+  timer_wheel wheel;
+  auto h = std::make_shared<EchoServer>();
+  auto start = timer_wheel::clock::now();
+
+  // one timer per level
+  std::vector<milliseconds> offsets = {
+    milliseconds(100), milliseconds(300), milliseconds(70000), milliseconds(20000000)
+  };
+  std::vector<timer_id> ids;
+  for (const auto &offset : offsets) {
+    ids.push_back(wheel.schedule(h, offset, milliseconds::zero(), start));
+  }
+
+  timer_wheel::t_expired_timers expired;
+  for (std::size_t i = 0; i < offsets.size(); ++i) {
+    UNIT_ASSERT_EQUAL(0UL, wheel.expire(start + offsets[i] - milliseconds(1), accept_all, expired));
+    UNIT_ASSERT_EQUAL(1UL, wheel.expire(start + offsets[i], accept_all, expired));
+    UNIT_ASSERT_EQUAL(ids[i], expired.back().id);
+  }
+  UNIT_ASSERT_TRUE(wheel.empty());
+}
+
+void TimerWheelTest::test_reject()
+{
+  timer_wheel wheel;
+  auto h = std::make_shared<EchoServer>();
+  auto start = timer_wheel::clock::now();
+
+  auto id = wheel.schedule(h, milliseconds(10), milliseconds::zero(), start);
+
+  timer_wheel::t_expired_timers expired;
+  auto reject_all = [](const timer_wheel::expired_timer&) { return false; };
+  UNIT_ASSERT_EQUAL(0UL, wheel.expire(start + milliseconds(10), reject_all, expired));
+  UNIT_ASSERT_TRUE(wheel.is_scheduled(id));
+  UNIT_ASSERT_EQUAL(0L, wheel.next_expiry(start + milliseconds(11)));
+
+  UNIT_ASSERT_EQUAL(1UL, wheel.expire(start + milliseconds(11), accept_all, expired));
+  UNIT_ASSERT_EQUAL(id, expired.front().id);
+  UNIT_ASSERT_TRUE(wheel.empty());
+}
+
+void TimerWheelTest::test_next_expiry()
+{
+  timer_wheel wheel;
+  auto h = std::make_shared<EchoServer>();
+  auto start = timer_wheel::clock::now();
+
+  UNIT_ASSERT_EQUAL(-1L, wheel.next_expiry(start));
+
+  wheel.schedule(h, milliseconds(10), milliseconds::zero(), start);
+
+  auto next = wheel.next_expiry(start);
+  UNIT_ASSERT_GREATER(next, 0L);
+  UNIT_ASSERT_LESS(next, 11L);
+
+  UNIT_ASSERT_EQUAL(0L, wheel.next_expiry(start + milliseconds(10)));
+
+  wheel.clear();
+  UNIT_ASSERT_EQUAL(-1L, wheel.next_expiry(start));
+}
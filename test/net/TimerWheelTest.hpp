@@ -0,0 +1,20 @@
+#ifndef MATADOR_TIMERWHEELTEST_HPP
+#define MATADOR_TIMERWHEELTEST_HPP
+
+#include "matador/unit/unit_test.hpp"
+
+class TimerWheelTest : public matador::unit_test
+{
+public:
+  TimerWheelTest();
+
+  void test_schedule();
+  void test_interval();
+  void test_cancel();
+  void test_cascade();
+  void test_reject();
+  void test_next_expiry();
+};
+
+
+#endif //MATADOR_TIMERWHEELTEST_HPP
@@ -12,6 +12,7 @@
 #include "utils/AnyTestUnit.hpp"
 #include "utils/Base64Test.hpp"
 #include "utils/BufferViewTest.hpp"
+#include "utils/BufferChainTest.hpp"
 #include "utils/BlobTestUnit.hpp"
 #include "utils/DateTestUnit.hpp"
 #include "utils/FileTestUnit.hpp"
@@ -70,6 +71,7 @@
 #include "net/SocketTest.hpp"
 #include "net/FDSetTest.hpp"
 #include "net/ReactorTest.hpp"
+#include "net/TimerWheelTest.hpp"
 #include "net/IOServiceTest.hpp"
 #include "net/AddressResolverTest.hpp"
 #include "net/SocketInterrupterTest.hpp"
@@ -77,13 +79,20 @@
 
 #include "http/HttpServerTest.hpp"
 #include "http/HttpClientTest.hpp"
+#include "http/AsyncClientTest.hpp"
 #include "http/JwtTest.hpp"
 #include "http/RequestParserTest.hpp"
 #include "http/ResponseParserTest.hpp"
 #include "http/RouteEngineTest.hpp"
 #include "http/RouteEndpointTest.hpp"
 #include "http/TemplateEngineTest.hpp"
+#include "http/TemplateRepositoryTest.hpp"
 #include "http/MiddlewareTest.hpp"
+#include "http/StaticFileCacheTest.hpp"
+#if defined(MATADOR_ZLIB)
+#include "http/CompressionMiddlewareTest.hpp"
+#include "http/ResponseCacheMiddlewareTest.hpp"
+#endif
 
 #include "connections.hpp"
 
@@ -120,6 +129,7 @@ int main(int argc, char *argv[])
   suite.register_unit(new AnyTestUnit);
   suite.register_unit(new Base64Test);
   suite.register_unit(new BufferViewTest);
+  suite.register_unit(new BufferChainTest);
   suite.register_unit(new DateTestUnit);
   suite.register_unit(new TimeTestUnit);
   suite.register_unit(new FileTestUnit);
@@ -166,6 +176,7 @@ int main(int argc, char *argv[])
   suite.register_unit(new SocketTest);
   suite.register_unit(new FDSetTest);
   suite.register_unit(new ReactorTest);
+  suite.register_unit(new TimerWheelTest);
   suite.register_unit(new IOServiceTest);
   suite.register_unit(new AddressResolverTest);
   suite.register_unit(new SocketInterrupterTest);
@@ -173,13 +184,20 @@ int main(int argc, char *argv[])
 
   suite.register_unit(new HttpServerTest);
   suite.register_unit(new HttpClientTest);
+  suite.register_unit(new AsyncClientTest);
   suite.register_unit(new JwtTest);
   suite.register_unit(new RequestParserTest);
   suite.register_unit(new ResponseParserTest);
   suite.register_unit(new RouteEngineTest);
   suite.register_unit(new RouteEndpointTest);
   suite.register_unit(new TemplateEngineTest);
+  suite.register_unit(new TemplateRepositoryTest);
   suite.register_unit(new MiddlewareTest);
+  suite.register_unit(new StaticFileCacheTest);
+#if defined(MATADOR_ZLIB)
+  suite.register_unit(new CompressionMiddlewareTest);
+  suite.register_unit(new ResponseCacheMiddlewareTest);
+#endif
 
   suite.register_unit(new ConnectionInfoTest());
 
@@ -0,0 +1,156 @@
+#include "BufferChainTest.hpp"
+
+#include "matador/utils/buffer_chain.hpp"
+
+#include <cstring>
+
+using namespace matador;
+
+BufferChainTest::BufferChainTest()
+  : matador::unit_test("buffer_chain", "buffer pool and chain tests")
+{
+  add_test("pool", [this]() { test_pool(); }, "test buffer pool");
+  add_test("append", [this]() { test_append(); }, "test buffer chain append");
+  add_test("prepare_commit", [this]() { test_prepare_commit(); }, "test buffer chain prepare and commit");
+  add_test("consume", [this]() { test_consume(); }, "test buffer chain consume");
+  add_test("share", [this]() { test_share(); }, "test buffer chain share");
+}
+
+void BufferChainTest::test_pool()
+{
+  buffer_pool pool(64, 4);
+
+  UNIT_ASSERT_EQUAL(0UL, pool.allocated());
+
+  auto s1 = pool.acquire();
+  UNIT_ASSERT_TRUE(static_cast<bool>(s1));
+  UNIT_ASSERT_EQUAL(64UL, s1.capacity());
+  UNIT_ASSERT_EQUAL(1UL, s1.use_count());
+  UNIT_ASSERT_EQUAL(4UL, pool.allocated());
+  UNIT_ASSERT_EQUAL(1UL, pool.in_use());
+  UNIT_ASSERT_EQUAL(3UL, pool.available());
+
+  {
+    auto s2 = s1;
+    UNIT_ASSERT_EQUAL(2UL, s1.use_count());
+    UNIT_ASSERT_EQUAL(s1.data(), s2.data());
+  }
+  UNIT_ASSERT_EQUAL(1UL, s1.use_count());
+
+  char *data = s1.data();
+  s1.reset();
+  UNIT_ASSERT_FALSE(static_cast<bool>(s1));
+  UNIT_ASSERT_EQUAL(0UL, pool.in_use());
+
+  // released segment is reused
+  auto s3 = pool.acquire();
+  UNIT_ASSERT_EQUAL(data, s3.data());
+
+  std::vector<segment_ref> segments;
+  for (int i = 0; i < 4; ++i) {
+    segments.push_back(pool.acquire());
+  }
+  UNIT_ASSERT_EQUAL(8UL, pool.allocated());
+  UNIT_ASSERT_EQUAL(5UL, pool.in_use());
+}
+
+void BufferChainTest::test_append()
+{
+  buffer_pool pool(16, 2);
+  buffer_chain chain(pool);
+
+  UNIT_ASSERT_TRUE(chain.empty());
+  UNIT_ASSERT_EQUAL(0UL, pool.in_use());
+
+  std::string data("hello world, this is a chained message");
+  chain.append(data);
+
+  UNIT_ASSERT_EQUAL(data.size(), chain.size());
+  UNIT_ASSERT_EQUAL(3UL, chain.slices().size());
+  UNIT_ASSERT_EQUAL(3UL, pool.in_use());
+  UNIT_ASSERT_EQUAL(data, chain.to_string());
+
+  auto buffers = chain.to_buffers();
+  UNIT_ASSERT_EQUAL(3UL, buffers.size());
+  UNIT_ASSERT_EQUAL(16UL, buffers.front().size());
+
+  chain.clear();
+  UNIT_ASSERT_TRUE(chain.empty());
+  UNIT_ASSERT_EQUAL(0UL, pool.in_use());
+}
+
+void BufferChainTest::test_prepare_commit()
+{
+  buffer_pool pool(16, 2);
+  buffer_chain chain(pool);
+
+  auto view = chain.prepare();
+  UNIT_ASSERT_EQUAL(16UL, view.capacity());
+  UNIT_ASSERT_EQUAL(1UL, pool.in_use());
+
+  // nothing written; segment goes back to the pool
+  chain.commit(0);
+  UNIT_ASSERT_TRUE(chain.empty());
+  UNIT_ASSERT_EQUAL(0UL, pool.in_use());
+
+  view = chain.prepare();
+  std::memcpy(view.data(), "hello", 5);
+  chain.commit(5);
+
+  view = chain.prepare();
+  UNIT_ASSERT_EQUAL(11UL, view.capacity());
+  std::memcpy(view.data(), " world", 6);
+  chain.commit(6);
+
+  UNIT_ASSERT_EQUAL(1UL, chain.slices().size());
+  UNIT_ASSERT_EQUAL("hello world", chain.to_string());
+}
+
+void BufferChainTest::test_consume()
+{
+  buffer_pool pool(8, 4);
+  buffer_chain chain(pool);
+
+  chain.append("0123456789abcdefXYZ");
+  UNIT_ASSERT_EQUAL(3UL, pool.in_use());
+
+  chain.consume(3);
+  UNIT_ASSERT_EQUAL("3456789abcdefXYZ", chain.to_string());
+  UNIT_ASSERT_EQUAL(3UL, pool.in_use());
+
+  chain.consume(5);
+  UNIT_ASSERT_EQUAL("89abcdefXYZ", chain.to_string());
+  UNIT_ASSERT_EQUAL(2UL, pool.in_use());
+
+  chain.consume(100);
+  UNIT_ASSERT_TRUE(chain.empty());
+  UNIT_ASSERT_EQUAL(0UL, pool.in_use());
+}
+
+void BufferChainTest::test_share()
+{
+  buffer_pool pool(8, 4);
+  buffer_chain chain(pool);
+
+  chain.append("GET /index.html");
+
+  auto path = chain.share(4, 11);
+  UNIT_ASSERT_EQUAL("/index.html", path.to_string());
+  UNIT_ASSERT_EQUAL(2UL, path.slices().size());
+  // no data was copied
+  UNIT_ASSERT_EQUAL(2UL, pool.in_use());
+  UNIT_ASSERT_EQUAL(chain.slices().front().data() + 4, path.slices().front().data());
+
+  // shared segment isn't written by the origin chain
+  chain.append("!");
+  UNIT_ASSERT_EQUAL(3UL, pool.in_use());
+  UNIT_ASSERT_EQUAL("GET /index.html!", chain.to_string());
+  UNIT_ASSERT_EQUAL("/index.html", path.to_string());
+
+  // segments live as long as they are referenced
+  chain.clear();
+  UNIT_ASSERT_EQUAL(2UL, pool.in_use());
+  UNIT_ASSERT_EQUAL("/index.html", path.to_string());
+  path.clear();
+  UNIT_ASSERT_EQUAL(0UL, pool.in_use());
+}
@@ -0,0 +1,18 @@
+#ifndef MATADOR_BUFFERCHAINTEST_HPP
+#define MATADOR_BUFFERCHAINTEST_HPP
+
+#include "matador/unit/unit_test.hpp"
+
+class BufferChainTest : public matador::unit_test
+{
+public:
+  BufferChainTest();
+
+  void test_pool();
+  void test_append();
+  void test_prepare_commit();
+  void test_consume();
+  void test_share();
+};
+
+#endif //MATADOR_BUFFERCHAINTEST_HPP
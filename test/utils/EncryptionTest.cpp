@@ -3,11 +3,14 @@
 #include "matador/utils/sha256.hpp"
 #include "matador/utils/hmac.hpp"
 
+#include <cstring>
+
 EncryptionTest::EncryptionTest()
   : matador::unit_test("encryption", "sha256 test")
 {
   add_test("sha256", [this] { test_sha256(); }, "test sha256 hashing");
   add_test("hmac", [this] { test_hmac(); }, "test hmac encryption");
+  add_test("hmac_key", [this] { test_hmac_key(); }, "test hmac with precomputed key");
 }
 
 using namespace matador::ext;
@@ -23,6 +26,23 @@ void EncryptionTest::test_sha256()
   enc = sha256(test, strlen(test));
 
   UNIT_ASSERT_EQUAL("fbc1a9f858ea9e177916964bd88c3d37b91a1e84412765e29950777f265c4b75", enc);
+
+  // padding edge cases and multi block messages
+  UNIT_ASSERT_EQUAL("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", sha256(""));
+  UNIT_ASSERT_EQUAL("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"));
+  UNIT_ASSERT_EQUAL("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0", sha256(std::string(1000000, 'a')));
+
+  SHA256 ctx {};
+  ctx.init();
+  const std::string chunk(100, 'a');
+  for (int i = 0; i < 10000; ++i) {
+    ctx.update(reinterpret_cast<const unsigned char*>(chunk.data()), static_cast<unsigned int>(chunk.size()));
+  }
+  unsigned char digest[SHA256::DIGEST_SIZE];
+  ctx.final(digest);
+  unsigned char expected[SHA256::DIGEST_SIZE];
+  sha256(std::string(1000000, 'a').data(), 1000000, expected, SHA256::DIGEST_SIZE);
+  UNIT_ASSERT_TRUE(memcmp(expected, digest, SHA256::DIGEST_SIZE) == 0);
 }
 
 void EncryptionTest::test_hmac()
@@ -34,3 +54,25 @@ void EncryptionTest::test_hmac()
 
   UNIT_ASSERT_EQUAL("7fdfaa9c9c0931f52d9ebf2538bc99700f2e771f3af1c1d93945c2256c11aedd", result);
 }
+
+void EncryptionTest::test_hmac_key()
+{
+  matador::hmac_key key("mykey");
+
+  UNIT_ASSERT_EQUAL("7fdfaa9c9c0931f52d9ebf2538bc99700f2e771f3af1c1d93945c2256c11aedd", key.sign("helloworld"));
+  // the key is reusable
+  UNIT_ASSERT_EQUAL("7fdfaa9c9c0931f52d9ebf2538bc99700f2e771f3af1c1d93945c2256c11aedd", key.sign("helloworld"));
+  UNIT_ASSERT_EQUAL(matador::hmac("mykey", "hello world"), key.sign("hello world"));
+
+  // RFC 4231 test case 2
+  matador::hmac_key jefe("Jefe");
+  UNIT_ASSERT_EQUAL("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843", jefe.sign("what do ya want for nothing?"));
+
+  unsigned char digest[matador::hmac_key::DIGEST_SIZE];
+  jefe.sign("what do ya want for nothing?", 28, digest);
+  UNIT_ASSERT_EQUAL(0x5b, static_cast<int>(digest[0]));
+  UNIT_ASSERT_EQUAL(0x43, static_cast<int>(digest[matador::hmac_key::DIGEST_SIZE - 1]));
+
+  const std::string message(1000, 'x');
+  UNIT_ASSERT_EQUAL(matador::hmac("Jefe", message), jefe.sign(message));
+}
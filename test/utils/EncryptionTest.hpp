@@ -10,6 +10,7 @@ public:
 
   void test_sha256();
   void test_hmac();
+  void test_hmac_key();
 };
 
 
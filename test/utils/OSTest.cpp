@@ -12,6 +12,7 @@ OSTest::OSTest()
   add_test("rm", std::bind(&OSTest::test_remove_file, this), "os rm file test");
   add_test("move", std::bind(&OSTest::test_rename_file, this), "os move file test");
   add_test("access", std::bind(&OSTest::test_access_file, this), "os access file test");
+  add_test("stat", std::bind(&OSTest::test_stat_file, this), "os stat file test");
 }
 
 void OSTest::test_mkdir()
@@ -129,3 +130,27 @@ void OSTest::test_access_file()
   // delete file
   UNIT_ASSERT_TRUE(os::remove(tempfilename));
 }
+
+void OSTest::test_stat_file()
+{
+  std::string tempfilename("temp.txt");
+
+  os::file_stat st;
+  UNIT_ASSERT_FALSE(os::stat_file(tempfilename, st));
+
+  FILE *f = os::fopen(tempfilename, "w");
+  UNIT_ASSERT_NOT_NULL(f);
+  fputs("hello", f);
+  UNIT_ASSERT_TRUE(os::fclose(f));
+
+  UNIT_ASSERT_TRUE(os::stat_file(tempfilename, st));
+  UNIT_ASSERT_EQUAL(5UL, st.size);
+  UNIT_ASSERT_TRUE(st.mtime > 0);
+
+  // directories aren't regular files
+  UNIT_ASSERT_TRUE(os::mkdir("stat_dir"));
+  UNIT_ASSERT_FALSE(os::stat_file("stat_dir", st));
+  UNIT_ASSERT_TRUE(os::rmdir("stat_dir"));
+
+  UNIT_ASSERT_TRUE(os::remove(tempfilename));
+}
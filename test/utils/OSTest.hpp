@@ -13,6 +13,7 @@ public:
   void test_remove_file();
   void test_rename_file();
   void test_access_file();
+  void test_stat_file();
 };
 
 #endif // OOS_OSTEST_HPP
\ No newline at end of file
@@ -5,12 +5,14 @@
 #include "StringTestUnit.hpp"
 
 #include "matador/utils/string.hpp"
+#include "matador/utils/string_span.hpp"
 
 StringTestUnit::StringTestUnit()
   : unit_test("string", "string test unit")
 {
   add_test("split", std::bind(&StringTestUnit::test_split, this), "test split");
   add_test("trim", std::bind(&StringTestUnit::test_trim, this), "test trim");
+  add_test("span_trim", std::bind(&StringTestUnit::test_span_trim, this), "test string span trim");
 }
 
 void StringTestUnit::test_split()
@@ -37,3 +39,14 @@ void StringTestUnit::test_trim()
 
   UNIT_ASSERT_EQUAL(result, str);
 }
+
+void StringTestUnit::test_span_trim()
+{
+  std::string str(" \t middle \t ");
+
+  auto result = matador::string_span(str).trim();
+
+  UNIT_ASSERT_EQUAL(result.to_string(), "middle");
+  UNIT_ASSERT_TRUE(matador::string_span(" \t ").trim().empty());
+  UNIT_ASSERT_TRUE(matador::string_span().trim().empty());
+}
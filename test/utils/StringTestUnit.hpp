@@ -10,6 +10,7 @@ public:
 
   void test_split();
   void test_trim();
+  void test_span_trim();
 };
 
 